@@ -29,6 +29,7 @@
 
 #include "access/nbtree.h"
 #include "catalog/namespace.h"
+#include "catalog/pg_am.h"
 #include "funcapi.h"
 #include "miscadmin.h"
 #include "utils/builtins.h"
@@ -0,0 +1,40 @@
+-- predictability
+SET synchronous_commit = on;
+
+SELECT 'init' FROM pg_create_logical_replication_slot('regression_slot', 'test_decoding');
+
+CREATE TABLE stream_test(data text);
+
+-- consume DDL
+SELECT data FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1');
+
+-- a transaction exceeding the memory limit is streamed before it commits
+SET logical_decoding_work_mem = '64kB';
+INSERT INTO stream_test SELECT repeat('a', 100) || g.i FROM generate_series(1, 1000) g(i);
+
+SELECT sum((data LIKE 'opening%')::int) > 1 AS multiple_blocks,
+       sum((data LIKE 'opening%')::int) = sum((data LIKE 'closing%')::int) AS balanced,
+       sum((data LIKE 'streaming change%')::int) AS changes,
+       sum((data LIKE 'committing%')::int) AS commits
+FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1', 'stream-changes', '1');
+
+-- aborts of a streamed transaction and its subtransactions are streamed too
+BEGIN;
+INSERT INTO stream_test SELECT repeat('a', 100) || g.i FROM generate_series(1, 1000) g(i);
+SAVEPOINT s1;
+INSERT INTO stream_test SELECT repeat('b', 100) || g.i FROM generate_series(1, 10) g(i);
+ROLLBACK TO SAVEPOINT s1;
+ROLLBACK;
+
+SELECT data FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1', 'stream-changes', '1')
+WHERE data LIKE 'aborting%' OR data LIKE 'committing%';
+
+-- without stream-changes, the same transaction is decoded at commit
+INSERT INTO stream_test SELECT repeat('a', 100) || g.i FROM generate_series(1, 1000) g(i);
+SELECT count(*) FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1')
+WHERE data LIKE 'table public.stream_test: INSERT%';
+
+RESET logical_decoding_work_mem;
+
+DROP TABLE stream_test;
+SELECT pg_drop_replication_slot('regression_slot');
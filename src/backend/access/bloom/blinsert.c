@@ -0,0 +1,416 @@
+/*-------------------------------------------------------------------------
+ *
+ * blinsert.c
+ *		Bloom index build and insert functions.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1990-1993, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/bloom/blinsert.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/bloom.h"
+#include "access/genam.h"
+#include "access/xloginsert.h"
+#include "catalog/index.h"
+#include "miscadmin.h"
+#include "storage/bufmgr.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+
+/*
+ * State of bloom index build.  We accumulate one page data here before
+ * flushing it to buffer manager.
+ */
+typedef struct
+{
+	BloomState	blstate;		/* bloom index state */
+	MemoryContext tmpCtx;		/* temporary memory context reset after each
+								 * tuple */
+	char		data[BLCKSZ];	/* cached page */
+	int64		count;			/* number of tuples in cached page */
+	double		indtuples;		/* total number of tuples indexed */
+} BloomBuildState;
+
+/*
+ * Flush page cached in BloomBuildState.
+ */
+static void
+flushCachedPage(Relation index, BloomBuildState *buildstate)
+{
+	Buffer		buffer = BloomNewBuffer(index);
+
+	START_CRIT_SECTION();
+	memcpy(BufferGetPage(buffer), buildstate->data, BLCKSZ);
+	MarkBufferDirty(buffer);
+	if (RelationNeedsWAL(index))
+		log_newpage_buffer(buffer, true);
+	END_CRIT_SECTION();
+
+	UnlockReleaseBuffer(buffer);
+}
+
+/*
+ * (Re)initialize cached page in BloomBuildState.
+ */
+static void
+initCachedPage(BloomBuildState *buildstate)
+{
+	memset(buildstate->data, 0, BLCKSZ);
+	BloomInitPage(buildstate->data, 0);
+	buildstate->count = 0;
+}
+
+/*
+ * Per-tuple callback from IndexBuildHeapScan.
+ */
+static void
+bloomBuildCallback(Relation index, HeapTuple htup, Datum *values,
+				   bool *isnull, bool tupleIsAlive, void *state)
+{
+	BloomBuildState *buildstate = (BloomBuildState *) state;
+	MemoryContext oldCtx;
+	BloomTuple *itup;
+
+	oldCtx = MemoryContextSwitchTo(buildstate->tmpCtx);
+
+	itup = BloomFormTuple(&buildstate->blstate, &htup->t_self, values, isnull);
+
+	/* Try to add next item to cached page */
+	if (BloomPageAddItem(&buildstate->blstate, buildstate->data, itup))
+	{
+		/* Next item was added successfully */
+		buildstate->count++;
+	}
+	else
+	{
+		/* Cached page is full, flush it out and make a new one */
+		flushCachedPage(index, buildstate);
+
+		CHECK_FOR_INTERRUPTS();
+
+		initCachedPage(buildstate);
+
+		if (!BloomPageAddItem(&buildstate->blstate, buildstate->data, itup))
+		{
+			/* We shouldn't be here since we're inserting to the empty page */
+			elog(ERROR, "could not add new bloom tuple to empty page");
+		}
+
+		/* Next item was added successfully */
+		buildstate->count++;
+	}
+
+	/* Update total tuple count */
+	buildstate->indtuples += 1;
+
+	MemoryContextSwitchTo(oldCtx);
+	MemoryContextReset(buildstate->tmpCtx);
+}
+
+/*
+ * blbuild() -- build a new bloom index.
+ */
+IndexBuildResult *
+blbuild(Relation heap, Relation index, IndexInfo *indexInfo)
+{
+	IndexBuildResult *result;
+	double		reltuples;
+	BloomBuildState *buildstate;
+
+	if (RelationGetNumberOfBlocks(index) != 0)
+		elog(ERROR, "index \"%s\" already contains data",
+			 RelationGetRelationName(index));
+
+	/* Initialize the meta page */
+	BloomInitMetapage(index);
+
+	/* Initialize the bloom build state */
+	buildstate = (BloomBuildState *) palloc0(sizeof(BloomBuildState));
+	initBloomState(&buildstate->blstate, index);
+	buildstate->tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
+											   "Bloom build temporary context",
+											   ALLOCSET_DEFAULT_MINSIZE,
+											   ALLOCSET_DEFAULT_INITSIZE,
+											   ALLOCSET_DEFAULT_MAXSIZE);
+	initCachedPage(buildstate);
+
+	/* Do the heap scan */
+	reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
+								   bloomBuildCallback, (void *) buildstate);
+
+	/* Flush last page if needed (it will be, unless heap was empty) */
+	if (buildstate->count > 0)
+		flushCachedPage(index, buildstate);
+
+	MemoryContextDelete(buildstate->tmpCtx);
+
+	result = (IndexBuildResult *) palloc(sizeof(IndexBuildResult));
+	result->heap_tuples = reltuples;
+	result->index_tuples = buildstate->indtuples;
+
+	pfree(buildstate);
+
+	return result;
+}
+
+/*
+ * blbuildempty() -- build an empty bloom index in the initialization fork
+ */
+void
+blbuildempty(Relation index)
+{
+	Buffer		metabuf;
+
+	/* An empty bloom index has a metapage only. */
+	metabuf =
+		ReadBufferExtended(index, INIT_FORKNUM, P_NEW, RBM_NORMAL, NULL);
+	LockBuffer(metabuf, BUFFER_LOCK_EXCLUSIVE);
+
+	/* Initialize and xlog metabuffer. */
+	START_CRIT_SECTION();
+	BloomFillMetapage(index, BufferGetPage(metabuf));
+	MarkBufferDirty(metabuf);
+	log_newpage_buffer(metabuf, true);
+	END_CRIT_SECTION();
+
+	UnlockReleaseBuffer(metabuf);
+}
+
+/*
+ * Try to add a bloom tuple to the page in the given buffer, which the caller
+ * has locked exclusively.  Returns false, without touching the page, if the
+ * page is deleted or has no room left.
+ */
+static bool
+bloomBufferAddItem(Relation index, BloomState *blstate, Buffer buffer,
+				   BloomTuple *itup)
+{
+	Page		page = BufferGetPage(buffer);
+	bool		isNew = PageIsNew(page);
+
+	/* Uninitialized pages are treated as empty */
+	if (!isNew &&
+		(BloomPageIsDeleted(page) ||
+		 BloomPageGetFreeSpace(blstate, page) < blstate->sizeOfBloomTuple))
+		return false;
+
+	START_CRIT_SECTION();
+
+	if (isNew)
+		BloomInitPage(page, 0);
+	if (!BloomPageAddItem(blstate, page, itup))
+		elog(PANIC, "could not add new bloom tuple to page with free space");
+
+	MarkBufferDirty(buffer);
+
+	if (RelationNeedsWAL(index))
+	{
+		XLogRecPtr	recptr;
+		uint8		info = XLOG_BLOOM_INSERT;
+		int			flags = REGBUF_STANDARD;
+
+		if (isNew)
+		{
+			info |= XLOG_BLOOM_INIT_PAGE;
+			flags |= REGBUF_WILL_INIT;
+		}
+
+		XLogBeginInsert();
+		XLogRegisterBuffer(0, buffer, flags);
+		XLogRegisterBufData(0, (char *) itup, blstate->sizeOfBloomTuple);
+
+		recptr = XLogInsert(RM_BLOOM_ID, info);
+
+		PageSetLSN(page, recptr);
+	}
+
+	END_CRIT_SECTION();
+
+	return true;
+}
+
+/*
+ * blinsert() -- insert a new tuple into a bloom index.
+ *
+ * The metapage keeps a list of pages known to have free space; we try them
+ * in order, advancing the start of the list past the ones that turn out to
+ * be full.  When the list is exhausted we allocate a new page and make it
+ * the only entry of the list.  VACUUM rebuilds the list.
+ */
+bool
+blinsert(Relation index, Datum *values, bool *isnull, ItemPointer ht_ctid,
+		 Relation heapRel, IndexUniqueCheck checkUnique)
+{
+	/* we ignore the rest of our arguments */
+	BloomState	blstate;
+	BloomTuple *itup;
+	MemoryContext oldCtx;
+	MemoryContext insertCtx;
+	BloomMetaPageData *metaData;
+	Buffer		buffer,
+				metaBuffer;
+	BlockNumber blkno = InvalidBlockNumber;
+	OffsetNumber nStart;
+
+	insertCtx = AllocSetContextCreate(CurrentMemoryContext,
+									  "Bloom insert temporary context",
+									  ALLOCSET_DEFAULT_MINSIZE,
+									  ALLOCSET_DEFAULT_INITSIZE,
+									  ALLOCSET_DEFAULT_MAXSIZE);
+
+	oldCtx = MemoryContextSwitchTo(insertCtx);
+
+	initBloomState(&blstate, index);
+	itup = BloomFormTuple(&blstate, ht_ctid, values, isnull);
+
+	/*
+	 * At first, try to insert new tuple to the first page in notFullPage
+	 * array.  If successful, we don't need to modify the meta page.
+	 */
+	metaBuffer = ReadBuffer(index, BLOOM_METAPAGE_BLKNO);
+	LockBuffer(metaBuffer, BUFFER_LOCK_SHARE);
+	metaData = BloomPageGetMeta(BufferGetPage(metaBuffer));
+
+	if (metaData->nEnd > metaData->nStart)
+	{
+		blkno = metaData->notFullPage[metaData->nStart];
+		Assert(blkno != InvalidBlockNumber);
+
+		/* Don't hold metabuffer lock while doing insert */
+		LockBuffer(metaBuffer, BUFFER_LOCK_UNLOCK);
+
+		buffer = ReadBuffer(index, blkno);
+		LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+
+		if (bloomBufferAddItem(index, &blstate, buffer, itup))
+		{
+			/* Success!  Clean up and exit */
+			UnlockReleaseBuffer(buffer);
+			ReleaseBuffer(metaBuffer);
+			MemoryContextSwitchTo(oldCtx);
+			MemoryContextDelete(insertCtx);
+			return false;
+		}
+
+		/* Didn't fit, must try other pages */
+		UnlockReleaseBuffer(buffer);
+	}
+	else
+	{
+		/* No entries in notFullPage */
+		LockBuffer(metaBuffer, BUFFER_LOCK_UNLOCK);
+	}
+
+	/*
+	 * Try other pages in notFullPage array.  We will have to change nStart in
+	 * metapage.  Thus, grab exclusive lock on metapage.
+	 */
+	LockBuffer(metaBuffer, BUFFER_LOCK_EXCLUSIVE);
+
+	/* nStart might have changed while we didn't have lock */
+	nStart = metaData->nStart;
+
+	/* Skip first page if we already tried it above */
+	if (nStart < metaData->nEnd &&
+		blkno == metaData->notFullPage[nStart])
+		nStart++;
+
+	while (nStart < metaData->nEnd)
+	{
+		blkno = metaData->notFullPage[nStart];
+		Assert(blkno != InvalidBlockNumber);
+
+		buffer = ReadBuffer(index, blkno);
+		LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+
+		if (bloomBufferAddItem(index, &blstate, buffer, itup))
+		{
+			UnlockReleaseBuffer(buffer);
+
+			/* Remember the pages we found to be full */
+			START_CRIT_SECTION();
+			metaData->nStart = nStart;
+			MarkBufferDirty(metaBuffer);
+			if (RelationNeedsWAL(index))
+			{
+				XLogRecPtr	recptr;
+				xl_bloom_update_meta xlmeta;
+
+				XLogBeginInsert();
+				BloomRegisterMetaUpdate(0, metaBuffer, &xlmeta, 0);
+
+				recptr = XLogInsert(RM_BLOOM_ID, XLOG_BLOOM_UPDATE_META);
+
+				PageSetLSN(BufferGetPage(metaBuffer), recptr);
+			}
+			END_CRIT_SECTION();
+
+			UnlockReleaseBuffer(metaBuffer);
+			MemoryContextSwitchTo(oldCtx);
+			MemoryContextDelete(insertCtx);
+			return false;
+		}
+
+		/* Didn't fit, must try other pages */
+		UnlockReleaseBuffer(buffer);
+		nStart++;
+	}
+
+	/*
+	 * Didn't find place to insert in notFullPage array.  Allocate new page.
+	 * We keep the exclusive lock on the metapage meanwhile: the new page
+	 * replaces the notFullPage array, in the same WAL record, and no other
+	 * inserter may change the array in between.  This only makes concurrent
+	 * inserters wait for one page allocation, and can't deadlock, since
+	 * BloomNewBuffer locks recycled pages only conditionally and nobody
+	 * waits for the metapage while holding the relation extension lock.
+	 */
+	buffer = BloomNewBuffer(index);
+
+	START_CRIT_SECTION();
+
+	BloomInitPage(BufferGetPage(buffer), 0);
+	if (!BloomPageAddItem(&blstate, BufferGetPage(buffer), itup))
+		elog(PANIC, "could not add new bloom tuple to empty page");
+
+	/* Reset notFullPage array to contain just this new page */
+	metaData->nStart = 0;
+	metaData->nEnd = 1;
+	metaData->notFullPage[0] = BufferGetBlockNumber(buffer);
+
+	MarkBufferDirty(buffer);
+	MarkBufferDirty(metaBuffer);
+
+	if (RelationNeedsWAL(index))
+	{
+		XLogRecPtr	recptr;
+		xl_bloom_update_meta xlmeta;
+
+		XLogBeginInsert();
+		XLogRegisterBuffer(0, buffer, REGBUF_STANDARD | REGBUF_WILL_INIT);
+		XLogRegisterBufData(0, (char *) itup, blstate.sizeOfBloomTuple);
+		BloomRegisterMetaUpdate(1, metaBuffer, &xlmeta, 1);
+
+		recptr = XLogInsert(RM_BLOOM_ID,
+							XLOG_BLOOM_INSERT | XLOG_BLOOM_INIT_PAGE);
+
+		PageSetLSN(BufferGetPage(buffer), recptr);
+		PageSetLSN(BufferGetPage(metaBuffer), recptr);
+	}
+
+	END_CRIT_SECTION();
+
+	UnlockReleaseBuffer(buffer);
+	UnlockReleaseBuffer(metaBuffer);
+
+	MemoryContextSwitchTo(oldCtx);
+	MemoryContextDelete(insertCtx);
+
+	return false;
+}
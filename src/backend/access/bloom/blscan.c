@@ -0,0 +1,190 @@
+/*-------------------------------------------------------------------------
+ *
+ * blscan.c
+ *		Bloom index scan functions.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1990-1993, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/bloom/blscan.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/bloom.h"
+#include "access/relscan.h"
+#include "miscadmin.h"
+#include "nodes/tidbitmap.h"
+#include "storage/bufmgr.h"
+#include "utils/rel.h"
+
+
+/*
+ * Begin scan of bloom index.
+ */
+IndexScanDesc
+blbeginscan(Relation r, int nkeys, int norderbys)
+{
+	IndexScanDesc scan;
+	BloomScanOpaque so;
+
+	scan = RelationGetIndexScan(r, nkeys, norderbys);
+
+	so = (BloomScanOpaque) palloc(sizeof(BloomScanOpaqueData));
+	initBloomState(&so->state, scan->indexRelation);
+	so->sign = NULL;
+
+	scan->opaque = so;
+
+	return scan;
+}
+
+/*
+ * Rescan a bloom index.
+ */
+void
+blrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys, ScanKey orderbys,
+		 int norderbys)
+{
+	BloomScanOpaque so = (BloomScanOpaque) scan->opaque;
+
+	/* other arguments ignored */
+
+	/* The search signature is computed lazily by blgetbitmap */
+	if (so->sign)
+		pfree(so->sign);
+	so->sign = NULL;
+
+	if (scankey && scan->numberOfKeys > 0)
+		memmove(scan->keyData, scankey,
+				scan->numberOfKeys * sizeof(ScanKeyData));
+}
+
+/*
+ * End scan of bloom index.
+ */
+void
+blendscan(IndexScanDesc scan)
+{
+	BloomScanOpaque so = (BloomScanOpaque) scan->opaque;
+
+	if (so->sign)
+		pfree(so->sign);
+	so->sign = NULL;
+	pfree(so);
+}
+
+void
+blmarkpos(IndexScanDesc scan)
+{
+	elog(ERROR, "bloom does not support mark/restore");
+}
+
+void
+blrestrpos(IndexScanDesc scan)
+{
+	elog(ERROR, "bloom does not support mark/restore");
+}
+
+/*
+ * Insert all matching tuples into a bitmap.
+ *
+ * There is no structure to exploit: the whole index is read sequentially,
+ * and every tuple whose signature has all the bits of the search signature
+ * set is a candidate.  All candidates need rechecking, since a bloom
+ * signature admits false positives.
+ */
+int64
+blgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
+{
+	int64		ntids = 0;
+	BlockNumber blkno = BLOOM_HEAD_BLKNO,
+				npages;
+	int			i;
+	BufferAccessStrategy bas;
+	BloomScanOpaque so = (BloomScanOpaque) scan->opaque;
+
+	if (so->sign == NULL)
+	{
+		/* New search: have to calculate search signature */
+		ScanKey		skey = scan->keyData;
+
+		so->sign = palloc0(sizeof(BloomSignatureWord) * so->state.opts.bloomLength);
+
+		for (i = 0; i < scan->numberOfKeys; i++)
+		{
+			/*
+			 * Assume bloom-indexable operators to be strict, so nothing could
+			 * be found for NULL key.
+			 */
+			if (skey->sk_flags & SK_ISNULL)
+			{
+				pfree(so->sign);
+				so->sign = NULL;
+				return 0;
+			}
+
+			/* Add next value to the signature */
+			signValue(&so->state, so->sign, skey->sk_argument,
+					  skey->sk_attno - 1);
+
+			skey++;
+		}
+	}
+
+	/*
+	 * We're going to read the whole index.  This is why we use appropriate
+	 * buffer access strategy.
+	 */
+	bas = GetAccessStrategy(BAS_BULKREAD);
+	npages = RelationGetNumberOfBlocks(scan->indexRelation);
+
+	for (blkno = BLOOM_HEAD_BLKNO; blkno < npages; blkno++)
+	{
+		Buffer		buffer;
+		Page		page;
+
+		buffer = ReadBufferExtended(scan->indexRelation, MAIN_FORKNUM,
+									blkno, RBM_NORMAL, bas);
+
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		page = BufferGetPage(buffer);
+
+		if (!PageIsNew(page) && !BloomPageIsDeleted(page))
+		{
+			OffsetNumber offset,
+						maxOffset = BloomPageGetMaxOffset(page);
+
+			for (offset = 1; offset <= maxOffset; offset++)
+			{
+				BloomTuple *itup = BloomPageGetTuple(&so->state, page, offset);
+				bool		res = true;
+
+				/* Check index signature with scan signature */
+				for (i = 0; i < so->state.opts.bloomLength; i++)
+				{
+					if ((itup->sign[i] & so->sign[i]) != so->sign[i])
+					{
+						res = false;
+						break;
+					}
+				}
+
+				/* Add matching tuples to bitmap */
+				if (res)
+				{
+					tbm_add_tuples(tbm, &itup->heapPtr, 1, true);
+					ntids++;
+				}
+			}
+		}
+
+		UnlockReleaseBuffer(buffer);
+		CHECK_FOR_INTERRUPTS();
+	}
+	FreeAccessStrategy(bas);
+
+	return ntids;
+}
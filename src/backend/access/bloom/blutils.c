@@ -0,0 +1,543 @@
+/*-------------------------------------------------------------------------
+ *
+ * blutils.c
+ *		Bloom index utilities.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1990-1993, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/bloom/blutils.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/bloom.h"
+#include "access/genam.h"
+#include "access/reloptions.h"
+#include "access/xloginsert.h"
+#include "miscadmin.h"
+#include "storage/bufmgr.h"
+#include "storage/indexfsm.h"
+#include "storage/lmgr.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/selfuncs.h"
+
+
+/*
+ * State of the pseudo-random generator used to spread the bits of a value
+ * over the signature.  We use the Park-Miller "minimal standard" generator,
+ * since we need the same sequence of bits for the same value on every
+ * platform, which rules out random().
+ */
+typedef struct BloomRandState
+{
+	int32		next;
+} BloomRandState;
+
+/*
+ * Bloom handler function: return IndexAmRoutine with access method parameters
+ * and callbacks.
+ */
+Datum
+blhandler(PG_FUNCTION_ARGS)
+{
+	IndexAmRoutine *amroutine = makeNode(IndexAmRoutine);
+
+	amroutine->amstrategies = BLOOM_NSTRATEGIES;
+	amroutine->amsupport = BLOOM_NPROC;
+	amroutine->amcanorder = false;
+	amroutine->amcanorderbyop = false;
+	amroutine->amcanbackward = false;
+	amroutine->amcanunique = false;
+	amroutine->amcanmulticol = true;
+	amroutine->amoptionalkey = true;
+	amroutine->amcanskip = false;
+	amroutine->amcaninclude = false;
+	amroutine->amsearcharray = false;
+	amroutine->amsearchnulls = false;
+	amroutine->amstorage = false;
+	amroutine->amclusterable = false;
+	amroutine->ampredlocks = false;
+	amroutine->amkeytype = InvalidOid;
+
+	amroutine->ambuild = blbuild;
+	amroutine->ambuildempty = blbuildempty;
+	amroutine->aminsert = blinsert;
+	amroutine->ambulkdelete = blbulkdelete;
+	amroutine->amvacuumcleanup = blvacuumcleanup;
+	amroutine->amcanreturn = NULL;
+	amroutine->amcostestimate = blcostestimate;
+	amroutine->amoptions = bloptions;
+	amroutine->ambeginscan = blbeginscan;
+	amroutine->amrescan = blrescan;
+	amroutine->amgettuple = NULL;
+	amroutine->amgetbitmap = blgetbitmap;
+	amroutine->amendscan = blendscan;
+	amroutine->ammarkpos = blmarkpos;
+	amroutine->amrestrpos = blrestrpos;
+
+	PG_RETURN_POINTER(amroutine);
+}
+
+static void
+bloomSeed(BloomRandState *rs, uint32 seed)
+{
+	/* Transform to [1, 0x7ffffffe] range */
+	rs->next = (int32) ((seed % 0x7ffffffe) + 1);
+}
+
+static int32
+bloomRand(BloomRandState *rs)
+{
+	int32		hi,
+				lo,
+				x;
+
+	/* Must be in [1, 0x7ffffffe] range at this point */
+	hi = rs->next / 127773;
+	lo = rs->next % 127773;
+	x = 16807 * lo - 2836 * hi;
+	if (x < 0)
+		x += 0x7fffffff;
+	rs->next = x;
+	/* Transform to [0, 0x7ffffffd] range */
+	return (x - 1);
+}
+
+/*
+ * Fill "opts" with the options that apply when none were given.
+ */
+static void
+makeDefaultBloomOptions(BloomOptions *opts)
+{
+	int			i;
+
+	SET_VARSIZE(opts, sizeof(BloomOptions));
+	opts->bloomLength = (DEFAULT_BLOOM_LENGTH + SIGNWORDBITS - 1) / SIGNWORDBITS;
+	for (i = 0; i < INDEX_MAX_KEYS; i++)
+		opts->bitSize[i] = DEFAULT_BLOOM_BITS;
+}
+
+/*
+ * Initialize a BloomState for the given index.
+ *
+ * The options are read from the metapage rather than from the relcache
+ * entry, since the signature length must not change once the index has been
+ * built, even if the reloptions are altered afterwards.  They are cached in
+ * rd_amcache.
+ */
+void
+initBloomState(BloomState *state, Relation index)
+{
+	int			i;
+
+	state->nColumns = index->rd_att->natts;
+
+	/* Initialize hash function for each attribute */
+	for (i = 0; i < index->rd_att->natts; i++)
+	{
+		fmgr_info_copy(&(state->hashFn[i]),
+					   index_getprocinfo(index, i + 1, BLOOM_HASH_PROC),
+					   CurrentMemoryContext);
+		state->collations[i] = index->rd_indcollation[i];
+	}
+
+	/* Initialize amcache if needed with options from metapage */
+	if (!index->rd_amcache)
+	{
+		Buffer		buffer;
+		Page		page;
+		BloomMetaPageData *meta;
+		BloomOptions *opts;
+
+		opts = MemoryContextAlloc(index->rd_indexcxt, sizeof(BloomOptions));
+
+		buffer = ReadBuffer(index, BLOOM_METAPAGE_BLKNO);
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+
+		page = BufferGetPage(buffer);
+
+		if (!BloomPageIsMeta(page))
+			elog(ERROR, "relation \"%s\" is not a bloom index",
+				 RelationGetRelationName(index));
+		meta = BloomPageGetMeta(page);
+
+		if (meta->magickNumber != BLOOM_MAGICK_NUMBER)
+			elog(ERROR, "relation \"%s\" is not a bloom index",
+				 RelationGetRelationName(index));
+
+		*opts = meta->opts;
+
+		UnlockReleaseBuffer(buffer);
+
+		index->rd_amcache = (void *) opts;
+	}
+
+	memcpy(&state->opts, index->rd_amcache, sizeof(state->opts));
+	state->sizeOfBloomTuple = BLOOMTUPLEHDRSZ +
+		sizeof(BloomSignatureWord) * state->opts.bloomLength;
+}
+
+/*
+ * Add bits of given value to the signature.
+ */
+void
+signValue(BloomState *state, BloomSignatureWord *sign, Datum value, int attno)
+{
+	BloomRandState rs;
+	uint32		hashVal;
+	int			nBit,
+				j;
+
+	/*
+	 * Seed the generator with the column number first, so that equal values
+	 * in different columns are not mapped into the same bits.
+	 */
+	bloomSeed(&rs, attno);
+
+	/*
+	 * Then initialize the sequence of bits for this value from its hash.
+	 */
+	hashVal = DatumGetInt32(FunctionCall1Coll(&state->hashFn[attno],
+											  state->collations[attno],
+											  value));
+	bloomSeed(&rs, hashVal ^ bloomRand(&rs));
+
+	for (j = 0; j < state->opts.bitSize[attno]; j++)
+	{
+		nBit = bloomRand(&rs) % (state->opts.bloomLength * SIGNWORDBITS);
+		sign[nBit / SIGNWORDBITS] |= (BloomSignatureWord) 1 << (nBit % SIGNWORDBITS);
+	}
+}
+
+/*
+ * Make bloom tuple from values.
+ */
+BloomTuple *
+BloomFormTuple(BloomState *state, ItemPointer iptr, Datum *values, bool *isnull)
+{
+	int			i;
+	BloomTuple *res = (BloomTuple *) palloc0(state->sizeOfBloomTuple);
+
+	res->heapPtr = *iptr;
+
+	/* Blooming each column; NULLs don't contribute any bits */
+	for (i = 0; i < state->nColumns; i++)
+	{
+		if (isnull[i])
+			continue;
+
+		signValue(state, res->sign, values[i], i);
+	}
+
+	return res;
+}
+
+/*
+ * Add new bloom tuple to the page.  Returns true if new tuple was successfully
+ * added to the page.  Returns false if it doesn't fit on the page, in which
+ * case the page is not modified.
+ */
+bool
+BloomPageAddItem(BloomState *state, Page page, BloomTuple *tuple)
+{
+	/* We shouldn't be pointed to an invalid page */
+	Assert(!PageIsNew(page) && !BloomPageIsDeleted(page));
+
+	/* Does new tuple fit on the page? */
+	if (BloomPageGetFreeSpace(state, page) < state->sizeOfBloomTuple)
+		return false;
+
+	BloomPageAppendTuple(page, tuple, state->sizeOfBloomTuple);
+
+	return true;
+}
+
+/*
+ * Copy a bloom tuple of the given size to the end of the page, which the
+ * caller has checked has room for it.  WAL replay has no BloomState, hence
+ * the explicit size.
+ */
+void
+BloomPageAppendTuple(Page page, BloomTuple *tuple, Size tupleSize)
+{
+	BloomPageOpaque opaque = BloomPageGetOpaque(page);
+	Pointer		ptr;
+
+	/* Copy new tuple to the end of page */
+	ptr = PageGetContents(page) + tupleSize * opaque->maxoff;
+	memcpy(ptr, (Pointer) tuple, tupleSize);
+
+	/* Adjust maxoff and pd_lower */
+	opaque->maxoff++;
+	((PageHeader) page)->pd_lower = (ptr + tupleSize) - page;
+
+	/* Assert we didn't overrun available space */
+	Assert(((PageHeader) page)->pd_lower <= ((PageHeader) page)->pd_upper);
+}
+
+/*
+ * Remove the tuples at the given offsets, which must be in ascending order,
+ * from a data page, moving the surviving tuples down over them.  A page left
+ * empty is marked deleted.
+ */
+void
+BloomPageDeleteItems(Page page, Size tupleSize, OffsetNumber *deleted,
+					 int ndeleted)
+{
+	OffsetNumber maxoff = BloomPageGetMaxOffset(page);
+	OffsetNumber offset;
+	Pointer		itup,
+				itupPtr;
+	int			i = 0;
+
+	itupPtr = PageGetContents(page);
+	for (offset = FirstOffsetNumber; offset <= maxoff; offset++)
+	{
+		if (i < ndeleted && deleted[i] == offset)
+		{
+			i++;
+			continue;
+		}
+
+		itup = PageGetContents(page) + tupleSize * (offset - 1);
+		if (itupPtr != itup)
+			memmove(itupPtr, itup, tupleSize);
+		itupPtr += tupleSize;
+	}
+	Assert(i == ndeleted);
+
+	BloomPageGetOpaque(page)->maxoff = maxoff - ndeleted;
+
+	/* Is it empty page now? */
+	if (BloomPageGetMaxOffset(page) == 0)
+		BloomPageSetDeleted(page);
+
+	/* Adjust pd_lower */
+	((PageHeader) page)->pd_lower = itupPtr - page;
+}
+
+/*
+ * Register the metapage with the WAL record being assembled, as block
+ * block_id, after nStart, nEnd and the first nPages entries of its list of
+ * pages with free space have been changed.  *xlmeta must stay valid until
+ * XLogInsert.
+ */
+void
+BloomRegisterMetaUpdate(uint8 block_id, Buffer metaBuffer,
+						xl_bloom_update_meta *xlmeta, int nPages)
+{
+	BloomMetaPageData *metaData;
+
+	metaData = BloomPageGetMeta(BufferGetPage(metaBuffer));
+	xlmeta->nStart = metaData->nStart;
+	xlmeta->nEnd = metaData->nEnd;
+	xlmeta->nPages = nPages;
+
+	XLogRegisterBuffer(block_id, metaBuffer, REGBUF_STANDARD);
+	XLogRegisterBufData(block_id, (char *) xlmeta, SizeOfBloomUpdateMeta);
+	if (nPages > 0)
+		XLogRegisterBufData(block_id, (char *) metaData->notFullPage,
+							sizeof(BlockNumber) * nPages);
+}
+
+/*
+ * Allocate a new page (either by recycling, or by extending the index file)
+ * The returned buffer is already pinned and exclusive-locked
+ * Caller is responsible for initializing the page by calling BloomInitPage
+ */
+Buffer
+BloomNewBuffer(Relation index)
+{
+	Buffer		buffer;
+	bool		needLock;
+
+	/* First, try to get a page from FSM */
+	for (;;)
+	{
+		BlockNumber blkno = GetFreeIndexPage(index);
+
+		if (blkno == InvalidBlockNumber)
+			break;
+
+		buffer = ReadBuffer(index, blkno);
+
+		/*
+		 * We have to guard against the possibility that someone else already
+		 * recycled this page; the buffer may be locked if so.
+		 */
+		if (ConditionalLockBuffer(buffer))
+		{
+			Page		page = BufferGetPage(buffer);
+
+			if (PageIsNew(page))
+				return buffer;	/* OK to use, if never initialized */
+
+			if (BloomPageIsDeleted(page))
+				return buffer;	/* OK to use */
+
+			LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
+		}
+
+		/* Can't use it, so release buffer and try again */
+		ReleaseBuffer(buffer);
+	}
+
+	/* Must extend the file */
+	needLock = !RELATION_IS_LOCAL(index);
+	if (needLock)
+		LockRelationForExtension(index, ExclusiveLock);
+
+	buffer = ReadBuffer(index, P_NEW);
+	LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+
+	if (needLock)
+		UnlockRelationForExtension(index, ExclusiveLock);
+
+	return buffer;
+}
+
+/*
+ * Initialize any page of a bloom index.
+ */
+void
+BloomInitPage(Page page, uint16 flags)
+{
+	BloomPageOpaque opaque;
+
+	PageInit(page, BLCKSZ, sizeof(BloomPageOpaqueData));
+
+	opaque = BloomPageGetOpaque(page);
+	memset(opaque, 0, sizeof(BloomPageOpaqueData));
+	opaque->flags = flags;
+	opaque->bloom_page_id = BLOOM_PAGE_ID;
+}
+
+/*
+ * Fill in metapage for bloom index.
+ */
+void
+BloomFillMetapage(Relation index, Page metaPage)
+{
+	BloomOptions defaultOpts;
+	BloomOptions *opts;
+	BloomMetaPageData *metadata;
+
+	/*
+	 * Choose the index's options.  If reloptions have been assigned, use
+	 * those, otherwise create default options.  This may be called in a
+	 * critical section, so don't palloc.
+	 */
+	opts = (BloomOptions *) index->rd_options;
+	if (!opts)
+	{
+		makeDefaultBloomOptions(&defaultOpts);
+		opts = &defaultOpts;
+	}
+
+	/*
+	 * Initialize contents of meta page, including a copy of the options,
+	 * which are now frozen for the life of the index.
+	 */
+	BloomInitPage(metaPage, BLOOM_META);
+	metadata = BloomPageGetMeta(metaPage);
+	memset(metadata, 0, sizeof(BloomMetaPageData));
+	metadata->magickNumber = BLOOM_MAGICK_NUMBER;
+	metadata->opts = *opts;
+	((PageHeader) metaPage)->pd_lower += sizeof(BloomMetaPageData);
+
+	/* If this fails, probably FreeBlockNumberArray size calc is wrong: */
+	Assert(((PageHeader) metaPage)->pd_lower <= ((PageHeader) metaPage)->pd_upper);
+}
+
+/*
+ * Initialize metapage for bloom index.
+ *
+ * Bloom indexes have no WAL resource manager of their own: every change to
+ * a page is logged as a full image of the page, which is what
+ * log_newpage_buffer() does for us.  Since all pages follow the standard
+ * layout, with pd_lower pointing just past the last tuple, the unused part of
+ * the page is left out of the record.
+ */
+void
+BloomInitMetapage(Relation index)
+{
+	Buffer		metaBuffer;
+
+	/*
+	 * Make a new page; since it is first page it should be associated with
+	 * block number 0 (BLOOM_METAPAGE_BLKNO).
+	 */
+	metaBuffer = BloomNewBuffer(index);
+	Assert(BufferGetBlockNumber(metaBuffer) == BLOOM_METAPAGE_BLKNO);
+
+	START_CRIT_SECTION();
+	BloomFillMetapage(index, BufferGetPage(metaBuffer));
+	MarkBufferDirty(metaBuffer);
+	if (RelationNeedsWAL(index))
+		log_newpage_buffer(metaBuffer, true);
+	END_CRIT_SECTION();
+
+	UnlockReleaseBuffer(metaBuffer);
+}
+
+/*
+ * reloptions processor for bloom indexes
+ */
+#define BLOOM_COL_RELOPT(n) \
+	{"col" CppAsString(n), RELOPT_TYPE_INT, \
+		offsetof(BloomOptions, bitSize) + sizeof(int) * ((n) - 1)}
+
+bytea *
+bloptions(Datum reloptions, bool validate)
+{
+	relopt_value *options;
+	BloomOptions *rdopts;
+	int			numoptions;
+	int			i;
+	static const relopt_parse_elt tab[] = {
+		{"length", RELOPT_TYPE_INT, offsetof(BloomOptions, bloomLength)},
+		BLOOM_COL_RELOPT(1), BLOOM_COL_RELOPT(2), BLOOM_COL_RELOPT(3),
+		BLOOM_COL_RELOPT(4), BLOOM_COL_RELOPT(5), BLOOM_COL_RELOPT(6),
+		BLOOM_COL_RELOPT(7), BLOOM_COL_RELOPT(8), BLOOM_COL_RELOPT(9),
+		BLOOM_COL_RELOPT(10), BLOOM_COL_RELOPT(11), BLOOM_COL_RELOPT(12),
+		BLOOM_COL_RELOPT(13), BLOOM_COL_RELOPT(14), BLOOM_COL_RELOPT(15),
+		BLOOM_COL_RELOPT(16), BLOOM_COL_RELOPT(17), BLOOM_COL_RELOPT(18),
+		BLOOM_COL_RELOPT(19), BLOOM_COL_RELOPT(20), BLOOM_COL_RELOPT(21),
+		BLOOM_COL_RELOPT(22), BLOOM_COL_RELOPT(23), BLOOM_COL_RELOPT(24),
+		BLOOM_COL_RELOPT(25), BLOOM_COL_RELOPT(26), BLOOM_COL_RELOPT(27),
+		BLOOM_COL_RELOPT(28), BLOOM_COL_RELOPT(29), BLOOM_COL_RELOPT(30),
+		BLOOM_COL_RELOPT(31), BLOOM_COL_RELOPT(32)
+	};
+
+	StaticAssertStmt(lengthof(tab) == BLOOM_NCOLUMN_OPTIONS + 1,
+					 "bloom column options out of sync");
+	StaticAssertStmt(BLOOM_NCOLUMN_OPTIONS <= INDEX_MAX_KEYS,
+					 "more bloom column options than index columns");
+
+	options = parseRelOptions(reloptions, validate, RELOPT_KIND_BLOOM,
+							  &numoptions);
+
+	/* if none set, we're done */
+	if (numoptions == 0)
+		return NULL;
+
+	rdopts = allocateReloptStruct(sizeof(BloomOptions), options, numoptions);
+
+	fillRelOptions((void *) rdopts, sizeof(BloomOptions), options, numoptions,
+				   validate, tab, lengthof(tab));
+
+	/* Convert signature length from # of bits to # to words, rounding up */
+	rdopts->bloomLength = (rdopts->bloomLength + SIGNWORDBITS - 1) / SIGNWORDBITS;
+
+	/* Columns without an option of their own get the default */
+	for (i = BLOOM_NCOLUMN_OPTIONS; i < INDEX_MAX_KEYS; i++)
+		rdopts->bitSize[i] = DEFAULT_BLOOM_BITS;
+
+	pfree(options);
+
+	return (bytea *) rdopts;
+}
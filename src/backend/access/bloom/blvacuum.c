@@ -0,0 +1,226 @@
+/*-------------------------------------------------------------------------
+ *
+ * blvacuum.c
+ *		Bloom VACUUM functions.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1990-1993, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/bloom/blvacuum.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/bloom.h"
+#include "access/genam.h"
+#include "access/xloginsert.h"
+#include "commands/vacuum.h"
+#include "miscadmin.h"
+#include "storage/bufmgr.h"
+#include "storage/indexfsm.h"
+#include "utils/rel.h"
+
+
+/*
+ * Bulk deletion of all index entries pointing to a set of heap tuples.
+ * The set of target tuples is specified via a callback routine that tells
+ * whether any given heap tuple (identified by ItemPointer) is being deleted.
+ *
+ * Result: a palloc'd struct containing statistical info for VACUUM displays.
+ */
+IndexBulkDeleteResult *
+blbulkdelete(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
+			 IndexBulkDeleteCallback callback, void *callback_state)
+{
+	Relation	index = info->index;
+	BlockNumber blkno,
+				npages;
+	FreeBlockNumberArray notFullPage;
+	int			countPage = 0;
+	BloomState	state;
+	Buffer		buffer;
+	Page		page;
+	BloomMetaPageData *metaData;
+	OffsetNumber deletable[MaxOffsetNumber];
+
+	if (stats == NULL)
+		stats = (IndexBulkDeleteResult *) palloc0(sizeof(IndexBulkDeleteResult));
+
+	initBloomState(&state, index);
+
+	/*
+	 * Iterate over the pages. We don't care about concurrently added pages,
+	 * they can't contain tuples to delete.
+	 */
+	npages = RelationGetNumberOfBlocks(index);
+	for (blkno = BLOOM_HEAD_BLKNO; blkno < npages; blkno++)
+	{
+		BloomTuple *itup;
+		OffsetNumber maxoff,
+					offset;
+		int			ndeletable = 0;
+
+		vacuum_delay_point();
+
+		buffer = ReadBufferExtended(index, MAIN_FORKNUM, blkno,
+									RBM_NORMAL, info->strategy);
+
+		LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+		page = BufferGetPage(buffer);
+
+		/* There is no need to vacuum deleted pages or new pages */
+		if (PageIsNew(page) || BloomPageIsDeleted(page))
+		{
+			UnlockReleaseBuffer(buffer);
+			continue;
+		}
+
+		/* Find out which tuples have to go, before touching the page */
+		maxoff = BloomPageGetMaxOffset(page);
+		for (offset = FirstOffsetNumber; offset <= maxoff; offset++)
+		{
+			itup = BloomPageGetTuple(&state, page, offset);
+			if (callback(&itup->heapPtr, callback_state))
+				deletable[ndeletable++] = offset;
+		}
+
+		if (ndeletable > 0)
+		{
+			START_CRIT_SECTION();
+
+			BloomPageDeleteItems(page, state.sizeOfBloomTuple,
+								 deletable, ndeletable);
+
+			MarkBufferDirty(buffer);
+
+			if (RelationNeedsWAL(index))
+			{
+				XLogRecPtr	recptr;
+				xl_bloom_vacuum_page xlrec;
+
+				xlrec.tupleSize = state.sizeOfBloomTuple;
+				xlrec.ndeleted = ndeletable;
+
+				XLogBeginInsert();
+				XLogRegisterData((char *) &xlrec, SizeOfBloomVacuumPage);
+				XLogRegisterBuffer(0, buffer, REGBUF_STANDARD);
+				XLogRegisterBufData(0, (char *) deletable,
+									sizeof(OffsetNumber) * ndeletable);
+
+				recptr = XLogInsert(RM_BLOOM_ID, XLOG_BLOOM_VACUUM_PAGE);
+
+				PageSetLSN(page, recptr);
+			}
+
+			END_CRIT_SECTION();
+
+			stats->tuples_removed += ndeletable;
+		}
+
+		/*
+		 * Add page to new notFullPage list if we will not mark page as
+		 * deleted and there is free space on it
+		 */
+		if (BloomPageGetMaxOffset(page) != 0 &&
+			BloomPageGetFreeSpace(&state, page) >= state.sizeOfBloomTuple &&
+			countPage < BloomMetaBlockN)
+			notFullPage[countPage++] = blkno;
+
+		UnlockReleaseBuffer(buffer);
+	}
+
+	/*
+	 * Update the metapage's notFullPage list with whatever we found.  Our
+	 * info could already be out of date at this point, but blinsert() will
+	 * cope if so.
+	 */
+	buffer = ReadBuffer(index, BLOOM_METAPAGE_BLKNO);
+	LockBuffer(buffer, BUFFER_LOCK_EXCLUSIVE);
+
+	START_CRIT_SECTION();
+
+	page = BufferGetPage(buffer);
+	metaData = BloomPageGetMeta(page);
+	memcpy(metaData->notFullPage, notFullPage, sizeof(BlockNumber) * countPage);
+	metaData->nStart = 0;
+	metaData->nEnd = countPage;
+
+	MarkBufferDirty(buffer);
+
+	if (RelationNeedsWAL(index))
+	{
+		XLogRecPtr	recptr;
+		xl_bloom_update_meta xlmeta;
+
+		XLogBeginInsert();
+		BloomRegisterMetaUpdate(0, buffer, &xlmeta, countPage);
+
+		recptr = XLogInsert(RM_BLOOM_ID, XLOG_BLOOM_UPDATE_META);
+
+		PageSetLSN(page, recptr);
+	}
+
+	END_CRIT_SECTION();
+
+	UnlockReleaseBuffer(buffer);
+
+	return stats;
+}
+
+/*
+ * Post-VACUUM cleanup.
+ *
+ * Result: a palloc'd struct containing statistical info for VACUUM displays.
+ */
+IndexBulkDeleteResult *
+blvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
+{
+	Relation	index = info->index;
+	BlockNumber npages,
+				blkno;
+
+	if (info->analyze_only)
+		return stats;
+
+	if (stats == NULL)
+		stats = (IndexBulkDeleteResult *) palloc0(sizeof(IndexBulkDeleteResult));
+
+	/*
+	 * Iterate over the pages: insert deleted pages into FSM and collect
+	 * statistics.
+	 */
+	npages = RelationGetNumberOfBlocks(index);
+	stats->num_pages = npages;
+	stats->pages_free = 0;
+	stats->num_index_tuples = 0;
+	for (blkno = BLOOM_HEAD_BLKNO; blkno < npages; blkno++)
+	{
+		Buffer		buffer;
+		Page		page;
+
+		vacuum_delay_point();
+
+		buffer = ReadBufferExtended(index, MAIN_FORKNUM, blkno,
+									RBM_NORMAL, info->strategy);
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		page = (Page) BufferGetPage(buffer);
+
+		if (PageIsNew(page) || BloomPageIsDeleted(page))
+		{
+			RecordFreeIndexPage(index, blkno);
+			stats->pages_free++;
+		}
+		else
+		{
+			stats->num_index_tuples += BloomPageGetMaxOffset(page);
+		}
+
+		UnlockReleaseBuffer(buffer);
+	}
+
+	IndexFreeSpaceMapVacuum(info->index);
+
+	return stats;
+}
@@ -0,0 +1,142 @@
+/*-------------------------------------------------------------------------
+ *
+ * blxlog.c
+ *		WAL replay logic for bloom indexes.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/bloom/blxlog.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/bloom.h"
+#include "access/xlogutils.h"
+#include "storage/bufmgr.h"
+
+
+/*
+ * Apply the change to the metapage's free page list carried as the data of
+ * the given block.
+ */
+static void
+bloomRedoUpdateMeta(XLogReaderState *record, uint8 block_id)
+{
+	XLogRecPtr	lsn = record->EndRecPtr;
+	Buffer		buffer;
+
+	if (XLogReadBufferForRedo(record, block_id, &buffer) == BLK_NEEDS_REDO)
+	{
+		Page		page = BufferGetPage(buffer);
+		BloomMetaPageData *metaData = BloomPageGetMeta(page);
+		xl_bloom_update_meta *xlmeta;
+		Size		datalen;
+
+		xlmeta = (xl_bloom_update_meta *)
+			XLogRecGetBlockData(record, block_id, &datalen);
+		Assert(datalen == SizeOfBloomUpdateMeta +
+			   sizeof(BlockNumber) * xlmeta->nPages);
+
+		metaData->nStart = xlmeta->nStart;
+		metaData->nEnd = xlmeta->nEnd;
+		if (xlmeta->nPages > 0)
+			memcpy(metaData->notFullPage,
+				   (char *) xlmeta + SizeOfBloomUpdateMeta,
+				   sizeof(BlockNumber) * xlmeta->nPages);
+
+		PageSetLSN(page, lsn);
+		MarkBufferDirty(buffer);
+	}
+	if (BufferIsValid(buffer))
+		UnlockReleaseBuffer(buffer);
+}
+
+/*
+ * replay insertion of a tuple, possibly on a new page
+ */
+static void
+bloomRedoInsert(XLogReaderState *record)
+{
+	XLogRecPtr	lsn = record->EndRecPtr;
+	Buffer		buffer;
+	XLogRedoAction action;
+
+	if (XLogRecGetInfo(record) & XLOG_BLOOM_INIT_PAGE)
+	{
+		buffer = XLogInitBufferForRedo(record, 0);
+		BloomInitPage(BufferGetPage(buffer), 0);
+		action = BLK_NEEDS_REDO;
+	}
+	else
+		action = XLogReadBufferForRedo(record, 0, &buffer);
+
+	if (action == BLK_NEEDS_REDO)
+	{
+		Page		page = BufferGetPage(buffer);
+		BloomTuple *tuple;
+		Size		tupleSize;
+
+		tuple = (BloomTuple *) XLogRecGetBlockData(record, 0, &tupleSize);
+		BloomPageAppendTuple(page, tuple, tupleSize);
+
+		PageSetLSN(page, lsn);
+		MarkBufferDirty(buffer);
+	}
+	if (BufferIsValid(buffer))
+		UnlockReleaseBuffer(buffer);
+
+	if (XLogRecHasBlockRef(record, 1))
+		bloomRedoUpdateMeta(record, 1);
+}
+
+/*
+ * replay removal of tuples from a data page by VACUUM
+ */
+static void
+bloomRedoVacuumPage(XLogReaderState *record)
+{
+	XLogRecPtr	lsn = record->EndRecPtr;
+	xl_bloom_vacuum_page *xlrec = (xl_bloom_vacuum_page *) XLogRecGetData(record);
+	Buffer		buffer;
+
+	if (XLogReadBufferForRedo(record, 0, &buffer) == BLK_NEEDS_REDO)
+	{
+		Page		page = BufferGetPage(buffer);
+		OffsetNumber *deleted;
+		Size		datalen;
+
+		deleted = (OffsetNumber *) XLogRecGetBlockData(record, 0, &datalen);
+		Assert(datalen == sizeof(OffsetNumber) * xlrec->ndeleted);
+
+		BloomPageDeleteItems(page, xlrec->tupleSize, deleted, xlrec->ndeleted);
+
+		PageSetLSN(page, lsn);
+		MarkBufferDirty(buffer);
+	}
+	if (BufferIsValid(buffer))
+		UnlockReleaseBuffer(buffer);
+}
+
+void
+bloom_redo(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+
+	switch (info & XLOG_BLOOM_OPMASK)
+	{
+		case XLOG_BLOOM_INSERT:
+			bloomRedoInsert(record);
+			break;
+		case XLOG_BLOOM_UPDATE_META:
+			bloomRedoUpdateMeta(record, 0);
+			break;
+		case XLOG_BLOOM_VACUUM_PAGE:
+			bloomRedoVacuumPage(record);
+			break;
+		default:
+			elog(PANIC, "bloom_redo: unknown op code %u", info);
+	}
+}
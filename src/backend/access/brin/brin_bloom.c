@@ -0,0 +1,480 @@
+/*
+ * brin_bloom.c
+ *		Implementation of Bloom opclass for BRIN
+ *
+ * A bloom filter summarizes the set of values appearing in a page range in
+ * a fixed-size bitmap, which can be used to rule out ranges that cannot
+ * contain a given value.  This works for equality searches on data types
+ * that have a hash function, without requiring any correlation between the
+ * values and their physical location in the table; it's intended for
+ * columns such as UUIDs or device identifiers, for which minmax summaries
+ * are useless.
+ *
+ * Each value is hashed once with the data type's default hash function, and
+ * the k bit positions in the filter are derived from that hash using double
+ * hashing, as described in "Less Hashing, Same Performance: Building a
+ * Better Bloom Filter" by Kirsch and Mitzenmacher.
+ *
+ * The size of the filter is determined by the number of distinct values we
+ * expect in a page range (a fixed fraction of the maximum number of tuples
+ * that fit in it) and the desired false positive rate.  BRIN tuples are
+ * stored uncompressed and must fit on a single page, so the filters are
+ * limited to an equal share of the space left in an index tuple by the
+ * other columns.  Since all filters of an index are built with the same
+ * parameters, any two of them can be combined by OR-ing their bitmaps.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/brin/brin_bloom.c
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/brin.h"
+#include "access/brin_internal.h"
+#include "access/brin_pageops.h"
+#include "access/brin_tuple.h"
+#include "access/genam.h"
+#include "access/hash.h"
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/fmgroids.h"
+#include "utils/rel.h"
+#include "utils/typcache.h"
+
+
+/* the only strategy number supported by bloom opclasses */
+#define BloomEqualStrategyNumber	1
+
+/*
+ * Fraction of the maximum number of tuples in a page range that we expect to
+ * be distinct, and the false positive rate we aim for.  These determine the
+ * size of the filter.
+ */
+#define BLOOM_NDISTINCT_FRACTION	0.1
+#define BLOOM_FALSE_POSITIVE_RATE	0.01
+
+/* lower bound for the number of distinct values per range */
+#define BLOOM_MIN_NDISTINCT			16
+
+/*
+ * Space set aside in an index tuple for each stored value of a column that
+ * doesn't use a bloom opclass, if that value's length varies.  This is only
+ * a guess; longer values of such columns may make the index tuple too large,
+ * as they can with any BRIN opclass.
+ */
+#define BLOOM_VARLENA_RESERVE		64
+
+/* lower bound for the size of the bitmap */
+#define BLOOM_MIN_BITS				64
+
+/* upper bound for the number of hash functions */
+#define BLOOM_MAX_HASHES			16
+
+/* seeds for the two hash functions used for double hashing */
+#define BLOOM_SEED_1				0x71d924af
+#define BLOOM_SEED_2				0xba48b314
+
+/*
+ * On-disk representation of a bloom filter.  This is stored as a bytea
+ * datum in the index tuple.
+ */
+typedef struct BloomFilter
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	uint16		nhashes;		/* number of hash functions */
+	uint16		flags;			/* currently unused */
+	uint32		nbits;			/* number of bits in the bitmap */
+	bits8		bitmap[FLEXIBLE_ARRAY_MEMBER];
+} BloomFilter;
+
+typedef struct BloomOpaque
+{
+	TypeCacheEntry *typcache;	/* type cache entry of the indexed type */
+	uint32		maxbits;		/* bitmap size limit, 0 if not computed yet */
+} BloomOpaque;
+
+Datum		brin_bloom_opcinfo(PG_FUNCTION_ARGS);
+Datum		brin_bloom_add_value(PG_FUNCTION_ARGS);
+Datum		brin_bloom_consistent(PG_FUNCTION_ARGS);
+Datum		brin_bloom_union(PG_FUNCTION_ARGS);
+static BloomFilter *bloom_init(BrinDesc *bdesc, AttrNumber attno);
+static uint32 bloom_max_bits(BrinDesc *bdesc);
+static uint32 bloom_hash_value(BrinDesc *bdesc, AttrNumber attno,
+				 Oid colloid, Datum value);
+static bool bloom_add_hash(BloomFilter *filter, uint32 hash);
+static bool bloom_contains_hash(BloomFilter *filter, uint32 hash);
+
+
+Datum
+brin_bloom_opcinfo(PG_FUNCTION_ARGS)
+{
+	Oid			typoid = PG_GETARG_OID(0);
+	BrinOpcInfo *result;
+	BloomOpaque *opaque;
+
+	/*
+	 * We store a single bloom filter per index column, as a bytea; the
+	 * opaque struct remembers the indexed type, for its hash function.
+	 */
+	result = palloc0(MAXALIGN(SizeofBrinOpcInfo(1)) +
+					 sizeof(BloomOpaque));
+	result->oi_nstored = 1;
+	result->oi_opaque = (BloomOpaque *)
+		MAXALIGN((char *) result + SizeofBrinOpcInfo(1));
+	result->oi_typcache[0] = lookup_type_cache(BYTEAOID, 0);
+
+	opaque = (BloomOpaque *) result->oi_opaque;
+	opaque->maxbits = 0;
+	opaque->typcache = lookup_type_cache(typoid, TYPECACHE_HASH_PROC_FINFO);
+	if (!OidIsValid(opaque->typcache->hash_proc))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_FUNCTION),
+				 errmsg("could not identify a hash function for type %s",
+						format_type_be(typoid))));
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Examine the given index tuple (which contains partial status of a certain
+ * page range) by comparing it to the given value that comes from another heap
+ * tuple.  If the new value is not yet represented in the bloom filter, set
+ * its bits and return true.  Otherwise, return false and do not modify in
+ * this case.
+ */
+Datum
+brin_bloom_add_value(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	Datum		newval = PG_GETARG_DATUM(2);
+	bool		isnull = PG_GETARG_DATUM(3);
+	Oid			colloid = PG_GET_COLLATION();
+	BloomFilter *filter;
+	bool		updated;
+
+	/*
+	 * If the new value is null, we record that we saw it if it's the first
+	 * one; otherwise, there's nothing to do.
+	 */
+	if (isnull)
+	{
+		if (column->bv_hasnulls)
+			PG_RETURN_BOOL(false);
+
+		column->bv_hasnulls = true;
+		PG_RETURN_BOOL(true);
+	}
+
+	/*
+	 * If this is the first non-null value, we need to initialize the bloom
+	 * filter.  Otherwise just extract the existing one.  Note that the
+	 * deformed tuple owns a private copy of the filter (possibly one with a
+	 * short varlena header, which is why we may need to detoast it), so we
+	 * can scribble on it.
+	 */
+	if (column->bv_allnulls)
+	{
+		filter = bloom_init(bdesc, column->bv_attno);
+		column->bv_values[0] = PointerGetDatum(filter);
+		column->bv_allnulls = false;
+		updated = true;
+	}
+	else
+	{
+		filter = (BloomFilter *) PG_DETOAST_DATUM(column->bv_values[0]);
+		if (filter != (BloomFilter *) DatumGetPointer(column->bv_values[0]))
+		{
+			pfree(DatumGetPointer(column->bv_values[0]));
+			column->bv_values[0] = PointerGetDatum(filter);
+		}
+		updated = false;
+	}
+
+	updated |= bloom_add_hash(filter,
+							  bloom_hash_value(bdesc, column->bv_attno,
+											   colloid, newval));
+
+	PG_RETURN_BOOL(updated);
+}
+
+/*
+ * Given an index tuple corresponding to a certain page range and a scan key,
+ * return whether the scan key is consistent with the index tuple's bloom
+ * filter.  Return true if so, false otherwise.
+ */
+Datum
+brin_bloom_consistent(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	ScanKey		key = (ScanKey) PG_GETARG_POINTER(2);
+	Oid			colloid = PG_GET_COLLATION();
+	BloomFilter *filter;
+
+	Assert(key->sk_attno == column->bv_attno);
+
+	/* handle IS NULL/IS NOT NULL tests */
+	if (key->sk_flags & SK_ISNULL)
+	{
+		if (key->sk_flags & SK_SEARCHNULL)
+		{
+			if (column->bv_allnulls || column->bv_hasnulls)
+				PG_RETURN_BOOL(true);
+			PG_RETURN_BOOL(false);
+		}
+
+		/*
+		 * For IS NOT NULL, we can only skip ranges that are known to have
+		 * only nulls.
+		 */
+		if (key->sk_flags & SK_SEARCHNOTNULL)
+			PG_RETURN_BOOL(!column->bv_allnulls);
+
+		/*
+		 * Neither IS NULL nor IS NOT NULL was used; assume all indexable
+		 * operators are strict and return false.
+		 */
+		PG_RETURN_BOOL(false);
+	}
+
+	/* if the range is all empty, it cannot possibly be consistent */
+	if (column->bv_allnulls)
+		PG_RETURN_BOOL(false);
+
+	if (key->sk_strategy != BloomEqualStrategyNumber)
+		elog(ERROR, "invalid strategy number %d", key->sk_strategy);
+
+	filter = (BloomFilter *) PG_DETOAST_DATUM(column->bv_values[0]);
+
+	PG_RETURN_BOOL(bloom_contains_hash(filter,
+									   bloom_hash_value(bdesc, key->sk_attno,
+														colloid,
+														key->sk_argument)));
+}
+
+/*
+ * Given two BrinValues, update the first of them as a union of the summary
+ * values contained in both.  The second one is untouched.
+ */
+Datum
+brin_bloom_union(PG_FUNCTION_ARGS)
+{
+	BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+	BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+	BloomFilter *filter_a;
+	BloomFilter *filter_b;
+	uint32		nbytes;
+	uint32		i;
+
+	Assert(col_a->bv_attno == col_b->bv_attno);
+
+	/* Adjust "hasnulls" */
+	if (!col_a->bv_hasnulls && col_b->bv_hasnulls)
+		col_a->bv_hasnulls = true;
+
+	/* If there are no values in B, there's nothing left to do */
+	if (col_b->bv_allnulls)
+		PG_RETURN_VOID();
+
+	filter_b = (BloomFilter *) PG_DETOAST_DATUM(col_b->bv_values[0]);
+
+	/*
+	 * Adjust "allnulls".  If A doesn't have values, just copy the filter
+	 * from B into A, and we're done.
+	 */
+	if (col_a->bv_allnulls)
+	{
+		col_a->bv_allnulls = false;
+		col_a->bv_values[0] = datumCopy(PointerGetDatum(filter_b),
+										false, -1);
+		PG_RETURN_VOID();
+	}
+
+	filter_a = (BloomFilter *) PG_DETOAST_DATUM(col_a->bv_values[0]);
+	if (filter_a != (BloomFilter *) DatumGetPointer(col_a->bv_values[0]))
+	{
+		pfree(DatumGetPointer(col_a->bv_values[0]));
+		col_a->bv_values[0] = PointerGetDatum(filter_a);
+	}
+
+	/* all filters of an index are built with the same parameters */
+	if (filter_a->nbits != filter_b->nbits ||
+		filter_a->nhashes != filter_b->nhashes)
+		elog(ERROR, "mismatched bloom filters (%u/%u bits, %u/%u hashes)",
+			 filter_a->nbits, filter_b->nbits,
+			 filter_a->nhashes, filter_b->nhashes);
+
+	nbytes = filter_a->nbits / BITS_PER_BYTE;
+	for (i = 0; i < nbytes; i++)
+		filter_a->bitmap[i] |= filter_b->bitmap[i];
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Create an empty bloom filter for column attno, sized for the page ranges
+ * of the index described by bdesc.
+ */
+static BloomFilter *
+bloom_init(BrinDesc *bdesc, AttrNumber attno)
+{
+	BlockNumber pagesPerRange = BrinGetPagesPerRange(bdesc->bd_index);
+	BloomOpaque *opaque;
+	double		ndistinct;
+	double		nbits;
+	int			nhashes;
+	Size		len;
+	BloomFilter *filter;
+
+	ndistinct = BLOOM_NDISTINCT_FRACTION * MaxHeapTuplesPerPage *
+		(double) pagesPerRange;
+	ndistinct = Max(ndistinct, BLOOM_MIN_NDISTINCT);
+
+	/*
+	 * The optimal number of bits for n distinct values and a false positive
+	 * rate p is -n ln(p) / (ln 2)^2, and the optimal number of hash
+	 * functions for m bits is (m / n) ln 2.  Round the bitmap up to whole
+	 * bytes.
+	 */
+	nbits = ceil(-(ndistinct * log(BLOOM_FALSE_POSITIVE_RATE)) /
+				 (M_LN2 * M_LN2));
+	nbits = TYPEALIGN(BITS_PER_BYTE, (uint32) nbits);
+
+	/*
+	 * With large pages_per_range values, or many columns, the bitmap may
+	 * not fit in the index tuple; the false positive rate grows beyond the
+	 * target instead.
+	 */
+	opaque = (BloomOpaque *) bdesc->bd_info[attno - 1]->oi_opaque;
+	if (opaque->maxbits == 0)
+		opaque->maxbits = bloom_max_bits(bdesc);
+	nbits = Min(nbits, opaque->maxbits);
+
+	nhashes = (int) rint(nbits / ndistinct * M_LN2);
+	nhashes = Max(nhashes, 1);
+	nhashes = Min(nhashes, BLOOM_MAX_HASHES);
+
+	len = offsetof(BloomFilter, bitmap) + (uint32) nbits / BITS_PER_BYTE;
+	filter = (BloomFilter *) palloc0(len);
+	SET_VARSIZE(filter, len);
+	filter->nhashes = (uint16) nhashes;
+	filter->nbits = (uint32) nbits;
+
+	return filter;
+}
+
+/*
+ * Compute the largest bitmap that lets every bloom filter of the index fit
+ * in one index tuple: the space left after the tuple header and the values
+ * of the other columns is divided evenly among the bloom columns.  The
+ * result is a multiple of BITS_PER_BYTE.
+ */
+static uint32
+bloom_max_bits(BrinDesc *bdesc)
+{
+	TupleDesc	tupdesc = bdesc->bd_tupdesc;
+	int64		space;
+	int			nbloom = 0;
+	int			keyno;
+
+	space = BrinMaxItemSize -
+		MAXALIGN(SizeOfBrinTuple + BITMAPLEN(tupdesc->natts * 2));
+
+	for (keyno = 0; keyno < tupdesc->natts; keyno++)
+	{
+		BrinOpcInfo *opcinfo = bdesc->bd_info[keyno];
+		int			i;
+
+		if (index_getprocid(bdesc->bd_index, keyno + 1,
+							BRIN_PROCNUM_OPCINFO) == F_BRIN_BLOOM_OPCINFO)
+		{
+			nbloom++;
+			continue;
+		}
+
+		for (i = 0; i < opcinfo->oi_nstored; i++)
+		{
+			int16		typlen = opcinfo->oi_typcache[i]->typlen;
+
+			space -= (typlen > 0) ? MAXALIGN(typlen) : BLOOM_VARLENA_RESERVE;
+		}
+	}
+	Assert(nbloom > 0);
+
+	/* each filter is a bytea, which may need padding for int alignment */
+	space = space / nbloom - (ALIGNOF_INT - 1) - offsetof(BloomFilter, bitmap);
+
+	return (uint32) Max(space * BITS_PER_BYTE, BLOOM_MIN_BITS);
+}
+
+/*
+ * Compute the hash of a value of the indexed type, using its default hash
+ * function.
+ */
+static uint32
+bloom_hash_value(BrinDesc *bdesc, AttrNumber attno, Oid colloid, Datum value)
+{
+	BloomOpaque *opaque;
+
+	opaque = (BloomOpaque *) bdesc->bd_info[attno - 1]->oi_opaque;
+
+	return DatumGetUInt32(FunctionCall1Coll(&opaque->typcache->hash_proc_finfo,
+											colloid, value));
+}
+
+/*
+ * Set the bits for the given hash value.  Returns true if any bit changed,
+ * that is, if the value was not already (possibly falsely) represented in the
+ * filter.
+ */
+static bool
+bloom_add_hash(BloomFilter *filter, uint32 hash)
+{
+	uint64		h1 = DatumGetUInt32(hash_uint32(hash ^ BLOOM_SEED_1));
+	uint64		h2 = DatumGetUInt32(hash_uint32(hash ^ BLOOM_SEED_2));
+	bool		updated = false;
+	int			i;
+
+	for (i = 0; i < filter->nhashes; i++)
+	{
+		uint32		bit = (h1 + i * h2) % filter->nbits;
+		uint32		byte = bit / BITS_PER_BYTE;
+		bits8		mask = 1 << (bit % BITS_PER_BYTE);
+
+		if (!(filter->bitmap[byte] & mask))
+		{
+			filter->bitmap[byte] |= mask;
+			updated = true;
+		}
+	}
+
+	return updated;
+}
+
+/*
+ * Check whether the bits for the given hash value are all set.
+ */
+static bool
+bloom_contains_hash(BloomFilter *filter, uint32 hash)
+{
+	uint64		h1 = DatumGetUInt32(hash_uint32(hash ^ BLOOM_SEED_1));
+	uint64		h2 = DatumGetUInt32(hash_uint32(hash ^ BLOOM_SEED_2));
+	int			i;
+
+	for (i = 0; i < filter->nhashes; i++)
+	{
+		uint32		bit = (h1 + i * h2) % filter->nbits;
+
+		if (!(filter->bitmap[bit / BITS_PER_BYTE] & (1 << (bit % BITS_PER_BYTE))))
+			return false;
+	}
+
+	return true;
+}
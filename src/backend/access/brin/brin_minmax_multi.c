@@ -0,0 +1,788 @@
+/*
+ * brin_minmax_multi.c
+ *		Implementation of Multi Min/Max opclass for BRIN
+ *
+ * The regular minmax opclasses summarize a page range with a single
+ * [min, max] interval, which becomes useless as soon as a few outlying
+ * values appear in the range.  This opclass instead keeps a sorted list of
+ * up to MINMAX_MAX_RANGES disjoint intervals per page range.  Every new
+ * value that isn't covered by an existing interval is added as a collapsed
+ * interval [value, value]; when that exceeds the limit, the two adjacent
+ * intervals separated by the smallest gap are merged.  The gap is measured
+ * by an opclass-specific "distance" support function, so that the intervals
+ * end up around the clusters of values actually present in the range.
+ *
+ * The intervals are stored in the index tuple as a single bytea datum, see
+ * SerializedRanges below.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/brin/brin_minmax_multi.c
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/brin_internal.h"
+#include "access/brin_tuple.h"
+#include "access/stratnum.h"
+#include "access/tupmacs.h"
+#include "catalog/pg_type.h"
+#include "catalog/pg_amop.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
+#include "utils/pg_lsn.h"
+#include "utils/rel.h"
+#include "utils/syscache.h"
+#include "utils/timestamp.h"
+
+
+/* maximum number of intervals kept per page range */
+#define MINMAX_MAX_RANGES		16
+
+/* support procedure number for the distance function */
+#define PROCNUM_DISTANCE		11
+
+typedef struct MinmaxMultiOpaque
+{
+	FmgrInfo	distance_procinfo;
+	Oid			cached_subtype;
+	FmgrInfo	strategy_procinfos[BTMaxStrategyNumber];
+} MinmaxMultiOpaque;
+
+/*
+ * On-disk representation of the intervals: the number of intervals followed
+ * by the 2 * nranges boundary values, each aligned as per the indexed type.
+ * The header is MAXALIGN'd, so that the values can be accessed in place.
+ */
+typedef struct SerializedRanges
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	uint32		nranges;		/* number of intervals */
+	char		data[FLEXIBLE_ARRAY_MEMBER];
+} SerializedRanges;
+
+#define SerializedRangesHdrSz	MAXALIGN(offsetof(SerializedRanges, data))
+
+/*
+ * In-memory representation: values[2 * i] and values[2 * i + 1] are the lower
+ * and upper boundary of the i-th interval.  The intervals are sorted and
+ * disjoint.  Pass-by-reference values point into the SerializedRanges the
+ * struct was built from, or into the new value being added.
+ */
+typedef struct Ranges
+{
+	int			nranges;
+	int			maxranges;
+	Datum	   *values;
+} Ranges;
+
+Datum		brin_minmax_multi_opcinfo(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_add_value(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_consistent(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_union(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_int2(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_int4(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_int8(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_float4(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_float8(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_numeric(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_oid(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_date(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_time(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_timestamp(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_interval(PG_FUNCTION_ARGS);
+Datum		brin_minmax_multi_distance_pg_lsn(PG_FUNCTION_ARGS);
+static Ranges *ranges_deserialize(Form_pg_attribute attr,
+				   SerializedRanges *serialized, int maxranges);
+static SerializedRanges *ranges_serialize(Form_pg_attribute attr,
+				 Ranges *ranges);
+static void ranges_reduce(BrinDesc *bdesc, AttrNumber attno, Oid colloid,
+			  Ranges *ranges);
+static bool ranges_lt(BrinDesc *bdesc, AttrNumber attno, Oid colloid,
+		  Datum a, Datum b);
+static FmgrInfo *minmax_multi_get_strategy_procinfo(BrinDesc *bdesc,
+								   uint16 attno, Oid subtype,
+								   uint16 strategynum);
+
+
+Datum
+brin_minmax_multi_opcinfo(PG_FUNCTION_ARGS)
+{
+	BrinOpcInfo *result;
+
+	/*
+	 * opaque->strategy_procinfos is initialized lazily; here it is set to
+	 * all-uninitialized by palloc0 which sets fn_oid to InvalidOid.  The
+	 * intervals are stored as a single bytea.
+	 */
+
+	result = palloc0(MAXALIGN(SizeofBrinOpcInfo(1)) +
+					 sizeof(MinmaxMultiOpaque));
+	result->oi_nstored = 1;
+	result->oi_opaque = (MinmaxMultiOpaque *)
+		MAXALIGN((char *) result + SizeofBrinOpcInfo(1));
+	result->oi_typcache[0] = lookup_type_cache(BYTEAOID, 0);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Examine the given index tuple (which contains partial status of a certain
+ * page range) by comparing it to the given value that comes from another heap
+ * tuple.  If the new value is outside all the intervals stored in the
+ * existing tuple, add it, merging intervals if there are too many, and return
+ * true.  Otherwise, return false and do not modify in this case.
+ */
+Datum
+brin_minmax_multi_add_value(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	Datum		newval = PG_GETARG_DATUM(2);
+	bool		isnull = PG_GETARG_DATUM(3);
+	Oid			colloid = PG_GET_COLLATION();
+	AttrNumber	attno;
+	Form_pg_attribute attr;
+	SerializedRanges *serialized;
+	SerializedRanges *newserialized;
+	Ranges	   *ranges;
+	int			lo,
+				hi;
+
+	/*
+	 * If the new value is null, we record that we saw it if it's the first
+	 * one; otherwise, there's nothing to do.
+	 */
+	if (isnull)
+	{
+		if (column->bv_hasnulls)
+			PG_RETURN_BOOL(false);
+
+		column->bv_hasnulls = true;
+		PG_RETURN_BOOL(true);
+	}
+
+	attno = column->bv_attno;
+	attr = bdesc->bd_tupdesc->attrs[attno - 1];
+
+	/* the value gets copied into the summary, so it must not be toasted */
+	if (attr->attlen == -1)
+		newval = PointerGetDatum(PG_DETOAST_DATUM(newval));
+
+	if (column->bv_allnulls)
+	{
+		serialized = NULL;
+		ranges = ranges_deserialize(attr, NULL, MINMAX_MAX_RANGES + 1);
+	}
+	else
+	{
+		serialized = (SerializedRanges *)
+			PG_DETOAST_DATUM(column->bv_values[0]);
+		ranges = ranges_deserialize(attr, serialized, MINMAX_MAX_RANGES + 1);
+	}
+
+	/*
+	 * Binary search for the first interval whose upper boundary is not less
+	 * than the new value.  If the new value is not less than that interval's
+	 * lower boundary either, it's already covered.
+	 */
+	lo = 0;
+	hi = ranges->nranges;
+	while (lo < hi)
+	{
+		int			mid = (lo + hi) / 2;
+
+		if (ranges_lt(bdesc, attno, colloid,
+					  ranges->values[2 * mid + 1], newval))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < ranges->nranges &&
+		!ranges_lt(bdesc, attno, colloid, newval, ranges->values[2 * lo]))
+		PG_RETURN_BOOL(false);
+
+	/* insert the new value as a collapsed interval at position lo */
+	memmove(&ranges->values[2 * lo + 2], &ranges->values[2 * lo],
+			sizeof(Datum) * 2 * (ranges->nranges - lo));
+	ranges->values[2 * lo] = ranges->values[2 * lo + 1] = newval;
+	ranges->nranges++;
+
+	ranges_reduce(bdesc, attno, colloid, ranges);
+
+	/*
+	 * Replace the stored value.  The old one is no longer needed once the
+	 * new one has been built, since that copies all the boundary values.
+	 */
+	newserialized = ranges_serialize(attr, ranges);
+	if (serialized != NULL)
+	{
+		if (serialized != (SerializedRanges *)
+			DatumGetPointer(column->bv_values[0]))
+			pfree(serialized);
+		pfree(DatumGetPointer(column->bv_values[0]));
+	}
+	column->bv_values[0] = PointerGetDatum(newserialized);
+	column->bv_allnulls = false;
+
+	pfree(ranges->values);
+	pfree(ranges);
+
+	PG_RETURN_BOOL(true);
+}
+
+/*
+ * Given an index tuple corresponding to a certain page range and a scan key,
+ * return whether the scan key is consistent with the index tuple's intervals.
+ * Return true if so, false otherwise.
+ */
+Datum
+brin_minmax_multi_consistent(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	ScanKey		key = (ScanKey) PG_GETARG_POINTER(2);
+	Oid			colloid = PG_GET_COLLATION(),
+				subtype;
+	AttrNumber	attno;
+	Form_pg_attribute attr;
+	Datum		value;
+	Datum		matches;
+	FmgrInfo   *finfo;
+	Ranges	   *ranges;
+	int			i;
+
+	Assert(key->sk_attno == column->bv_attno);
+
+	/* handle IS NULL/IS NOT NULL tests */
+	if (key->sk_flags & SK_ISNULL)
+	{
+		if (key->sk_flags & SK_SEARCHNULL)
+		{
+			if (column->bv_allnulls || column->bv_hasnulls)
+				PG_RETURN_BOOL(true);
+			PG_RETURN_BOOL(false);
+		}
+
+		/*
+		 * For IS NOT NULL, we can only skip ranges that are known to have
+		 * only nulls.
+		 */
+		if (key->sk_flags & SK_SEARCHNOTNULL)
+			PG_RETURN_BOOL(!column->bv_allnulls);
+
+		/*
+		 * Neither IS NULL nor IS NOT NULL was used; assume all indexable
+		 * operators are strict and return false.
+		 */
+		PG_RETURN_BOOL(false);
+	}
+
+	/* if the range is all empty, it cannot possibly be consistent */
+	if (column->bv_allnulls)
+		PG_RETURN_BOOL(false);
+
+	attno = key->sk_attno;
+	attr = bdesc->bd_tupdesc->attrs[attno - 1];
+	subtype = key->sk_subtype;
+	value = key->sk_argument;
+	ranges = ranges_deserialize(attr, (SerializedRanges *)
+								PG_DETOAST_DATUM(column->bv_values[0]), 0);
+
+	switch (key->sk_strategy)
+	{
+		case BTLessStrategyNumber:
+		case BTLessEqualStrategyNumber:
+			/* compare against the overall minimum */
+			finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+													   key->sk_strategy);
+			matches = FunctionCall2Coll(finfo, colloid, ranges->values[0],
+										value);
+			break;
+		case BTEqualStrategyNumber:
+
+			/*
+			 * In the equality case (WHERE col = someval), we want to return
+			 * the current page range if any of the intervals has minimum <=
+			 * scan key and maximum >= scan key.
+			 */
+			matches = BoolGetDatum(false);
+			for (i = 0; i < ranges->nranges; i++)
+			{
+				finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+												 BTLessEqualStrategyNumber);
+				if (!DatumGetBool(FunctionCall2Coll(finfo, colloid,
+													ranges->values[2 * i],
+													value)))
+					break;		/* this and all later intervals are above */
+
+				finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+											  BTGreaterEqualStrategyNumber);
+				matches = FunctionCall2Coll(finfo, colloid,
+											ranges->values[2 * i + 1], value);
+				if (DatumGetBool(matches))
+					break;
+			}
+			break;
+		case BTGreaterEqualStrategyNumber:
+		case BTGreaterStrategyNumber:
+			/* compare against the overall maximum */
+			finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+													   key->sk_strategy);
+			matches = FunctionCall2Coll(finfo, colloid,
+							ranges->values[2 * ranges->nranges - 1], value);
+			break;
+		default:
+			/* shouldn't happen */
+			elog(ERROR, "invalid strategy number %d", key->sk_strategy);
+			matches = 0;
+			break;
+	}
+
+	PG_RETURN_DATUM(matches);
+}
+
+/*
+ * Given two BrinValues, update the first of them as a union of the summary
+ * values contained in both.  The second one is untouched.
+ */
+Datum
+brin_minmax_multi_union(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+	BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+	Oid			colloid = PG_GET_COLLATION();
+	AttrNumber	attno;
+	Form_pg_attribute attr;
+	SerializedRanges *serialized_a;
+	SerializedRanges *newserialized;
+	Ranges	   *ranges_a;
+	Ranges	   *ranges_b;
+	Ranges	   *ranges;
+	int			ia,
+				ib;
+
+	Assert(col_a->bv_attno == col_b->bv_attno);
+
+	/* Adjust "hasnulls" */
+	if (!col_a->bv_hasnulls && col_b->bv_hasnulls)
+		col_a->bv_hasnulls = true;
+
+	/* If there are no values in B, there's nothing left to do */
+	if (col_b->bv_allnulls)
+		PG_RETURN_VOID();
+
+	attno = col_a->bv_attno;
+	attr = bdesc->bd_tupdesc->attrs[attno - 1];
+
+	/*
+	 * Adjust "allnulls".  If A doesn't have values, just copy the values from
+	 * B into A, and we're done.
+	 */
+	if (col_a->bv_allnulls)
+	{
+		col_a->bv_allnulls = false;
+		col_a->bv_values[0] = datumCopy(col_b->bv_values[0], false, -1);
+		PG_RETURN_VOID();
+	}
+
+	serialized_a = (SerializedRanges *) PG_DETOAST_DATUM(col_a->bv_values[0]);
+	ranges_a = ranges_deserialize(attr, serialized_a, 0);
+	ranges_b = ranges_deserialize(attr, (SerializedRanges *)
+								  PG_DETOAST_DATUM(col_b->bv_values[0]), 0);
+
+	/*
+	 * Merge the two sorted lists of intervals by lower boundary, coalescing
+	 * intervals that overlap.
+	 */
+	ranges = ranges_deserialize(attr, NULL,
+								ranges_a->nranges + ranges_b->nranges);
+	ia = ib = 0;
+	while (ia < ranges_a->nranges || ib < ranges_b->nranges)
+	{
+		Datum	   *next;
+
+		if (ib >= ranges_b->nranges ||
+			(ia < ranges_a->nranges &&
+			 ranges_lt(bdesc, attno, colloid, ranges_a->values[2 * ia],
+					   ranges_b->values[2 * ib])))
+			next = &ranges_a->values[2 * ia++];
+		else
+			next = &ranges_b->values[2 * ib++];
+
+		if (ranges->nranges > 0 &&
+			!ranges_lt(bdesc, attno, colloid,
+					   ranges->values[2 * ranges->nranges - 1], next[0]))
+		{
+			/* overlaps the last interval; extend it if needed */
+			if (ranges_lt(bdesc, attno, colloid,
+						  ranges->values[2 * ranges->nranges - 1], next[1]))
+				ranges->values[2 * ranges->nranges - 1] = next[1];
+		}
+		else
+		{
+			ranges->values[2 * ranges->nranges] = next[0];
+			ranges->values[2 * ranges->nranges + 1] = next[1];
+			ranges->nranges++;
+		}
+	}
+
+	ranges_reduce(bdesc, attno, colloid, ranges);
+
+	/* ranges_a points into A's old value, so replace that only now */
+	newserialized = ranges_serialize(attr, ranges);
+	if (serialized_a != (SerializedRanges *)
+		DatumGetPointer(col_a->bv_values[0]))
+		pfree(serialized_a);
+	pfree(DatumGetPointer(col_a->bv_values[0]));
+	col_a->bv_values[0] = PointerGetDatum(newserialized);
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Build the in-memory representation of the given serialized intervals
+ * (which may be NULL, for an empty list), with room for at least maxranges
+ * intervals.
+ */
+static Ranges *
+ranges_deserialize(Form_pg_attribute attr, SerializedRanges *serialized,
+				   int maxranges)
+{
+	Ranges	   *ranges;
+	int			nranges;
+	char	   *ptr;
+	int			i;
+
+	nranges = serialized ? serialized->nranges : 0;
+
+	ranges = palloc(sizeof(Ranges));
+	ranges->nranges = nranges;
+	ranges->maxranges = Max(nranges, maxranges);
+	ranges->values = palloc(sizeof(Datum) * 2 * ranges->maxranges);
+
+	if (serialized == NULL)
+		return ranges;
+
+	ptr = (char *) serialized + SerializedRangesHdrSz;
+	for (i = 0; i < 2 * nranges; i++)
+	{
+		ptr = (char *) att_align_nominal(ptr, attr->attalign);
+		ranges->values[i] = fetch_att(ptr, attr->attbyval, attr->attlen);
+		ptr = att_addlength_pointer(ptr, attr->attlen, ptr);
+	}
+
+	return ranges;
+}
+
+/*
+ * Build the on-disk representation of the given intervals.
+ */
+static SerializedRanges *
+ranges_serialize(Form_pg_attribute attr, Ranges *ranges)
+{
+	SerializedRanges *serialized;
+	Size		len;
+	char	   *ptr;
+	int			i;
+
+	len = SerializedRangesHdrSz;
+	for (i = 0; i < 2 * ranges->nranges; i++)
+	{
+		len = att_align_nominal(len, attr->attalign);
+		len = att_addlength_datum(len, attr->attlen, ranges->values[i]);
+	}
+
+	serialized = (SerializedRanges *) palloc0(len);
+	SET_VARSIZE(serialized, len);
+	serialized->nranges = ranges->nranges;
+
+	ptr = (char *) serialized + SerializedRangesHdrSz;
+	for (i = 0; i < 2 * ranges->nranges; i++)
+	{
+		Size		datalen;
+
+		ptr = (char *) att_align_nominal(ptr, attr->attalign);
+		if (attr->attbyval)
+		{
+			store_att_byval(ptr, ranges->values[i], attr->attlen);
+			datalen = attr->attlen;
+		}
+		else
+		{
+			datalen = att_addlength_datum(0, attr->attlen, ranges->values[i]);
+			memcpy(ptr, DatumGetPointer(ranges->values[i]), datalen);
+		}
+		ptr += datalen;
+	}
+
+	return serialized;
+}
+
+/*
+ * Reduce the number of intervals to MINMAX_MAX_RANGES, by repeatedly merging
+ * the two adjacent intervals separated by the smallest gap.
+ */
+static void
+ranges_reduce(BrinDesc *bdesc, AttrNumber attno, Oid colloid, Ranges *ranges)
+{
+	MinmaxMultiOpaque *opaque;
+
+	if (ranges->nranges <= MINMAX_MAX_RANGES)
+		return;
+
+	opaque = (MinmaxMultiOpaque *) bdesc->bd_info[attno - 1]->oi_opaque;
+	if (opaque->distance_procinfo.fn_oid == InvalidOid)
+		fmgr_info_copy(&opaque->distance_procinfo,
+					   index_getprocinfo(bdesc->bd_index, attno,
+										 PROCNUM_DISTANCE),
+					   bdesc->bd_context);
+
+	while (ranges->nranges > MINMAX_MAX_RANGES)
+	{
+		int			best = 0;
+		double		bestdist = 0;
+		int			i;
+
+		for (i = 0; i < ranges->nranges - 1; i++)
+		{
+			double		dist;
+
+			dist = DatumGetFloat8(FunctionCall2Coll(&opaque->distance_procinfo,
+													colloid,
+												ranges->values[2 * i + 1],
+												ranges->values[2 * i + 2]));
+			if (i == 0 || dist < bestdist)
+			{
+				best = i;
+				bestdist = dist;
+			}
+		}
+
+		/* merge interval best+1 into best */
+		ranges->values[2 * best + 1] = ranges->values[2 * best + 3];
+		memmove(&ranges->values[2 * best + 2], &ranges->values[2 * best + 4],
+				sizeof(Datum) * 2 * (ranges->nranges - best - 2));
+		ranges->nranges--;
+	}
+}
+
+/*
+ * Return whether a < b, using the opclass' "less than" operator.
+ */
+static bool
+ranges_lt(BrinDesc *bdesc, AttrNumber attno, Oid colloid, Datum a, Datum b)
+{
+	Form_pg_attribute attr = bdesc->bd_tupdesc->attrs[attno - 1];
+	FmgrInfo   *finfo;
+
+	finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, attr->atttypid,
+											   BTLessStrategyNumber);
+	return DatumGetBool(FunctionCall2Coll(finfo, colloid, a, b));
+}
+
+/*
+ * Cache and return the procedure for the given strategy.
+ *
+ * Note: this function mirrors minmax_get_strategy_procinfo; see notes there.
+ * If changes are made here, see that function too.
+ */
+static FmgrInfo *
+minmax_multi_get_strategy_procinfo(BrinDesc *bdesc, uint16 attno, Oid subtype,
+								   uint16 strategynum)
+{
+	MinmaxMultiOpaque *opaque;
+
+	Assert(strategynum >= 1 &&
+		   strategynum <= BTMaxStrategyNumber);
+
+	opaque = (MinmaxMultiOpaque *) bdesc->bd_info[attno - 1]->oi_opaque;
+
+	/*
+	 * We cache the procedures for the previous subtype in the opaque struct,
+	 * to avoid repetitive syscache lookups.  If the subtype changed,
+	 * invalidate all the cached entries.
+	 */
+	if (opaque->cached_subtype != subtype)
+	{
+		uint16		i;
+
+		for (i = 1; i <= BTMaxStrategyNumber; i++)
+			opaque->strategy_procinfos[i - 1].fn_oid = InvalidOid;
+		opaque->cached_subtype = subtype;
+	}
+
+	if (opaque->strategy_procinfos[strategynum - 1].fn_oid == InvalidOid)
+	{
+		Form_pg_attribute attr;
+		HeapTuple	tuple;
+		Oid			opfamily,
+					oprid;
+		bool		isNull;
+
+		opfamily = bdesc->bd_index->rd_opfamily[attno - 1];
+		attr = bdesc->bd_tupdesc->attrs[attno - 1];
+		tuple = SearchSysCache4(AMOPSTRATEGY, ObjectIdGetDatum(opfamily),
+								ObjectIdGetDatum(attr->atttypid),
+								ObjectIdGetDatum(subtype),
+								Int16GetDatum(strategynum));
+
+		if (!HeapTupleIsValid(tuple))
+			elog(ERROR, "missing operator %d(%u,%u) in opfamily %u",
+				 strategynum, attr->atttypid, subtype, opfamily);
+
+		oprid = DatumGetObjectId(SysCacheGetAttr(AMOPSTRATEGY, tuple,
+											 Anum_pg_amop_amopopr, &isNull));
+		ReleaseSysCache(tuple);
+		Assert(!isNull && RegProcedureIsValid(oprid));
+
+		fmgr_info_cxt(get_opcode(oprid),
+					  &opaque->strategy_procinfos[strategynum - 1],
+					  bdesc->bd_context);
+	}
+
+	return &opaque->strategy_procinfos[strategynum - 1];
+}
+
+/*
+ * Distance functions.
+ *
+ * Each of these returns the distance between two values a <= b of the
+ * indexed type, as a float8.  Only the relative order of the distances
+ * matters, so they don't need to be exact, but they should grow with the
+ * gap between the values.
+ */
+Datum
+brin_minmax_multi_distance_int2(PG_FUNCTION_ARGS)
+{
+	int16		a = PG_GETARG_INT16(0);
+	int16		b = PG_GETARG_INT16(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_int4(PG_FUNCTION_ARGS)
+{
+	int32		a = PG_GETARG_INT32(0);
+	int32		b = PG_GETARG_INT32(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_int8(PG_FUNCTION_ARGS)
+{
+	int64		a = PG_GETARG_INT64(0);
+	int64		b = PG_GETARG_INT64(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_float4(PG_FUNCTION_ARGS)
+{
+	float4		a = PG_GETARG_FLOAT4(0);
+	float4		b = PG_GETARG_FLOAT4(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_float8(PG_FUNCTION_ARGS)
+{
+	float8		a = PG_GETARG_FLOAT8(0);
+	float8		b = PG_GETARG_FLOAT8(1);
+
+	PG_RETURN_FLOAT8(b - a);
+}
+
+Datum
+brin_minmax_multi_distance_numeric(PG_FUNCTION_ARGS)
+{
+	Datum		a = PG_GETARG_DATUM(0);
+	Datum		b = PG_GETARG_DATUM(1);
+	Datum		d;
+
+	d = DirectFunctionCall2(numeric_sub, b, a);
+
+	PG_RETURN_DATUM(DirectFunctionCall1(numeric_float8_no_overflow, d));
+}
+
+Datum
+brin_minmax_multi_distance_oid(PG_FUNCTION_ARGS)
+{
+	Oid			a = PG_GETARG_OID(0);
+	Oid			b = PG_GETARG_OID(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_date(PG_FUNCTION_ARGS)
+{
+	DateADT		a = PG_GETARG_DATEADT(0);
+	DateADT		b = PG_GETARG_DATEADT(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_time(PG_FUNCTION_ARGS)
+{
+	TimeADT		a = PG_GETARG_TIMEADT(0);
+	TimeADT		b = PG_GETARG_TIMEADT(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+/*
+ * Also used for timestamptz, which has the same representation.
+ */
+Datum
+brin_minmax_multi_distance_timestamp(PG_FUNCTION_ARGS)
+{
+	Timestamp	a = PG_GETARG_TIMESTAMP(0);
+	Timestamp	b = PG_GETARG_TIMESTAMP(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_interval(PG_FUNCTION_ARGS)
+{
+	Interval   *a = PG_GETARG_INTERVAL_P(0);
+	Interval   *b = PG_GETARG_INTERVAL_P(1);
+	double		da,
+				db;
+
+	/* same approximation as interval_cmp_value */
+#ifdef HAVE_INT64_TIMESTAMP
+	da = a->time + ((double) a->month * DAYS_PER_MONTH + a->day) *
+		(double) USECS_PER_DAY;
+	db = b->time + ((double) b->month * DAYS_PER_MONTH + b->day) *
+		(double) USECS_PER_DAY;
+#else
+	da = a->time + ((double) a->month * DAYS_PER_MONTH + a->day) *
+		(double) SECS_PER_DAY;
+	db = b->time + ((double) b->month * DAYS_PER_MONTH + b->day) *
+		(double) SECS_PER_DAY;
+#endif
+
+	PG_RETURN_FLOAT8(db - da);
+}
+
+Datum
+brin_minmax_multi_distance_pg_lsn(PG_FUNCTION_ARGS)
+{
+	XLogRecPtr	a = PG_GETARG_LSN(0);
+	XLogRecPtr	b = PG_GETARG_LSN(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
@@ -15,6 +15,7 @@
 
 #include "postgres.h"
 
+#include "access/bloom.h"
 #include "access/gist_private.h"
 #include "access/hash.h"
 #include "access/htup_details.h"
@@ -80,6 +81,26 @@ static relopt_bool boolRelOpts[] =
 		},
 		true
 	},
+	{
+		{
+			"autosummarize",
+			"Enables automatic summarization on this BRIN index",
+			RELOPT_KIND_BRIN,
+			ShareUpdateExclusiveLock	/* since it applies only to later
+										 * inserts */
+		},
+		false
+	},
+	{
+		{
+			"deduplicate_items",
+			"Enables \"deduplicate items\" feature for this btree index",
+			RELOPT_KIND_BTREE,
+			ShareUpdateExclusiveLock	/* since it applies only to later
+										 * inserts */
+		},
+		true
+	},
 	{
 		{
 			"security_barrier",
@@ -93,6 +114,17 @@ static relopt_bool boolRelOpts[] =
 	{{NULL}}
 };
 
+/* per-column options of bloom indexes, "col1" to "col32" */
+#define BLOOM_COL_RELOPT(n) \
+	{ \
+		{ \
+			"col" CppAsString(n), \
+			"Number of bits generated for column " CppAsString(n) " of a bloom index", \
+			RELOPT_KIND_BLOOM, \
+			AccessExclusiveLock \
+		}, DEFAULT_BLOOM_BITS, 1, MAX_BLOOM_BITS \
+	}
+
 static relopt_int intRelOpts[] =
 {
 	{
@@ -245,6 +277,46 @@ static relopt_int intRelOpts[] =
 			AccessExclusiveLock
 		}, 128, 1, 131072
 	},
+	{
+		{
+			"length",
+			"Length of the signature of a bloom index, in bits",
+			RELOPT_KIND_BLOOM,
+			AccessExclusiveLock
+		}, DEFAULT_BLOOM_LENGTH, 1, MAX_BLOOM_LENGTH
+	},
+	BLOOM_COL_RELOPT(1),
+	BLOOM_COL_RELOPT(2),
+	BLOOM_COL_RELOPT(3),
+	BLOOM_COL_RELOPT(4),
+	BLOOM_COL_RELOPT(5),
+	BLOOM_COL_RELOPT(6),
+	BLOOM_COL_RELOPT(7),
+	BLOOM_COL_RELOPT(8),
+	BLOOM_COL_RELOPT(9),
+	BLOOM_COL_RELOPT(10),
+	BLOOM_COL_RELOPT(11),
+	BLOOM_COL_RELOPT(12),
+	BLOOM_COL_RELOPT(13),
+	BLOOM_COL_RELOPT(14),
+	BLOOM_COL_RELOPT(15),
+	BLOOM_COL_RELOPT(16),
+	BLOOM_COL_RELOPT(17),
+	BLOOM_COL_RELOPT(18),
+	BLOOM_COL_RELOPT(19),
+	BLOOM_COL_RELOPT(20),
+	BLOOM_COL_RELOPT(21),
+	BLOOM_COL_RELOPT(22),
+	BLOOM_COL_RELOPT(23),
+	BLOOM_COL_RELOPT(24),
+	BLOOM_COL_RELOPT(25),
+	BLOOM_COL_RELOPT(26),
+	BLOOM_COL_RELOPT(27),
+	BLOOM_COL_RELOPT(28),
+	BLOOM_COL_RELOPT(29),
+	BLOOM_COL_RELOPT(30),
+	BLOOM_COL_RELOPT(31),
+	BLOOM_COL_RELOPT(32),
 	{
 		{
 			"gin_pending_list_limit",
@@ -887,11 +959,13 @@ untransformRelOptions(Datum options)
  * other uses, consider grabbing the rd_options pointer from the relcache entry
  * instead.
  *
- * tupdesc is pg_class' tuple descriptor.  amoptions is the amoptions regproc
- * in the case of the tuple corresponding to an index, or InvalidOid otherwise.
+ * tupdesc is pg_class' tuple descriptor.  amoptions is a pointer to the index
+ * AM's options parser function in the case of a tuple corresponding to an
+ * index, or NULL otherwise.
  */
 bytea *
-extractRelOptions(HeapTuple tuple, TupleDesc tupdesc, Oid amoptions)
+extractRelOptions(HeapTuple tuple, TupleDesc tupdesc,
+				  amoptions_function amoptions)
 {
 	bytea	   *options;
 	bool		isnull;
@@ -919,6 +993,7 @@ extractRelOptions(HeapTuple tuple, TupleDesc tupdesc, Oid amoptions)
 			options = view_reloptions(datum, false);
 			break;
 		case RELKIND_INDEX:
+			Assert(amoptions != NULL);
 			options = index_reloptions(amoptions, datum, false);
 			break;
 		case RELKIND_FOREIGN_TABLE:
@@ -1374,39 +1449,20 @@ heap_reloptions(char relkind, Datum reloptions, bool validate)
 /*
  * Parse options for indexes.
  *
- *	amoptions	Oid of option parser
+ *	amoptions	index AM's option parser function
  *	reloptions	options as text[] datum
  *	validate	error flag
  */
 bytea *
-index_reloptions(RegProcedure amoptions, Datum reloptions, bool validate)
+index_reloptions(amoptions_function amoptions, Datum reloptions, bool validate)
 {
-	FmgrInfo	flinfo;
-	FunctionCallInfoData fcinfo;
-	Datum		result;
-
-	Assert(RegProcedureIsValid(amoptions));
+	Assert(amoptions != NULL);
 
 	/* Assume function is strict */
 	if (!PointerIsValid(DatumGetPointer(reloptions)))
 		return NULL;
 
-	/* Can't use OidFunctionCallN because we might get a NULL result */
-	fmgr_info(amoptions, &flinfo);
-
-	InitFunctionCallInfoData(fcinfo, &flinfo, 2, InvalidOid, NULL, NULL);
-
-	fcinfo.arg[0] = reloptions;
-	fcinfo.arg[1] = BoolGetDatum(validate);
-	fcinfo.argnull[0] = false;
-	fcinfo.argnull[1] = false;
-
-	result = FunctionCallInvoke(&fcinfo);
-
-	if (fcinfo.isnull || DatumGetPointer(result) == NULL)
-		return NULL;
-
-	return DatumGetByteaP(result);
+	return amoptions(reloptions, validate);
 }
 
 /*
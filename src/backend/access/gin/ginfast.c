@@ -3,9 +3,10 @@
  * ginfast.c
  *	  Fast insert routines for the Postgres inverted index access method.
  *	  Pending entries are stored in linear list of pages.  Later on
- *	  (typically during VACUUM), ginInsertCleanup() will be invoked to
- *	  transfer pending entries into the regular index structure.  This
- *	  wins because bulk insertion is much more efficient than retail.
+ *	  (typically during VACUUM, or in an autovacuum worker when the list
+ *	  grows too long), ginInsertCleanup() will be invoked to transfer
+ *	  pending entries into the regular index structure.  This wins because
+ *	  bulk insertion is much more efficient than retail.
  *
  * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -19,12 +20,18 @@
 #include "postgres.h"
 
 #include "access/gin_private.h"
+#include "access/xlog.h"
 #include "access/xloginsert.h"
+#include "catalog/pg_am.h"
 #include "commands/vacuum.h"
 #include "miscadmin.h"
+#include "postmaster/autovacuum.h"
+#include "storage/indexfsm.h"
+#include "storage/lmgr.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
-#include "storage/indexfsm.h"
 
 /* GUC parameter */
 int			gin_pending_list_limit = 0;
@@ -223,6 +230,7 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 	ginxlogUpdateMeta data;
 	bool		separateList = false;
 	bool		needCleanup = false;
+	bool		forceCleanup = false;
 	int			cleanupSize;
 	bool		needWal;
 
@@ -416,25 +424,35 @@ ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collector)
 		UnlockReleaseBuffer(buffer);
 
 	/*
-	 * Force pending list cleanup when it becomes too long. And,
-	 * ginInsertCleanup could take significant amount of time, so we prefer to
-	 * call it when it can do all the work in a single collection cycle. In
-	 * non-vacuum mode, it shouldn't require maintenance_work_mem, so fire it
-	 * while pending list is still small enough to fit into
-	 * gin_pending_list_limit.
+	 * Pending list cleanup could take significant amount of time, so we'd
+	 * rather not make this inserter pay for it.  Once the list grows larger
+	 * than the cleanup threshold, ask autovacuum to move it into the main
+	 * structure in the background.  If autovacuum is not running or cannot
+	 * take the request, or if it has fallen behind so much that the list has
+	 * grown to twice the threshold, clean up here instead; but then we only
+	 * process the pages that exist now and don't wait for any concurrent
+	 * cleanup, so that the delay stays bounded.
 	 *
 	 * ginInsertCleanup() should not be called inside our CRIT_SECTION.
 	 */
 	cleanupSize = GinGetPendingListCleanupSize(index);
 	if (metadata->nPendingPages * GIN_PAGE_FREESIZE > cleanupSize * 1024L)
 		needCleanup = true;
+	if (metadata->nPendingPages * GIN_PAGE_FREESIZE > cleanupSize * 2048L)
+		forceCleanup = true;
 
 	UnlockReleaseBuffer(metabuffer);
 
 	END_CRIT_SECTION();
 
 	if (needCleanup)
-		ginInsertCleanup(ginstate, false, true, NULL);
+	{
+		if (forceCleanup || !AutoVacuumingActive() ||
+			!AutoVacuumRequestWork(AVW_GINCleanPendingList,
+								   RelationGetRelid(index),
+								   InvalidBlockNumber))
+			ginInsertCleanup(ginstate, false, true, NULL);
+	}
 }
 
 /*
@@ -719,21 +737,24 @@ processPendingPage(BuildAccumulator *accum, KeyArray *ka,
 /*
  * Move tuples from pending pages into regular GIN structure.
  *
- * This can be called concurrently by multiple backends, so it must cope.
- * On first glance it looks completely not concurrent-safe and not crash-safe
- * either.  The reason it's okay is that multiple insertion of the same entry
- * is detected and treated as a no-op by gininsert.c.  If we crash after
- * posting entries to the main index and before removing them from the
+ * On first glance this looks completely not crash-safe.  But if we crash
+ * after posting entries to the main index and before removing them from the
  * pending list, it's okay because when we redo the posting later on, nothing
- * bad will happen.  Likewise, if two backends simultaneously try to post
- * a pending entry into the main index, one will succeed and one will do
- * nothing.  We try to notice when someone else is a little bit ahead of
- * us in the process, but that's just to avoid wasting cycles.  Only the
- * action of removing a page from the pending list really needs exclusive
- * lock.
+ * bad will happen.
  *
- * vac_delay indicates that ginInsertCleanup should call
- * vacuum_delay_point() periodically.
+ * Only one backend at a time cleans up the pending list of a given index;
+ * that's enforced by a heavyweight lock on the metapage.  Other backends can
+ * keep appending to the list and scanning it meanwhile.  Only the action of
+ * removing a page from the pending list needs an exclusive buffer lock.
+ *
+ * full_clean is true when called from VACUUM, autovacuum or
+ * gin_clean_pending_list().  We then wait for any concurrent cleanup to
+ * finish, and process the whole list including pages appended while we work.
+ * Otherwise, we're being called from an inserter: if someone else is already
+ * cleaning up we just return, and we only process the pages that existed
+ * when we started, so that the inserter isn't held up indefinitely by a
+ * stream of concurrent insertions.  A full clean uses maintenance_work_mem
+ * (or autovacuum_work_mem) for the accumulator, an inserter only work_mem.
  *
  * fill_fsm indicates that ginInsertCleanup should add deleted pages
  * to FSM otherwise caller is responsible to put deleted pages into
@@ -743,7 +764,7 @@ processPendingPage(BuildAccumulator *accum, KeyArray *ka,
  */
 void
 ginInsertCleanup(GinState *ginstate,
-				 bool vac_delay, bool fill_fsm,
+				 bool full_clean, bool fill_fsm,
 				 IndexBulkDeleteResult *stats)
 {
 	Relation	index = ginstate->index;
@@ -756,8 +777,25 @@ ginInsertCleanup(GinState *ginstate,
 				oldCtx;
 	BuildAccumulator accum;
 	KeyArray	datums;
-	BlockNumber blkno;
+	BlockNumber blkno,
+				blknoFinish;
+	bool		cleanupFinish = false;
 	bool		fsm_vac = false;
+	Size		workMemory;
+
+	if (full_clean)
+	{
+		LockPage(index, GIN_METAPAGE_BLKNO, ExclusiveLock);
+		workMemory = (IsAutoVacuumWorkerProcess() &&
+					  autovacuum_work_mem != -1) ?
+			autovacuum_work_mem : maintenance_work_mem;
+	}
+	else
+	{
+		if (!ConditionalLockPage(index, GIN_METAPAGE_BLKNO, ExclusiveLock))
+			return;
+		workMemory = work_mem;
+	}
 
 	metabuffer = ReadBuffer(index, GIN_METAPAGE_BLKNO);
 	LockBuffer(metabuffer, GIN_SHARE);
@@ -768,9 +806,16 @@ ginInsertCleanup(GinState *ginstate,
 	{
 		/* Nothing to do */
 		UnlockReleaseBuffer(metabuffer);
+		UnlockPage(index, GIN_METAPAGE_BLKNO, ExclusiveLock);
 		return;
 	}
 
+	/*
+	 * Remember the tail page, so that an inserter can stop there; new pages
+	 * may be appended behind it while we work.
+	 */
+	blknoFinish = metadata->tail;
+
 	/*
 	 * Read and lock head of pending list
 	 */
@@ -811,6 +856,9 @@ ginInsertCleanup(GinState *ginstate,
 			break;
 		}
 
+		if (blkno == blknoFinish && !full_clean)
+			cleanupFinish = true;
+
 		/*
 		 * read page's datums into accum
 		 */
@@ -820,15 +868,13 @@ ginInsertCleanup(GinState *ginstate,
 
 		/*
 		 * Is it time to flush memory to disk?	Flush if we are at the end of
-		 * the pending list, or if we have a full row and memory is getting
-		 * full.
-		 *
-		 * XXX using up maintenance_work_mem here is probably unreasonably
-		 * much, since vacuum might already be using that much.
+		 * the pending list or of the part of it we were asked to process, or
+		 * if we have a full row and memory is getting full.
 		 */
 		if (GinPageGetOpaque(page)->rightlink == InvalidBlockNumber ||
 			(GinPageHasFullRow(page) &&
-			 (accum.allocatedMemory >= (Size)maintenance_work_mem * 1024L)))
+			 (cleanupFinish ||
+			  accum.allocatedMemory >= workMemory * 1024L)))
 		{
 			ItemPointerData *list;
 			uint32		nlist;
@@ -920,9 +966,10 @@ ginInsertCleanup(GinState *ginstate,
 			LockBuffer(metabuffer, GIN_UNLOCK);
 
 			/*
-			 * if we removed the whole pending list just exit
+			 * if we removed the whole pending list, or everything we were
+			 * asked to process, just exit
 			 */
-			if (blkno == InvalidBlockNumber)
+			if (blkno == InvalidBlockNumber || cleanupFinish)
 				break;
 
 			/*
@@ -948,6 +995,7 @@ ginInsertCleanup(GinState *ginstate,
 	}
 
 	ReleaseBuffer(metabuffer);
+	UnlockPage(index, GIN_METAPAGE_BLKNO, ExclusiveLock);
 
 	/*
 	 * As pending list pages can have a high churn rate, it is
@@ -962,3 +1010,52 @@ ginInsertCleanup(GinState *ginstate,
 	MemoryContextSwitchTo(oldCtx);
 	MemoryContextDelete(opCtx);
 }
+
+/*
+ * SQL-callable function to clean the insert pending list
+ */
+Datum
+gin_clean_pending_list(PG_FUNCTION_ARGS)
+{
+	Oid			indexoid = PG_GETARG_OID(0);
+	Relation	indexRel = index_open(indexoid, AccessShareLock);
+	IndexBulkDeleteResult stats;
+	GinState	ginstate;
+
+	if (RecoveryInProgress())
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("recovery is in progress"),
+		 errhint("GIN pending list cannot be cleaned up during recovery.")));
+
+	/* Must be a GIN index */
+	if (indexRel->rd_rel->relkind != RELKIND_INDEX ||
+		indexRel->rd_rel->relam != GIN_AM_OID)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not a GIN index",
+						RelationGetRelationName(indexRel))));
+
+	/*
+	 * Reject attempts to read non-local temporary relations; we would be
+	 * likely to get wrong data since we have no visibility into the owning
+	 * session's local buffers.
+	 */
+	if (RELATION_IS_OTHER_TEMP(indexRel))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			   errmsg("cannot access temporary indexes of other sessions")));
+
+	/* User must own the index (comparable to privileges needed for VACUUM) */
+	if (!pg_class_ownercheck(indexoid, GetUserId()))
+		aclcheck_error(ACLCHECK_NOT_OWNER, ACL_KIND_CLASS,
+					   RelationGetRelationName(indexRel));
+
+	memset(&stats, 0, sizeof(stats));
+	initGinState(&ginstate, indexRel);
+	ginInsertCleanup(&ginstate, true, true, &stats);
+
+	index_close(indexRel, AccessShareLock);
+
+	PG_RETURN_INT64((int64) stats.pages_deleted);
+}
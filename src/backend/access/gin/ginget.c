@@ -1644,6 +1644,17 @@ collectMatchesForHeapRow(IndexScanDesc scan, pendingPosition *pos)
 
 				pos->hasMatchKey[i] |= key->entryRes[j];
 			}
+
+			/*
+			 * If this page holds the rest of the heap row and none of the
+			 * key's entries matched, the row can't be returned; don't bother
+			 * looking up the remaining keys.
+			 */
+			if (!pos->hasMatchKey[i] && GinPageHasFullRow(page))
+			{
+				pos->firstOffset = pos->lastOffset;
+				return false;
+			}
 		}
 
 		/* Advance firstOffset over the scanned tuples */
@@ -1772,11 +1783,9 @@ scanPendingInsert(IndexScanDesc scan, TIDBitmap *tbm, int64 *ntids)
 
 #define GinIsVoidRes(s)		( ((GinScanOpaque) scan->opaque)->isVoidRes )
 
-Datum
-gingetbitmap(PG_FUNCTION_ARGS)
+int64
+gingetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
-	TIDBitmap  *tbm = (TIDBitmap *) PG_GETARG_POINTER(1);
 	GinScanOpaque so = (GinScanOpaque) scan->opaque;
 	int64		ntids;
 	ItemPointerData iptr;
@@ -1790,7 +1799,7 @@ gingetbitmap(PG_FUNCTION_ARGS)
 	ginNewScanKey(scan);
 
 	if (GinIsVoidRes(scan))
-		PG_RETURN_INT64(0);
+		return 0;
 
 	ntids = 0;
 
@@ -1827,5 +1836,5 @@ gingetbitmap(PG_FUNCTION_ARGS)
 		ntids++;
 	}
 
-	PG_RETURN_INT64(ntids);
+	return ntids;
 }
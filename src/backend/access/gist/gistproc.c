@@ -17,9 +17,12 @@
  */
 #include "postgres.h"
 
+#include <math.h>
+
 #include "access/gist.h"
 #include "access/stratnum.h"
 #include "utils/geo_decls.h"
+#include "utils/sortsupport.h"
 
 
 static bool gist_box_leaf_consistent(BOX *key, BOX *query,
@@ -1515,3 +1518,159 @@ gist_bbox_distance(PG_FUNCTION_ARGS)
 
 	PG_RETURN_FLOAT8(distance);
 }
+
+
+/**************************************************
+ * Z-order routines for sorted index build
+ **************************************************/
+
+/*
+ * Map a float8 to a uint32 in a way that preserves the ordering
+ *
+ * The IEEE 754 bit pattern of a non-negative double, read as an unsigned
+ * integer, sorts the same way as the value itself; for negative values the
+ * order is reversed.  So we flip all bits of negative values and only the
+ * sign bit of the others, which yields an order-preserving uint64, and keep
+ * its upper half.  That retains the sign, the exponent and 20 bits of
+ * mantissa, plenty for clustering purposes.  All NaNs are mapped to the
+ * largest value, as float8 comparisons do.
+ */
+static uint32
+gist_float8_to_zorder(float8 f)
+{
+	union
+	{
+		float8		f;
+		uint64		i;
+	}			u;
+
+	if (isnan(f))
+		return PG_UINT32_MAX;
+
+	u.f = f;
+	if ((u.i & UINT64CONST(0x8000000000000000)) != 0)
+		u.i = ~u.i;
+	else
+		u.i |= UINT64CONST(0x8000000000000000);
+
+	return (uint32) (u.i >> 32);
+}
+
+/* Spread the 32 bits of x over the even bits of a uint64 */
+static uint64
+gist_part_bits32_by2(uint32 x)
+{
+	uint64		n = x;
+
+	n = (n | (n << 16)) & UINT64CONST(0x0000FFFF0000FFFF);
+	n = (n | (n << 8)) & UINT64CONST(0x00FF00FF00FF00FF);
+	n = (n | (n << 4)) & UINT64CONST(0x0F0F0F0F0F0F0F0F);
+	n = (n | (n << 2)) & UINT64CONST(0x3333333333333333);
+	n = (n | (n << 1)) & UINT64CONST(0x5555555555555555);
+
+	return n;
+}
+
+/*
+ * Compute the Z-order value (Morton code) of the center of a box
+ *
+ * Z-order maps a two-dimensional point to a single integer by interleaving
+ * the bits of its coordinates, in a way that preserves locality: points that
+ * are close to each other tend to get close values.  Sorting the input on it
+ * and packing pages in that order gives leaf pages with compact bounding
+ * boxes.  For the point opclass the keys are degenerate boxes, and the center
+ * is the point itself.
+ */
+static uint64
+gist_box_zorder(BOX *box)
+{
+	float8		x = box->low.x + (box->high.x - box->low.x) / 2.0;
+	float8		y = box->low.y + (box->high.y - box->low.y) / 2.0;
+
+	return gist_part_bits32_by2(gist_float8_to_zorder(x)) |
+		(gist_part_bits32_by2(gist_float8_to_zorder(y)) << 1);
+}
+
+static int
+gist_bbox_zorder_cmp(Datum a, Datum b, SortSupport ssup)
+{
+	BOX		   *box1 = DatumGetBoxP(a);
+	BOX		   *box2 = DatumGetBoxP(b);
+	uint64		z1;
+	uint64		z2;
+
+	/*
+	 * Do a quick check for equality first.  This is cheap, and common when
+	 * used as tie-breaker with abbreviated keys.
+	 */
+	if (memcmp(box1, box2, sizeof(BOX)) == 0)
+		return 0;
+
+	z1 = gist_box_zorder(box1);
+	z2 = gist_box_zorder(box2);
+	if (z1 > z2)
+		return 1;
+	else if (z1 < z2)
+		return -1;
+	else
+		return 0;
+}
+
+/*
+ * Abbreviated keys are the Z-order value itself, or its most significant
+ * bits where Datum is only 32 bits wide.
+ */
+static Datum
+gist_bbox_zorder_abbrev_convert(Datum original, SortSupport ssup)
+{
+	uint64		z = gist_box_zorder(DatumGetBoxP(original));
+
+#if SIZEOF_DATUM == 8
+	return (Datum) z;
+#else
+	return (Datum) (z >> 32);
+#endif
+}
+
+static int
+gist_bbox_zorder_cmp_abbrev(Datum z1, Datum z2, SortSupport ssup)
+{
+	if (z1 > z2)
+		return 1;
+	else if (z1 < z2)
+		return -1;
+	else
+		return 0;
+}
+
+/*
+ * We never abort abbreviation: it's lossless on 64-bit platforms, and
+ * computing the Z-order value is no more expensive than a full comparison.
+ */
+static bool
+gist_bbox_zorder_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+	return false;
+}
+
+/*
+ * Sort support routine for sorted GiST index build over boxes and points,
+ * ordering keys by the Z-order value of their center.
+ */
+Datum
+gist_box_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+
+	if (ssup->abbreviate)
+	{
+		ssup->comparator = gist_bbox_zorder_cmp_abbrev;
+		ssup->abbrev_converter = gist_bbox_zorder_abbrev_convert;
+		ssup->abbrev_abort = gist_bbox_zorder_abbrev_abort;
+		ssup->abbrev_full_comparator = gist_bbox_zorder_cmp;
+	}
+	else
+		ssup->comparator = gist_bbox_zorder_cmp;
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,398 @@
+/*-------------------------------------------------------------------------
+ *
+ * nbtdedup.c
+ *	  Deduplicate items in Postgres btrees.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/nbtree/nbtdedup.c
+ *
+ *	NOTES
+ *	   Runs of leaf tuples with equal keys are merged into "posting list"
+ *	   tuples, which store the key once followed by the heap TIDs of all the
+ *	   merged tuples, much like GIN's posting lists.  This happens lazily,
+ *	   when an insertion would otherwise have to split a leaf page, and
+ *	   during index builds.  See nbtree/README for details.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/nbtree.h"
+#include "access/xloginsert.h"
+#include "miscadmin.h"
+#include "utils/rel.h"
+
+static bool _bt_dedup_keys_equal(IndexTuple a, IndexTuple b);
+static int	_bt_itemptr_cmp(const void *a, const void *b);
+
+
+/*
+ * Should tuples inserted into this index be deduplicated?
+ *
+ * Unique indexes are never deduplicated: they have few duplicates to begin
+ * with, and _bt_check_unique expects one heap TID per tuple.
+ */
+bool
+_bt_dedup_enabled(Relation rel)
+{
+	return !rel->rd_index->indisunique && BTGetDeduplicateItems(rel);
+}
+
+/*
+ * Try to make room on a full leaf page by merging runs of duplicates into
+ * posting list tuples.
+ *
+ * The page is rebuilt on a temporary copy; if nothing could be merged, the
+ * original is left untouched.  The caller must hold an exclusive lock on
+ * buf, and must not rely on any offset numbers on the page afterwards.
+ */
+void
+_bt_dedup_one_page(Relation rel, Buffer buf)
+{
+	Page		page = BufferGetPage(buf);
+	BTPageOpaque opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+	Page		newpage;
+	BTPageOpaque nopaque;
+	BTDedupState state;
+	OffsetNumber offnum,
+				minoff,
+				maxoff;
+
+	Assert(P_ISLEAF(opaque));
+
+	minoff = P_FIRSTDATAKEY(opaque);
+	maxoff = PageGetMaxOffsetNumber(page);
+	if (minoff >= maxoff)
+		return;					/* fewer than two items, nothing to merge */
+
+	state = _bt_dedup_begin(BTMaxPostingSize(page));
+
+	newpage = PageGetTempPageCopySpecial(page);
+	PageSetLSN(newpage, PageGetLSN(page));
+
+	/* Copy the high key, if any, unchanged */
+	if (!P_RIGHTMOST(opaque))
+	{
+		ItemId		hitemid = PageGetItemId(page, P_HIKEY);
+		Size		hitemsz = ItemIdGetLength(hitemid);
+		IndexTuple	hitem = (IndexTuple) PageGetItem(page, hitemid);
+
+		if (PageAddItem(newpage, (Item) hitem, hitemsz, P_HIKEY,
+						false, false) == InvalidOffsetNumber)
+			elog(ERROR, "deduplication failed to add high key");
+	}
+
+	for (offnum = minoff; offnum <= maxoff; offnum = OffsetNumberNext(offnum))
+	{
+		ItemId		itemid = PageGetItemId(page, offnum);
+		IndexTuple	itup = (IndexTuple) PageGetItem(page, itemid);
+
+		if (offnum == minoff)
+			_bt_dedup_start_pending(state, itup, offnum);
+		else if (!_bt_dedup_save_htid(state, itup))
+		{
+			/* itup starts a new group; emit the pending one */
+			_bt_dedup_finish_pending(newpage, state);
+			_bt_dedup_start_pending(state, itup, offnum);
+		}
+	}
+	_bt_dedup_finish_pending(newpage, state);
+
+	if (state->nintervals == 0)
+	{
+		/* nothing merged, so don't touch the page */
+		pfree(newpage);
+		_bt_dedup_end(state);
+		return;
+	}
+
+	/*
+	 * LP_DEAD bits were not carried over to the new page, so don't claim
+	 * there are any.
+	 */
+	nopaque = (BTPageOpaque) PageGetSpecialPointer(newpage);
+	nopaque->btpo_flags &= ~BTP_HAS_GARBAGE;
+
+	/* No ereport(ERROR) until changes are logged */
+	START_CRIT_SECTION();
+
+	PageRestoreTempPage(newpage, page);
+	MarkBufferDirty(buf);
+
+	/* XLOG stuff */
+	if (RelationNeedsWAL(rel))
+	{
+		XLogRecPtr	recptr;
+		xl_btree_dedup xlrec_dedup;
+
+		xlrec_dedup.nintervals = state->nintervals;
+
+		XLogBeginInsert();
+		XLogRegisterBuffer(0, buf, REGBUF_STANDARD);
+		XLogRegisterData((char *) &xlrec_dedup, SizeOfBtreeDedup);
+
+		/*
+		 * The intervals array is not in the buffer, but pretend that it is.
+		 * When XLogInsert stores the whole buffer, the array need not be
+		 * stored too.
+		 */
+		XLogRegisterBufData(0, (char *) state->intervals,
+							state->nintervals * sizeof(BTDedupInterval));
+
+		recptr = XLogInsert(RM_BTREE_ID, XLOG_BTREE_DEDUP);
+
+		PageSetLSN(page, recptr);
+	}
+
+	END_CRIT_SECTION();
+
+	_bt_dedup_end(state);
+}
+
+/*
+ * Set up a deduplication state whose posting list tuples are limited to
+ * maxpostingsize bytes.
+ */
+BTDedupState
+_bt_dedup_begin(Size maxpostingsize)
+{
+	BTDedupState state;
+
+	state = (BTDedupState) palloc(sizeof(BTDedupStateData));
+	state->maxpostingsize = maxpostingsize;
+	state->base = NULL;
+	state->baseoff = InvalidOffsetNumber;
+	state->basetupsize = 0;
+	state->htids = (ItemPointer)
+		palloc(MaxTIDsPerBTreePage * sizeof(ItemPointerData));
+	state->nhtids = 0;
+	state->nitems = 0;
+	state->phystupsize = 0;
+	state->nintervals = 0;
+
+	return state;
+}
+
+/*
+ * Release a deduplication state.  The base tuple belongs to the caller.
+ */
+void
+_bt_dedup_end(BTDedupState state)
+{
+	pfree(state->htids);
+	pfree(state);
+}
+
+/*
+ * Start a new pending posting list, with "base" as its first tuple.  baseoff
+ * is base's offset on the page being deduplicated, or InvalidOffsetNumber
+ * during an index build.
+ *
+ * base is only referenced, not copied; it must stay valid until the group
+ * is finished.
+ */
+void
+_bt_dedup_start_pending(BTDedupState state, IndexTuple base,
+						OffsetNumber baseoff)
+{
+	int			nhtids = BTreeTupleGetNHeapTIDs(base);
+
+	Assert(state->nhtids == 0 && state->nitems == 0);
+
+	state->base = base;
+	state->baseoff = baseoff;
+	state->basetupsize = BTreeTupleGetKeySize(base);
+	memcpy(state->htids, BTreeTupleGetHeapTIDs(base),
+		   nhtids * sizeof(ItemPointerData));
+	state->nhtids = nhtids;
+	state->nitems = 1;
+	state->phystupsize = MAXALIGN(IndexTupleSize(base)) + sizeof(ItemIdData);
+}
+
+/*
+ * Try to add itup's heap TIDs to the pending posting list.
+ *
+ * Returns false, without changing anything, if itup's key is not equal to
+ * the base tuple's or if the posting list would grow too large.  The caller
+ * should then finish the pending posting list and start a new one with itup.
+ */
+bool
+_bt_dedup_save_htid(BTDedupState state, IndexTuple itup)
+{
+	int			nhtids = BTreeTupleGetNHeapTIDs(itup);
+	Size		mergedtupsz;
+
+	Assert(state->nitems > 0);
+
+	if (!_bt_dedup_keys_equal(state->base, itup))
+		return false;
+
+	mergedtupsz = MAXALIGN(state->basetupsize +
+						   (state->nhtids + nhtids) * sizeof(ItemPointerData));
+	if (mergedtupsz > state->maxpostingsize ||
+		state->nhtids + nhtids > BT_OFFSET_MASK)
+		return false;
+
+	memcpy(state->htids + state->nhtids, BTreeTupleGetHeapTIDs(itup),
+		   nhtids * sizeof(ItemPointerData));
+	state->nhtids += nhtids;
+	state->nitems++;
+	state->phystupsize += MAXALIGN(IndexTupleSize(itup)) + sizeof(ItemIdData);
+
+	return true;
+}
+
+/*
+ * Add the pending posting list to newpage, and reset the pending state.
+ *
+ * If only the base tuple is pending, it is added unchanged; otherwise a new
+ * posting list tuple is formed from it and the accumulated heap TIDs, and
+ * the group is recorded in state->intervals.  Returns the space saved on the
+ * page, line pointers included.
+ */
+Size
+_bt_dedup_finish_pending(Page newpage, BTDedupState state)
+{
+	OffsetNumber tupoff;
+	Size		tuplesz;
+	Size		spacesaving = 0;
+
+	Assert(state->nitems > 0);
+	Assert(state->nintervals < MaxIndexTuplesPerPage);
+
+	tupoff = OffsetNumberNext(PageGetMaxOffsetNumber(newpage));
+	if (state->nitems == 1)
+	{
+		/* Use original, unchanged base tuple */
+		tuplesz = IndexTupleSize(state->base);
+		if (PageAddItem(newpage, (Item) state->base, tuplesz, tupoff,
+						false, false) == InvalidOffsetNumber)
+			elog(ERROR, "deduplication failed to add tuple to page");
+	}
+	else
+	{
+		IndexTuple	final;
+
+		/* Merged TIDs need not arrive in order, but posting lists are sorted */
+		qsort(state->htids, state->nhtids, sizeof(ItemPointerData),
+			  _bt_itemptr_cmp);
+
+		final = _bt_form_posting(state->base, state->htids, state->nhtids);
+		tuplesz = IndexTupleSize(final);
+		Assert(tuplesz <= state->maxpostingsize);
+
+		state->intervals[state->nintervals].baseoff = state->baseoff;
+		state->intervals[state->nintervals].nitems = state->nitems;
+		state->nintervals++;
+
+		if (PageAddItem(newpage, (Item) final, tuplesz, tupoff,
+						false, false) == InvalidOffsetNumber)
+			elog(ERROR, "deduplication failed to add tuple to page");
+
+		pfree(final);
+		spacesaving = state->phystupsize - (tuplesz + sizeof(ItemIdData));
+	}
+
+	state->nhtids = 0;
+	state->nitems = 0;
+	state->phystupsize = 0;
+
+	return spacesaving;
+}
+
+/*
+ * Build a leaf tuple with the key of "base" and the given heap TIDs, which
+ * must be sorted.  With a single TID the result is a plain tuple, otherwise
+ * a posting list tuple.  Any posting list base has is ignored.
+ *
+ * The result is palloc'd.
+ */
+IndexTuple
+_bt_form_posting(IndexTuple base, ItemPointer htids, int nhtids)
+{
+	Size		keysize;
+	Size		newsize;
+	IndexTuple	itup;
+
+	Assert(nhtids > 0);
+
+	keysize = BTreeTupleGetKeySize(base);
+	Assert(keysize == MAXALIGN(keysize));
+
+	if (nhtids > 1)
+		newsize = MAXALIGN(keysize + nhtids * sizeof(ItemPointerData));
+	else
+		newsize = keysize;
+	Assert(newsize <= INDEX_SIZE_MASK);
+
+	itup = (IndexTuple) palloc0(newsize);
+	memcpy(itup, base, keysize);
+	itup->t_info &= ~INDEX_SIZE_MASK;
+	itup->t_info |= newsize;
+
+	if (nhtids > 1)
+	{
+		BTreeTupleSetPosting(itup, nhtids, keysize);
+		memcpy(BTreeTupleGetPosting(itup), htids,
+			   nhtids * sizeof(ItemPointerData));
+	}
+	else
+	{
+		itup->t_info &= ~INDEX_ALT_TID_MASK;
+		ItemPointerCopy(htids, &itup->t_tid);
+	}
+
+	return itup;
+}
+
+/*
+ * Make a palloc'd copy of a leaf tuple suitable for use as a high key or
+ * downlink: any posting list is cut off, leaving a plain tuple that points
+ * to the first of its heap TIDs.
+ */
+IndexTuple
+_bt_pivotcopy(IndexTuple itup)
+{
+	if (!BTreeTupleIsPosting(itup))
+		return CopyIndexTuple(itup);
+
+	return _bt_form_posting(itup, BTreeTupleGetPosting(itup), 1);
+}
+
+/*
+ * Do two leaf tuples have binary-identical keys?
+ *
+ * This is stricter than the opclass's notion of equality: values that
+ * compare equal but are stored differently (e.g. numeric 1.0 and 1.00, or
+ * float8 0 and -0) are never merged, so that a posting list always stands
+ * for tuples that are truly interchangeable, and index-only scans keep
+ * returning the values that were actually indexed.
+ */
+static bool
+_bt_dedup_keys_equal(IndexTuple a, IndexTuple b)
+{
+	Size		keysize = BTreeTupleGetKeySize(a);
+
+	if (BTreeTupleGetKeySize(b) != keysize)
+		return false;
+	if ((a->t_info & INDEX_NULL_MASK) != (b->t_info & INDEX_NULL_MASK))
+		return false;
+
+	/* compare everything after the header: null bitmap, padding and data */
+	return memcmp((char *) a + sizeof(IndexTupleData),
+				  (char *) b + sizeof(IndexTupleData),
+				  keysize - sizeof(IndexTupleData)) == 0;
+}
+
+/*
+ * qsort comparator for heap TIDs
+ */
+static int
+_bt_itemptr_cmp(const void *a, const void *b)
+{
+	return ItemPointerCompare((ItemPointer) a, (ItemPointer) b);
+}
@@ -108,7 +108,7 @@ _bt_doinsert(Relation rel, IndexTuple itup,
 			 IndexUniqueCheck checkUnique, Relation heapRel)
 {
 	bool		is_unique = false;
-	int			natts = rel->rd_rel->relnatts;
+	int			natts = IndexRelationGetNumberOfKeyAttributes(rel);
 	ScanKey		itup_scankey;
 	BTStack		stack;
 	Buffer		buf;
@@ -242,7 +242,7 @@ _bt_check_unique(Relation rel, IndexTuple itup, Relation heapRel,
 				 uint32 *speculativeToken)
 {
 	TupleDesc	itupdesc = RelationGetDescr(rel);
-	int			natts = rel->rd_rel->relnatts;
+	int			natts = IndexRelationGetNumberOfKeyAttributes(rel);
 	SnapshotData SnapshotDirty;
 	OffsetNumber maxoff;
 	Page		page;
@@ -668,6 +668,19 @@ _bt_findinsertloc(Relation rel,
 		vacuumed = false;
 	}
 
+	/*
+	 * If the item still doesn't fit, we'd have to split the page.  On a leaf
+	 * page, first see if merging duplicates into posting list tuples frees
+	 * enough space.  Like vacuuming, that moves tuples around, so the
+	 * caller's hint is no longer good afterwards.
+	 */
+	if (PageGetFreeSpace(page) < itemsz && P_ISLEAF(lpageop) &&
+		_bt_dedup_enabled(rel))
+	{
+		_bt_dedup_one_page(rel, buf);
+		vacuumed = true;
+	}
+
 	/*
 	 * Now we are on the right page, so find the insert position. If we moved
 	 * right at all, we know we should insert at the start of the page. If we
@@ -1072,6 +1085,36 @@ _bt_split(Relation rel, Buffer buf, Buffer cbuf, OffsetNumber firstright,
 		itemsz = ItemIdGetLength(itemid);
 		item = (IndexTuple) PageGetItem(origpage, itemid);
 	}
+
+	/*
+	 * On the leaf level, the high key only has to separate the last tuple on
+	 * the left page from the first one on the right page, so _bt_truncate
+	 * can leave out any trailing columns that are not needed for that.  The
+	 * result never carries a posting list.  Upper levels keep using the
+	 * whole key, which is already a pivot tuple.
+	 */
+	if (isleaf)
+	{
+		IndexTuple	lastleft;
+
+		if (newitemonleft && newitemoff == firstright)
+		{
+			/* incoming tuple will become last on left page */
+			lastleft = newitem;
+		}
+		else
+		{
+			OffsetNumber lastleftoff = OffsetNumberPrev(firstright);
+
+			Assert(lastleftoff >= P_FIRSTDATAKEY(oopaque));
+			itemid = PageGetItemId(origpage, lastleftoff);
+			lastleft = (IndexTuple) PageGetItem(origpage, itemid);
+		}
+
+		item = _bt_truncate(rel, lastleft, item);
+		itemsz = IndexTupleSize(item);
+		itemsz = MAXALIGN(itemsz);
+	}
 	if (PageAddItem(leftpage, (Item) item, itemsz, leftoff,
 					false, false) == InvalidOffsetNumber)
 	{
@@ -1289,20 +1332,17 @@ _bt_split(Relation rel, Buffer buf, Buffer cbuf, OffsetNumber firstright,
 		if (newitemonleft)
 			XLogRegisterBufData(0, (char *) newitem, MAXALIGN(newitemsz));
 
-		/* Log left page */
-		if (!isleaf)
-		{
-			/*
-			 * We must also log the left page's high key, because the right
-			 * page's leftmost key is suppressed on non-leaf levels.  Show it
-			 * as belonging to the left page buffer, so that it is not stored
-			 * if XLogInsert decides it needs a full-page image of the left
-			 * page.
-			 */
-			itemid = PageGetItemId(origpage, P_HIKEY);
-			item = (IndexTuple) PageGetItem(origpage, itemid);
-			XLogRegisterBufData(0, (char *) item, MAXALIGN(IndexTupleSize(item)));
-		}
+		/*
+		 * Log the left page's high key.  It can't be reconstructed from the
+		 * right page: on non-leaf levels the right page's leftmost key is
+		 * suppressed, and on the leaf level the high key may have been
+		 * truncated.  Show it as belonging to the left page buffer, so that
+		 * it is not stored if XLogInsert decides it needs a full-page image
+		 * of the left page.
+		 */
+		itemid = PageGetItemId(origpage, P_HIKEY);
+		item = (IndexTuple) PageGetItem(origpage, itemid);
+		XLogRegisterBufData(0, (char *) item, MAXALIGN(IndexTupleSize(item)));
 
 		/*
 		 * Log the contents of the right page in the format understood by
@@ -1687,7 +1727,7 @@ _bt_insert_parent(Relation rel,
 
 		/* form an index tuple that points at the new right page */
 		new_item = CopyIndexTuple(ritem);
-		ItemPointerSet(&(new_item->t_tid), rbknum, P_HIKEY);
+		BTreeInnerTupleSetDownLink(new_item, rbknum);
 
 		/*
 		 * Find the parent buffer and get the parent page.
@@ -1952,7 +1992,7 @@ _bt_newroot(Relation rel, Buffer lbuf, Buffer rbuf)
 	left_item_sz = sizeof(IndexTupleData);
 	left_item = (IndexTuple) palloc(left_item_sz);
 	left_item->t_info = left_item_sz;
-	ItemPointerSet(&(left_item->t_tid), lbkno, P_HIKEY);
+	BTreeInnerTupleSetDownLink(left_item, lbkno);
 
 	/*
 	 * Create downlink item for right page.  The key for it is obtained from
@@ -1962,7 +2002,7 @@ _bt_newroot(Relation rel, Buffer lbuf, Buffer rbuf)
 	right_item_sz = ItemIdGetLength(itemid);
 	item = (IndexTuple) PageGetItem(lpage, itemid);
 	right_item = CopyIndexTuple(item);
-	ItemPointerSet(&(right_item->t_tid), rbkno, P_HIKEY);
+	BTreeInnerTupleSetDownLink(right_item, rbkno);
 
 	/* NO EREPORT(ERROR) from here till newroot op is logged */
 	START_CRIT_SECTION();
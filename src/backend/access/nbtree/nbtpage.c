@@ -783,19 +783,61 @@ _bt_page_recyclable(Page page)
  * for the last block in the index, whether or not it contained any items
  * to be removed. This allows us to scan right up to end of index to
  * ensure correct locking.
+ *
+ * Posting list tuples that lost only some of their heap TIDs are passed in
+ * updated[], along with their offsets in updateitemnos[]; each replaces the
+ * tuple at the same offset.  An offset must not appear in both arrays.
  */
 void
 _bt_delitems_vacuum(Relation rel, Buffer buf,
 					OffsetNumber *itemnos, int nitems,
+					OffsetNumber *updateitemnos,
+					IndexTuple *updated, int nupdated,
 					BlockNumber lastBlockVacuumed)
 {
 	Page		page = BufferGetPage(buf);
 	BTPageOpaque opaque;
+	char	   *updatedbuf = NULL;
+	Size		updatedbuflen = 0;
+	int			i;
+
+	/*
+	 * Gather the replacement tuples into a single chunk for the WAL record
+	 * now, since we cannot palloc inside the critical section.
+	 */
+	if (nupdated > 0 && RelationNeedsWAL(rel))
+	{
+		Size		offset = 0;
+
+		for (i = 0; i < nupdated; i++)
+			updatedbuflen += IndexTupleSize(updated[i]);
+		updatedbuf = palloc(updatedbuflen);
+		for (i = 0; i < nupdated; i++)
+		{
+			Size		itemsz = IndexTupleSize(updated[i]);
+
+			memcpy(updatedbuf + offset, updated[i], itemsz);
+			offset += itemsz;
+		}
+	}
 
 	/* No ereport(ERROR) until changes are logged */
 	START_CRIT_SECTION();
 
-	/* Fix the page */
+	/*
+	 * Fix the page.  Replace the updated posting list tuples first, in place,
+	 * so that the offsets of the deleted items are still valid afterwards.
+	 */
+	for (i = 0; i < nupdated; i++)
+	{
+		Size		itemsz = IndexTupleSize(updated[i]);
+
+		PageIndexTupleDelete(page, updateitemnos[i]);
+		if (PageAddItem(page, (Item) updated[i], itemsz, updateitemnos[i],
+						false, false) == InvalidOffsetNumber)
+			elog(PANIC, "failed to update partially dead item in index \"%s\"",
+				 RelationGetRelationName(rel));
+	}
 	if (nitems > 0)
 		PageIndexMultiDelete(page, itemnos, nitems);
 
@@ -824,6 +866,8 @@ _bt_delitems_vacuum(Relation rel, Buffer buf,
 		xl_btree_vacuum xlrec_vacuum;
 
 		xlrec_vacuum.lastBlockVacuumed = lastBlockVacuumed;
+		xlrec_vacuum.ndeleted = nitems;
+		xlrec_vacuum.nupdated = nupdated;
 
 		XLogBeginInsert();
 		XLogRegisterBuffer(0, buf, REGBUF_STANDARD);
@@ -832,10 +876,16 @@ _bt_delitems_vacuum(Relation rel, Buffer buf,
 		/*
 		 * The target-offsets array is not in the buffer, but pretend that it
 		 * is.  When XLogInsert stores the whole buffer, the offsets array
-		 * need not be stored too.
+		 * need not be stored too.  Likewise for the updated tuples.
 		 */
 		if (nitems > 0)
 			XLogRegisterBufData(0, (char *) itemnos, nitems * sizeof(OffsetNumber));
+		if (nupdated > 0)
+		{
+			XLogRegisterBufData(0, (char *) updateitemnos,
+								nupdated * sizeof(OffsetNumber));
+			XLogRegisterBufData(0, updatedbuf, updatedbuflen);
+		}
 
 		recptr = XLogInsert(RM_BTREE_ID, XLOG_BTREE_VACUUM);
 
@@ -843,6 +893,9 @@ _bt_delitems_vacuum(Relation rel, Buffer buf,
 	}
 
 	END_CRIT_SECTION();
+
+	if (updatedbuf)
+		pfree(updatedbuf);
 }
 
 /*
@@ -1254,8 +1307,8 @@ _bt_pagedel(Relation rel, Buffer buf)
 				/* we need an insertion scan key for the search, so build one */
 				itup_scankey = _bt_mkscankey(rel, targetkey);
 				/* find the leftmost leaf page containing this key */
-				stack = _bt_search(rel, rel->rd_rel->relnatts, itup_scankey,
-								   false, &lbuf, BT_READ);
+				stack = _bt_search(rel, BTreeTupleGetNAtts(targetkey, rel),
+								   itup_scankey, false, &lbuf, BT_READ);
 				/* don't need a pin on the page */
 				_bt_relbuf(rel, lbuf);
 
@@ -1422,7 +1475,7 @@ _bt_mark_page_halfdead(Relation rel, Buffer leafbuf, BTStack stack)
 
 	itemid = PageGetItemId(page, topoff);
 	itup = (IndexTuple) PageGetItem(page, itemid);
-	ItemPointerSet(&(itup->t_tid), rightsib, P_HIKEY);
+	BTreeInnerTupleSetDownLink(itup, rightsib);
 
 	nextoffset = OffsetNumberNext(topoff);
 	PageIndexTupleDelete(page, nextoffset);
@@ -29,6 +29,7 @@
 #include "storage/smgr.h"
 #include "tcop/tcopprot.h"
 #include "utils/memutils.h"
+#include "utils/selfuncs.h"
 
 
 /* Working state for btbuild and its callback */
@@ -73,17 +74,61 @@ static void btvacuumscan(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
 			 BTCycleId cycleid);
 static void btvacuumpage(BTVacState *vstate, BlockNumber blkno,
 			 BlockNumber orig_blkno);
+static IndexTuple btvacuumposting(BTVacState *vstate, IndexTuple posting,
+				int *nremaining);
 
 
 /*
- *	btbuild() -- build a new btree index.
+ * Btree handler function: return IndexAmRoutine with access method parameters
+ * and callbacks.
  */
 Datum
-btbuild(PG_FUNCTION_ARGS)
+bthandler(PG_FUNCTION_ARGS)
+{
+	IndexAmRoutine *amroutine = makeNode(IndexAmRoutine);
+
+	amroutine->amstrategies = BTMaxStrategyNumber;
+	amroutine->amsupport = BTNProcs;
+	amroutine->amcanorder = true;
+	amroutine->amcanorderbyop = false;
+	amroutine->amcanbackward = true;
+	amroutine->amcanunique = true;
+	amroutine->amcanmulticol = true;
+	amroutine->amoptionalkey = true;
+	amroutine->amcanskip = true;
+	amroutine->amcaninclude = true;
+	amroutine->amsearcharray = true;
+	amroutine->amsearchnulls = true;
+	amroutine->amstorage = false;
+	amroutine->amclusterable = true;
+	amroutine->ampredlocks = true;
+	amroutine->amkeytype = InvalidOid;
+
+	amroutine->ambuild = btbuild;
+	amroutine->ambuildempty = btbuildempty;
+	amroutine->aminsert = btinsert;
+	amroutine->ambulkdelete = btbulkdelete;
+	amroutine->amvacuumcleanup = btvacuumcleanup;
+	amroutine->amcanreturn = btcanreturn;
+	amroutine->amcostestimate = btcostestimate;
+	amroutine->amoptions = btoptions;
+	amroutine->ambeginscan = btbeginscan;
+	amroutine->amrescan = btrescan;
+	amroutine->amgettuple = btgettuple;
+	amroutine->amgetbitmap = btgetbitmap;
+	amroutine->amendscan = btendscan;
+	amroutine->ammarkpos = btmarkpos;
+	amroutine->amrestrpos = btrestrpos;
+
+	PG_RETURN_POINTER(amroutine);
+}
+
+/*
+ *	btbuild() -- build a new btree index.
+ */
+IndexBuildResult *
+btbuild(Relation heap, Relation index, IndexInfo *indexInfo)
 {
-	Relation	heap = (Relation) PG_GETARG_POINTER(0);
-	Relation	index = (Relation) PG_GETARG_POINTER(1);
-	IndexInfo  *indexInfo = (IndexInfo *) PG_GETARG_POINTER(2);
 	IndexBuildResult *result;
 	double		reltuples;
 	BTBuildState buildstate;
@@ -155,7 +200,7 @@ btbuild(PG_FUNCTION_ARGS)
 	result->heap_tuples = reltuples;
 	result->index_tuples = buildstate.indtuples;
 
-	PG_RETURN_POINTER(result);
+	return result;
 }
 
 /*
@@ -190,10 +235,9 @@ btbuildCallback(Relation index,
 /*
  *	btbuildempty() -- build an empty btree index in the initialization fork
  */
-Datum
-btbuildempty(PG_FUNCTION_ARGS)
+void
+btbuildempty(Relation index)
 {
-	Relation	index = (Relation) PG_GETARG_POINTER(0);
 	Page		metapage;
 
 	/* Construct metapage. */
@@ -214,8 +258,6 @@ btbuildempty(PG_FUNCTION_ARGS)
 	 * checkpoint may have moved the redo pointer past our xlog record.
 	 */
 	smgrimmedsync(index->rd_smgr, INIT_FORKNUM);
-
-	PG_RETURN_VOID();
 }
 
 /*
@@ -224,15 +266,10 @@ btbuildempty(PG_FUNCTION_ARGS)
  *		Descend the tree recursively, find the appropriate location for our
  *		new tuple, and put it there.
  */
-Datum
-btinsert(PG_FUNCTION_ARGS)
+bool
+btinsert(Relation rel, Datum *values, bool *isnull, ItemPointer ht_ctid,
+		 Relation heapRel, IndexUniqueCheck checkUnique)
 {
-	Relation	rel = (Relation) PG_GETARG_POINTER(0);
-	Datum	   *values = (Datum *) PG_GETARG_POINTER(1);
-	bool	   *isnull = (bool *) PG_GETARG_POINTER(2);
-	ItemPointer ht_ctid = (ItemPointer) PG_GETARG_POINTER(3);
-	Relation	heapRel = (Relation) PG_GETARG_POINTER(4);
-	IndexUniqueCheck checkUnique = (IndexUniqueCheck) PG_GETARG_INT32(5);
 	bool		result;
 	IndexTuple	itup;
 
@@ -244,17 +281,15 @@ btinsert(PG_FUNCTION_ARGS)
 
 	pfree(itup);
 
-	PG_RETURN_BOOL(result);
+	return result;
 }
 
 /*
  *	btgettuple() -- Get the next tuple in the scan.
  */
-Datum
-btgettuple(PG_FUNCTION_ARGS)
+bool
+btgettuple(IndexScanDesc scan, ScanDirection dir)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
-	ScanDirection dir = (ScanDirection) PG_GETARG_INT32(1);
 	BTScanOpaque so = (BTScanOpaque) scan->opaque;
 	bool		res;
 
@@ -270,12 +305,27 @@ btgettuple(PG_FUNCTION_ARGS)
 	{
 		/* punt if we have any unsatisfiable array keys */
 		if (so->numArrayKeys < 0)
-			PG_RETURN_BOOL(false);
+			return false;
 
 		_bt_start_array_keys(scan, dir);
 	}
 
-	/* This loop handles advancing to the next array elements, if any */
+	/*
+	 * Likewise, a skip scan starts with the first (or last) first-column
+	 * value in the index.
+	 */
+	if (so->skipScan && !BTScanPosIsValid(so->currPos))
+	{
+		if (!_bt_skip_advance(scan, dir, true))
+			return false;
+	}
+
+	/*
+	 * This loop handles advancing to the next array elements, if any, and
+	 * then to the next first-column value of a skip scan.  The array keys
+	 * are all on later columns, so they must cycle fastest to produce output
+	 * in index order.
+	 */
 	do
 	{
 		/*
@@ -303,8 +353,8 @@ btgettuple(PG_FUNCTION_ARGS)
 				 */
 				if (so->killedItems == NULL)
 					so->killedItems = (int *)
-						palloc(MaxIndexTuplesPerPage * sizeof(int));
-				if (so->numKilled < MaxIndexTuplesPerPage)
+						palloc(MaxTIDsPerBTreePage * sizeof(int));
+				if (so->numKilled < MaxTIDsPerBTreePage)
 					so->killedItems[so->numKilled++] = so->currPos.itemIndex;
 			}
 
@@ -318,19 +368,18 @@ btgettuple(PG_FUNCTION_ARGS)
 		if (res)
 			break;
 		/* ... otherwise see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, dir));
+	} while ((so->numArrayKeys && _bt_advance_array_keys(scan, dir)) ||
+			 (so->skipScan && _bt_skip_advance(scan, dir, false)));
 
-	PG_RETURN_BOOL(res);
+	return res;
 }
 
 /*
  * btgetbitmap() -- gets all matching tuples, and adds them to a bitmap
  */
-Datum
-btgetbitmap(PG_FUNCTION_ARGS)
+int64
+btgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
-	TIDBitmap  *tbm = (TIDBitmap *) PG_GETARG_POINTER(1);
 	BTScanOpaque so = (BTScanOpaque) scan->opaque;
 	int64		ntids = 0;
 	ItemPointer heapTid;
@@ -342,12 +391,22 @@ btgetbitmap(PG_FUNCTION_ARGS)
 	{
 		/* punt if we have any unsatisfiable array keys */
 		if (so->numArrayKeys < 0)
-			PG_RETURN_INT64(ntids);
+			return ntids;
 
 		_bt_start_array_keys(scan, ForwardScanDirection);
 	}
 
-	/* This loop handles advancing to the next array elements, if any */
+	/* If this is a skip scan, start with the first first-column value */
+	if (so->skipScan)
+	{
+		if (!_bt_skip_advance(scan, ForwardScanDirection, true))
+			return ntids;
+	}
+
+	/*
+	 * This loop handles advancing to the next array elements, if any, and to
+	 * the next first-column value of a skip scan.
+	 */
 	do
 	{
 		/* Fetch the first page & tuple */
@@ -377,21 +436,21 @@ btgetbitmap(PG_FUNCTION_ARGS)
 				ntids++;
 			}
 		}
-		/* Now see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, ForwardScanDirection));
+		/* Now see if we have more array keys or skip groups to deal with */
+	} while ((so->numArrayKeys &&
+			  _bt_advance_array_keys(scan, ForwardScanDirection)) ||
+			 (so->skipScan &&
+			  _bt_skip_advance(scan, ForwardScanDirection, false)));
 
-	PG_RETURN_INT64(ntids);
+	return ntids;
 }
 
 /*
  *	btbeginscan() -- start a scan on a btree index
  */
-Datum
-btbeginscan(PG_FUNCTION_ARGS)
+IndexScanDesc
+btbeginscan(Relation rel, int nkeys, int norderbys)
 {
-	Relation	rel = (Relation) PG_GETARG_POINTER(0);
-	int			nkeys = PG_GETARG_INT32(1);
-	int			norderbys = PG_GETARG_INT32(2);
 	IndexScanDesc scan;
 	BTScanOpaque so;
 
@@ -415,6 +474,10 @@ btbeginscan(PG_FUNCTION_ARGS)
 	so->arrayKeys = NULL;
 	so->arrayContext = NULL;
 
+	so->skipScan = false;		/* decided in btrescan */
+	so->skipKeyData = NULL;
+	so->skipContext = NULL;
+
 	so->killedItems = NULL;		/* until needed */
 	so->numKilled = 0;
 
@@ -429,19 +492,16 @@ btbeginscan(PG_FUNCTION_ARGS)
 
 	scan->opaque = so;
 
-	PG_RETURN_POINTER(scan);
+	return scan;
 }
 
 /*
  *	btrescan() -- rescan an index relation
  */
-Datum
-btrescan(PG_FUNCTION_ARGS)
+void
+btrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys, ScanKey orderbys,
+		 int norderbys)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
-	ScanKey		scankey = (ScanKey) PG_GETARG_POINTER(1);
-
-	/* remaining arguments are ignored */
 	BTScanOpaque so = (BTScanOpaque) scan->opaque;
 
 	/* we aren't holding any read locks, but gotta drop the pins */
@@ -493,16 +553,16 @@ btrescan(PG_FUNCTION_ARGS)
 	/* If any keys are SK_SEARCHARRAY type, set up array-key info */
 	_bt_preprocess_array_keys(scan);
 
-	PG_RETURN_VOID();
+	/* Set up for a skip scan, if the caller asked for one */
+	_bt_preprocess_skip_keys(scan);
 }
 
 /*
  *	btendscan() -- close down a scan
  */
-Datum
-btendscan(PG_FUNCTION_ARGS)
+void
+btendscan(IndexScanDesc scan)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
 	BTScanOpaque so = (BTScanOpaque) scan->opaque;
 
 	/* we aren't holding any read locks, but gotta drop the pins */
@@ -525,23 +585,25 @@ btendscan(PG_FUNCTION_ARGS)
 	/* so->arrayKeyData and so->arrayKeys are in arrayContext */
 	if (so->arrayContext != NULL)
 		MemoryContextDelete(so->arrayContext);
+	if (so->skipKeyData != NULL)
+		pfree(so->skipKeyData);
+	/* so->skipValue and so->markSkipValue are in skipContext */
+	if (so->skipContext != NULL)
+		MemoryContextDelete(so->skipContext);
 	if (so->killedItems != NULL)
 		pfree(so->killedItems);
 	if (so->currTuples != NULL)
 		pfree(so->currTuples);
 	/* so->markTuples should not be pfree'd, see btrescan */
 	pfree(so);
-
-	PG_RETURN_VOID();
 }
 
 /*
  *	btmarkpos() -- save current scan position
  */
-Datum
-btmarkpos(PG_FUNCTION_ARGS)
+void
+btmarkpos(IndexScanDesc scan)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
 	BTScanOpaque so = (BTScanOpaque) scan->opaque;
 
 	/* There may be an old mark with a pin (but no lock). */
@@ -565,22 +627,27 @@ btmarkpos(PG_FUNCTION_ARGS)
 	if (so->numArrayKeys)
 		_bt_mark_array_keys(scan);
 
-	PG_RETURN_VOID();
+	/* ... and the current first-column value of a skip scan */
+	if (so->skipScan)
+		_bt_mark_skip_key(scan);
 }
 
 /*
  *	btrestrpos() -- restore scan to last saved position
  */
-Datum
-btrestrpos(PG_FUNCTION_ARGS)
+void
+btrestrpos(IndexScanDesc scan)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
 	BTScanOpaque so = (BTScanOpaque) scan->opaque;
 
 	/* Restore the marked positions of any array keys */
 	if (so->numArrayKeys)
 		_bt_restore_array_keys(scan);
 
+	/* Restore the marked first-column value of a skip scan */
+	if (so->skipScan)
+		_bt_restore_skip_key(scan);
+
 	if (so->markItemIndex >= 0)
 	{
 		/*
@@ -642,8 +709,6 @@ btrestrpos(PG_FUNCTION_ARGS)
 		else
 			BTScanPosInvalidate(so->currPos);
 	}
-
-	PG_RETURN_VOID();
 }
 
 /*
@@ -653,13 +718,10 @@ btrestrpos(PG_FUNCTION_ARGS)
  *
  * Result: a palloc'd struct containing statistical info for VACUUM displays.
  */
-Datum
-btbulkdelete(PG_FUNCTION_ARGS)
+IndexBulkDeleteResult *
+btbulkdelete(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
+			 IndexBulkDeleteCallback callback, void *callback_state)
 {
-	IndexVacuumInfo *info = (IndexVacuumInfo *) PG_GETARG_POINTER(0);
-	IndexBulkDeleteResult *volatile stats = (IndexBulkDeleteResult *) PG_GETARG_POINTER(1);
-	IndexBulkDeleteCallback callback = (IndexBulkDeleteCallback) PG_GETARG_POINTER(2);
-	void	   *callback_state = (void *) PG_GETARG_POINTER(3);
 	Relation	rel = info->index;
 	BTCycleId	cycleid;
 
@@ -678,7 +740,7 @@ btbulkdelete(PG_FUNCTION_ARGS)
 	PG_END_ENSURE_ERROR_CLEANUP(_bt_end_vacuum_callback, PointerGetDatum(rel));
 	_bt_end_vacuum(rel);
 
-	PG_RETURN_POINTER(stats);
+	return stats;
 }
 
 /*
@@ -686,15 +748,12 @@ btbulkdelete(PG_FUNCTION_ARGS)
  *
  * Result: a palloc'd struct containing statistical info for VACUUM displays.
  */
-Datum
-btvacuumcleanup(PG_FUNCTION_ARGS)
+IndexBulkDeleteResult *
+btvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
 {
-	IndexVacuumInfo *info = (IndexVacuumInfo *) PG_GETARG_POINTER(0);
-	IndexBulkDeleteResult *stats = (IndexBulkDeleteResult *) PG_GETARG_POINTER(1);
-
 	/* No-op in ANALYZE ONLY mode */
 	if (info->analyze_only)
-		PG_RETURN_POINTER(stats);
+		return stats;
 
 	/*
 	 * If btbulkdelete was called, we need not do anything, just return the
@@ -726,7 +785,7 @@ btvacuumcleanup(PG_FUNCTION_ARGS)
 			stats->num_index_tuples = info->num_heap_tuples;
 	}
 
-	PG_RETURN_POINTER(stats);
+	return stats;
 }
 
 /*
@@ -847,7 +906,8 @@ btvacuumscan(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
 								 RBM_NORMAL, info->strategy);
 		LockBufferForCleanup(buf);
 		_bt_checkpage(rel, buf);
-		_bt_delitems_vacuum(rel, buf, NULL, 0, vstate.lastBlockVacuumed);
+		_bt_delitems_vacuum(rel, buf, NULL, 0, NULL, NULL, 0,
+							vstate.lastBlockVacuumed);
 		_bt_relbuf(rel, buf);
 	}
 
@@ -945,6 +1005,12 @@ restart:
 	{
 		OffsetNumber deletable[MaxOffsetNumber];
 		int			ndeletable;
+		OffsetNumber updatable[MaxOffsetNumber];
+		IndexTuple	updated[MaxOffsetNumber];
+		int			nupdatable;
+		int			nhtidsdead;
+		int			nhtidslive;
+		int			i;
 		OffsetNumber offnum,
 					minoff,
 					maxoff;
@@ -981,55 +1047,84 @@ restart:
 
 		/*
 		 * Scan over all items to see which ones need deleted according to the
-		 * callback function.
+		 * callback function.  Posting list tuples are deleted only if all of
+		 * their heap TIDs are dead, and otherwise shrunk to the live ones.
+		 * Count the surviving heap TIDs as we go.
 		 */
 		ndeletable = 0;
+		nupdatable = 0;
+		nhtidsdead = 0;
+		nhtidslive = 0;
 		minoff = P_FIRSTDATAKEY(opaque);
 		maxoff = PageGetMaxOffsetNumber(page);
-		if (callback)
+		for (offnum = minoff;
+			 offnum <= maxoff;
+			 offnum = OffsetNumberNext(offnum))
 		{
-			for (offnum = minoff;
-				 offnum <= maxoff;
-				 offnum = OffsetNumberNext(offnum))
+			IndexTuple	itup;
+			ItemPointer htup;
+
+			itup = (IndexTuple) PageGetItem(page,
+											PageGetItemId(page, offnum));
+
+			if (!callback)
 			{
-				IndexTuple	itup;
-				ItemPointer htup;
+				nhtidslive += BTreeTupleGetNHeapTIDs(itup);
+				continue;
+			}
 
-				itup = (IndexTuple) PageGetItem(page,
-												PageGetItemId(page, offnum));
-				htup = &(itup->t_tid);
+			if (BTreeTupleIsPosting(itup))
+			{
+				int			nremaining;
 
-				/*
-				 * During Hot Standby we currently assume that
-				 * XLOG_BTREE_VACUUM records do not produce conflicts. That is
-				 * only true as long as the callback function depends only
-				 * upon whether the index tuple refers to heap tuples removed
-				 * in the initial heap scan. When vacuum starts it derives a
-				 * value of OldestXmin. Backends taking later snapshots could
-				 * have a RecentGlobalXmin with a later xid than the vacuum's
-				 * OldestXmin, so it is possible that row versions deleted
-				 * after OldestXmin could be marked as killed by other
-				 * backends. The callback function *could* look at the index
-				 * tuple state in isolation and decide to delete the index
-				 * tuple, though currently it does not. If it ever did, we
-				 * would need to reconsider whether XLOG_BTREE_VACUUM records
-				 * should cause conflicts. If they did cause conflicts they
-				 * would be fairly harsh conflicts, since we haven't yet
-				 * worked out a way to pass a useful value for
-				 * latestRemovedXid on the XLOG_BTREE_VACUUM records. This
-				 * applies to *any* type of index that marks index tuples as
-				 * killed.
-				 */
-				if (callback(htup, callback_state))
+				updated[nupdatable] = btvacuumposting(vstate, itup,
+													  &nremaining);
+				nhtidsdead += BTreeTupleGetNPosting(itup) - nremaining;
+				nhtidslive += nremaining;
+				if (nremaining == 0)
 					deletable[ndeletable++] = offnum;
+				else if (updated[nupdatable] != NULL)
+					updatable[nupdatable++] = offnum;
+				continue;
+			}
+
+			htup = &(itup->t_tid);
+
+			/*
+			 * During Hot Standby we currently assume that
+			 * XLOG_BTREE_VACUUM records do not produce conflicts. That is
+			 * only true as long as the callback function depends only
+			 * upon whether the index tuple refers to heap tuples removed
+			 * in the initial heap scan. When vacuum starts it derives a
+			 * value of OldestXmin. Backends taking later snapshots could
+			 * have a RecentGlobalXmin with a later xid than the vacuum's
+			 * OldestXmin, so it is possible that row versions deleted
+			 * after OldestXmin could be marked as killed by other
+			 * backends. The callback function *could* look at the index
+			 * tuple state in isolation and decide to delete the index
+			 * tuple, though currently it does not. If it ever did, we
+			 * would need to reconsider whether XLOG_BTREE_VACUUM records
+			 * should cause conflicts. If they did cause conflicts they
+			 * would be fairly harsh conflicts, since we haven't yet
+			 * worked out a way to pass a useful value for
+			 * latestRemovedXid on the XLOG_BTREE_VACUUM records. This
+			 * applies to *any* type of index that marks index tuples as
+			 * killed.
+			 */
+			if (callback(htup, callback_state))
+			{
+				deletable[ndeletable++] = offnum;
+				nhtidsdead++;
 			}
+			else
+				nhtidslive++;
 		}
 
 		/*
 		 * Apply any needed deletes.  We issue just one _bt_delitems_vacuum()
 		 * call per page, so as to minimize WAL traffic.
 		 */
-		if (ndeletable > 0)
+		if (ndeletable > 0 || nupdatable > 0)
 		{
 			/*
 			 * Notice that the issued XLOG_BTREE_VACUUM WAL record includes an
@@ -1043,7 +1138,10 @@ restart:
 			 * that.
 			 */
 			_bt_delitems_vacuum(rel, buf, deletable, ndeletable,
+								updatable, updated, nupdatable,
 								vstate->lastBlockVacuumed);
+			for (i = 0; i < nupdatable; i++)
+				pfree(updated[i]);
 
 			/*
 			 * Remember highest leaf page number we've issued a
@@ -1052,7 +1150,7 @@ restart:
 			if (blkno > vstate->lastBlockVacuumed)
 				vstate->lastBlockVacuumed = blkno;
 
-			stats->tuples_removed += ndeletable;
+			stats->tuples_removed += nhtidsdead;
 			/* must recompute maxoff */
 			maxoff = PageGetMaxOffsetNumber(page);
 		}
@@ -1084,7 +1182,7 @@ restart:
 		if (minoff > maxoff)
 			delete_now = (blkno == orig_blkno);
 		else
-			stats->num_index_tuples += maxoff - minoff + 1;
+			stats->num_index_tuples += nhtidslive;
 	}
 
 	if (delete_now)
@@ -1122,13 +1220,64 @@ restart:
 	}
 }
 
+/*
+ * btvacuumposting --- determine which heap TIDs of a posting list tuple
+ * are to be removed
+ *
+ * Returns a new posting list tuple holding only the TIDs the callback wants
+ * to keep, or NULL if either all or none of them are to be removed.  The
+ * number of TIDs kept is returned in *nremaining.
+ */
+static IndexTuple
+btvacuumposting(BTVacState *vstate, IndexTuple posting, int *nremaining)
+{
+	int			nhtids = BTreeTupleGetNPosting(posting);
+	ItemPointer htids = BTreeTupleGetPosting(posting);
+	ItemPointer live = NULL;
+	int			nlive = 0;
+	int			i;
+
+	for (i = 0; i < nhtids; i++)
+	{
+		if (vstate->callback(htids + i, vstate->callback_state))
+		{
+			/* First dead TID seen: remember the live ones before it */
+			if (live == NULL)
+			{
+				live = palloc(sizeof(ItemPointerData) * nhtids);
+				memcpy(live, htids, sizeof(ItemPointerData) * i);
+				nlive = i;
+			}
+		}
+		else if (live != NULL)
+			live[nlive++] = htids[i];
+	}
+
+	if (live == NULL)
+	{
+		*nremaining = nhtids;
+		return NULL;
+	}
+
+	*nremaining = nlive;
+	if (nlive == 0)
+	{
+		pfree(live);
+		return NULL;
+	}
+
+	posting = _bt_form_posting(posting, live, nlive);
+	pfree(live);
+	return posting;
+}
+
 /*
  *	btcanreturn() -- Check whether btree indexes support index-only scans.
  *
  * btrees always do, so this is trivial.
  */
-Datum
-btcanreturn(PG_FUNCTION_ARGS)
+bool
+btcanreturn(Relation index, int attno)
 {
-	PG_RETURN_BOOL(true);
+	return true;
 }
@@ -29,6 +29,12 @@ static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir,
 			 OffsetNumber offnum);
 static void _bt_saveitem(BTScanOpaque so, int itemIndex,
 			 OffsetNumber offnum, IndexTuple itup);
+static int _bt_setuppostingitems(BTScanOpaque so, int itemIndex,
+					  OffsetNumber offnum, ItemPointer heapTid,
+					  IndexTuple itup);
+static void _bt_savepostingitem(BTScanOpaque so, int itemIndex,
+					OffsetNumber offnum, ItemPointer heapTid,
+					int tupleOffset);
 static bool _bt_steppage(IndexScanDesc scan, ScanDirection dir);
 static Buffer _bt_walk_left(Relation rel, Buffer buf);
 static bool _bt_endpoint(IndexScanDesc scan, ScanDirection dir);
@@ -402,6 +408,9 @@ _bt_binsrch(Relation rel,
  *		"equality" does not necessarily mean that the item should be
  *		returned to the caller as a matching key!
  *
+ * Likewise, columns that suffix truncation removed from a pivot tuple are
+ * assumed to be "minus infinity".
+ *
  * CRUCIAL NOTE: on a non-leaf page, the first data key is assumed to be
  * "minus infinity": this routine will always claim it is less than the
  * scankey.  The actual key value stored (if any, which there probably isn't)
@@ -420,6 +429,7 @@ _bt_compare(Relation rel,
 	TupleDesc	itupdesc = RelationGetDescr(rel);
 	BTPageOpaque opaque = (BTPageOpaque) PageGetSpecialPointer(page);
 	IndexTuple	itup;
+	int			ntupatts;
 	int			i;
 
 	/*
@@ -430,6 +440,7 @@ _bt_compare(Relation rel,
 		return 1;
 
 	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
+	ntupatts = BTreeTupleGetNAtts(itup, rel);
 
 	/*
 	 * The scan key is set up with the attribute number associated with each
@@ -449,6 +460,14 @@ _bt_compare(Relation rel,
 		bool		isNull;
 		int32		result;
 
+		/*
+		 * A pivot tuple whose trailing columns were truncated away treats
+		 * them as "minus infinity", so any scankey that is equal on all the
+		 * columns it does have is greater than it (see _bt_truncate).
+		 */
+		if (i > ntupatts)
+			return 1;
+
 		datum = index_getattr(itup, scankey->sk_attno, itupdesc, &isNull);
 
 		/* see comments about NULLs handling in btbuild */
@@ -1215,8 +1234,30 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 			if (itup != NULL)
 			{
 				/* tuple passes all scan key conditions, so remember it */
-				_bt_saveitem(so, itemIndex, offnum, itup);
-				itemIndex++;
+				if (!BTreeTupleIsPosting(itup))
+				{
+					_bt_saveitem(so, itemIndex, offnum, itup);
+					itemIndex++;
+				}
+				else
+				{
+					int			tupleOffset;
+					int			i;
+
+					/* remember each of its heap TIDs, in TID order */
+					tupleOffset =
+						_bt_setuppostingitems(so, itemIndex, offnum,
+											  BTreeTupleGetPostingN(itup, 0),
+											  itup);
+					itemIndex++;
+					for (i = 1; i < BTreeTupleGetNPosting(itup); i++)
+					{
+						_bt_savepostingitem(so, itemIndex, offnum,
+											BTreeTupleGetPostingN(itup, i),
+											tupleOffset);
+						itemIndex++;
+					}
+				}
 			}
 			if (!continuescan)
 			{
@@ -1228,7 +1269,7 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 			offnum = OffsetNumberNext(offnum);
 		}
 
-		Assert(itemIndex <= MaxIndexTuplesPerPage);
+		Assert(itemIndex <= MaxTIDsPerBTreePage);
 		so->currPos.firstItem = 0;
 		so->currPos.lastItem = itemIndex - 1;
 		so->currPos.itemIndex = 0;
@@ -1236,7 +1277,7 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 	else
 	{
 		/* load items[] in descending order */
-		itemIndex = MaxIndexTuplesPerPage;
+		itemIndex = MaxTIDsPerBTreePage;
 
 		offnum = Min(offnum, maxoff);
 
@@ -1246,8 +1287,34 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 			if (itup != NULL)
 			{
 				/* tuple passes all scan key conditions, so remember it */
-				itemIndex--;
-				_bt_saveitem(so, itemIndex, offnum, itup);
+				if (!BTreeTupleIsPosting(itup))
+				{
+					itemIndex--;
+					_bt_saveitem(so, itemIndex, offnum, itup);
+				}
+				else
+				{
+					int			tupleOffset;
+					int			i;
+
+					/*
+					 * remember each of its heap TIDs; they end up in
+					 * descending TID order, which is the order a backward
+					 * scan returns them in
+					 */
+					itemIndex--;
+					tupleOffset =
+						_bt_setuppostingitems(so, itemIndex, offnum,
+											  BTreeTupleGetPostingN(itup, 0),
+											  itup);
+					for (i = 1; i < BTreeTupleGetNPosting(itup); i++)
+					{
+						itemIndex--;
+						_bt_savepostingitem(so, itemIndex, offnum,
+											BTreeTupleGetPostingN(itup, i),
+											tupleOffset);
+					}
+				}
 			}
 			if (!continuescan)
 			{
@@ -1261,8 +1328,8 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 
 		Assert(itemIndex >= 0);
 		so->currPos.firstItem = itemIndex;
-		so->currPos.lastItem = MaxIndexTuplesPerPage - 1;
-		so->currPos.itemIndex = MaxIndexTuplesPerPage - 1;
+		so->currPos.lastItem = MaxTIDsPerBTreePage - 1;
+		so->currPos.itemIndex = MaxTIDsPerBTreePage - 1;
 	}
 
 	return (so->currPos.firstItem <= so->currPos.lastItem);
@@ -1287,6 +1354,57 @@ _bt_saveitem(BTScanOpaque so, int itemIndex,
 	}
 }
 
+/*
+ * Set up state to save the heap TIDs of a posting list tuple: save its first
+ * heap TID into so->currPos.items[itemIndex], and, for an index-only scan,
+ * save the tuple's key part once for all the TIDs.  Returns the offset of
+ * the saved key in the tuple workspace, for _bt_savepostingitem.
+ */
+static int
+_bt_setuppostingitems(BTScanOpaque so, int itemIndex, OffsetNumber offnum,
+					  ItemPointer heapTid, IndexTuple itup)
+{
+	BTScanPosItem *currItem = &so->currPos.items[itemIndex];
+
+	currItem->heapTid = *heapTid;
+	currItem->indexOffset = offnum;
+	if (so->currTuples)
+	{
+		/* save the key with the posting list cut off */
+		Size		itupsz = BTreeTupleGetPostingOffset(itup);
+		IndexTuple	base;
+
+		currItem->tupleOffset = so->currPos.nextTupleOffset;
+		base = (IndexTuple) (so->currTuples + so->currPos.nextTupleOffset);
+		memcpy(base, itup, itupsz);
+		base->t_info &= ~(INDEX_SIZE_MASK | INDEX_ALT_TID_MASK);
+		base->t_info |= itupsz;
+		base->t_tid = *heapTid;
+		so->currPos.nextTupleOffset += MAXALIGN(itupsz);
+
+		return currItem->tupleOffset;
+	}
+
+	return 0;
+}
+
+/*
+ * Save a further heap TID of a posting list tuple into
+ * so->currPos.items[itemIndex], sharing the key saved by
+ * _bt_setuppostingitems.
+ */
+static void
+_bt_savepostingitem(BTScanOpaque so, int itemIndex, OffsetNumber offnum,
+					ItemPointer heapTid, int tupleOffset)
+{
+	BTScanPosItem *currItem = &so->currPos.items[itemIndex];
+
+	currItem->heapTid = *heapTid;
+	currItem->indexOffset = offnum;
+	if (so->currTuples)
+		currItem->tupleOffset = tupleOffset;
+}
+
 /*
  *	_bt_steppage() -- Step to next page containing valid data for scan
  *
@@ -1759,3 +1877,143 @@ _bt_endpoint(IndexScanDesc scan, ScanDirection dir)
 
 	return true;
 }
+
+/*
+ *	_bt_skip_advance() -- Move a skip scan to its next first-column value
+ *
+ * A skip scan runs one subscan per distinct value of the first index column
+ * (see _bt_preprocess_skip_keys).  If first is true, we find the first value
+ * in the index (the last one, for a backward scan); otherwise we find the
+ * next value after the current one in the given direction.  Either way, we
+ * descend the tree rather than walking the leaf level, so that all the index
+ * entries sharing the current value are skipped over at once.
+ *
+ * Returns TRUE and sets up the prefix key for the new value, or FALSE if
+ * there are no more values.  We hold no pins or locks on return.
+ */
+bool
+_bt_skip_advance(IndexScanDesc scan, ScanDirection dir, bool first)
+{
+	Relation	rel = scan->indexRelation;
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Buffer		buf;
+	Page		page;
+	BTPageOpaque opaque;
+	OffsetNumber offnum;
+	IndexTuple	itup;
+	Datum		value;
+	bool		isnull;
+
+	Assert(so->skipScan);
+
+	if (first)
+	{
+		buf = _bt_get_endpoint(rel, 0, ScanDirectionIsBackward(dir));
+		if (!BufferIsValid(buf))
+		{
+			/* Empty index; lock the whole relation, as in _bt_endpoint */
+			PredicateLockRelation(rel, scan->xs_snapshot);
+			return false;
+		}
+		page = BufferGetPage(buf);
+		opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+		if (ScanDirectionIsForward(dir))
+			offnum = P_FIRSTDATAKEY(opaque);
+		else
+			offnum = PageGetMaxOffsetNumber(page);
+	}
+	else
+	{
+		ScanKeyData skey;
+		BTStack		stack;
+		int			flags;
+
+		/*
+		 * If the other keys can never be satisfied, no first-column value
+		 * will change that (there are no other keys on the first column).
+		 * With array keys, the next set of elements might be satisfiable,
+		 * but we only get here after cycling through all of them.
+		 */
+		if (!so->qual_ok && so->numArrayKeys == 0)
+			return false;
+
+		/*
+		 * Build an insertion scankey for the current value, and descend to
+		 * the first item > value (forward scan) or the first item >= value
+		 * (backward scan), in index order.
+		 */
+		flags = rel->rd_indoption[0] << SK_BT_INDOPTION_SHIFT;
+		if (so->skipIsNull)
+			flags |= SK_ISNULL;
+		ScanKeyEntryInitializeWithInfo(&skey,
+									   flags,
+									   1,
+									   InvalidStrategy,
+									   InvalidOid,
+									   rel->rd_indcollation[0],
+									   index_getprocinfo(rel, 1, BTORDER_PROC),
+									   so->skipValue);
+
+		stack = _bt_search(rel, 1, &skey, ScanDirectionIsForward(dir),
+						   &buf, BT_READ);
+		_bt_freestack(stack);
+		if (!BufferIsValid(buf))
+		{
+			PredicateLockRelation(rel, scan->xs_snapshot);
+			return false;
+		}
+
+		offnum = _bt_binsrch(rel, buf, 1, &skey, ScanDirectionIsForward(dir));
+
+		/* for a backward scan, we want the last item < value instead */
+		if (ScanDirectionIsBackward(dir))
+			offnum = OffsetNumberPrev(offnum);
+	}
+
+	/*
+	 * offnum might be off either end of the page; if so, step to the next
+	 * page in the scan direction, skipping over any empty or dead ones.
+	 */
+	for (;;)
+	{
+		page = BufferGetPage(buf);
+		opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+
+		PredicateLockPage(rel, BufferGetBlockNumber(buf), scan->xs_snapshot);
+
+		if (!P_IGNORE(opaque) &&
+			offnum >= P_FIRSTDATAKEY(opaque) &&
+			offnum <= PageGetMaxOffsetNumber(page))
+			break;
+
+		if (ScanDirectionIsForward(dir))
+		{
+			if (P_RIGHTMOST(opaque))
+			{
+				_bt_relbuf(rel, buf);
+				return false;
+			}
+			buf = _bt_relandgetbuf(rel, buf, opaque->btpo_next, BT_READ);
+			page = BufferGetPage(buf);
+			opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+			offnum = P_FIRSTDATAKEY(opaque);
+		}
+		else
+		{
+			buf = _bt_walk_left(rel, buf);
+			if (!BufferIsValid(buf))
+				return false;
+			page = BufferGetPage(buf);
+			offnum = PageGetMaxOffsetNumber(page);
+		}
+	}
+
+	/* Found it; remember the value and set up the prefix key */
+	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
+	value = index_getattr(itup, 1, RelationGetDescr(rel), &isnull);
+	_bt_set_skip_key(scan, value, isnull);
+
+	_bt_relbuf(rel, buf);
+
+	return true;
+}
@@ -136,6 +136,10 @@ static void _bt_sortaddtup(Page page, Size itemsize,
 static void _bt_buildadd(BTWriteState *wstate, BTPageState *state,
 			 IndexTuple itup);
 static void _bt_uppershutdown(BTWriteState *wstate, BTPageState *state);
+static void _bt_sort_dedup(BTWriteState *wstate, BTSpool *btspool,
+			   BTPageState **statep);
+static void _bt_sort_dedup_finish_pending(BTWriteState *wstate,
+							  BTPageState *state, BTDedupState dstate);
 static void _bt_load(BTWriteState *wstate,
 		 BTSpool *btspool, BTSpool *btspool2);
 
@@ -529,6 +533,31 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 		oitup = (IndexTuple) PageGetItem(opage, ii);
 		_bt_sortaddtup(npage, ItemIdGetLength(ii), oitup, P_FIRSTKEY);
 
+		/*
+		 * On the leaf level, the high key only has to separate the item
+		 * before 'last' from 'last' itself, so replace 'last' by a copy
+		 * truncated by _bt_truncate first.  That also cuts off any posting
+		 * list, which a high key never carries.  The truncated copy becomes
+		 * the downlink for the new page as well, via btps_minkey below.
+		 */
+		if (state->btps_level == 0)
+		{
+			IndexTuple	lastleft;
+			IndexTuple	hikey;
+
+			lastleft = (IndexTuple) PageGetItem(opage,
+							PageGetItemId(opage, OffsetNumberPrev(last_off)));
+			hikey = _bt_truncate(wstate->index, lastleft, oitup);
+
+			PageIndexTupleDelete(opage, last_off);
+			if (PageAddItem(opage, (Item) hikey, IndexTupleSize(hikey),
+							last_off, false, false) == InvalidOffsetNumber)
+				elog(ERROR, "failed to add high key to the index page");
+			pfree(hikey);
+			ii = PageGetItemId(opage, last_off);
+			oitup = (IndexTuple) PageGetItem(opage, ii);
+		}
+
 		/*
 		 * Move 'last' into the high key position on opage
 		 */
@@ -546,7 +575,7 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 			state->btps_next = _bt_pagestate(wstate, state->btps_level + 1);
 
 		Assert(state->btps_minkey != NULL);
-		ItemPointerSet(&(state->btps_minkey->t_tid), oblkno, P_HIKEY);
+		BTreeInnerTupleSetDownLink(state->btps_minkey, oblkno);
 		_bt_buildadd(wstate, state->btps_next, state->btps_minkey);
 		pfree(state->btps_minkey);
 
@@ -590,7 +619,7 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 	if (last_off == P_HIKEY)
 	{
 		Assert(state->btps_minkey == NULL);
-		state->btps_minkey = CopyIndexTuple(itup);
+		state->btps_minkey = _bt_pivotcopy(itup);
 	}
 
 	/*
@@ -643,7 +672,7 @@ _bt_uppershutdown(BTWriteState *wstate, BTPageState *state)
 		else
 		{
 			Assert(s->btps_minkey != NULL);
-			ItemPointerSet(&(s->btps_minkey->t_tid), blkno, P_HIKEY);
+			BTreeInnerTupleSetDownLink(s->btps_minkey, blkno);
 			_bt_buildadd(wstate, s->btps_next, s->btps_minkey);
 			pfree(s->btps_minkey);
 			s->btps_minkey = NULL;
@@ -669,6 +698,85 @@ _bt_uppershutdown(BTWriteState *wstate, BTPageState *state)
 	_bt_blwritepage(wstate, metapage, BTREE_METAPAGE);
 }
 
+/*
+ * Read tuples in correct sort order from tuplesort, merge runs of duplicates
+ * into posting list tuples, and load the results into btree leaves.
+ *
+ * The first leaf page is created here if there are any tuples at all, and
+ * returned in *statep.
+ */
+static void
+_bt_sort_dedup(BTWriteState *wstate, BTSpool *btspool, BTPageState **statep)
+{
+	BTPageState *state = NULL;
+	BTDedupState dstate = NULL;
+	IndexTuple	itup;
+	bool		should_free;
+
+	while ((itup = tuplesort_getindextuple(btspool->sortstate,
+										   true, &should_free)) != NULL)
+	{
+		/* When we see first tuple, create first index page */
+		if (state == NULL)
+		{
+			state = _bt_pagestate(wstate, 0);
+			dstate = _bt_dedup_begin(BTMaxPostingSize(state->btps_page));
+			/* the base tuple must survive the next getindextuple call */
+			_bt_dedup_start_pending(dstate, CopyIndexTuple(itup),
+									InvalidOffsetNumber);
+		}
+		else if (!_bt_dedup_save_htid(dstate, itup))
+		{
+			/* itup starts a new group; emit the pending one */
+			_bt_sort_dedup_finish_pending(wstate, state, dstate);
+			pfree(dstate->base);
+			_bt_dedup_start_pending(dstate, CopyIndexTuple(itup),
+									InvalidOffsetNumber);
+		}
+
+		if (should_free)
+			pfree(itup);
+	}
+
+	if (state != NULL)
+	{
+		_bt_sort_dedup_finish_pending(wstate, state, dstate);
+		pfree(dstate->base);
+		_bt_dedup_end(dstate);
+	}
+
+	*statep = state;
+}
+
+/*
+ * Add the pending posting list of an index build to the leaf level.
+ *
+ * The tuples are sorted by heap TID within equal keys, so the accumulated
+ * TIDs are already in order.
+ */
+static void
+_bt_sort_dedup_finish_pending(BTWriteState *wstate, BTPageState *state,
+							  BTDedupState dstate)
+{
+	Assert(dstate->nitems > 0);
+
+	if (dstate->nitems == 1)
+		_bt_buildadd(wstate, state, dstate->base);
+	else
+	{
+		IndexTuple	postingtuple;
+
+		postingtuple = _bt_form_posting(dstate->base, dstate->htids,
+										dstate->nhtids);
+		_bt_buildadd(wstate, state, postingtuple);
+		pfree(postingtuple);
+	}
+
+	dstate->nhtids = 0;
+	dstate->nitems = 0;
+	dstate->phystupsize = 0;
+}
+
 /*
  * Read tuples in correct sort order from tuplesort, and load them into
  * btree leaves.
@@ -685,7 +793,7 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 				load1;
 	TupleDesc	tupdes = RelationGetDescr(wstate->index);
 	int			i,
-				keysz = RelationGetNumberOfAttributes(wstate->index);
+				keysz = IndexRelationGetNumberOfKeyAttributes(wstate->index);
 	ScanKey		indexScanKey = NULL;
 	SortSupport sortKeys;
 
@@ -791,6 +899,11 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 		}
 		pfree(sortKeys);
 	}
+	else if (_bt_dedup_enabled(wstate->index))
+	{
+		/* merge is unnecessary, but deduplicate on the fly */
+		_bt_sort_dedup(wstate, btspool, &state);
+	}
 	else
 	{
 		/* merge is unnecessary */
@@ -22,6 +22,7 @@
 #include "access/relscan.h"
 #include "miscadmin.h"
 #include "utils/array.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
@@ -56,7 +57,10 @@ static bool _bt_check_rowcompare(ScanKey skey,
  *		Build an insertion scan key that contains comparison data from itup
  *		as well as comparator routines appropriate to the key datatypes.
  *
- *		The result is intended for use with _bt_compare().
+ *		The result is intended for use with _bt_compare().  If itup is a
+ *		truncated pivot tuple, the key only covers the columns it has; use
+ *		BTreeTupleGetNAtts() to find out how many that is.  Non-key INCLUDE
+ *		columns are never part of the key.
  */
 ScanKey
 _bt_mkscankey(Relation rel, IndexTuple itup)
@@ -68,7 +72,8 @@ _bt_mkscankey(Relation rel, IndexTuple itup)
 	int			i;
 
 	itupdesc = RelationGetDescr(rel);
-	natts = RelationGetNumberOfAttributes(rel);
+	natts = Min(BTreeTupleGetNAtts(itup, rel),
+				IndexRelationGetNumberOfKeyAttributes(rel));
 	indoption = rel->rd_indoption;
 
 	skey = (ScanKey) palloc(natts * sizeof(ScanKeyData));
@@ -119,7 +124,7 @@ _bt_mkscankey_nodata(Relation rel)
 	int16	   *indoption;
 	int			i;
 
-	natts = RelationGetNumberOfAttributes(rel);
+	natts = IndexRelationGetNumberOfKeyAttributes(rel);
 	indoption = rel->rd_indoption;
 
 	skey = (ScanKey) palloc(natts * sizeof(ScanKeyData));
@@ -173,6 +178,101 @@ _bt_freestack(BTStack stack)
 	}
 }
 
+/*
+ * _bt_keep_natts
+ *		How many leading columns does a pivot tuple need in order to
+ *		separate lastleft from firstright?
+ *
+ * Columns are compared with the opclass's comparison procedure, not
+ * binary, since it is the opclass's notion of equality that the pivot has
+ * to respect.  Returns one more than the number of key columns if the two
+ * tuples are equal on all of them.  INCLUDE columns are never looked at.
+ */
+static int
+_bt_keep_natts(Relation rel, IndexTuple lastleft, IndexTuple firstright)
+{
+	TupleDesc	itupdesc = RelationGetDescr(rel);
+	int			natts = IndexRelationGetNumberOfKeyAttributes(rel);
+	int			keepnatts;
+
+	for (keepnatts = 1; keepnatts <= natts; keepnatts++)
+	{
+		FmgrInfo   *procinfo;
+		Datum		datum1,
+					datum2;
+		bool		isNull1,
+					isNull2;
+
+		datum1 = index_getattr(lastleft, keepnatts, itupdesc, &isNull1);
+		datum2 = index_getattr(firstright, keepnatts, itupdesc, &isNull2);
+
+		if (isNull1 != isNull2)
+			break;
+		if (isNull1)
+			continue;
+
+		procinfo = index_getprocinfo(rel, keepnatts, BTORDER_PROC);
+		if (DatumGetInt32(FunctionCall2Coll(procinfo,
+											rel->rd_indcollation[keepnatts - 1],
+											datum1,
+											datum2)) != 0)
+			break;
+	}
+
+	return keepnatts;
+}
+
+/*
+ * _bt_truncate
+ *		Build the high key for the left half of a leaf page split.
+ *
+ * lastleft is the last tuple that goes on the left page, and firstright is
+ * the first tuple on the right page.  The new high key must be greater than
+ * lastleft and no greater than firstright; a copy of firstright that keeps
+ * only the leading columns needed to tell the two apart is enough, because
+ * _bt_compare() treats the missing columns as "minus infinity".  The result
+ * is also what gets copied into the parent as the downlink of the right
+ * page, so shorter pivots mean more downlinks per internal page.
+ *
+ * Non-key INCLUDE columns are always truncated away, since only leaf
+ * tuples need them.  If firstright is a posting list tuple the posting list
+ * is never kept.
+ * The result is palloc'd in the caller's memory context.
+ */
+IndexTuple
+_bt_truncate(Relation rel, IndexTuple lastleft, IndexTuple firstright)
+{
+	TupleDesc	itupdesc = RelationGetDescr(rel);
+	int			natts = RelationGetNumberOfAttributes(rel);
+	int			keepnatts;
+	TupleDesc	truncdesc;
+	Datum		values[INDEX_MAX_KEYS];
+	bool		isnull[INDEX_MAX_KEYS];
+	IndexTuple	pivot;
+
+	keepnatts = Min(_bt_keep_natts(rel, lastleft, firstright),
+					IndexRelationGetNumberOfKeyAttributes(rel));
+
+	/* Nothing to truncate; use the whole key of firstright */
+	if (keepnatts >= natts)
+		return _bt_pivotcopy(firstright);
+
+	/*
+	 * Form a new tuple from the leading columns of firstright, using a copy
+	 * of the index's tuple descriptor that ends after the last kept column.
+	 */
+	index_deform_tuple(firstright, itupdesc, values, isnull);
+	truncdesc = CreateTupleDescCopy(itupdesc);
+	truncdesc->natts = keepnatts;
+	pivot = index_form_tuple(truncdesc, values, isnull);
+	FreeTupleDesc(truncdesc);
+
+	BTreeTupleSetNAtts(pivot, keepnatts);
+	Assert(IndexTupleSize(pivot) <= IndexTupleSize(firstright));
+
+	return pivot;
+}
+
 
 /*
  *	_bt_preprocess_array_keys() -- Preprocess SK_SEARCHARRAY scan keys
@@ -654,6 +754,165 @@ _bt_restore_array_keys(IndexScanDesc scan)
 	}
 }
 
+/*
+ * _bt_preprocess_skip_keys() -- Decide whether to run a skip scan
+ *
+ * The executor sets scan->xs_want_skip when the planner chose a skip scan,
+ * meaning there are quals on later index columns but none on the first.
+ * Rather than scanning the whole index, we then run one subscan per distinct
+ * value of the first column, with an extra "attr1 = value" key in front of
+ * the regular ones so that the later columns' keys become required and
+ * usable for positioning.  _bt_skip_advance finds each successive value.
+ *
+ * This is called from btrescan, after _bt_preprocess_array_keys.  We don't
+ * take the request if the scan turns out to have a key on the first column
+ * after all, or if we can't find an equality operator for it; the scan then
+ * simply proceeds as a full-index scan.  Columns stored as cstring (name_ops)
+ * are excluded as well, since the stored value isn't of the operator's type.
+ */
+void
+_bt_preprocess_skip_keys(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	Oid			eqop;
+
+	so->skipScan = false;
+
+	if (!scan->xs_want_skip ||
+		scan->numberOfKeys < 1 ||
+		scan->keyData[0].sk_attno == 1 ||
+		IndexRelationGetNumberOfKeyAttributes(rel) < 2 ||
+		RelationGetDescr(rel)->attrs[0]->attlen == -2)
+		return;
+
+	/*
+	 * Set up the workspace, unless a previous rescan already did.  The key
+	 * arrays live as long as the scan; the context only holds copies of
+	 * first-column values, and is reset on each rescan.
+	 */
+	if (so->skipKeyData == NULL)
+	{
+		eqop = get_opfamily_member(rel->rd_opfamily[0],
+								   rel->rd_opcintype[0],
+								   rel->rd_opcintype[0],
+								   BTEqualStrategyNumber);
+		if (!OidIsValid(eqop))
+			return;
+		fmgr_info(get_opcode(eqop), &so->skipEqProc);
+
+		so->skipKeyData = (ScanKey)
+			palloc((scan->numberOfKeys + 1) * sizeof(ScanKeyData));
+		/* the preprocessed keys can now include the prefix key, too */
+		pfree(so->keyData);
+		so->keyData = (ScanKey)
+			palloc((scan->numberOfKeys + 1) * sizeof(ScanKeyData));
+		so->skipContext = AllocSetContextCreate(CurrentMemoryContext,
+												"BTree Skip Context",
+												ALLOCSET_SMALL_MINSIZE,
+												ALLOCSET_SMALL_INITSIZE,
+												ALLOCSET_SMALL_MAXSIZE);
+	}
+	else
+		MemoryContextReset(so->skipContext);
+
+	so->skipValue = so->markSkipValue = (Datum) 0;
+	so->skipIsNull = so->markSkipIsNull = true;
+	so->skipScan = true;
+}
+
+/*
+ * _bt_set_skip_key() -- Set the skip scan's current first-column value
+ *
+ * The value is copied into the scan's workspace, and the prefix key in
+ * so->skipKeyData[0] is rebuilt to match it.  The caller must call (or let
+ * _bt_first call) _bt_preprocess_keys before the new key takes effect.
+ */
+void
+_bt_set_skip_key(IndexScanDesc scan, Datum value, bool isnull)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	Form_pg_attribute att = RelationGetDescr(rel)->attrs[0];
+	ScanKey		skey = &so->skipKeyData[0];
+	MemoryContext oldContext;
+
+	Assert(so->skipScan);
+
+	/* Release the previous value, if we copied one */
+	if (!so->skipIsNull && !att->attbyval)
+		pfree(DatumGetPointer(so->skipValue));
+
+	if (isnull)
+	{
+		so->skipValue = (Datum) 0;
+		so->skipIsNull = true;
+		ScanKeyEntryInitialize(skey,
+							   SK_ISNULL | SK_SEARCHNULL,
+							   1,
+							   InvalidStrategy,
+							   InvalidOid,
+							   InvalidOid,
+							   InvalidOid,
+							   (Datum) 0);
+	}
+	else
+	{
+		oldContext = MemoryContextSwitchTo(so->skipContext);
+		so->skipValue = datumCopy(value, att->attbyval, att->attlen);
+		so->skipIsNull = false;
+		ScanKeyEntryInitializeWithInfo(skey,
+									   0,
+									   1,
+									   BTEqualStrategyNumber,
+									   rel->rd_opcintype[0],
+									   rel->rd_indcollation[0],
+									   &so->skipEqProc,
+									   so->skipValue);
+		MemoryContextSwitchTo(oldContext);
+	}
+}
+
+/*
+ * _bt_mark_skip_key() -- Handle the skip prefix during btmarkpos
+ */
+void
+_bt_mark_skip_key(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Form_pg_attribute att = RelationGetDescr(scan->indexRelation)->attrs[0];
+
+	if (!so->markSkipIsNull && !att->attbyval)
+		pfree(DatumGetPointer(so->markSkipValue));
+
+	if (so->skipIsNull)
+		so->markSkipValue = (Datum) 0;
+	else
+	{
+		MemoryContext oldContext = MemoryContextSwitchTo(so->skipContext);
+
+		so->markSkipValue = datumCopy(so->skipValue,
+									  att->attbyval, att->attlen);
+		MemoryContextSwitchTo(oldContext);
+	}
+	so->markSkipIsNull = so->skipIsNull;
+}
+
+/*
+ * _bt_restore_skip_key() -- Handle the skip prefix during btrestrpos
+ *
+ * As in _bt_restore_array_keys, the keys must be preprocessed again since
+ * the prefix key may have changed.
+ */
+void
+_bt_restore_skip_key(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+
+	_bt_set_skip_key(scan, so->markSkipValue, so->markSkipIsNull);
+	_bt_preprocess_keys(scan);
+}
+
 
 /*
  *	_bt_preprocess_keys() -- Preprocess scan keys
@@ -661,7 +920,8 @@ _bt_restore_array_keys(IndexScanDesc scan)
  * The given search-type keys (in scan->keyData[] or so->arrayKeyData[])
  * are copied to so->keyData[] with possible transformation.
  * scan->numberOfKeys is the number of input keys, so->numberOfKeys gets
- * the number of output keys (possibly less, never greater).
+ * the number of output keys (possibly less, never greater).  A skip scan
+ * adds one more input key of its own; see _bt_preprocess_skip_keys.
  *
  * The output keys are marked with additional sk_flag bits beyond the
  * system-standard bits supplied by the caller.  The DESC and NULLS_FIRST
@@ -771,6 +1031,18 @@ _bt_preprocess_keys(IndexScanDesc scan)
 	else
 		inkeys = scan->keyData;
 
+	/*
+	 * In a skip scan, put the current first-column prefix key in front of the
+	 * input keys.  We work on a copy, so the input keys aren't modified.
+	 */
+	if (so->skipScan)
+	{
+		memcpy(&so->skipKeyData[1], inkeys,
+			   numberOfKeys * sizeof(ScanKeyData));
+		inkeys = so->skipKeyData;
+		numberOfKeys++;
+	}
+
 	outkeys = so->keyData;
 	cur = &inkeys[0];
 	/* we check that input keys are correctly ordered */
@@ -1717,6 +1989,48 @@ _bt_check_rowcompare(ScanKey skey, IndexTuple tuple, TupleDesc tupdesc,
 	return result;
 }
 
+/*
+ * Does posting list tuple "posting" contain heap TID "htid"?
+ */
+static bool
+_bt_posting_contains(IndexTuple posting, ItemPointer htid)
+{
+	int			i;
+
+	for (i = 0; i < BTreeTupleGetNPosting(posting); i++)
+	{
+		if (ItemPointerEquals(BTreeTupleGetPostingN(posting, i), htid))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Are all the heap TIDs of posting list tuple "posting" among the first
+ * numKilled entries of so->killedItems?
+ */
+static bool
+_bt_posting_all_killed(BTScanOpaque so, IndexTuple posting, int numKilled)
+{
+	int			i,
+				j;
+
+	for (i = 0; i < BTreeTupleGetNPosting(posting); i++)
+	{
+		ItemPointer htid = BTreeTupleGetPostingN(posting, i);
+
+		for (j = 0; j < numKilled; j++)
+		{
+			if (ItemPointerEquals(&so->currPos.items[so->killedItems[j]].heapTid,
+								  htid))
+				break;
+		}
+		if (j >= numKilled)
+			return false;
+	}
+	return true;
+}
+
 /*
  * _bt_killitems - set LP_DEAD state for items an indexscan caller has
  * told us were killed
@@ -1821,7 +2135,24 @@ _bt_killitems(IndexScanDesc scan)
 			ItemId		iid = PageGetItemId(page, offnum);
 			IndexTuple	ituple = (IndexTuple) PageGetItem(page, iid);
 
-			if (ItemPointerEquals(&ituple->t_tid, &kitem->heapTid))
+			if (BTreeTupleIsPosting(ituple))
+			{
+				if (_bt_posting_contains(ituple, &kitem->heapTid))
+				{
+					/*
+					 * found the item; but a posting list tuple can only be
+					 * marked dead once all of its heap TIDs are known dead
+					 */
+					if (!ItemIdIsDead(iid) &&
+						_bt_posting_all_killed(so, ituple, numKilled))
+					{
+						ItemIdMarkDead(iid);
+						killedsomething = true;
+					}
+					break;		/* out of inner search loop */
+				}
+			}
+			else if (ItemPointerEquals(&ituple->t_tid, &kitem->heapTid))
 			{
 				/* found the item */
 				ItemIdMarkDead(iid);
@@ -2058,15 +2389,31 @@ BTreeShmemInit(void)
 		Assert(found);
 }
 
-Datum
-btoptions(PG_FUNCTION_ARGS)
+bytea *
+btoptions(Datum reloptions, bool validate)
 {
-	Datum		reloptions = PG_GETARG_DATUM(0);
-	bool		validate = PG_GETARG_BOOL(1);
-	bytea	   *result;
-
-	result = default_reloptions(reloptions, validate, RELOPT_KIND_BTREE);
-	if (result)
-		PG_RETURN_BYTEA_P(result);
-	PG_RETURN_NULL();
+	relopt_value *options;
+	BTOptions  *rdopts;
+	int			numoptions;
+	static const relopt_parse_elt tab[] = {
+		{"fillfactor", RELOPT_TYPE_INT, offsetof(BTOptions, fillfactor)},
+		{"deduplicate_items", RELOPT_TYPE_BOOL,
+		offsetof(BTOptions, deduplicate_items)}
+	};
+
+	options = parseRelOptions(reloptions, validate, RELOPT_KIND_BTREE,
+							  &numoptions);
+
+	/* if none set, we're done */
+	if (numoptions == 0)
+		return NULL;
+
+	rdopts = allocateReloptStruct(sizeof(BTOptions), options, numoptions);
+
+	fillRelOptions((void *) rdopts, sizeof(BTOptions), options, numoptions,
+				   validate, tab, lengthof(tab));
+
+	pfree(options);
+
+	return (bytea *) rdopts;
 }
@@ -0,0 +1,75 @@
+/*-------------------------------------------------------------------------
+ *
+ * bloomdesc.c
+ *	  rmgr descriptor routines for bloom indexes
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/rmgrdesc/bloomdesc.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/bloom_xlog.h"
+
+static void
+out_update_meta(StringInfo buf, XLogReaderState *record, uint8 block_id)
+{
+	xl_bloom_update_meta *xlmeta;
+
+	xlmeta = (xl_bloom_update_meta *)
+		XLogRecGetBlockData(record, block_id, NULL);
+	if (xlmeta)
+		appendStringInfo(buf, "meta nStart %u nEnd %u nPages %u",
+						 xlmeta->nStart, xlmeta->nEnd, xlmeta->nPages);
+}
+
+void
+bloom_desc(StringInfo buf, XLogReaderState *record)
+{
+	char	   *rec = XLogRecGetData(record);
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+
+	info &= XLOG_BLOOM_OPMASK;
+	if (info == XLOG_BLOOM_INSERT)
+	{
+		if (XLogRecHasBlockRef(record, 1))
+			out_update_meta(buf, record, 1);
+	}
+	else if (info == XLOG_BLOOM_UPDATE_META)
+		out_update_meta(buf, record, 0);
+	else if (info == XLOG_BLOOM_VACUUM_PAGE)
+	{
+		xl_bloom_vacuum_page *xlrec = (xl_bloom_vacuum_page *) rec;
+
+		appendStringInfo(buf, "ndeleted %u", xlrec->ndeleted);
+	}
+}
+
+const char *
+bloom_identify(uint8 info)
+{
+	const char *id = NULL;
+
+	switch (info & ~XLR_INFO_MASK)
+	{
+		case XLOG_BLOOM_INSERT:
+			id = "INSERT";
+			break;
+		case XLOG_BLOOM_INSERT | XLOG_BLOOM_INIT_PAGE:
+			id = "INSERT+INIT";
+			break;
+		case XLOG_BLOOM_UPDATE_META:
+			id = "UPDATE_META";
+			break;
+		case XLOG_BLOOM_VACUUM_PAGE:
+			id = "VACUUM_PAGE";
+			break;
+	}
+
+	return id;
+}
@@ -15,7 +15,7 @@
 
 #include "postgres.h"
 
-#include "access/spgist.h"
+#include "access/spgist_private.h"
 #include "access/stratnum.h"
 #include "catalog/pg_type.h"
 #include "utils/builtins.h"
@@ -248,12 +248,84 @@ spg_kd_inner_consistent(PG_FUNCTION_ARGS)
 	}
 
 	/* We must descend into the children identified by which */
-	out->nodeNumbers = (int *) palloc(sizeof(int) * 2);
 	out->nNodes = 0;
-	for (i = 1; i <= 2; i++)
+
+	/* Fast-path for no matching children */
+	if (!which)
+		PG_RETURN_VOID();
+
+	out->nodeNumbers = (int *) palloc(sizeof(int) * 2);
+
+	/*
+	 * When ordering by distance, we track the bounding box of each subtree
+	 * as its traversal value, and use it to compute the distances of the
+	 * children.  The root has no bounds at all.
+	 */
+	if (in->norderbys > 0)
 	{
-		if (which & (1 << i))
-			out->nodeNumbers[out->nNodes++] = i - 1;
+		BOX			infArea;
+		BOX		   *area;
+
+		out->distances = (double **) palloc(sizeof(double *) * in->nNodes);
+		out->traversalValues = (void **) palloc(sizeof(void *) * in->nNodes);
+
+		if (in->traversalValue)
+			area = (BOX *) in->traversalValue;
+		else
+		{
+			double		inf = get_float8_infinity();
+
+			infArea.high.x = inf;
+			infArea.high.y = inf;
+			infArea.low.x = -inf;
+			infArea.low.y = -inf;
+			area = &infArea;
+		}
+
+		for (i = 1; i <= 2; i++)
+		{
+			if (which & (1 << i))
+			{
+				MemoryContext oldCtx;
+				BOX		   *childArea;
+
+				/* Child 1 holds the lower coordinates, child 2 the higher */
+				oldCtx = MemoryContextSwitchTo(in->traversalMemoryContext);
+				childArea = (BOX *) palloc(sizeof(BOX));
+				*childArea = *area;
+				MemoryContextSwitchTo(oldCtx);
+
+				if ((in->level % 2) != 0)
+				{
+					if (i == 1)
+						childArea->high.x = coord;
+					else
+						childArea->low.x = coord;
+				}
+				else
+				{
+					if (i == 1)
+						childArea->high.y = coord;
+					else
+						childArea->low.y = coord;
+				}
+
+				out->nodeNumbers[out->nNodes] = i - 1;
+				out->traversalValues[out->nNodes] = childArea;
+				out->distances[out->nNodes] =
+					spg_key_orderbys_distances(BoxPGetDatum(childArea), false,
+											   in->orderbys, in->norderbys);
+				out->nNodes++;
+			}
+		}
+	}
+	else
+	{
+		for (i = 1; i <= 2; i++)
+		{
+			if (which & (1 << i))
+				out->nodeNumbers[out->nNodes++] = i - 1;
+		}
 	}
 
 	/* Set up level increments, too */
@@ -15,37 +15,119 @@
 
 #include "postgres.h"
 
+#include <math.h>
+
 #include "access/relscan.h"
 #include "access/spgist_private.h"
+#include "catalog/pg_type.h"
 #include "miscadmin.h"
 #include "storage/bufmgr.h"
 #include "utils/datum.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 
 
 typedef void (*storeRes_func) (SpGistScanOpaque so, ItemPointer heapPtr,
-								 Datum leafValue, bool isnull, bool recheck);
+								 Datum leafValue, bool isnull, bool recheck,
+								 bool recheckDistances, double *distances);
 
-typedef struct ScanStackEntry
+/*
+ * Pairing heap comparison function for the SpGistSearchItem queue of an
+ * ordered scan.  Items in the nulls tree have no distances, and come after
+ * all the non-null ones.
+ */
+static int
+pairingheap_SpGistSearchItem_cmp(const pairingheap_node *a,
+								 const pairingheap_node *b, void *arg)
 {
-	Datum		reconstructedValue;		/* value reconstructed from parent */
-	int			level;			/* level of items on this page */
-	ItemPointerData ptr;		/* block and offset to scan from */
-} ScanStackEntry;
+	const SpGistSearchItem *sa = (const SpGistSearchItem *) a;
+	const SpGistSearchItem *sb = (const SpGistSearchItem *) b;
+	SpGistScanOpaque so = (SpGistScanOpaque) arg;
+	int			i;
 
+	if (sa->isNull)
+	{
+		if (!sb->isNull)
+			return -1;
+	}
+	else if (sb->isNull)
+	{
+		return 1;
+	}
+	else
+	{
+		/* Order according to distance comparison */
+		for (i = 0; i < so->numberOfOrderBys; i++)
+		{
+			if (isnan(sa->distances[i]) && isnan(sb->distances[i]))
+				continue;		/* NaN == NaN */
+			if (isnan(sa->distances[i]))
+				return -1;		/* NaN > number */
+			if (isnan(sb->distances[i]))
+				return 1;		/* number < NaN */
+			if (sa->distances[i] != sb->distances[i])
+				return (sa->distances[i] < sb->distances[i]) ? 1 : -1;
+		}
+	}
 
-/* Free a ScanStackEntry */
+	/* Heap items go before inner pages, to ensure a depth-first search */
+	if (sa->isLeaf && !sb->isLeaf)
+		return 1;
+	if (!sa->isLeaf && sb->isLeaf)
+		return -1;
+
+	return 0;
+}
+
+/* Free a SpGistSearchItem */
 static void
-freeScanStackEntry(SpGistScanOpaque so, ScanStackEntry *stackEntry)
+spgFreeSearchItem(SpGistScanOpaque so, SpGistSearchItem *item)
 {
 	if (!so->state.attType.attbyval &&
-		DatumGetPointer(stackEntry->reconstructedValue) != NULL)
-		pfree(DatumGetPointer(stackEntry->reconstructedValue));
-	pfree(stackEntry);
+		DatumGetPointer(item->value) != NULL)
+		pfree(DatumGetPointer(item->value));
+
+	if (item->traversalValue)
+		pfree(item->traversalValue);
+
+	pfree(item);
 }
 
-/* Free the entire stack */
+/* Add a SpGistSearchItem to the set of items still to be visited */
+static void
+spgAddSearchItemToQueue(SpGistScanOpaque so, SpGistSearchItem *item)
+{
+	if (so->numberOfOrderBys > 0)
+		pairingheap_add(so->scanQueue, &item->phNode);
+	else
+		so->scanStack = lcons(item, so->scanStack);
+}
+
+/* Pull the next item to visit, or NULL if there is none left */
+static SpGistSearchItem *
+spgGetNextQueueItem(SpGistScanOpaque so)
+{
+	SpGistSearchItem *item;
+
+	if (so->numberOfOrderBys > 0)
+	{
+		if (pairingheap_is_empty(so->scanQueue))
+			return NULL;
+		return (SpGistSearchItem *) pairingheap_remove_first(so->scanQueue);
+	}
+
+	if (so->scanStack == NIL)
+		return NULL;
+	item = (SpGistSearchItem *) linitial(so->scanStack);
+	so->scanStack = list_delete_first(so->scanStack);
+	return item;
+}
+
+/*
+ * Free all the items still to be visited.  Both containers are checked, since
+ * a rescan can switch between ordered and unordered mode.
+ */
 static void
 freeScanStack(SpGistScanOpaque so)
 {
@@ -53,60 +135,96 @@ freeScanStack(SpGistScanOpaque so)
 
 	foreach(lc, so->scanStack)
 	{
-		freeScanStackEntry(so, (ScanStackEntry *) lfirst(lc));
+		spgFreeSearchItem(so, (SpGistSearchItem *) lfirst(lc));
 	}
 	list_free(so->scanStack);
 	so->scanStack = NIL;
+
+	if (so->scanQueue)
+	{
+		while (!pairingheap_is_empty(so->scanQueue))
+			spgFreeSearchItem(so, (SpGistSearchItem *)
+							  pairingheap_remove_first(so->scanQueue));
+	}
+}
+
+/* Free the tuples collected by storeGettuple */
+static void
+spgFreeReturnedTuples(SpGistScanOpaque so)
+{
+	int			i;
+
+	for (i = 0; i < so->nPtrs; i++)
+	{
+		/* Must pfree IndexTuples to avoid memory leak */
+		if (so->want_itup)
+			pfree(so->indexTups[i]);
+		if (so->distances[i])
+			pfree(so->distances[i]);
+	}
+	so->iPtr = so->nPtrs = 0;
+}
+
+/* Add a work item to scan the root of the nulls or non-nulls tree */
+static void
+spgAddStartItem(SpGistScanOpaque so, bool isnull)
+{
+	SpGistSearchItem *startEntry;
+
+	/* palloc0 sets the distances of the root to zero */
+	startEntry = (SpGistSearchItem *)
+		palloc0(SizeOfSpGistSearchItem(so->numberOfOrderBys));
+	ItemPointerSet(&startEntry->ptr,
+				   isnull ? SPGIST_NULL_BLKNO : SPGIST_ROOT_BLKNO,
+				   FirstOffsetNumber);
+	startEntry->isLeaf = false;
+	startEntry->isNull = isnull;
+	startEntry->level = 0;
+	startEntry->value = (Datum) 0;
+	startEntry->traversalValue = NULL;
+
+	spgAddSearchItemToQueue(so, startEntry);
 }
 
 /*
- * Initialize scanStack to search the root page, resetting
+ * Initialize the queue to search the root page, resetting
  * any previously active scan
  */
 static void
 resetSpGistScanOpaque(SpGistScanOpaque so)
 {
-	ScanStackEntry *startEntry;
-
 	freeScanStack(so);
 
-	if (so->searchNulls)
-	{
-		/* Stack a work item to scan the null index entries */
-		startEntry = (ScanStackEntry *) palloc0(sizeof(ScanStackEntry));
-		ItemPointerSet(&startEntry->ptr, SPGIST_NULL_BLKNO, FirstOffsetNumber);
-		so->scanStack = lappend(so->scanStack, startEntry);
-	}
+	/* All traversal values are gone now, so we can reset their context */
+	MemoryContextReset(so->traversalCxt);
 
+	/*
+	 * Stack the work item for the non-null entries first, so that a plain
+	 * scan pulls the nulls first; an ordered scan returns the nulls last
+	 * regardless.
+	 */
 	if (so->searchNonNulls)
-	{
-		/* Stack a work item to scan the non-null index entries */
-		startEntry = (ScanStackEntry *) palloc0(sizeof(ScanStackEntry));
-		ItemPointerSet(&startEntry->ptr, SPGIST_ROOT_BLKNO, FirstOffsetNumber);
-		so->scanStack = lappend(so->scanStack, startEntry);
-	}
+		spgAddStartItem(so, false);
 
-	if (so->want_itup)
-	{
-		/* Must pfree IndexTuples to avoid memory leak */
-		int			i;
+	if (so->searchNulls)
+		spgAddStartItem(so, true);
 
-		for (i = 0; i < so->nPtrs; i++)
-			pfree(so->indexTups[i]);
-	}
-	so->iPtr = so->nPtrs = 0;
+	spgFreeReturnedTuples(so);
 }
 
 /*
  * Prepare scan keys in SpGistScanOpaque from caller-given scan keys
  *
- * Sets searchNulls, searchNonNulls, numberOfKeys, keyData fields of *so.
+ * Sets searchNulls, searchNonNulls, numberOfKeys, keyData fields of *so,
+ * and the fields describing the ordering operators.
  *
  * The point here is to eliminate null-related considerations from what the
  * opclass consistent functions need to deal with.  We assume all SPGiST-
  * indexable operators are strict, so any null RHS value makes the scan
  * condition unsatisfiable.  We also pull out any IS NULL/IS NOT NULL
  * conditions; their effect is reflected into searchNulls/searchNonNulls.
+ * Likewise, an ordering operator with a null RHS value makes every distance
+ * null, so the scan is then done unordered.
  */
 static void
 spgPrepareScanKeys(IndexScanDesc scan)
@@ -118,6 +236,26 @@ spgPrepareScanKeys(IndexScanDesc scan)
 	int			nkeys;
 	int			i;
 
+	so->numberOfOrderBys = scan->numberOfOrderBys;
+	so->orderByData = scan->orderByData;
+	for (i = 0; i < scan->numberOfOrderBys; i++)
+	{
+		ScanKey		skey = &scan->orderByData[i];
+
+		if (skey->sk_flags & SK_ISNULL)
+		{
+			so->numberOfOrderBys = 0;
+			break;
+		}
+
+		/*
+		 * Look up the datatype returned by the ordering operator.  The
+		 * opclass computes distances as float8, which we know how to convert
+		 * to float8 or float4 only.
+		 */
+		so->orderByTypes[i] = get_func_rettype(skey->sk_func.fn_oid);
+	}
+
 	if (scan->numberOfKeys <= 0)
 	{
 		/* If no quals, whole-index scan is required */
@@ -173,17 +311,13 @@ spgPrepareScanKeys(IndexScanDesc scan)
 	}
 }
 
-Datum
-spgbeginscan(PG_FUNCTION_ARGS)
+IndexScanDesc
+spgbeginscan(Relation rel, int keysz, int norderbys)
 {
-	Relation	rel = (Relation) PG_GETARG_POINTER(0);
-	int			keysz = PG_GETARG_INT32(1);
-
-	/* ScanKey			scankey = (ScanKey) PG_GETARG_POINTER(2); */
 	IndexScanDesc scan;
 	SpGistScanOpaque so;
 
-	scan = RelationGetIndexScan(rel, keysz, 0);
+	scan = RelationGetIndexScan(rel, keysz, norderbys);
 
 	so = (SpGistScanOpaque) palloc0(sizeof(SpGistScanOpaqueData));
 	if (keysz > 0)
@@ -196,21 +330,40 @@ spgbeginscan(PG_FUNCTION_ARGS)
 										ALLOCSET_DEFAULT_MINSIZE,
 										ALLOCSET_DEFAULT_INITSIZE,
 										ALLOCSET_DEFAULT_MAXSIZE);
+	so->traversalCxt = AllocSetContextCreate(CurrentMemoryContext,
+											 "SP-GiST traversal-value context",
+											 ALLOCSET_DEFAULT_MINSIZE,
+											 ALLOCSET_DEFAULT_INITSIZE,
+											 ALLOCSET_DEFAULT_MAXSIZE);
 
 	/* Set up indexTupDesc and xs_itupdesc in case it's an index-only scan */
 	so->indexTupDesc = scan->xs_itupdesc = RelationGetDescr(rel);
 
+	/* Set up the workspace of ordered scans */
+	if (scan->numberOfOrderBys > 0)
+	{
+		so->orderByTypes = (Oid *) palloc0(sizeof(Oid) * scan->numberOfOrderBys);
+		so->scanQueue = pairingheap_allocate(pairingheap_SpGistSearchItem_cmp,
+											 so);
+
+		scan->xs_orderbyvals = (Datum *)
+			palloc0(sizeof(Datum) * scan->numberOfOrderBys);
+		scan->xs_orderbynulls = (bool *)
+			palloc(sizeof(bool) * scan->numberOfOrderBys);
+		memset(scan->xs_orderbynulls, true,
+			   sizeof(bool) * scan->numberOfOrderBys);
+	}
+
 	scan->opaque = so;
 
-	PG_RETURN_POINTER(scan);
+	return scan;
 }
 
-Datum
-spgrescan(PG_FUNCTION_ARGS)
+void
+spgrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys, ScanKey orderbys,
+		  int norderbys)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
 	SpGistScanOpaque so = (SpGistScanOpaque) scan->opaque;
-	ScanKey		scankey = (ScanKey) PG_GETARG_POINTER(1);
 
 	/* copy scankeys into local storage */
 	if (scankey && scan->numberOfKeys > 0)
@@ -219,95 +372,218 @@ spgrescan(PG_FUNCTION_ARGS)
 				scan->numberOfKeys * sizeof(ScanKeyData));
 	}
 
+	/* copy order-by keys, too */
+	if (orderbys && scan->numberOfOrderBys > 0)
+	{
+		memmove(scan->orderByData, orderbys,
+				scan->numberOfOrderBys * sizeof(ScanKeyData));
+	}
+
 	/* preprocess scankeys, set up the representation in *so */
 	spgPrepareScanKeys(scan);
 
-	/* set up starting stack entries */
+	/* set up starting queue entries */
 	resetSpGistScanOpaque(so);
-
-	PG_RETURN_VOID();
 }
 
-Datum
-spgendscan(PG_FUNCTION_ARGS)
+void
+spgendscan(IndexScanDesc scan)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
 	SpGistScanOpaque so = (SpGistScanOpaque) scan->opaque;
 
 	MemoryContextDelete(so->tempCxt);
-
-	PG_RETURN_VOID();
+	MemoryContextDelete(so->traversalCxt);
 }
 
-Datum
-spgmarkpos(PG_FUNCTION_ARGS)
+void
+spgmarkpos(IndexScanDesc scan)
 {
 	elog(ERROR, "SPGiST does not support mark/restore");
-	PG_RETURN_VOID();
 }
 
-Datum
-spgrestrpos(PG_FUNCTION_ARGS)
+void
+spgrestrpos(IndexScanDesc scan)
 {
 	elog(ERROR, "SPGiST does not support mark/restore");
-	PG_RETURN_VOID();
 }
 
 /*
- * Test whether a leaf tuple satisfies all the scan keys
+ * Make a queue item for a heap tuple whose leaf tuple passed the scan keys
+ * of an ordered scan.  Everything passed in may live in the temp context,
+ * so copy it out.
+ */
+static SpGistSearchItem *
+spgNewHeapItem(SpGistScanOpaque so, int level, ItemPointer heapPtr,
+			   Datum leafValue, bool recheck, bool recheckDistances,
+			   bool isnull, double *distances)
+{
+	SpGistSearchItem *item;
+
+	item = (SpGistSearchItem *)
+		palloc(SizeOfSpGistSearchItem(so->numberOfOrderBys));
+
+	item->level = level;
+	item->ptr = *heapPtr;
+	/* The value is only needed if we're to return the tuple itself */
+	if (so->want_itup && !isnull)
+		item->value = datumCopy(leafValue,
+								so->state.attType.attbyval,
+								so->state.attType.attlen);
+	else
+		item->value = (Datum) 0;
+	item->traversalValue = NULL;
+	item->isLeaf = true;
+	item->recheck = recheck;
+	item->recheckDistances = recheckDistances;
+	item->isNull = isnull;
+
+	/* Null items have no distances; they are sorted last anyway */
+	if (!isnull)
+		memcpy(item->distances, distances,
+			   sizeof(double) * so->numberOfOrderBys);
+
+	return item;
+}
+
+/*
+ * Test whether a leaf tuple satisfies all the scan keys, and deal with it if
+ * so: in an unordered scan it's reported to the storeRes subroutine right
+ * away, in an ordered scan it's added to the queue, to be reported when its
+ * turn comes.
  *
- * *leafValue is set to the reconstructed datum, if provided
- * *recheck is set true if any of the operators are lossy
+ * Returns true if a tuple was reported.
  */
 static bool
-spgLeafTest(Relation index, SpGistScanOpaque so,
+spgLeafTest(Relation index, SpGistScanOpaque so, SpGistSearchItem *item,
 			SpGistLeafTuple leafTuple, bool isnull,
-			int level, Datum reconstructedValue,
-			Datum *leafValue, bool *recheck)
+			storeRes_func storeRes)
 {
 	bool		result;
-	Datum		leafDatum;
-	spgLeafConsistentIn in;
-	spgLeafConsistentOut out;
-	FmgrInfo   *procinfo;
-	MemoryContext oldCtx;
+	Datum		leafValue;
+	bool		recheck;
+	bool		recheckDistances;
+	double	   *distances;
 
 	if (isnull)
 	{
 		/* Should not have arrived on a nulls page unless nulls are wanted */
 		Assert(so->searchNulls);
-		*leafValue = (Datum) 0;
-		*recheck = false;
-		return true;
+		result = true;
+		leafValue = (Datum) 0;
+		recheck = false;
+		recheckDistances = false;
+		distances = NULL;
+	}
+	else
+	{
+		spgLeafConsistentIn in;
+		spgLeafConsistentOut out;
+		FmgrInfo   *procinfo;
+		MemoryContext oldCtx;
+
+		/* use temp context for calling leaf_consistent */
+		oldCtx = MemoryContextSwitchTo(so->tempCxt);
+
+		in.scankeys = so->keyData;
+		in.nkeys = so->numberOfKeys;
+		in.orderbys = so->orderByData;
+		in.norderbys = so->numberOfOrderBys;
+		in.reconstructedValue = item->value;
+		in.traversalValue = item->traversalValue;
+		in.level = item->level;
+		in.returnData = so->want_itup;
+		in.leafDatum = SGLTDATUM(leafTuple, &so->state);
+
+		out.leafValue = (Datum) 0;
+		out.recheck = false;
+		out.recheckDistances = false;
+		out.distances = NULL;
+
+		procinfo = index_getprocinfo(index, 1, SPGIST_LEAF_CONSISTENT_PROC);
+		result = DatumGetBool(FunctionCall2Coll(procinfo,
+												index->rd_indcollation[0],
+												PointerGetDatum(&in),
+												PointerGetDatum(&out)));
+
+		leafValue = out.leafValue;
+		recheck = out.recheck;
+		recheckDistances = out.recheckDistances;
+		distances = out.distances;
+
+		MemoryContextSwitchTo(oldCtx);
+
+		if (result && so->numberOfOrderBys > 0 && distances == NULL)
+			elog(ERROR, "SP-GiST leaf_consistent function did not return distances");
 	}
 
-	leafDatum = SGLTDATUM(leafTuple, &so->state);
+	if (!result)
+		return false;
 
-	/* use temp context for calling leaf_consistent */
-	oldCtx = MemoryContextSwitchTo(so->tempCxt);
+	if (so->numberOfOrderBys > 0)
+	{
+		/* the scan is ordered, so queue the heap tuple */
+		spgAddSearchItemToQueue(so,
+								spgNewHeapItem(so, item->level,
+											   &leafTuple->heapPtr,
+											   leafValue, recheck,
+											   recheckDistances, isnull,
+											   distances));
+		return false;
+	}
 
-	in.scankeys = so->keyData;
-	in.nkeys = so->numberOfKeys;
-	in.reconstructedValue = reconstructedValue;
-	in.level = level;
-	in.returnData = so->want_itup;
-	in.leafDatum = leafDatum;
+	/* the scan is unordered, so report the tuple right away */
+	storeRes(so, &leafTuple->heapPtr, leafValue, isnull, recheck,
+			 false, NULL);
+	return true;
+}
 
-	out.leafValue = (Datum) 0;
-	out.recheck = false;
+/*
+ * Make a queue item for the child of an inner tuple, that inner_consistent
+ * told us to visit as its i'th choice.
+ */
+static SpGistSearchItem *
+spgNewInnerItem(SpGistScanOpaque so, SpGistSearchItem *parentItem,
+				SpGistNodeTuple node, spgInnerConsistentOut *out, int i,
+				bool isnull, double *distances)
+{
+	SpGistSearchItem *item;
+
+	item = (SpGistSearchItem *)
+		palloc(SizeOfSpGistSearchItem(so->numberOfOrderBys));
+
+	item->ptr = node->t_tid;
+	if (out->levelAdds)
+		item->level = parentItem->level + out->levelAdds[i];
+	else
+		item->level = parentItem->level;
 
-	procinfo = index_getprocinfo(index, 1, SPGIST_LEAF_CONSISTENT_PROC);
-	result = DatumGetBool(FunctionCall2Coll(procinfo,
-											index->rd_indcollation[0],
-											PointerGetDatum(&in),
-											PointerGetDatum(&out)));
+	/* Must copy value out of temp context */
+	if (out->reconstructedValues)
+		item->value = datumCopy(out->reconstructedValues[i],
+								so->state.attType.attbyval,
+								so->state.attType.attlen);
+	else
+		item->value = (Datum) 0;
+
+	/*
+	 * Traversal values are allocated by the opclass in traversalCxt, which
+	 * lives as long as the scan, so no copy is needed.
+	 */
+	if (out->traversalValues)
+		item->traversalValue = out->traversalValues[i];
+	else
+		item->traversalValue = NULL;
 
-	*leafValue = out.leafValue;
-	*recheck = out.recheck;
+	item->isLeaf = false;
+	item->recheck = false;
+	item->recheckDistances = false;
+	item->isNull = isnull;
 
-	MemoryContextSwitchTo(oldCtx);
+	if (so->numberOfOrderBys > 0)
+		memcpy(item->distances, distances,
+			   sizeof(double) * so->numberOfOrderBys);
 
-	return result;
+	return item;
 }
 
 /*
@@ -315,7 +591,8 @@ spgLeafTest(Relation index, SpGistScanOpaque so,
  * subroutine.
  *
  * If scanWholeIndex is true, we'll do just that.  If not, we'll stop at the
- * next page boundary once we have reported at least one tuple.
+ * next page boundary once we have reported at least one tuple.  In an
+ * ordered scan, tuples are reported in order of distance, one at a time.
  */
 static void
 spgWalk(Relation index, SpGistScanOpaque so, bool scanWholeIndex,
@@ -326,25 +603,34 @@ spgWalk(Relation index, SpGistScanOpaque so, bool scanWholeIndex,
 
 	while (scanWholeIndex || !reportedSome)
 	{
-		ScanStackEntry *stackEntry;
+		SpGistSearchItem *item;
 		BlockNumber blkno;
 		OffsetNumber offset;
 		Page		page;
 		bool		isnull;
 
-		/* Pull next to-do item from the list */
-		if (so->scanStack == NIL)
+		/* Pull next to-do item from the queue */
+		item = spgGetNextQueueItem(so);
+		if (item == NULL)
 			break;				/* there are no more pages to scan */
 
-		stackEntry = (ScanStackEntry *) linitial(so->scanStack);
-		so->scanStack = list_delete_first(so->scanStack);
+		if (item->isLeaf)
+		{
+			/* Heap tuples are only queued in ordered scans */
+			Assert(so->numberOfOrderBys > 0);
+			storeRes(so, &item->ptr, item->value, item->isNull,
+					 item->recheck, item->recheckDistances,
+					 item->isNull ? NULL : item->distances);
+			reportedSome = true;
+			goto done;
+		}
 
 redirect:
 		/* Check for interrupts, just in case of infinite loop */
 		CHECK_FOR_INTERRUPTS();
 
-		blkno = ItemPointerGetBlockNumber(&stackEntry->ptr);
-		offset = ItemPointerGetOffsetNumber(&stackEntry->ptr);
+		blkno = ItemPointerGetBlockNumber(&item->ptr);
+		offset = ItemPointerGetOffsetNumber(&item->ptr);
 
 		if (buffer == InvalidBuffer)
 		{
@@ -367,8 +653,6 @@ redirect:
 		{
 			SpGistLeafTuple leafTuple;
 			OffsetNumber max = PageGetMaxOffsetNumber(page);
-			Datum		leafValue = (Datum) 0;
-			bool		recheck = false;
 
 			if (SpGistBlockIsRoot(blkno))
 			{
@@ -385,17 +669,9 @@ redirect:
 					}
 
 					Assert(ItemPointerIsValid(&leafTuple->heapPtr));
-					if (spgLeafTest(index, so,
-									leafTuple, isnull,
-									stackEntry->level,
-									stackEntry->reconstructedValue,
-									&leafValue,
-									&recheck))
-					{
-						storeRes(so, &leafTuple->heapPtr,
-								 leafValue, isnull, recheck);
+					if (spgLeafTest(index, so, item, leafTuple, isnull,
+									storeRes))
 						reportedSome = true;
-					}
 				}
 			}
 			else
@@ -411,16 +687,16 @@ redirect:
 						if (leafTuple->tupstate == SPGIST_REDIRECT)
 						{
 							/* redirection tuple should be first in chain */
-							Assert(offset == ItemPointerGetOffsetNumber(&stackEntry->ptr));
+							Assert(offset == ItemPointerGetOffsetNumber(&item->ptr));
 							/* transfer attention to redirect point */
-							stackEntry->ptr = ((SpGistDeadTuple) leafTuple)->pointer;
-							Assert(ItemPointerGetBlockNumber(&stackEntry->ptr) != SPGIST_METAPAGE_BLKNO);
+							item->ptr = ((SpGistDeadTuple) leafTuple)->pointer;
+							Assert(ItemPointerGetBlockNumber(&item->ptr) != SPGIST_METAPAGE_BLKNO);
 							goto redirect;
 						}
 						if (leafTuple->tupstate == SPGIST_DEAD)
 						{
 							/* dead tuple should be first in chain */
-							Assert(offset == ItemPointerGetOffsetNumber(&stackEntry->ptr));
+							Assert(offset == ItemPointerGetOffsetNumber(&item->ptr));
 							/* No live entries on this page */
 							Assert(leafTuple->nextOffset == InvalidOffsetNumber);
 							break;
@@ -431,17 +707,9 @@ redirect:
 					}
 
 					Assert(ItemPointerIsValid(&leafTuple->heapPtr));
-					if (spgLeafTest(index, so,
-									leafTuple, isnull,
-									stackEntry->level,
-									stackEntry->reconstructedValue,
-									&leafValue,
-									&recheck))
-					{
-						storeRes(so, &leafTuple->heapPtr,
-								 leafValue, isnull, recheck);
+					if (spgLeafTest(index, so, item, leafTuple, isnull,
+									storeRes))
 						reportedSome = true;
-					}
 
 					offset = leafTuple->nextOffset;
 				}
@@ -466,8 +734,8 @@ redirect:
 				if (innerTuple->tupstate == SPGIST_REDIRECT)
 				{
 					/* transfer attention to redirect point */
-					stackEntry->ptr = ((SpGistDeadTuple) innerTuple)->pointer;
-					Assert(ItemPointerGetBlockNumber(&stackEntry->ptr) != SPGIST_METAPAGE_BLKNO);
+					item->ptr = ((SpGistDeadTuple) innerTuple)->pointer;
+					Assert(ItemPointerGetBlockNumber(&item->ptr) != SPGIST_METAPAGE_BLKNO);
 					goto redirect;
 				}
 				elog(ERROR, "unexpected SPGiST tuple state: %d",
@@ -479,8 +747,12 @@ redirect:
 
 			in.scankeys = so->keyData;
 			in.nkeys = so->numberOfKeys;
-			in.reconstructedValue = stackEntry->reconstructedValue;
-			in.level = stackEntry->level;
+			in.orderbys = so->orderByData;
+			in.norderbys = so->numberOfOrderBys;
+			in.reconstructedValue = item->value;
+			in.traversalValue = item->traversalValue;
+			in.traversalMemoryContext = so->traversalCxt;
+			in.level = item->level;
 			in.returnData = so->want_itup;
 			in.allTheSame = innerTuple->allTheSame;
 			in.hasPrefix = (innerTuple->prefixSize > 0);
@@ -505,6 +777,10 @@ redirect:
 								  index->rd_indcollation[0],
 								  PointerGetDatum(&in),
 								  PointerGetDatum(&out));
+
+				if (out.nNodes > 0 && so->numberOfOrderBys > 0 &&
+					out.distances == NULL)
+					elog(ERROR, "SP-GiST inner_consistent function did not return distances");
 			}
 			else
 			{
@@ -529,31 +805,27 @@ redirect:
 				Assert(nodeN >= 0 && nodeN < in.nNodes);
 				if (ItemPointerIsValid(&nodes[nodeN]->t_tid))
 				{
-					ScanStackEntry *newEntry;
-
-					/* Create new work item for this node */
-					newEntry = palloc(sizeof(ScanStackEntry));
-					newEntry->ptr = nodes[nodeN]->t_tid;
-					if (out.levelAdds)
-						newEntry->level = stackEntry->level + out.levelAdds[i];
-					else
-						newEntry->level = stackEntry->level;
-					/* Must copy value out of temp context */
-					if (out.reconstructedValues)
-						newEntry->reconstructedValue =
-							datumCopy(out.reconstructedValues[i],
-									  so->state.attType.attbyval,
-									  so->state.attType.attlen);
-					else
-						newEntry->reconstructedValue = (Datum) 0;
-
-					so->scanStack = lcons(newEntry, so->scanStack);
+					/*
+					 * Create new work item for this node.  Children in the
+					 * nulls tree inherit the distances of their parent.
+					 */
+					spgAddSearchItemToQueue(so,
+											spgNewInnerItem(so, item,
+															nodes[nodeN],
+															&out, i, isnull,
+															isnull ? item->distances : out.distances[i]));
+				}
+				else if (out.traversalValues && out.traversalValues[i])
+				{
+					/* nobody is going to use this traversal value */
+					pfree(out.traversalValues[i]);
 				}
 			}
 		}
 
-		/* done with this scan stack entry */
-		freeScanStackEntry(so, stackEntry);
+done:
+		/* done with this queue item */
+		spgFreeSearchItem(so, item);
 		/* clear temp context before proceeding to the next one */
 		MemoryContextReset(so->tempCxt);
 	}
@@ -565,17 +837,17 @@ redirect:
 /* storeRes subroutine for getbitmap case */
 static void
 storeBitmap(SpGistScanOpaque so, ItemPointer heapPtr,
-			Datum leafValue, bool isnull, bool recheck)
+			Datum leafValue, bool isnull, bool recheck,
+			bool recheckDistances, double *distances)
 {
+	Assert(!recheckDistances && !distances);
 	tbm_add_tuples(so->tbm, heapPtr, 1, recheck);
 	so->ntids++;
 }
 
-Datum
-spggetbitmap(PG_FUNCTION_ARGS)
+int64
+spggetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
-	TIDBitmap  *tbm = (TIDBitmap *) PG_GETARG_POINTER(1);
 	SpGistScanOpaque so = (SpGistScanOpaque) scan->opaque;
 
 	/* Copy want_itup to *so so we don't need to pass it around separately */
@@ -586,17 +858,29 @@ spggetbitmap(PG_FUNCTION_ARGS)
 
 	spgWalk(scan->indexRelation, so, true, storeBitmap);
 
-	PG_RETURN_INT64(so->ntids);
+	return so->ntids;
 }
 
 /* storeRes subroutine for gettuple case */
 static void
 storeGettuple(SpGistScanOpaque so, ItemPointer heapPtr,
-			  Datum leafValue, bool isnull, bool recheck)
+			  Datum leafValue, bool isnull, bool recheck,
+			  bool recheckDistances, double *distances)
 {
 	Assert(so->nPtrs < MaxIndexTuplesPerPage);
 	so->heapPtrs[so->nPtrs] = *heapPtr;
 	so->recheck[so->nPtrs] = recheck;
+	so->recheckDistances[so->nPtrs] = recheckDistances;
+
+	if (distances != NULL)
+	{
+		Size		size = sizeof(double) * so->numberOfOrderBys;
+
+		so->distances[so->nPtrs] = memcpy(palloc(size), distances, size);
+	}
+	else
+		so->distances[so->nPtrs] = NULL;
+
 	if (so->want_itup)
 	{
 		/*
@@ -610,11 +894,63 @@ storeGettuple(SpGistScanOpaque so, ItemPointer heapPtr,
 	so->nPtrs++;
 }
 
-Datum
-spggettuple(PG_FUNCTION_ARGS)
+/*
+ * Pass the distances of the tuple being returned to the executor, converted
+ * to the result types of the ordering operators.  A NULL distances array
+ * means that the distances are null.
+ */
+static void
+spgSetOrderByValues(IndexScanDesc scan, double *distances,
+					bool recheckDistances)
+{
+	SpGistScanOpaque so = (SpGistScanOpaque) scan->opaque;
+	int			i;
+
+	scan->xs_recheckorderby = recheckDistances;
+	for (i = 0; i < scan->numberOfOrderBys; i++)
+	{
+		/* must free any old value to avoid memory leakage */
+		if (!scan->xs_orderbynulls[i] &&
+			((so->orderByTypes[i] == FLOAT8OID && !FLOAT8PASSBYVAL) ||
+			 (so->orderByTypes[i] == FLOAT4OID && !FLOAT4PASSBYVAL)))
+			pfree(DatumGetPointer(scan->xs_orderbyvals[i]));
+
+		if (distances == NULL)
+		{
+			scan->xs_orderbyvals[i] = (Datum) 0;
+			scan->xs_orderbynulls[i] = true;
+		}
+		else if (so->orderByTypes[i] == FLOAT8OID)
+		{
+			scan->xs_orderbyvals[i] = Float8GetDatum(distances[i]);
+			scan->xs_orderbynulls[i] = false;
+		}
+		else if (so->orderByTypes[i] == FLOAT4OID)
+		{
+			/* convert the opclass's distance to ORDER BY type */
+			scan->xs_orderbyvals[i] = Float4GetDatum((float4) distances[i]);
+			scan->xs_orderbynulls[i] = false;
+		}
+		else
+		{
+			/*
+			 * If the ordering operator's return value is anything else, we
+			 * don't know how to convert the float8 bound calculated by the
+			 * opclass to that.  The executor won't actually need the order
+			 * by values we return here, if there are no lossy results, so
+			 * only insist on converting if the recheck flag is set.
+			 */
+			if (recheckDistances)
+				elog(ERROR, "SP-GiST operator family's FOR ORDER BY operator must return float8 or float4 if the distances are lossy");
+			scan->xs_orderbyvals[i] = (Datum) 0;
+			scan->xs_orderbynulls[i] = true;
+		}
+	}
+}
+
+bool
+spggettuple(IndexScanDesc scan, ScanDirection dir)
 {
-	IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
-	ScanDirection dir = (ScanDirection) PG_GETARG_INT32(1);
 	SpGistScanOpaque so = (SpGistScanOpaque) scan->opaque;
 
 	if (dir != ForwardScanDirection)
@@ -631,19 +967,15 @@ spggettuple(PG_FUNCTION_ARGS)
 			scan->xs_ctup.t_self = so->heapPtrs[so->iPtr];
 			scan->xs_recheck = so->recheck[so->iPtr];
 			scan->xs_itup = so->indexTups[so->iPtr];
+
+			if (scan->numberOfOrderBys > 0)
+				spgSetOrderByValues(scan, so->distances[so->iPtr],
+									so->recheckDistances[so->iPtr]);
 			so->iPtr++;
-			PG_RETURN_BOOL(true);
+			return true;
 		}
 
-		if (so->want_itup)
-		{
-			/* Must pfree IndexTuples to avoid memory leak */
-			int			i;
-
-			for (i = 0; i < so->nPtrs; i++)
-				pfree(so->indexTups[i]);
-		}
-		so->iPtr = so->nPtrs = 0;
+		spgFreeReturnedTuples(so);
 
 		spgWalk(scan->indexRelation, so, false, storeGettuple);
 
@@ -651,19 +983,16 @@ spggettuple(PG_FUNCTION_ARGS)
 			break;				/* must have completed scan */
 	}
 
-	PG_RETURN_BOOL(false);
+	return false;
 }
 
-Datum
-spgcanreturn(PG_FUNCTION_ARGS)
+bool
+spgcanreturn(Relation index, int attno)
 {
-	Relation	index = (Relation) PG_GETARG_POINTER(0);
-
-	/* int			i = PG_GETARG_INT32(1); */
 	SpGistCache *cache;
 
 	/* We can do it if the opclass config function says so */
 	cache = spgGetCache(index);
 
-	PG_RETURN_BOOL(cache->config.canReturnData);
+	return cache->config.canReturnData;
 }
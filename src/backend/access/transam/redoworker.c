@@ -0,0 +1,767 @@
+/*-------------------------------------------------------------------------
+ *
+ * redoworker.c
+ *		Parallel application of WAL records during recovery.
+ *
+ * Normally the startup process applies every WAL record itself.  When
+ * redo_workers is set, it starts that many background workers at the
+ * beginning of redo and hands them the records that modify exactly one
+ * data block, choosing the worker by hashing the block's identity.  Records
+ * touching the same block therefore always go to the same worker, through
+ * the same queue, and are applied in WAL order; records touching different
+ * blocks may be applied in any order relative to each other.
+ *
+ * Only record types whose redo routines are known to touch nothing but
+ * their block (plus the free space map and visibility map bits for it,
+ * which are updated under buffer locks and commute) are handed out; see
+ * RedoRecordMode().  Everything else is a barrier: the startup process
+ * waits for all the workers to catch up, then applies the record itself.
+ * That covers multi-block records, whose blocks may belong to different
+ * workers, and anything that needs the state of the database as of a
+ * particular point in WAL: checkpoints, relation drops and truncations,
+ * and, in hot standby, transaction commits and anything that may need to
+ * resolve conflicts with queries.  The startup process also waits for the
+ * workers before declaring the database consistent and before pausing.
+ *
+ * A worker can come across a reference to a page that doesn't exist, just
+ * like the startup process.  The table of such references lives in the
+ * startup process (xlogutils.c), so workers pass them back through shared
+ * memory, and the startup process enters them in its table whenever it
+ * waits for the workers.  Since truncations and drops, which remove
+ * entries from the table, are barriers, this happens in the right order.
+ *
+ * Relation extension during redo normally needs no lock, as the startup
+ * process is the only one doing it.  With several workers that's no longer
+ * true, so XLogReadBufferExtended takes RedoExtensionLock while extending,
+ * and so does md.c when it creates or pads segments during recovery.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/backend/access/transam/redoworker.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/heapam_xlog.h"
+#include "access/nbtree.h"
+#include "access/redoworker.h"
+#include "access/rmgr.h"
+#include "access/xact.h"
+#include "access/xlog.h"
+#include "access/xlog_internal.h"
+#include "access/xlogutils.h"
+#include "catalog/pg_control.h"
+#include "miscadmin.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/startup.h"
+#include "storage/barrier.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
+#include "storage/shmem.h"
+#include "storage/smgr.h"
+#include "storage/spin.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+
+
+/* GUC variable: number of redo workers to use, or 0 */
+int			redo_workers = 0;
+
+bool		AmRedoWorker = false;
+
+/* Size of each worker's message queue */
+#define REDO_WORKER_QUEUE_SIZE	(256 * 1024)
+
+/* Invalid-page references a worker can pass back before it has to wait */
+#define REDO_WORKER_MAX_INVALID_PAGES	32
+
+typedef struct RedoWorkerInvalidPage
+{
+	RelFileNode node;
+	ForkNumber	forkno;
+	BlockNumber blkno;
+	bool		present;
+} RedoWorkerInvalidPage;
+
+typedef struct RedoWorkerSlot
+{
+	slock_t		mutex;			/* protects the fields below */
+
+	/* EndRecPtr of the last record the worker has applied */
+	XLogRecPtr	applied;
+
+	/* Invalid-page references not yet taken over by the startup process */
+	int			ninvalid;
+	RedoWorkerInvalidPage invalid[REDO_WORKER_MAX_INVALID_PAGES];
+} RedoWorkerSlot;
+
+typedef struct RedoWorkerCtlData
+{
+	/* The startup process, so that workers can wake it */
+	PGPROC	   *startupProc;
+
+	/*
+	 * Advanced whenever the startup process has waited for the workers.
+	 * Workers close their files when they see it change, since the startup
+	 * process may have dropped relations in the meantime.
+	 */
+	uint32		closeGeneration;
+
+	RedoWorkerSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} RedoWorkerCtlData;
+
+/* Message header; the record itself follows */
+typedef struct RedoWorkerMsg
+{
+	XLogRecPtr	ReadRecPtr;
+	XLogRecPtr	EndRecPtr;
+} RedoWorkerMsg;
+
+/* How RedoWorkersDispatch handles a record */
+typedef enum
+{
+	REDO_PARALLEL,				/* hand it to a worker */
+	REDO_SERIAL,				/* apply it in the startup process */
+	REDO_BARRIER				/* wait for the workers, then apply it */
+} RedoMode;
+
+static RedoWorkerCtlData *RedoWorkerCtl = NULL;
+
+/* Startup process state for the current redo run */
+static int	nRedoWorkers = 0;
+static shm_mq_handle **redoQueues;
+static BackgroundWorkerHandle **redoHandles;
+static XLogRecPtr *redoDispatched;
+
+/* Redo worker state */
+static RedoWorkerSlot *MyRedoWorkerSlot = NULL;
+
+static Size RedoWorkerCtlSize(void);
+static shm_mq *RedoWorkerQueue(int workerno);
+static RedoMode RedoRecordMode(XLogReaderState *record);
+static void RedoWorkerSend(int workerno, XLogReaderState *record);
+static void RedoWorkersAbsorbInvalidPages(void);
+static void RedoWorkerCheckAlive(int workerno);
+static void RedoWorkersShutdown(int code, Datum arg);
+static void RedoWorkerDetach(int code, Datum arg);
+
+
+/*
+ * Initialization of shared memory
+ */
+static Size
+RedoWorkerCtlSize(void)
+{
+	return MAXALIGN(add_size(offsetof(RedoWorkerCtlData, slots),
+							 mul_size(sizeof(RedoWorkerSlot), redo_workers)));
+}
+
+Size
+RedoWorkerShmemSize(void)
+{
+	if (redo_workers <= 0)
+		return 0;
+
+	return add_size(RedoWorkerCtlSize(),
+					mul_size(REDO_WORKER_QUEUE_SIZE, redo_workers));
+}
+
+void
+RedoWorkerShmemInit(void)
+{
+	bool		found;
+
+	if (redo_workers <= 0)
+		return;
+
+	RedoWorkerCtl = (RedoWorkerCtlData *)
+		ShmemInitStruct("Redo Worker Ctl", RedoWorkerShmemSize(), &found);
+
+	if (!found)
+	{
+		int			i;
+
+		RedoWorkerCtl->startupProc = NULL;
+		RedoWorkerCtl->closeGeneration = 0;
+		for (i = 0; i < redo_workers; i++)
+		{
+			RedoWorkerSlot *slot = &RedoWorkerCtl->slots[i];
+
+			SpinLockInit(&slot->mutex);
+			slot->applied = InvalidXLogRecPtr;
+			slot->ninvalid = 0;
+		}
+	}
+}
+
+/* Queues follow the slots; REDO_WORKER_QUEUE_SIZE is a multiple of MAXALIGN */
+static shm_mq *
+RedoWorkerQueue(int workerno)
+{
+	return (shm_mq *) ((char *) RedoWorkerCtl + RedoWorkerCtlSize() +
+					   (Size) workerno * REDO_WORKER_QUEUE_SIZE);
+}
+
+/*
+ * Start the redo workers.  Called by the startup process as it begins
+ * replaying WAL.  If no workers can be started, redo just proceeds
+ * serially.
+ */
+void
+RedoWorkersStart(void)
+{
+	BackgroundWorker worker;
+	int			i;
+
+	Assert(nRedoWorkers == 0);
+
+	if (redo_workers <= 0)
+		return;
+
+	redoQueues = (shm_mq_handle **)
+		MemoryContextAlloc(TopMemoryContext,
+						   sizeof(shm_mq_handle *) * redo_workers);
+	redoHandles = (BackgroundWorkerHandle **)
+		MemoryContextAlloc(TopMemoryContext,
+						   sizeof(BackgroundWorkerHandle *) * redo_workers);
+	redoDispatched = (XLogRecPtr *)
+		MemoryContextAllocZero(TopMemoryContext,
+							   sizeof(XLogRecPtr) * redo_workers);
+
+	RedoWorkerCtl->startupProc = MyProc;
+
+	memset(&worker, 0, sizeof(worker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	worker.bgw_start_time = BgWorkerStart_PostmasterStart;
+	worker.bgw_restart_time = BGW_NEVER_RESTART;
+	worker.bgw_main = RedoWorkerMain;
+	/* the postmaster only notifies regular backends, so we poll instead */
+	worker.bgw_notify_pid = 0;
+
+	for (i = 0; i < redo_workers; i++)
+	{
+		RedoWorkerSlot *slot = &RedoWorkerCtl->slots[i];
+		shm_mq	   *mq;
+
+		SpinLockAcquire(&slot->mutex);
+		slot->applied = InvalidXLogRecPtr;
+		slot->ninvalid = 0;
+		SpinLockRelease(&slot->mutex);
+
+		mq = shm_mq_create(RedoWorkerQueue(i), REDO_WORKER_QUEUE_SIZE);
+		shm_mq_set_sender(mq, MyProc);
+
+		snprintf(worker.bgw_name, BGW_MAXLEN, "redo worker %d", i);
+		worker.bgw_main_arg = Int32GetDatum(i);
+		if (!RegisterDynamicBackgroundWorker(&worker, &redoHandles[i]))
+		{
+			/* Out of background worker slots; make do with what we have */
+			shm_mq_detach(mq);
+			break;
+		}
+		redoQueues[i] = shm_mq_attach(mq, NULL, redoHandles[i]);
+		nRedoWorkers++;
+	}
+
+	if (nRedoWorkers < redo_workers)
+		ereport(LOG,
+				(errmsg("could only start %d of %d redo workers",
+						nRedoWorkers, redo_workers),
+		   errhint("You might need to increase max_worker_processes.")));
+
+	if (nRedoWorkers > 0)
+		on_shmem_exit(RedoWorkersShutdown, (Datum) 0);
+}
+
+/*
+ * Decide how a record can be applied.
+ *
+ * A record may be handed to a worker only if it touches a single block and
+ * its redo routine doesn't look at anything that other workers may be in
+ * the middle of changing.  This is deliberately a short list of the record
+ * types that make up most of the WAL of a busy server.
+ */
+static RedoMode
+RedoRecordMode(XLogReaderState *record)
+{
+	RmgrId		rmid = XLogRecGetRmid(record);
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+	bool		singleBlock = (record->max_block_id == 0);
+
+	switch (rmid)
+	{
+		case RM_XLOG_ID:
+			if (singleBlock && (info == XLOG_FPI || info == XLOG_FPI_FOR_HINT))
+				return REDO_PARALLEL;
+			break;
+
+		case RM_HEAP_ID:
+			switch (info & XLOG_HEAP_OPMASK)
+			{
+				case XLOG_HEAP_INSERT:
+				case XLOG_HEAP_DELETE:
+				case XLOG_HEAP_UPDATE:
+				case XLOG_HEAP_HOT_UPDATE:
+				case XLOG_HEAP_CONFIRM:
+				case XLOG_HEAP_LOCK:
+				case XLOG_HEAP_INPLACE:
+					if (singleBlock)
+						return REDO_PARALLEL;
+					break;
+			}
+			break;
+
+		case RM_HEAP2_ID:
+			switch (info & XLOG_HEAP_OPMASK)
+			{
+				case XLOG_HEAP2_MULTI_INSERT:
+				case XLOG_HEAP2_LOCK_UPDATED:
+					if (singleBlock)
+						return REDO_PARALLEL;
+					break;
+
+				case XLOG_HEAP2_CLEAN:
+				case XLOG_HEAP2_FREEZE_PAGE:
+					/* these resolve conflicts with queries in hot standby */
+					if (singleBlock && !InHotStandby)
+						return REDO_PARALLEL;
+					break;
+
+				case XLOG_HEAP2_NEW_CID:
+					/* nothing to do at redo */
+					return REDO_SERIAL;
+			}
+			break;
+
+		case RM_BTREE_ID:
+			if (singleBlock && info == XLOG_BTREE_INSERT_LEAF)
+				return REDO_PARALLEL;
+			break;
+
+		case RM_XACT_ID:
+
+			/*
+			 * Outside hot standby nobody looks at the data pages, so a
+			 * commit or abort needn't wait for the changes made by the
+			 * transaction to be applied, unless it drops relations.
+			 */
+			if (!InHotStandby)
+			{
+				uint8		xact_info = info & XLOG_XACT_OPMASK;
+
+				if (xact_info == XLOG_XACT_COMMIT)
+				{
+					xl_xact_parsed_commit parsed;
+
+					ParseCommitRecord(XLogRecGetInfo(record),
+									  (xl_xact_commit *) XLogRecGetData(record),
+									  &parsed);
+					if (parsed.nrels == 0)
+						return REDO_SERIAL;
+				}
+				else if (xact_info == XLOG_XACT_ABORT)
+				{
+					xl_xact_parsed_abort parsed;
+
+					ParseAbortRecord(XLogRecGetInfo(record),
+									 (xl_xact_abort *) XLogRecGetData(record),
+									 &parsed);
+					if (parsed.nrels == 0)
+						return REDO_SERIAL;
+				}
+			}
+			break;
+
+		case RM_STANDBY_ID:
+			/* standby_redo does nothing unless in hot standby */
+			if (!InHotStandby)
+				return REDO_SERIAL;
+			break;
+	}
+
+	return REDO_BARRIER;
+}
+
+/*
+ * Called by the startup process for each record it's about to replay.
+ * Returns true if the record was handed to a redo worker, in which case the
+ * caller mustn't apply it.  Otherwise, the caller applies it; if it's a
+ * barrier, all records handed out earlier have been applied by now.
+ */
+bool
+RedoWorkersDispatch(XLogReaderState *record)
+{
+	RelFileNode rnode;
+	ForkNumber	forknum;
+	BlockNumber blkno;
+	uint32		hash;
+
+	if (nRedoWorkers == 0)
+		return false;
+
+	switch (RedoRecordMode(record))
+	{
+		case REDO_PARALLEL:
+			break;
+		case REDO_SERIAL:
+			return false;
+		case REDO_BARRIER:
+			RedoWorkersDrain();
+			return false;
+	}
+
+	if (!XLogRecGetBlockTag(record, 0, &rnode, &forknum, &blkno))
+		elog(ERROR, "failed to locate backup block with ID 0");
+
+	hash = DatumGetUInt32(hash_uint32((uint32) rnode.relNode ^ blkno));
+	hash ^= DatumGetUInt32(hash_uint32((uint32) rnode.dbNode ^
+										((uint32) forknum << 24)));
+	RedoWorkerSend(hash % nRedoWorkers, record);
+
+	return true;
+}
+
+/*
+ * Put a record on a worker's queue, waiting for room if necessary.
+ */
+static void
+RedoWorkerSend(int workerno, XLogReaderState *record)
+{
+	RedoWorkerMsg msg;
+	shm_mq_iovec iov[2];
+
+	msg.ReadRecPtr = record->ReadRecPtr;
+	msg.EndRecPtr = record->EndRecPtr;
+
+	iov[0].data = (char *) &msg;
+	iov[0].len = sizeof(msg);
+	iov[1].data = (char *) record->decoded_record;
+	iov[1].len = record->decoded_record->xl_tot_len;
+
+	for (;;)
+	{
+		shm_mq_result res;
+
+		res = shm_mq_sendv(redoQueues[workerno], iov, 2, true);
+		if (res == SHM_MQ_SUCCESS)
+			break;
+		if (res == SHM_MQ_DETACHED)
+			ereport(FATAL,
+					(errmsg("redo worker %d exited unexpectedly", workerno)));
+
+		/*
+		 * The queue is full.  The worker might be waiting for us to take
+		 * its invalid-page references, so do that before sleeping.
+		 */
+		RedoWorkersAbsorbInvalidPages();
+		WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT, 1000L);
+		ResetLatch(MyLatch);
+		HandleStartupProcInterrupts();
+	}
+
+	redoDispatched[workerno] = record->EndRecPtr;
+}
+
+/*
+ * Wait until every record handed out so far has been applied.
+ */
+void
+RedoWorkersDrain(void)
+{
+	if (nRedoWorkers == 0)
+		return;
+
+	for (;;)
+	{
+		bool		done = true;
+		int			i;
+
+		ResetLatch(MyLatch);
+
+		RedoWorkersAbsorbInvalidPages();
+
+		for (i = 0; i < nRedoWorkers; i++)
+		{
+			RedoWorkerSlot *slot = &RedoWorkerCtl->slots[i];
+			XLogRecPtr	applied;
+
+			SpinLockAcquire(&slot->mutex);
+			applied = slot->applied;
+			SpinLockRelease(&slot->mutex);
+
+			if (applied < redoDispatched[i])
+			{
+				RedoWorkerCheckAlive(i);
+				done = false;
+			}
+		}
+
+		if (done)
+			break;
+
+		WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT, 1000L);
+		HandleStartupProcInterrupts();
+	}
+
+	/*
+	 * Only we write this, and the workers merely compare it.  It must be
+	 * visible before any record we send after this point, since that record
+	 * may come after a drop or truncation we're about to apply ourselves.
+	 */
+	RedoWorkerCtl->closeGeneration++;
+	pg_write_barrier();
+}
+
+/*
+ * Wait for the workers to finish, and let them go.  Called by the startup
+ * process at the end of redo.
+ */
+void
+RedoWorkersStop(void)
+{
+	int			i;
+
+	if (nRedoWorkers == 0)
+		return;
+
+	RedoWorkersDrain();
+
+	RedoWorkersShutdown(0, (Datum) 0);
+
+	for (i = 0; i < nRedoWorkers; i++)
+	{
+		pid_t		pid;
+
+		while (GetBackgroundWorkerPid(redoHandles[i], &pid) != BGWH_STOPPED)
+		{
+			WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT, 100L);
+			ResetLatch(MyLatch);
+			HandleStartupProcInterrupts();
+		}
+	}
+
+	/* this also disarms the exit callback */
+	nRedoWorkers = 0;
+	pfree(redoQueues);
+	pfree(redoHandles);
+	pfree(redoDispatched);
+}
+
+/*
+ * Detach from the queues, which makes the workers exit once they have
+ * applied what's on them.  Also used as an exit callback, in case the
+ * startup process dies mid-redo.
+ */
+static void
+RedoWorkersShutdown(int code, Datum arg)
+{
+	int			i;
+
+	for (i = 0; i < nRedoWorkers; i++)
+		shm_mq_detach(shm_mq_get_queue(redoQueues[i]));
+}
+
+static void
+RedoWorkerCheckAlive(int workerno)
+{
+	pid_t		pid;
+
+	if (GetBackgroundWorkerPid(redoHandles[workerno], &pid) == BGWH_STOPPED)
+		ereport(FATAL,
+				(errmsg("redo worker %d exited unexpectedly", workerno)));
+}
+
+/*
+ * Take over the invalid-page references the workers have passed back.
+ */
+static void
+RedoWorkersAbsorbInvalidPages(void)
+{
+	int			i;
+
+	for (i = 0; i < nRedoWorkers; i++)
+	{
+		RedoWorkerSlot *slot = &RedoWorkerCtl->slots[i];
+		RedoWorkerInvalidPage pages[REDO_WORKER_MAX_INVALID_PAGES];
+		int			npages;
+		int			j;
+
+		SpinLockAcquire(&slot->mutex);
+		npages = slot->ninvalid;
+		memcpy(pages, slot->invalid, sizeof(RedoWorkerInvalidPage) * npages);
+		slot->ninvalid = 0;
+		SpinLockRelease(&slot->mutex);
+
+		for (j = 0; j < npages; j++)
+			XLogRememberInvalidPage(pages[j].node, pages[j].forkno,
+									pages[j].blkno, pages[j].present);
+	}
+}
+
+/*
+ * Called from xlogutils.c, in a redo worker, instead of entering a
+ * reference to an invalid page in the local table.
+ */
+void
+RedoWorkerForwardInvalidPage(RelFileNode node, ForkNumber forkno,
+							 BlockNumber blkno, bool present)
+{
+	RedoWorkerSlot *slot = MyRedoWorkerSlot;
+
+	Assert(AmRedoWorker);
+
+	for (;;)
+	{
+		SpinLockAcquire(&slot->mutex);
+		if (slot->ninvalid < REDO_WORKER_MAX_INVALID_PAGES)
+		{
+			RedoWorkerInvalidPage *page = &slot->invalid[slot->ninvalid++];
+
+			page->node = node;
+			page->forkno = forkno;
+			page->blkno = blkno;
+			page->present = present;
+			SpinLockRelease(&slot->mutex);
+			break;
+		}
+		SpinLockRelease(&slot->mutex);
+
+		/* No room; prod the startup process and wait for it to make some */
+		SetLatch(&RedoWorkerCtl->startupProc->procLatch);
+		WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT, 10L);
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
+/*
+ * Main entry point for a redo worker.
+ */
+void
+RedoWorkerMain(Datum main_arg)
+{
+	int			workerno = DatumGetInt32(main_arg);
+	shm_mq	   *mq;
+	shm_mq_handle *mqh;
+	XLogReaderState *reader;
+	MemoryContext redo_context;
+	uint32		closeGeneration;
+
+	/* The default SIGTERM handler, which exits at once, is fine for us */
+	BackgroundWorkerUnblockSignals();
+
+	CurrentResourceOwner = ResourceOwnerCreate(NULL, "redo worker");
+
+	/* Redo routines and the storage manager expect these */
+	AmRedoWorker = true;
+	InRecovery = true;
+
+	MyRedoWorkerSlot = &RedoWorkerCtl->slots[workerno];
+
+	mq = RedoWorkerQueue(workerno);
+	shm_mq_set_receiver(mq, MyProc);
+	mqh = shm_mq_attach(mq, NULL, NULL);
+	on_shmem_exit(RedoWorkerDetach, PointerGetDatum(mq));
+
+	reader = XLogReaderAllocate(NULL, NULL);
+	if (!reader)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+		   errdetail("Failed while allocating an XLog reading processor.")));
+
+	redo_context = AllocSetContextCreate(TopMemoryContext,
+										 "Redo Worker",
+										 ALLOCSET_DEFAULT_MINSIZE,
+										 ALLOCSET_DEFAULT_INITSIZE,
+										 ALLOCSET_DEFAULT_MAXSIZE);
+
+	closeGeneration = RedoWorkerCtl->closeGeneration;
+
+	for (;;)
+	{
+		shm_mq_result res;
+		Size		nbytes;
+		void	   *data;
+		RedoWorkerMsg msg;
+		XLogRecord *record;
+		char	   *errormsg;
+		ErrorContextCallback errcallback;
+		MemoryContext oldcontext;
+
+		res = shm_mq_receive(mqh, &nbytes, &data, true);
+		if (res == SHM_MQ_WOULD_BLOCK)
+		{
+			/*
+			 * We've caught up.  If the startup process has waited for us in
+			 * the meantime it may have dropped relations, so let go of our
+			 * files.  Then tell it we're idle, in case it's waiting now.
+			 */
+			if (closeGeneration != RedoWorkerCtl->closeGeneration)
+			{
+				closeGeneration = RedoWorkerCtl->closeGeneration;
+				smgrcloseall();
+			}
+			SetLatch(&RedoWorkerCtl->startupProc->procLatch);
+
+			res = shm_mq_receive(mqh, &nbytes, &data, false);
+		}
+		if (res != SHM_MQ_SUCCESS)
+			break;				/* the startup process is done with us */
+
+		/*
+		 * The startup process may have waited for us, and then dropped or
+		 * truncated relations, while we were blocked in the receive above.
+		 * Check again now that we have a record in hand: applying it through
+		 * a file descriptor for an unlinked file would lose the change.
+		 */
+		pg_read_barrier();
+		if (closeGeneration != RedoWorkerCtl->closeGeneration)
+		{
+			closeGeneration = RedoWorkerCtl->closeGeneration;
+			smgrcloseall();
+		}
+
+		if (nbytes < sizeof(msg) + SizeOfXLogRecord)
+			elog(ERROR, "invalid message received by redo worker");
+		memcpy(&msg, data, sizeof(msg));
+		record = (XLogRecord *) ((char *) data + sizeof(msg));
+
+		reader->ReadRecPtr = msg.ReadRecPtr;
+		reader->EndRecPtr = msg.EndRecPtr;
+		if (!DecodeXLogRecord(reader, record, &errormsg))
+			elog(ERROR, "could not decode WAL record at %X/%X: %s",
+				 (uint32) (msg.ReadRecPtr >> 32), (uint32) msg.ReadRecPtr,
+				 errormsg);
+
+		errcallback.callback = rm_redo_error_callback;
+		errcallback.arg = (void *) reader;
+		errcallback.previous = error_context_stack;
+		error_context_stack = &errcallback;
+
+		oldcontext = MemoryContextSwitchTo(redo_context);
+		RmgrTable[record->xl_rmid].rm_redo(reader);
+		MemoryContextSwitchTo(oldcontext);
+
+		error_context_stack = errcallback.previous;
+
+		MemoryContextReset(redo_context);
+
+		SpinLockAcquire(&MyRedoWorkerSlot->mutex);
+		MyRedoWorkerSlot->applied = msg.EndRecPtr;
+		SpinLockRelease(&MyRedoWorkerSlot->mutex);
+	}
+
+	proc_exit(0);
+}
+
+static void
+RedoWorkerDetach(int code, Datum arg)
+{
+	shm_mq_detach((shm_mq *) DatumGetPointer(arg));
+}
@@ -31,6 +31,7 @@
 #include "access/slru.h"
 #include "access/subtrans.h"
 #include "access/transam.h"
+#include "access/xlog.h"
 #include "pg_trace.h"
 #include "utils/snapmgr.h"
 
@@ -62,6 +63,38 @@ static SlruCtlData SubTransCtlData;
 #define SubTransCtl  (&SubTransCtlData)
 
 
+/*
+ * Backend-local cache of SubTransGetTopmostTransaction() results.
+ *
+ * Once a subtransaction's parent has been recorded in pg_subtrans it never
+ * changes (except that recovery may relink it directly to the top-level XID,
+ * which leaves the topmost parent unchanged), so the topmost parent of an XID
+ * can be remembered indefinitely.  When a snapshot is suboverflowed, every
+ * visibility check on a recent XID goes through SubTransGetTopmostTransaction,
+ * and without this cache each of those calls would need SubtransControlLock.
+ *
+ * The cache is direct-mapped on the low-order bits of the XID.  To make sure
+ * that an entry can never be confused with a later XID of the same value
+ * after wraparound, the whole cache is discarded once TransactionXmin has
+ * advanced SUBTRANS_TOPMOST_CACHE_MAX_AGE XIDs past the point where it was
+ * last reset.
+ */
+#define SUBTRANS_TOPMOST_CACHE_SIZE		4096	/* must be power of 2 */
+#define SUBTRANS_TOPMOST_CACHE_MAX_AGE	((uint32) 1 << 30)
+
+typedef struct SubTransTopmostCacheEntry
+{
+	TransactionId xid;			/* InvalidTransactionId if unused */
+	TransactionId topmostXid;
+} SubTransTopmostCacheEntry;
+
+static SubTransTopmostCacheEntry
+			SubTransTopmostCache[SUBTRANS_TOPMOST_CACHE_SIZE];
+static TransactionId SubTransTopmostCacheXmin = InvalidTransactionId;
+
+#define SubTransTopmostCacheSlot(xid) \
+	(&SubTransTopmostCache[(xid) & (SUBTRANS_TOPMOST_CACHE_SIZE - 1)])
+
 static int	ZeroSUBTRANSPage(int pageno);
 static bool SubTransPagePrecedes(int page1, int page2);
 
@@ -147,10 +180,24 @@ SubTransGetTopmostTransaction(TransactionId xid)
 {
 	TransactionId parentXid = xid,
 				previousXid = xid;
+	SubTransTopmostCacheEntry *entry;
 
 	/* Can't ask about stuff that might not be around anymore */
 	Assert(TransactionIdFollowsOrEquals(xid, TransactionXmin));
 
+	/* Discard the cache if it could contain entries from before wraparound */
+	if (!TransactionIdIsValid(SubTransTopmostCacheXmin) ||
+		(uint32) (TransactionXmin - SubTransTopmostCacheXmin) >
+		SUBTRANS_TOPMOST_CACHE_MAX_AGE)
+	{
+		MemSet(SubTransTopmostCache, 0, sizeof(SubTransTopmostCache));
+		SubTransTopmostCacheXmin = TransactionXmin;
+	}
+
+	entry = SubTransTopmostCacheSlot(xid);
+	if (TransactionIdEquals(entry->xid, xid))
+		return entry->topmostXid;
+
 	while (TransactionIdIsValid(parentXid))
 	{
 		previousXid = parentXid;
@@ -161,6 +208,21 @@ SubTransGetTopmostTransaction(TransactionId xid)
 
 	Assert(TransactionIdIsValid(previousXid));
 
+	/*
+	 * Remember the answer, but only if we walked all the way up to a
+	 * transaction with no parent; if we stopped early at TransactionXmin, the
+	 * result isn't the real topmost XID.  During recovery, a subtransaction's
+	 * parent isn't recorded until its XID assignment record is replayed, so
+	 * finding no parent for the XID itself proves nothing and we mustn't
+	 * cache that.
+	 */
+	if (!TransactionIdIsValid(parentXid) &&
+		(!TransactionIdEquals(previousXid, xid) || !RecoveryInProgress()))
+	{
+		entry->xid = xid;
+		entry->topmostXid = previousXid;
+	}
+
 	return previousXid;
 }
 
@@ -2140,7 +2140,7 @@ RecordTransactionCommitPrepared(TransactionId xid,
 	 */
 
 	/* Flush XLOG to disk */
-	XLogFlush(recptr);
+	XLogFlushCommit(recptr);
 
 	/* Mark the transaction committed in pg_clog */
 	TransactionIdCommitTree(xid, nchildren, children);
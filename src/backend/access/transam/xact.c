@@ -445,6 +445,27 @@ MarkCurrentTransactionIdLoggedIfAny(void)
 		CurrentTransactionState->didLogXid = true;
 }
 
+/*
+ *	IsSubTransactionAssignmentPending
+ *
+ * Should the next WAL record include the toplevel xid?  With wal_level =
+ * logical, the first record carrying a subtransaction's xid does, so that
+ * logical decoding knows which transaction the subtransaction's changes
+ * belong to before the commit record arrives.
+ */
+bool
+IsSubTransactionAssignmentPending(void)
+{
+	TransactionState s = CurrentTransactionState;
+
+	if (!XLogLogicalInfoActive())
+		return false;
+
+	return s->nestingLevel >= 2 &&
+		TransactionIdIsValid(s->transactionId) &&
+		!s->didLogXid;
+}
+
 
 /*
  *	GetStableLatestTransactionId
@@ -1269,7 +1290,7 @@ RecordTransactionCommit(void)
 		 synchronous_commit > SYNCHRONOUS_COMMIT_OFF) ||
 		forceSyncCommit || nrels > 0)
 	{
-		XLogFlush(XactLastRecEnd);
+		XLogFlushCommit(XactLastRecEnd);
 
 		/*
 		 * Now we may update the CLOG, if we wrote a COMMIT record above
@@ -24,6 +24,7 @@
 #include "access/clog.h"
 #include "access/commit_ts.h"
 #include "access/multixact.h"
+#include "access/redoworker.h"
 #include "access/rewriteheap.h"
 #include "access/subtrans.h"
 #include "access/timeline.h"
@@ -33,6 +34,7 @@
 #include "access/xact.h"
 #include "access/xlog_internal.h"
 #include "access/xloginsert.h"
+#include "access/xlogprefetch.h"
 #include "access/xlogreader.h"
 #include "access/xlogutils.h"
 #include "catalog/catversion.h"
@@ -41,6 +43,7 @@
 #include "commands/tablespace.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "portability/instr_time.h"
 #include "postmaster/bgwriter.h"
 #include "postmaster/startup.h"
 #include "replication/basebackup.h"
@@ -98,6 +101,7 @@ int			sync_method = DEFAULT_SYNC_METHOD;
 int			wal_level = WAL_LEVEL_MINIMAL;
 int			CommitDelay = 0;	/* precommit delay in microseconds */
 int			CommitSiblings = 5; /* # concurrent xacts needed to sleep */
+bool		track_wal_flush_timing = false;
 int			wal_retrieve_retry_interval = 5000;
 
 #ifdef WAL_DEBUG
@@ -105,11 +109,28 @@ bool		XLOG_DEBUG = false;
 #endif
 
 /*
- * Number of WAL insertion locks to use. A higher value allows more insertions
- * to happen concurrently, but adds some CPU overhead to flushing the WAL,
- * which needs to iterate all the locks.
+ * Number of WAL insertion locks to use (wal_insert_locks). A higher value
+ * allows more insertions to happen concurrently, but adds some CPU overhead
+ * to flushing the WAL, which needs to iterate all the locks.  -1 means
+ * choose a value based on max_connections, see XLOGChooseNumInsertLocks().
+ *
+ * WALInsertLockAcquireExclusive() holds all of them at once, so the maximum
+ * must stay well below MAX_SIMUL_LWLOCKS.
+ */
+int			NumXLogInsertLocks = -1;
+
+#define MAX_XLOGINSERT_LOCKS	128
+
+/*
+ * On platforms with 64-bit atomics, WAL space is reserved by atomically
+ * advancing CurrBytePos, and the prev-link of each record is handed from
+ * one inserter to the next through a small table in shared memory (see
+ * ReserveXLogInsertLocation).  Elsewhere we fall back to protecting
+ * CurrBytePos and PrevBytePos with insertpos_lck.
  */
-#define NUM_XLOGINSERT_LOCKS  8
+#ifdef PG_HAVE_ATOMIC_U64_SUPPORT
+#define XLOG_ATOMIC_RESERVATION
+#endif
 
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
@@ -456,11 +477,43 @@ typedef union WALInsertLockPadded
 	char		pad[PG_CACHE_LINE_SIZE];
 } WALInsertLockPadded;
 
+/* Samples larger than this (1 second) are clamped in the flush statistics */
+#define XLOG_FLUSH_MAX_SAMPLE	1000000
+
+#ifdef XLOG_ATOMIC_RESERVATION
+/*
+ * An entry in the prev-link table.  Each inserter publishes the start of its
+ * record keyed by the record's end position; the inserter that reserved the
+ * space immediately following it looks the entry up by its own start
+ * position to learn its xl_prev, and then frees the entry.  endBytePos is 0
+ * for a free entry and XLOG_PREV_LINK_BUSY while an entry is being filled.
+ */
+typedef struct XLogPrevLink
+{
+	pg_atomic_uint64 endBytePos;
+	uint64		prevBytePos;
+} XLogPrevLink;
+
+#define XLOG_PREV_LINK_BUSY		PG_UINT64_MAX
+#endif
+
 /*
  * Shared state data for WAL insertion.
  */
 typedef struct XLogCtlInsert
 {
+#ifdef XLOG_ATOMIC_RESERVATION
+
+	/*
+	 * CurrBytePos is the end of reserved WAL. The next record will be
+	 * inserted at that position.  It is stored as a "usable byte position"
+	 * rather than an XLogRecPtr (see XLogBytePosToRecPtr()), which lets
+	 * ReserveXLogInsertLocation advance it with a single atomic add.  The
+	 * start position of the previously reserved record, which is copied to
+	 * the prev-link of the next record, lives in the PrevLinks table.
+	 */
+	pg_atomic_uint64 CurrBytePos;
+#else
 	slock_t		insertpos_lck;	/* protects CurrBytePos and PrevBytePos */
 
 	/*
@@ -472,6 +525,7 @@ typedef struct XLogCtlInsert
 	 */
 	uint64		CurrBytePos;
 	uint64		PrevBytePos;
+#endif
 
 	/*
 	 * Make sure the above heavily-contended spinlock and byte positions are
@@ -513,6 +567,19 @@ typedef struct XLogCtlInsert
 	WALInsertLockPadded *WALInsertLocks;
 	LWLockTranche WALInsertLockTranche;
 	int			WALInsertLockTrancheId;
+
+#ifdef XLOG_ATOMIC_RESERVATION
+	/* Prev-link hand-off table, XLogPrevLinksSize() entries */
+	XLogPrevLink *PrevLinks;
+	uint64		PrevLinksMask;	/* XLogPrevLinksSize() - 1, set at init */
+
+	/*
+	 * All insertions below this point are known to have finished; lets
+	 * WaitXLogInsertionsToFinish skip scanning the insertion locks when a
+	 * previous caller has already established that.
+	 */
+	pg_atomic_uint64 knownFinishedUpto;
+#endif
 } XLogCtlInsert;
 
 /*
@@ -647,6 +714,28 @@ typedef struct XLogCtlData
 	XLogRecPtr	lastFpwDisableRecPtr;
 
 	slock_t		info_lck;		/* locks shared variables shown above */
+
+	/*
+	 * Statistics about WAL flushes, used to choose the group commit delay
+	 * when commit_delay is -1, and exposed by pg_stat_get_wal_flush_latency.
+	 * avgFlushInterval is a moving average of the time between commit flush
+	 * requests, avgFlushDuration of the time a flushing backend spends
+	 * writing and syncing the WAL, both in microseconds.  The histograms
+	 * count, per power-of-two bucket of microseconds, how long XLogFlush
+	 * callers waited in total and how long the actual flushes took.
+	 *
+	 * Only backends running with track_wal_flush_timing on or with
+	 * commit_delay = -1 maintain these, so that the default configuration
+	 * doesn't pay for another shared spinlock on every flush.
+	 *
+	 * Protected by flushstats_lck.
+	 */
+	slock_t		flushstats_lck;
+	instr_time	lastFlushRequest;
+	uint64		avgFlushInterval;
+	uint64		avgFlushDuration;
+	uint64		flushWaitHist[XLOG_FLUSH_HIST_BUCKETS];
+	uint64		flushWriteHist[XLOG_FLUSH_HIST_BUCKETS];
 } XLogCtlData;
 
 static XLogCtlData *XLogCtl = NULL;
@@ -846,7 +935,6 @@ static bool read_backup_label(XLogRecPtr *checkPointLoc,
 				  bool *backupEndRequired, bool *backupFromStandby);
 static bool read_tablespace_map(List **tablespaces);
 
-static void rm_redo_error_callback(void *arg);
 static int	get_sync_bit(int method);
 
 static void CopyXLogRecordToWAL(int write_len, bool isLogSwitch,
@@ -856,7 +944,17 @@ static void ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos,
 						  XLogRecPtr *EndPos, XLogRecPtr *PrevPtr);
 static bool ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 				  XLogRecPtr *PrevPtr);
+static uint64 ReadCurrBytePos(void);
+#ifdef XLOG_ATOMIC_RESERVATION
+static int	XLogPrevLinksSize(void);
+static uint64 XLogPrevLinkConsume(uint64 startbytepos);
+static void XLogPrevLinkPublish(uint64 endbytepos, uint64 prevbytepos);
+static uint64 XLogPrevLinkPeek(uint64 endbytepos);
+#endif
 static XLogRecPtr WaitXLogInsertionsToFinish(XLogRecPtr upto);
+static void XLogFlushRecordRequest(void);
+static void XLogFlushRecordStats(uint64 waitUsecs, uint64 writeUsecs);
+static long XLogFlushAdaptiveDelay(void);
 static char *GetXLogBuffer(XLogRecPtr ptr);
 static XLogRecPtr XLogBytePosToRecPtr(uint64 bytepos);
 static XLogRecPtr XLogBytePosToEndRecPtr(uint64 bytepos);
@@ -916,8 +1014,9 @@ XLogInsertRecord(XLogRecData *rdata, XLogRecPtr fpw_lsn)
 	 * record to the shared WAL buffer cache is a two-step process:
 	 *
 	 * 1. Reserve the right amount of space from the WAL. The current head of
-	 *	  reserved space is kept in Insert->CurrBytePos, and is protected by
-	 *	  insertpos_lck.
+	 *	  reserved space is kept in Insert->CurrBytePos, which is advanced
+	 *	  atomically (or under insertpos_lck, on platforms without 64-bit
+	 *	  atomics).
 	 *
 	 * 2. Copy the record to the reserved WAL space. This involves finding the
 	 *	  correct WAL buffer containing the reserved space, and copying the
@@ -927,7 +1026,7 @@ XLogInsertRecord(XLogRecData *rdata, XLogRecPtr fpw_lsn)
 	 * inserter acquires an insertion lock. In addition to just indicating that
 	 * an insertion is in progress, the lock tells others how far the inserter
 	 * has progressed. There is a small fixed number of insertion locks,
-	 * determined by NUM_XLOGINSERT_LOCKS. When an inserter crosses a page
+	 * determined by wal_insert_locks. When an inserter crosses a page
 	 * boundary, it updates the value stored in the lock to the how far it has
 	 * inserted, to allow the previous buffer to be flushed.
 	 *
@@ -1127,6 +1226,146 @@ XLogInsertRecord(XLogRecData *rdata, XLogRecPtr fpw_lsn)
 	return EndPos;
 }
 
+#ifdef XLOG_ATOMIC_RESERVATION
+/*
+ * Number of entries in the prev-link table.  At most one entry per inserter
+ * that is in the middle of reserving space, plus the one left by the latest
+ * reservation, can be in use at a time, so a few per insertion lock keeps
+ * collisions rare.
+ */
+static int
+XLogPrevLinksSize(void)
+{
+	int			nlinks = 64;
+
+	while (nlinks < 4 * NumXLogInsertLocks)
+		nlinks *= 2;
+	return nlinks;
+}
+
+/* Map a byte position to its slot in the prev-link table */
+static inline XLogPrevLink *
+XLogPrevLinkSlot(uint64 bytepos)
+{
+	uint64		h = bytepos / MAXIMUM_ALIGNOF;
+
+	h ^= h >> 17;
+	h *= UINT64CONST(0x9E3779B97F4A7C15);
+	h ^= h >> 29;
+	return &XLogCtl->Insert.PrevLinks[h & XLogCtl->Insert.PrevLinksMask];
+}
+
+/*
+ * Wait until the inserter whose record ends at 'startbytepos' has published
+ * its start position, then take it out of the table and return it.
+ *
+ * The record preceding ours was reserved before ours, and its inserter
+ * publishes its link as the very next step after its own reservation, so we
+ * only have to wait for a few instructions unless it gets descheduled.
+ */
+static uint64
+XLogPrevLinkConsume(uint64 startbytepos)
+{
+	XLogPrevLink *link = XLogPrevLinkSlot(startbytepos);
+	uint64		prevbytepos;
+	int			spins = 0;
+
+	while (pg_atomic_read_u64(&link->endBytePos) != startbytepos)
+	{
+		if (++spins >= 1000)
+		{
+			pg_usleep(100L);
+			spins = 0;
+		}
+		else
+			SPIN_DELAY();
+	}
+	pg_read_barrier();
+	prevbytepos = link->prevBytePos;
+
+	/* Make sure we've read prevBytePos before the slot can be reused */
+	pg_memory_barrier();
+	pg_atomic_write_u64(&link->endBytePos, 0);
+
+	return prevbytepos;
+}
+
+/*
+ * Publish 'prevbytepos' as the start of the record that ends at
+ * 'endbytepos', for the inserter of the following record to consume.
+ *
+ * If the slot is occupied by another record's link, we wait for that to be
+ * consumed.  That can't deadlock: the occupant's successor has already
+ * reserved its space (otherwise we couldn't have, since we reserved after
+ * the occupant), and consuming a link never waits for anything except the
+ * link itself.
+ */
+static void
+XLogPrevLinkPublish(uint64 endbytepos, uint64 prevbytepos)
+{
+	XLogPrevLink *link = XLogPrevLinkSlot(endbytepos);
+	int			spins = 0;
+
+	for (;;)
+	{
+		uint64		expected = 0;
+
+		if (pg_atomic_compare_exchange_u64(&link->endBytePos, &expected,
+										   XLOG_PREV_LINK_BUSY))
+			break;
+
+		if (++spins >= 1000)
+		{
+			pg_usleep(100L);
+			spins = 0;
+		}
+		else
+			SPIN_DELAY();
+	}
+	link->prevBytePos = prevbytepos;
+	pg_write_barrier();
+	pg_atomic_write_u64(&link->endBytePos, endbytepos);
+}
+
+/*
+ * Return the start of the record ending at 'endbytepos', without consuming
+ * the link.  The caller must hold all the insertion locks, which guarantees
+ * that the latest reservation has published its link.
+ */
+static uint64
+XLogPrevLinkPeek(uint64 endbytepos)
+{
+	XLogPrevLink *link = XLogPrevLinkSlot(endbytepos);
+
+	Assert(holdingAllLocks);
+	if (pg_atomic_read_u64(&link->endBytePos) != endbytepos)
+		elog(PANIC, "could not find WAL prev-link for %X/%X",
+			 (uint32) (endbytepos >> 32), (uint32) endbytepos);
+	pg_read_barrier();
+	return link->prevBytePos;
+}
+#endif   /* XLOG_ATOMIC_RESERVATION */
+
+/*
+ * Read the current end of reserved WAL, as a usable byte position.
+ */
+static uint64
+ReadCurrBytePos(void)
+{
+	XLogCtlInsert *Insert = &XLogCtl->Insert;
+	uint64		bytepos;
+
+#ifdef XLOG_ATOMIC_RESERVATION
+	bytepos = pg_atomic_read_u64(&Insert->CurrBytePos);
+#else
+	SpinLockAcquire(&Insert->insertpos_lck);
+	bytepos = Insert->CurrBytePos;
+	SpinLockRelease(&Insert->insertpos_lck);
+#endif
+
+	return bytepos;
+}
+
 /*
  * Reserves the right amount of space for a record of given size from the WAL.
  * *StartPos is set to the beginning of the reserved section, *EndPos to
@@ -1134,9 +1373,11 @@ XLogInsertRecord(XLogRecData *rdata, XLogRecPtr fpw_lsn)
  * used to set the xl_prev of this record.
  *
  * This is the performance critical part of XLogInsert that must be serialized
- * across backends. The rest can happen mostly in parallel. Try to keep this
- * section as short as possible, insertpos_lck can be heavily contended on a
- * busy system.
+ * across backends. The rest can happen mostly in parallel. Where 64-bit
+ * atomics are available the reservation itself is a single atomic add, and
+ * the only remaining serialization is passing each record's start position
+ * on to the next inserter.  Otherwise, try to keep this section as short as
+ * possible, insertpos_lck can be heavily contended on a busy system.
  *
  * NB: The space calculation here must match the code in CopyXLogRecordToWAL,
  * where we actually copy the record to the reserved space.
@@ -1156,15 +1397,25 @@ ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 	Assert(size > SizeOfXLogRecord);
 
 	/*
-	 * The duration the spinlock needs to be held is minimized by minimizing
-	 * the calculations that have to be done while holding the lock. The
-	 * current tip of reserved WAL is kept in CurrBytePos, as a byte position
-	 * that only counts "usable" bytes in WAL, that is, it excludes all WAL
-	 * page headers. The mapping between "usable" byte positions and physical
-	 * positions (XLogRecPtrs) can be done outside the locked region, and
-	 * because the usable byte position doesn't include any headers, reserving
-	 * X bytes from WAL is almost as simple as "CurrBytePos += X".
+	 * The current tip of reserved WAL is kept in CurrBytePos, as a byte
+	 * position that only counts "usable" bytes in WAL, that is, it excludes
+	 * all WAL page headers. The mapping between "usable" byte positions and
+	 * physical positions (XLogRecPtrs) can be done outside the critical
+	 * section, and because the usable byte position doesn't include any
+	 * headers, reserving X bytes from WAL is almost as simple as
+	 * "CurrBytePos += X".
 	 */
+#ifdef XLOG_ATOMIC_RESERVATION
+	startbytepos = pg_atomic_fetch_add_u64(&Insert->CurrBytePos, size);
+	endbytepos = startbytepos + size;
+
+	/*
+	 * Collect our prev-link from the record before us, then leave ours for
+	 * the record after us.  The order matters, see XLogPrevLinkPublish.
+	 */
+	prevbytepos = XLogPrevLinkConsume(startbytepos);
+	XLogPrevLinkPublish(endbytepos, startbytepos);
+#else
 	SpinLockAcquire(&Insert->insertpos_lck);
 
 	startbytepos = Insert->CurrBytePos;
@@ -1174,6 +1425,7 @@ ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 	Insert->PrevBytePos = startbytepos;
 
 	SpinLockRelease(&Insert->insertpos_lck);
+#endif
 
 	*StartPos = XLogBytePosToRecPtr(startbytepos);
 	*EndPos = XLogBytePosToEndRecPtr(endbytepos);
@@ -1212,22 +1464,34 @@ ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos, XLogRecPtr *PrevPtr)
 	 * These calculations are a bit heavy-weight to be done while holding a
 	 * spinlock, but since we're holding all the WAL insertion locks, there
 	 * are no other inserters competing for it. GetXLogInsertRecPtr() does
-	 * compete for it, but that's not called very frequently.
+	 * compete for it, but that's not called very frequently.  With atomic
+	 * reservation, nobody else can change CurrBytePos or the prev-link of
+	 * the latest record while we hold all the insertion locks.
 	 */
+#ifdef XLOG_ATOMIC_RESERVATION
+	startbytepos = pg_atomic_read_u64(&Insert->CurrBytePos);
+#else
 	SpinLockAcquire(&Insert->insertpos_lck);
 
 	startbytepos = Insert->CurrBytePos;
+#endif
 
 	ptr = XLogBytePosToEndRecPtr(startbytepos);
 	if (ptr % XLOG_SEG_SIZE == 0)
 	{
+#ifndef XLOG_ATOMIC_RESERVATION
 		SpinLockRelease(&Insert->insertpos_lck);
+#endif
 		*EndPos = *StartPos = ptr;
 		return false;
 	}
 
 	endbytepos = startbytepos + size;
+#ifdef XLOG_ATOMIC_RESERVATION
+	prevbytepos = XLogPrevLinkConsume(startbytepos);
+#else
 	prevbytepos = Insert->PrevBytePos;
+#endif
 
 	*StartPos = XLogBytePosToRecPtr(startbytepos);
 	*EndPos = XLogBytePosToEndRecPtr(endbytepos);
@@ -1239,10 +1503,15 @@ ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos, XLogRecPtr *PrevPtr)
 		*EndPos += segleft;
 		endbytepos = XLogRecPtrToBytePos(*EndPos);
 	}
+#ifdef XLOG_ATOMIC_RESERVATION
+	XLogPrevLinkPublish(endbytepos, startbytepos);
+	pg_atomic_write_u64(&Insert->CurrBytePos, endbytepos);
+#else
 	Insert->CurrBytePos = endbytepos;
 	Insert->PrevBytePos = startbytepos;
 
 	SpinLockRelease(&Insert->insertpos_lck);
+#endif
 
 	*PrevPtr = XLogBytePosToRecPtr(prevbytepos);
 
@@ -1401,7 +1670,7 @@ WALInsertLockAcquire(void)
 	static int	lockToTry = -1;
 
 	if (lockToTry == -1)
-		lockToTry = MyProc->pgprocno % NUM_XLOGINSERT_LOCKS;
+		lockToTry = MyProc->pgprocno % NumXLogInsertLocks;
 	MyLockNo = lockToTry;
 
 	/*
@@ -1419,7 +1688,7 @@ WALInsertLockAcquire(void)
 		 * than locks, it still helps to distribute the inserters evenly
 		 * across the locks.
 		 */
-		lockToTry = (lockToTry + 1) % NUM_XLOGINSERT_LOCKS;
+		lockToTry = (lockToTry + 1) % NumXLogInsertLocks;
 	}
 }
 
@@ -1437,7 +1706,7 @@ WALInsertLockAcquireExclusive(void)
 	 * indicator is set to 0xFFFFFFFFFFFFFFFF, which is higher than any real
 	 * XLogRecPtr value, to make sure that no-one blocks waiting on those.
 	 */
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS - 1; i++)
+	for (i = 0; i < NumXLogInsertLocks - 1; i++)
 	{
 		LWLockAcquire(&WALInsertLocks[i].l.lock, LW_EXCLUSIVE);
 		LWLockUpdateVar(&WALInsertLocks[i].l.lock,
@@ -1463,7 +1732,7 @@ WALInsertLockRelease(void)
 	{
 		int			i;
 
-		for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+		for (i = 0; i < NumXLogInsertLocks; i++)
 			LWLockReleaseClearVar(&WALInsertLocks[i].l.lock,
 								  &WALInsertLocks[i].l.insertingAt,
 								  0);
@@ -1491,8 +1760,8 @@ WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt)
 		 * We use the last lock to mark our actual position, see comments in
 		 * WALInsertLockAcquireExclusive.
 		 */
-		LWLockUpdateVar(&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.lock,
-					 &WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.insertingAt,
+		LWLockUpdateVar(&WALInsertLocks[NumXLogInsertLocks - 1].l.lock,
+					 &WALInsertLocks[NumXLogInsertLocks - 1].l.insertingAt,
 						insertingAt);
 	}
 	else
@@ -1518,20 +1787,27 @@ WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt)
 static XLogRecPtr
 WaitXLogInsertionsToFinish(XLogRecPtr upto)
 {
-	uint64		bytepos;
 	XLogRecPtr	reservedUpto;
 	XLogRecPtr	finishedUpto;
-	XLogCtlInsert *Insert = &XLogCtl->Insert;
 	int			i;
 
 	if (MyProc == NULL)
 		elog(PANIC, "cannot wait without a PGPROC structure");
 
+#ifdef XLOG_ATOMIC_RESERVATION
+
+	/*
+	 * If someone has already verified that all insertions up to 'upto' have
+	 * finished, there's no need to look at the insertion locks again.  That
+	 * is common when several backends flush WAL in quick succession.
+	 */
+	finishedUpto = pg_atomic_read_u64(&XLogCtl->Insert.knownFinishedUpto);
+	if (upto <= finishedUpto)
+		return finishedUpto;
+#endif
+
 	/* Read the current insert position */
-	SpinLockAcquire(&Insert->insertpos_lck);
-	bytepos = Insert->CurrBytePos;
-	SpinLockRelease(&Insert->insertpos_lck);
-	reservedUpto = XLogBytePosToEndRecPtr(bytepos);
+	reservedUpto = XLogBytePosToEndRecPtr(ReadCurrBytePos());
 
 	/*
 	 * No-one should request to flush a piece of WAL that hasn't even been
@@ -1559,7 +1835,7 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	 * out for any insertion that's still in progress.
 	 */
 	finishedUpto = reservedUpto;
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < NumXLogInsertLocks; i++)
 	{
 		XLogRecPtr	insertingat = InvalidXLogRecPtr;
 
@@ -1595,6 +1871,22 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 		if (insertingat != InvalidXLogRecPtr && insertingat < finishedUpto)
 			finishedUpto = insertingat;
 	}
+
+#ifdef XLOG_ATOMIC_RESERVATION
+	/* Advertise what we found, unless someone has got further already */
+	{
+		uint64		known;
+
+		known = pg_atomic_read_u64(&XLogCtl->Insert.knownFinishedUpto);
+		while (known < finishedUpto)
+		{
+			if (pg_atomic_compare_exchange_u64(&XLogCtl->Insert.knownFinishedUpto,
+											   &known, finishedUpto))
+				break;
+		}
+	}
+#endif
+
 	return finishedUpto;
 }
 
@@ -2559,6 +2851,147 @@ UpdateMinRecoveryPoint(XLogRecPtr lsn, bool force)
 	LWLockRelease(ControlFileLock);
 }
 
+/*
+ * Map a duration in microseconds to its bucket in the flush histograms.
+ * Bucket i counts durations below XLogFlushHistBucketBound(i); the last
+ * bucket has no upper bound.
+ */
+static int
+XLogFlushHistBucket(uint64 usecs)
+{
+	int			bucket = 0;
+
+	while (bucket < XLOG_FLUSH_HIST_BUCKETS - 1 &&
+		   usecs >= XLogFlushHistBucketBound(bucket))
+		bucket++;
+	return bucket;
+}
+
+/*
+ * Note the arrival of a commit that needs a flush, to keep track of the rate
+ * at which commits could join a group commit.
+ */
+static void
+XLogFlushRecordRequest(void)
+{
+	instr_time	now;
+	instr_time	interval;
+	uint64		usecs;
+
+	INSTR_TIME_SET_CURRENT(now);
+
+	SpinLockAcquire(&XLogCtl->flushstats_lck);
+	if (!INSTR_TIME_IS_ZERO(XLogCtl->lastFlushRequest))
+	{
+		interval = now;
+		INSTR_TIME_SUBTRACT(interval, XLogCtl->lastFlushRequest);
+		usecs = INSTR_TIME_GET_MICROSEC(interval);
+
+		/*
+		 * Don't let a long idle period (or the clock going backwards) wipe
+		 * out what we know about the busy periods.
+		 */
+		if (usecs > XLOG_FLUSH_MAX_SAMPLE)
+			usecs = XLOG_FLUSH_MAX_SAMPLE;
+		if (XLogCtl->avgFlushInterval == 0)
+			XLogCtl->avgFlushInterval = Max(usecs, 1);
+		else
+			XLogCtl->avgFlushInterval = XLogCtl->avgFlushInterval -
+				XLogCtl->avgFlushInterval / 8 + usecs / 8;
+	}
+	XLogCtl->lastFlushRequest = now;
+	SpinLockRelease(&XLogCtl->flushstats_lck);
+}
+
+/*
+ * Account for a finished XLogFlush call: waitUsecs is the total time spent
+ * in it, writeUsecs the time spent writing and syncing WAL ourselves, or 0 if
+ * somebody else did it for us.
+ */
+static void
+XLogFlushRecordStats(uint64 waitUsecs, uint64 writeUsecs)
+{
+	SpinLockAcquire(&XLogCtl->flushstats_lck);
+	XLogCtl->flushWaitHist[XLogFlushHistBucket(waitUsecs)]++;
+	if (writeUsecs > 0)
+	{
+		XLogCtl->flushWriteHist[XLogFlushHistBucket(writeUsecs)]++;
+		if (writeUsecs > XLOG_FLUSH_MAX_SAMPLE)
+			writeUsecs = XLOG_FLUSH_MAX_SAMPLE;
+		if (XLogCtl->avgFlushDuration == 0)
+			XLogCtl->avgFlushDuration = writeUsecs;
+		else
+			XLogCtl->avgFlushDuration = XLogCtl->avgFlushDuration -
+				XLogCtl->avgFlushDuration / 8 + writeUsecs / 8;
+	}
+	SpinLockRelease(&XLogCtl->flushstats_lck);
+}
+
+/*
+ * Choose how long the flushing backend should wait for more commits to
+ * join its group commit, when commit_delay is -1.
+ *
+ * Every backend that arrives while we wait gets its commit flushed by our
+ * fsync instead of having to wait for a later one, but everybody already
+ * waiting for us pays for the delay.  So we only wait if at least two more
+ * flush requests can be expected to arrive within half the time a flush
+ * takes, and never longer than that.
+ */
+static long
+XLogFlushAdaptiveDelay(void)
+{
+	uint64		interval;
+	uint64		duration;
+	uint64		delay;
+
+	SpinLockAcquire(&XLogCtl->flushstats_lck);
+	interval = XLogCtl->avgFlushInterval;
+	duration = XLogCtl->avgFlushDuration;
+	SpinLockRelease(&XLogCtl->flushstats_lck);
+
+	/* not enough history yet? */
+	if (interval == 0 || duration == 0)
+		return 0;
+
+	delay = duration / 2;
+	if (interval * 2 > delay)
+		return 0;
+
+	/* same limit as commit_delay */
+	return (long) Min(delay, 100000);
+}
+
+/*
+ * Return a copy of the WAL flush latency histograms, for
+ * pg_stat_get_wal_flush_latency.  Each array must have room for
+ * XLOG_FLUSH_HIST_BUCKETS entries.
+ */
+void
+XLogGetFlushStats(uint64 *waitHist, uint64 *writeHist)
+{
+	SpinLockAcquire(&XLogCtl->flushstats_lck);
+	memcpy(waitHist, XLogCtl->flushWaitHist,
+		   sizeof(uint64) * XLOG_FLUSH_HIST_BUCKETS);
+	memcpy(writeHist, XLogCtl->flushWriteHist,
+		   sizeof(uint64) * XLOG_FLUSH_HIST_BUCKETS);
+	SpinLockRelease(&XLogCtl->flushstats_lck);
+}
+
+/*
+ * XLogFlush for a transaction commit.  Commits are what a group commit
+ * delay is waiting for, so with commit_delay = -1 their arrival rate is
+ * tracked here before flushing.
+ */
+void
+XLogFlushCommit(XLogRecPtr record)
+{
+	if (CommitDelay < 0 && XLogInsertAllowed() &&
+		record > LogwrtResult.Flush)
+		XLogFlushRecordRequest();
+
+	XLogFlush(record);
+}
+
 /*
  * Ensure that all XLOG data through the given position is flushed to disk.
  *
@@ -2570,6 +3003,11 @@ XLogFlush(XLogRecPtr record)
 {
 	XLogRecPtr	WriteRqstPtr;
 	XLogwrtRqst WriteRqst;
+	instr_time	flushStart;
+	instr_time	writeStart;
+	instr_time	duration;
+	uint64		writeUsecs = 0;
+	bool		collectStats;
 
 	/*
 	 * During REDO, we are reading not writing WAL.  Therefore, instead of
@@ -2588,6 +3026,10 @@ XLogFlush(XLogRecPtr record)
 	if (record <= LogwrtResult.Flush)
 		return;
 
+	collectStats = (track_wal_flush_timing || CommitDelay < 0);
+	if (collectStats)
+		INSTR_TIME_SET_CURRENT(flushStart);
+
 #ifdef WAL_DEBUG
 	if (XLOG_DEBUG)
 		elog(LOG, "xlog flush request %X/%X; write %X/%X; flush %X/%X",
@@ -2639,7 +3081,9 @@ XLogFlush(XLogRecPtr record)
 		 * until it's released, and recheck if we still need to do the flush
 		 * or if the backend that held the lock did it for us already. This
 		 * helps to maintain a good rate of group committing when the system
-		 * is bottlenecked by the speed of fsyncing.
+		 * is bottlenecked by the speed of fsyncing.  When the lock is
+		 * released, all the backends waiting like this are woken up at once,
+		 * so the followers of a group commit don't have to take turns.
 		 */
 		if (!LWLockAcquireOrWait(WALWriteLock, LW_EXCLUSIVE))
 		{
@@ -2663,15 +3107,21 @@ XLogFlush(XLogRecPtr record)
 		 * Sleep before flush! By adding a delay here, we may give further
 		 * backends the opportunity to join the backlog of group commit
 		 * followers; this can significantly improve transaction throughput,
-		 * at the risk of increasing transaction latency.
+		 * at the risk of increasing transaction latency.  With commit_delay
+		 * set to -1, the delay is chosen from the observed flush duration
+		 * and rate of flush requests, see XLogFlushAdaptiveDelay.
 		 *
 		 * We do not sleep if enableFsync is not turned on, nor if there are
 		 * fewer than CommitSiblings other backends with active transactions.
 		 */
-		if (CommitDelay > 0 && enableFsync &&
+		if (CommitDelay != 0 && enableFsync &&
 			MinimumActiveBackends(CommitSiblings))
 		{
-			pg_usleep(CommitDelay);
+			long		delay;
+
+			delay = (CommitDelay > 0) ? CommitDelay : XLogFlushAdaptiveDelay();
+			if (delay > 0)
+				pg_usleep(delay);
 
 			/*
 			 * Re-check how far we can now flush the WAL. It's generally not
@@ -2690,7 +3140,15 @@ XLogFlush(XLogRecPtr record)
 		WriteRqst.Write = insertpos;
 		WriteRqst.Flush = insertpos;
 
+		if (collectStats)
+			INSTR_TIME_SET_CURRENT(writeStart);
 		XLogWrite(WriteRqst, false);
+		if (collectStats)
+		{
+			INSTR_TIME_SET_CURRENT(duration);
+			INSTR_TIME_SUBTRACT(duration, writeStart);
+			writeUsecs = Max(INSTR_TIME_GET_MICROSEC(duration), 1);
+		}
 
 		LWLockRelease(WALWriteLock);
 		/* done */
@@ -2699,6 +3157,13 @@ XLogFlush(XLogRecPtr record)
 
 	END_CRIT_SECTION();
 
+	if (collectStats)
+	{
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, flushStart);
+		XLogFlushRecordStats(INSTR_TIME_GET_MICROSEC(duration), writeUsecs);
+	}
+
 	/* wake up walsenders now that we've released heavily contended locks */
 	WalSndWakeupProcessRequests();
 
@@ -4571,6 +5036,48 @@ check_wal_buffers(int *newval, void **extra, GucSource source)
 	return true;
 }
 
+/*
+ * Auto-tune the number of WAL insertion locks from max_connections.
+ *
+ * The default of 8 is plenty for up to a hundred or so connections; beyond
+ * that, add a lock for every 16 connections, rounded up to a power of two.
+ */
+static int
+XLOGChooseNumInsertLocks(void)
+{
+	int			nlocks = 8;
+
+	while (nlocks < MAX_XLOGINSERT_LOCKS && nlocks * 16 < MaxConnections)
+		nlocks *= 2;
+	return nlocks;
+}
+
+/*
+ * GUC check_hook for wal_insert_locks
+ */
+bool
+check_wal_insert_locks(int *newval, void **extra, GucSource source)
+{
+	/*
+	 * -1 indicates a request for auto-tune.  Like wal_buffers, leave the
+	 * boot_val alone until XLOGShmemSize fixes it.
+	 */
+	if (*newval == -1)
+	{
+		if (NumXLogInsertLocks == -1)
+			return true;
+
+		*newval = XLOGChooseNumInsertLocks();
+	}
+	else if (*newval < 1)
+	{
+		GUC_check_errdetail("\"wal_insert_locks\" must be -1 or at least 1.");
+		return false;
+	}
+
+	return true;
+}
+
 /*
  * Initialization of shared memory for XLOG
  */
@@ -4594,11 +5101,25 @@ XLOGShmemSize(void)
 	}
 	Assert(XLOGbuffers > 0);
 
+	/* Likewise for wal_insert_locks, which depends on max_connections */
+	if (NumXLogInsertLocks == -1)
+	{
+		char		buf[32];
+
+		snprintf(buf, sizeof(buf), "%d", XLOGChooseNumInsertLocks());
+		SetConfigOption("wal_insert_locks", buf, PGC_POSTMASTER, PGC_S_OVERRIDE);
+	}
+	Assert(NumXLogInsertLocks > 0);
+
 	/* XLogCtl */
 	size = sizeof(XLogCtlData);
 
 	/* WAL insertion locks, plus alignment */
-	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NUM_XLOGINSERT_LOCKS + 1));
+	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NumXLogInsertLocks + 1));
+#ifdef XLOG_ATOMIC_RESERVATION
+	/* prev-link table, plus alignment */
+	size = add_size(size, mul_size(sizeof(XLogPrevLink), XLogPrevLinksSize() + 1));
+#endif
 	/* xlblocks array */
 	size = add_size(size, mul_size(sizeof(XLogRecPtr), XLOGbuffers));
 	/* extra alignment padding for XLOG I/O buffers */
@@ -4675,7 +5196,7 @@ XLOGShmemInit(void)
 		((uintptr_t) allocptr) %sizeof(WALInsertLockPadded);
 	WALInsertLocks = XLogCtl->Insert.WALInsertLocks =
 		(WALInsertLockPadded *) allocptr;
-	allocptr += sizeof(WALInsertLockPadded) * NUM_XLOGINSERT_LOCKS;
+	allocptr += sizeof(WALInsertLockPadded) * NumXLogInsertLocks;
 
 	XLogCtl->Insert.WALInsertLockTrancheId = LWLockNewTrancheId();
 
@@ -4684,13 +5205,26 @@ XLOGShmemInit(void)
 	XLogCtl->Insert.WALInsertLockTranche.array_stride = sizeof(WALInsertLockPadded);
 
 	LWLockRegisterTranche(XLogCtl->Insert.WALInsertLockTrancheId, &XLogCtl->Insert.WALInsertLockTranche);
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < NumXLogInsertLocks; i++)
 	{
 		LWLockInitialize(&WALInsertLocks[i].l.lock,
 						 XLogCtl->Insert.WALInsertLockTrancheId);
 		WALInsertLocks[i].l.insertingAt = InvalidXLogRecPtr;
 	}
 
+#ifdef XLOG_ATOMIC_RESERVATION
+	/* Prev-link table; 64-bit atomics need 8-byte alignment */
+	allocptr = (char *) TYPEALIGN(sizeof(XLogPrevLink), allocptr);
+	XLogCtl->Insert.PrevLinks = (XLogPrevLink *) allocptr;
+	XLogCtl->Insert.PrevLinksMask = XLogPrevLinksSize() - 1;
+	for (i = 0; i <= XLogCtl->Insert.PrevLinksMask; i++)
+	{
+		pg_atomic_init_u64(&XLogCtl->Insert.PrevLinks[i].endBytePos, 0);
+		XLogCtl->Insert.PrevLinks[i].prevBytePos = 0;
+	}
+	allocptr += sizeof(XLogPrevLink) * (XLogCtl->Insert.PrevLinksMask + 1);
+#endif
+
 	/*
 	 * Align the start of the page buffers to a full xlog block size boundary.
 	 * This simplifies some calculations in XLOG insertion. It is also
@@ -4709,9 +5243,15 @@ XLOGShmemInit(void)
 	XLogCtl->SharedHotStandbyActive = false;
 	XLogCtl->WalWriterSleeping = false;
 
+#ifdef XLOG_ATOMIC_RESERVATION
+	pg_atomic_init_u64(&XLogCtl->Insert.CurrBytePos, 0);
+	pg_atomic_init_u64(&XLogCtl->Insert.knownFinishedUpto, 0);
+#else
 	SpinLockInit(&XLogCtl->Insert.insertpos_lck);
+#endif
 	SpinLockInit(&XLogCtl->info_lck);
 	SpinLockInit(&XLogCtl->ulsn_lck);
+	SpinLockInit(&XLogCtl->flushstats_lck);
 	InitSharedLatch(&XLogCtl->recoveryWakeupLatch);
 
 	/*
@@ -5616,6 +6156,9 @@ recoveryPausesHere(void)
 	if (!LocalHotStandbyActive)
 		return;
 
+	/* Let users see everything replayed so far */
+	RedoWorkersDrain();
+
 	ereport(LOG,
 			(errmsg("recovery has paused"),
 			 errhint("Execute pg_xlog_replay_resume() to continue.")));
@@ -6680,9 +7223,14 @@ StartupXLOG(void)
 		{
 			ErrorContextCallback errcallback;
 			TimestampTz xtime;
+			XLogPrefetcher *prefetcher;
 
 			InRedo = true;
 
+			prefetcher = XLogPrefetcherAllocate(ControlFile->system_identifier);
+
+			RedoWorkersStart();
+
 			ereport(LOG,
 					(errmsg("redo starts at %X/%X",
 						 (uint32) (ReadRecPtr >> 32), (uint32) ReadRecPtr)));
@@ -6758,6 +7306,12 @@ StartupXLOG(void)
 						recoveryPausesHere();
 				}
 
+				/*
+				 * Start reading in the blocks that upcoming records will
+				 * need, if they aren't cached already.
+				 */
+				XLogPrefetcherReadAhead(prefetcher, ReadRecPtr, curFileTLI);
+
 				/* Setup error traceback support for ereport() */
 				errcallback.callback = rm_redo_error_callback;
 				errcallback.arg = (void *) xlogreader;
@@ -6840,8 +7394,12 @@ StartupXLOG(void)
 					TransactionIdIsValid(record->xl_xid))
 					RecordKnownAssignedTransactionIds(record->xl_xid);
 
-				/* Now apply the WAL record itself */
-				RmgrTable[record->xl_rmid].rm_redo(xlogreader);
+				/*
+				 * Now apply the WAL record itself, unless a redo worker can
+				 * do it for us
+				 */
+				if (!RedoWorkersDispatch(xlogreader))
+					RmgrTable[record->xl_rmid].rm_redo(xlogreader);
 
 				/* Pop the error context stack */
 				error_context_stack = errcallback.previous;
@@ -6894,6 +7452,9 @@ StartupXLOG(void)
 			 * end of main redo apply loop
 			 */
 
+			RedoWorkersStop();
+			XLogPrefetcherFree(prefetcher);
+
 			if (reachedStopPoint)
 			{
 				if (!reachedConsistency)
@@ -7108,8 +7669,14 @@ StartupXLOG(void)
 	 * previous incarnation.
 	 */
 	Insert = &XLogCtl->Insert;
+#ifdef XLOG_ATOMIC_RESERVATION
+	XLogPrevLinkPublish(XLogRecPtrToBytePos(EndOfLog),
+						XLogRecPtrToBytePos(LastRec));
+	pg_atomic_write_u64(&Insert->CurrBytePos, XLogRecPtrToBytePos(EndOfLog));
+#else
 	Insert->PrevBytePos = XLogRecPtrToBytePos(LastRec);
 	Insert->CurrBytePos = XLogRecPtrToBytePos(EndOfLog);
+#endif
 
 	/*
 	 * Tricky point here: readBuf contains the *last* block that the LastRec
@@ -7468,6 +8035,12 @@ CheckRecoveryConsistency(void)
 		minRecoveryPoint <= lastReplayedEndRecPtr &&
 		XLogRecPtrIsInvalid(ControlFile->backupStartPoint))
 	{
+		/*
+		 * Wait for the redo workers, so that the data really is consistent
+		 * and we know about all the invalid pages they have come across.
+		 */
+		RedoWorkersDrain();
+
 		/*
 		 * Check to see if the XLOG sequence contained any unresolved
 		 * references to uninitialized pages.
@@ -7491,6 +8064,8 @@ CheckRecoveryConsistency(void)
 		reachedConsistency &&
 		IsUnderPostmaster)
 	{
+		RedoWorkersDrain();
+
 		SpinLockAcquire(&XLogCtl->info_lck);
 		XLogCtl->SharedHotStandbyActive = true;
 		SpinLockRelease(&XLogCtl->info_lck);
@@ -8218,8 +8793,17 @@ CreateCheckPoint(int flags)
 	 * determine the checkpoint REDO pointer.
 	 */
 	WALInsertLockAcquireExclusive();
+#ifdef XLOG_ATOMIC_RESERVATION
+	{
+		uint64		currbytepos = pg_atomic_read_u64(&Insert->CurrBytePos);
+
+		curInsert = XLogBytePosToRecPtr(currbytepos);
+		prevPtr = XLogBytePosToRecPtr(XLogPrevLinkPeek(currbytepos));
+	}
+#else
 	curInsert = XLogBytePosToRecPtr(Insert->CurrBytePos);
 	prevPtr = XLogBytePosToRecPtr(Insert->PrevBytePos);
+#endif
 
 	/*
 	 * If this isn't a shutdown or forced checkpoint, and we have not inserted
@@ -10602,14 +11186,7 @@ GetXLogReplayRecPtr(TimeLineID *replayTLI)
 XLogRecPtr
 GetXLogInsertRecPtr(void)
 {
-	XLogCtlInsert *Insert = &XLogCtl->Insert;
-	uint64		current_bytepos;
-
-	SpinLockAcquire(&Insert->insertpos_lck);
-	current_bytepos = Insert->CurrBytePos;
-	SpinLockRelease(&Insert->insertpos_lck);
-
-	return XLogBytePosToRecPtr(current_bytepos);
+	return XLogBytePosToRecPtr(ReadCurrBytePos());
 }
 
 /*
@@ -10813,7 +11390,7 @@ read_tablespace_map(List **tablespaces)
 /*
  * Error context callback for errors occurring during rm_redo().
  */
-static void
+void
 rm_redo_error_callback(void *arg)
 {
 	XLogReaderState *record = (XLogReaderState *) arg;
@@ -20,6 +20,7 @@
 #include "access/xlog.h"
 #include "access/xlog_fn.h"
 #include "access/xlog_internal.h"
+#include "access/xlogprefetch.h"
 #include "access/xlogutils.h"
 #include "catalog/catalog.h"
 #include "catalog/pg_type.h"
@@ -517,3 +518,106 @@ pg_backup_start_time(PG_FUNCTION_ARGS)
 
 	PG_RETURN_DATUM(xtime);
 }
+
+/*
+ * Report the WAL flush latency histograms.
+ *
+ * Returns one row per bucket, with the bucket's upper bound in microseconds
+ * (NULL for the last, unbounded bucket), the number of XLogFlush calls that
+ * waited that long for their WAL to be flushed, and the number of actual
+ * WAL write-and-sync operations that took that long.
+ */
+Datum
+pg_stat_get_wal_flush_latency(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_WAL_FLUSH_LATENCY_COLS	3
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	uint64		waitHist[XLOG_FLUSH_HIST_BUCKETS];
+	uint64		writeHist[XLOG_FLUSH_HIST_BUCKETS];
+	int			i;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not " \
+						"allowed in this context")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	XLogGetFlushStats(waitHist, writeHist);
+
+	for (i = 0; i < XLOG_FLUSH_HIST_BUCKETS; i++)
+	{
+		Datum		values[PG_STAT_GET_WAL_FLUSH_LATENCY_COLS];
+		bool		nulls[PG_STAT_GET_WAL_FLUSH_LATENCY_COLS];
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		if (i < XLOG_FLUSH_HIST_BUCKETS - 1)
+			values[0] = Int64GetDatum((int64) XLogFlushHistBucketBound(i));
+		else
+			nulls[0] = true;
+		values[1] = Int64GetDatum((int64) waitHist[i]);
+		values[2] = Int64GetDatum((int64) writeHist[i]);
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	/* clean up and return the tuplestore */
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
+
+/*
+ * Returns what the startup process's block prefetcher has done so far:
+ * prefetches issued, blocks found already cached, block references skipped
+ * for each reason, and how far ahead of replay it last was, in bytes.
+ */
+Datum
+pg_stat_get_recovery_prefetch(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_RECOVERY_PREFETCH_COLS	6
+	TupleDesc	tupdesc;
+	Datum		values[PG_STAT_GET_RECOVERY_PREFETCH_COLS];
+	bool		nulls[PG_STAT_GET_RECOVERY_PREFETCH_COLS];
+	XLogPrefetchStats stats;
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	XLogPrefetchGetStats(&stats);
+
+	MemSet(nulls, 0, sizeof(nulls));
+	values[0] = Int64GetDatum((int64) stats.prefetch);
+	values[1] = Int64GetDatum((int64) stats.hit);
+	values[2] = Int64GetDatum((int64) stats.skip_init);
+	values[3] = Int64GetDatum((int64) stats.skip_new);
+	values[4] = Int64GetDatum((int64) stats.skip_repeat);
+	values[5] = Int32GetDatum((int32) Min(stats.distance, PG_INT32_MAX));
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
@@ -0,0 +1,438 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogprefetch.c
+ *		Prefetching of data blocks referenced by WAL, during recovery.
+ *
+ * Replay is single-threaded, and most redo routines start by reading the
+ * page they are going to modify.  When that page isn't cached, the startup
+ * process waits for a synchronous read, so on a large database recovery
+ * tends to run at the speed of random reads done one at a time.
+ *
+ * To do better, the startup process decodes WAL some distance ahead of the
+ * record being replayed, and for each block referenced there that isn't
+ * already in shared buffers, asks the kernel to start reading it
+ * (posix_fadvise through smgrprefetch).  By the time replay gets to the
+ * record the read has hopefully completed.
+ *
+ * The look-ahead uses its own XLogReaderState, which reads segment files
+ * directly from pg_xlog.  It never waits for WAL to arrive, and never
+ * restores anything from the archive: if the data it wants isn't there yet,
+ * it just gives up and tries again a little later.  On a standby that is
+ * streaming, it doesn't read past the point the WAL receiver has flushed.
+ *
+ * Everything here is advisory.  A block we prefetch in vain, because we
+ * read WAL that turns out not to be replayed (a timeline switch, a torn
+ * tail after a crash), costs some I/O but nothing else; replay itself
+ * always works from the records read by the main xlogreader.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/backend/access/transam/xlogprefetch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "access/xlog_internal.h"
+#include "access/xlogprefetch.h"
+#include "access/xlogreader.h"
+#include "replication/walreceiver.h"
+#include "storage/bufmgr.h"
+#include "storage/fd.h"
+#include "storage/shmem.h"
+#include "storage/smgr.h"
+#include "storage/spin.h"
+
+
+/*
+ * How far ahead of replay to decode, in units of WAL pages.  Zero disables
+ * prefetching.
+ */
+int			recovery_prefetch_distance = 0;
+
+/*
+ * Number of recently seen block references remembered, so that a block
+ * touched by several records close together is only looked up once.
+ */
+#define XLOGPREFETCHER_RECENT_BLOCKS	64
+
+typedef struct XLogPrefetcherBlock
+{
+	RelFileNode rnode;
+	ForkNumber	forknum;
+	BlockNumber blkno;
+} XLogPrefetcherBlock;
+
+struct XLogPrefetcher
+{
+	XLogReaderState *reader;	/* private reader for the look-ahead */
+	bool		started;		/* has the reader been positioned yet? */
+	TimeLineID	tli;			/* timeline we're reading segments of */
+
+	/* Segment file currently open for the reader, if any */
+	int			readFile;
+	XLogSegNo	readSegNo;
+
+	/*
+	 * Replay position at which the look-ahead last ran out of WAL, or
+	 * InvalidXLogRecPtr.  We don't retry until replay has moved on a bit.
+	 */
+	XLogRecPtr	stalledAt;
+
+	/* Ring of recently seen block references */
+	XLogPrefetcherBlock recent[XLOGPREFETCHER_RECENT_BLOCKS];
+	int			nrecent;
+	int			nextrecent;
+
+	/* Our counters; copied to shared memory whenever they change */
+	XLogPrefetchStats stats;
+};
+
+/* Shared memory copy of the counters, for pg_stat_get_recovery_prefetch() */
+typedef struct XLogPrefetchCtlData
+{
+	slock_t		mutex;			/* protects stats */
+	XLogPrefetchStats stats;
+} XLogPrefetchCtlData;
+
+static XLogPrefetchCtlData *XLogPrefetchCtl = NULL;
+
+static int XLogPrefetcherReadPage(XLogReaderState *reader,
+					   XLogRecPtr targetPagePtr, int reqLen,
+					   XLogRecPtr targetRecPtr, char *readBuf,
+					   TimeLineID *pageTLI);
+static void XLogPrefetcherReset(XLogPrefetcher *prefetcher);
+static void XLogPrefetcherScanBlocks(XLogPrefetcher *prefetcher);
+static bool XLogPrefetcherRecentlySeen(XLogPrefetcher *prefetcher,
+						   DecodedBkpBlock *block);
+static void XLogPrefetcherPublishStats(XLogPrefetcher *prefetcher);
+
+
+/*
+ * Initialization of shared memory for the prefetch counters
+ */
+Size
+XLogPrefetchShmemSize(void)
+{
+	return sizeof(XLogPrefetchCtlData);
+}
+
+void
+XLogPrefetchShmemInit(void)
+{
+	bool		found;
+
+	XLogPrefetchCtl = (XLogPrefetchCtlData *)
+		ShmemInitStruct("XLog Prefetch Ctl", XLogPrefetchShmemSize(), &found);
+
+	if (!found)
+	{
+		MemSet(XLogPrefetchCtl, 0, XLogPrefetchShmemSize());
+		SpinLockInit(&XLogPrefetchCtl->mutex);
+	}
+}
+
+/*
+ * Copy the shared counters into *stats.
+ */
+void
+XLogPrefetchGetStats(XLogPrefetchStats *stats)
+{
+	SpinLockAcquire(&XLogPrefetchCtl->mutex);
+	*stats = XLogPrefetchCtl->stats;
+	SpinLockRelease(&XLogPrefetchCtl->mutex);
+}
+
+/*
+ * Create a prefetcher.  It is positioned lazily, by the first call to
+ * XLogPrefetcherReadAhead.  system_identifier is used to validate the WAL
+ * page headers we read, as for the main reader.
+ */
+XLogPrefetcher *
+XLogPrefetcherAllocate(uint64 system_identifier)
+{
+	XLogPrefetcher *prefetcher;
+
+	prefetcher = (XLogPrefetcher *) palloc0(sizeof(XLogPrefetcher));
+	prefetcher->reader = XLogReaderAllocate(&XLogPrefetcherReadPage,
+											prefetcher);
+	if (!prefetcher->reader)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+		   errdetail("Failed while allocating an XLog prefetching processor.")));
+	prefetcher->reader->system_identifier = system_identifier;
+	prefetcher->readFile = -1;
+	prefetcher->stalledAt = InvalidXLogRecPtr;
+
+	/* Carry on counting from where a previous prefetcher left off */
+	XLogPrefetchGetStats(&prefetcher->stats);
+	prefetcher->stats.distance = 0;
+
+	return prefetcher;
+}
+
+void
+XLogPrefetcherFree(XLogPrefetcher *prefetcher)
+{
+	XLogPrefetcherReset(prefetcher);
+	XLogReaderFree(prefetcher->reader);
+	pfree(prefetcher);
+}
+
+/*
+ * Forget where the look-ahead was; the next call starts over at the replay
+ * position.
+ */
+static void
+XLogPrefetcherReset(XLogPrefetcher *prefetcher)
+{
+	if (prefetcher->readFile >= 0)
+	{
+		close(prefetcher->readFile);
+		prefetcher->readFile = -1;
+	}
+	prefetcher->started = false;
+	prefetcher->stalledAt = InvalidXLogRecPtr;
+	prefetcher->nrecent = 0;
+	prefetcher->nextrecent = 0;
+
+	if (prefetcher->stats.distance != 0)
+	{
+		prefetcher->stats.distance = 0;
+		XLogPrefetcherPublishStats(prefetcher);
+	}
+}
+
+/*
+ * Called by the startup process before replaying the record at replayPtr,
+ * on timeline replayTLI.  Decodes WAL until we're recovery_prefetch_distance
+ * ahead of that point, or run out of WAL, prefetching blocks as we go.
+ */
+void
+XLogPrefetcherReadAhead(XLogPrefetcher *prefetcher, XLogRecPtr replayPtr,
+						TimeLineID replayTLI)
+{
+	XLogReaderState *reader = prefetcher->reader;
+	XLogRecPtr	target;
+	bool		changed = false;
+
+	/* The setting can be changed by SIGHUP at any time */
+	if (recovery_prefetch_distance <= 0)
+	{
+		if (prefetcher->started)
+			XLogPrefetcherReset(prefetcher);
+		return;
+	}
+
+	/*
+	 * If replay has moved to a different timeline, whatever we read ahead
+	 * came from the wrong segment files.
+	 */
+	if (replayTLI != prefetcher->tli)
+	{
+		XLogPrefetcherReset(prefetcher);
+		prefetcher->tli = replayTLI;
+	}
+
+	/*
+	 * After running out of WAL, give it a chance to arrive before trying
+	 * again, rather than rereading the same page for every record replayed.
+	 */
+	if (!XLogRecPtrIsInvalid(prefetcher->stalledAt))
+	{
+		if (replayPtr < prefetcher->stalledAt + XLOG_BLCKSZ)
+			return;
+		prefetcher->stalledAt = InvalidXLogRecPtr;
+	}
+
+	target = replayPtr + (XLogRecPtr) recovery_prefetch_distance * XLOG_BLCKSZ;
+
+	while (!prefetcher->started || reader->EndRecPtr < target)
+	{
+		XLogRecord *record;
+		char	   *errormsg;
+
+		/*
+		 * The first read starts at the record about to be replayed, which is
+		 * known to be a valid record boundary.  After that we read
+		 * sequentially; after a failure, XLogReadRecord retries from the end
+		 * of the last record it managed to read.
+		 */
+		record = XLogReadRecord(reader,
+								prefetcher->started ? InvalidXLogRecPtr : replayPtr,
+								&errormsg);
+		if (record == NULL)
+		{
+			prefetcher->stalledAt = replayPtr;
+			break;
+		}
+		prefetcher->started = true;
+
+		/* Records replay has already passed are of no interest */
+		if (reader->ReadRecPtr >= replayPtr)
+			XLogPrefetcherScanBlocks(prefetcher);
+		changed = true;
+	}
+
+	if (changed)
+	{
+		prefetcher->stats.distance = (reader->EndRecPtr > replayPtr) ?
+			(uint32) Min(reader->EndRecPtr - replayPtr, PG_UINT32_MAX) : 0;
+		XLogPrefetcherPublishStats(prefetcher);
+	}
+}
+
+/*
+ * Prefetch the blocks referenced by the record the reader has just decoded.
+ */
+static void
+XLogPrefetcherScanBlocks(XLogPrefetcher *prefetcher)
+{
+	XLogReaderState *reader = prefetcher->reader;
+	int			block_id;
+
+	for (block_id = 0; block_id <= reader->max_block_id; block_id++)
+	{
+		DecodedBkpBlock *block = &reader->blocks[block_id];
+		SMgrRelation reln;
+
+		if (!block->in_use)
+			continue;
+
+		/*
+		 * Whether we've seen the block recently is checked first, so that
+		 * the pages below also go into the ring: once redo has restored or
+		 * initialized a page, later references to it will find it cached.
+		 */
+		if (XLogPrefetcherRecentlySeen(prefetcher, block))
+		{
+			prefetcher->stats.skip_repeat++;
+			continue;
+		}
+
+		/* Redo doesn't read a page it's going to overwrite */
+		if (block->has_image || (block->flags & BKPBLOCK_WILL_INIT) != 0)
+		{
+			prefetcher->stats.skip_init++;
+			continue;
+		}
+
+		reln = smgropen(block->rnode, InvalidBackendId);
+		switch (PrefetchSharedBuffer(reln, block->forknum, block->blkno))
+		{
+			case PREFETCH_BUFFER_HIT:
+				prefetcher->stats.hit++;
+				break;
+			case PREFETCH_BUFFER_ISSUED:
+				prefetcher->stats.prefetch++;
+				break;
+			case PREFETCH_BUFFER_NO_FILE:
+				prefetcher->stats.skip_new++;
+				break;
+		}
+	}
+}
+
+/*
+ * Check whether a block reference was among those we saw recently, and
+ * remember it if not.
+ */
+static bool
+XLogPrefetcherRecentlySeen(XLogPrefetcher *prefetcher, DecodedBkpBlock *block)
+{
+	XLogPrefetcherBlock *entry;
+	int			i;
+
+	for (i = 0; i < prefetcher->nrecent; i++)
+	{
+		entry = &prefetcher->recent[i];
+		if (entry->blkno == block->blkno &&
+			entry->forknum == block->forknum &&
+			RelFileNodeEquals(entry->rnode, block->rnode))
+			return true;
+	}
+
+	entry = &prefetcher->recent[prefetcher->nextrecent];
+	entry->rnode = block->rnode;
+	entry->forknum = block->forknum;
+	entry->blkno = block->blkno;
+	prefetcher->nextrecent = (prefetcher->nextrecent + 1) %
+		XLOGPREFETCHER_RECENT_BLOCKS;
+	if (prefetcher->nrecent < XLOGPREFETCHER_RECENT_BLOCKS)
+		prefetcher->nrecent++;
+
+	return false;
+}
+
+static void
+XLogPrefetcherPublishStats(XLogPrefetcher *prefetcher)
+{
+	SpinLockAcquire(&XLogPrefetchCtl->mutex);
+	XLogPrefetchCtl->stats = prefetcher->stats;
+	SpinLockRelease(&XLogPrefetchCtl->mutex);
+}
+
+/*
+ * read_page callback for the look-ahead reader.
+ *
+ * Reads the page straight from the segment file in pg_xlog.  Returns -1,
+ * with no complaint, if the data isn't available; the caller will try again
+ * later.
+ */
+static int
+XLogPrefetcherReadPage(XLogReaderState *reader, XLogRecPtr targetPagePtr,
+					   int reqLen, XLogRecPtr targetRecPtr, char *readBuf,
+					   TimeLineID *pageTLI)
+{
+	XLogPrefetcher *prefetcher = (XLogPrefetcher *) reader->private_data;
+	uint32		targetPageOff;
+	int			readLen = XLOG_BLCKSZ;
+
+	/*
+	 * When streaming, stay behind the WAL receiver's flush position: the
+	 * rest of the segment is either being written or not there at all.
+	 * Otherwise we just read what's on disk, and rely on the record
+	 * validation in xlogreader.c to stop us at the end of valid WAL.
+	 */
+	if (WalRcvStreaming())
+	{
+		XLogRecPtr	receivedUpto = GetWalRcvWriteRecPtr(NULL, NULL);
+
+		if (receivedUpto < targetPagePtr + reqLen)
+			return -1;
+		if (targetPagePtr / XLOG_BLCKSZ == receivedUpto / XLOG_BLCKSZ)
+			readLen = receivedUpto % XLOG_BLCKSZ;
+	}
+
+	/* Switch segments if the page isn't in the one we have open */
+	if (prefetcher->readFile >= 0 &&
+		!XLByteInSeg(targetPagePtr, prefetcher->readSegNo))
+	{
+		close(prefetcher->readFile);
+		prefetcher->readFile = -1;
+	}
+
+	if (prefetcher->readFile < 0)
+	{
+		char		path[MAXPGPATH];
+
+		XLByteToSeg(targetPagePtr, prefetcher->readSegNo);
+		XLogFilePath(path, prefetcher->tli, prefetcher->readSegNo);
+		prefetcher->readFile = BasicOpenFile(path, O_RDONLY | PG_BINARY, 0);
+		if (prefetcher->readFile < 0)
+			return -1;
+	}
+
+	targetPageOff = targetPagePtr % XLogSegSize;
+	if (lseek(prefetcher->readFile, (off_t) targetPageOff, SEEK_SET) < 0 ||
+		read(prefetcher->readFile, readBuf, XLOG_BLCKSZ) != XLOG_BLCKSZ)
+		return -1;
+
+	*pageTLI = prefetcher->tli;
+	return readLen;
+}
@@ -21,6 +21,7 @@
  */
 #include "postgres.h"
 
+#include "access/relscan.h"
 #include "executor/execdebug.h"
 #include "executor/nodeBitmapIndexscan.h"
 #include "executor/nodeIndexscan.h"
@@ -303,6 +304,9 @@ ExecInitBitmapIndexScan(BitmapIndexScan *node, EState *estate, int eflags)
 							   estate->es_snapshot,
 							   indexstate->biss_NumScanKeys);
 
+	/* Ask the index AM for a skip scan if the planner chose one */
+	indexstate->biss_ScanDesc->xs_want_skip = node->indexskip;
+
 	/*
 	 * If no run-time keys to calculate, go ahead and pass the scankeys to the
 	 * index AM.
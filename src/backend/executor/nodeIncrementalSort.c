@@ -0,0 +1,360 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeIncrementalSort.c
+ *	  Routines to handle incremental sorting of relations.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeIncrementalSort.c
+ *
+ * DESCRIPTION
+ *
+ *	Incremental sort is a variant of a multi-key sort for input that is
+ *	already sorted on a prefix of the sort keys.  If we are asked to sort by
+ *	(key1, ... keyN) and the input is known to be sorted by (key1, ... keyM),
+ *	M < N, then the input falls into groups of tuples that are equal on the
+ *	first M keys, and each group can be sorted separately.  The first tuples
+ *	can therefore be returned long before the whole input has been read,
+ *	which matters a great deal under a LIMIT, and each sort is small enough
+ *	to be done in memory.
+ *
+ *	Setting up a tuplesort for every group would be wasteful when groups are
+ *	small, so we read at least MIN_BATCH_SIZE tuples before starting to look
+ *	for a group boundary, and cut the batch at the first change of the
+ *	presorted keys after that.  A batch may thus contain several groups,
+ *	which is fine since it is sorted on all of the keys.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "executor/execdebug.h"
+#include "executor/nodeIncrementalSort.h"
+#include "miscadmin.h"
+#include "utils/lsyscache.h"
+#include "utils/tuplesort.h"
+
+/*
+ * Minimum number of tuples in a batch.  This needs to be large enough that
+ * the cost of starting a tuplesort is well amortized, but small enough that
+ * a bounded sort doesn't read much more than it needs.
+ */
+#define MIN_BATCH_SIZE 32
+
+
+/* ----------------------------------------------------------------
+ *		incsort_fill_batch
+ *
+ *		Read the next batch of tuples from the outer plan and sort it.
+ *		The batch starts with the tuple left in group_pivot by the previous
+ *		call, if any, and ends just before the first tuple whose presorted
+ *		keys differ from those of the MIN_BATCH_SIZE'th tuple.  That tuple
+ *		is left in group_pivot for the next call.
+ * ----------------------------------------------------------------
+ */
+static void
+incsort_fill_batch(IncrementalSortState *node)
+{
+	IncrementalSort *plannode = (IncrementalSort *) node->ss.ps.plan;
+	PlanState  *outerNode = outerPlanState(node);
+	TupleTableSlot *pivot = node->group_pivot;
+	Tuplesortstate *tuplesortstate;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	int64		ntuples = 0;
+
+	/* Get rid of the previous batch's sort, if any */
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+
+	tuplesortstate = tuplesort_begin_heap(ExecGetResultType(outerNode),
+										  plannode->sort.numCols,
+										  plannode->sort.sortColIdx,
+										  plannode->sort.sortOperators,
+										  plannode->sort.collations,
+										  plannode->sort.nullsFirst,
+										  work_mem,
+										  false);
+	node->tuplesortstate = (void *) tuplesortstate;
+
+	/*
+	 * If the output is bounded, this batch never needs to produce more than
+	 * the tuples still wanted by the caller.
+	 */
+	if (node->bounded)
+		tuplesort_set_bound(tuplesortstate,
+							Max(node->bound - node->tuples_returned, 1));
+
+	/* Start with the tuple that ended the previous batch */
+	if (!TupIsNull(pivot))
+	{
+		tuplesort_puttupleslot(tuplesortstate, pivot);
+		ntuples++;
+	}
+
+	for (;;)
+	{
+		TupleTableSlot *slot = ExecProcNode(outerNode);
+
+		if (TupIsNull(slot))
+		{
+			node->outer_Done = true;
+			ExecClearTuple(pivot);
+			break;
+		}
+
+		/*
+		 * Once the batch is big enough, stop at the first tuple that doesn't
+		 * belong to the same group as the last one we've committed to.
+		 */
+		if (ntuples >= MIN_BATCH_SIZE &&
+			!execTuplesMatch(pivot, slot,
+							 plannode->presortedCols,
+							 plannode->sort.sortColIdx,
+							 node->eqfunctions,
+							 econtext->ecxt_per_tuple_memory))
+		{
+			ExecCopySlot(pivot, slot);
+			break;
+		}
+
+		tuplesort_puttupleslot(tuplesortstate, slot);
+		ntuples++;
+
+		/* This tuple's group must be finished within the batch */
+		if (ntuples == MIN_BATCH_SIZE)
+			ExecCopySlot(pivot, slot);
+	}
+
+	tuplesort_performsort(tuplesortstate);
+
+	node->batch_Done = true;
+	node->batch_count++;
+
+	SO1_printf("ExecIncrementalSort: sorted batch of " INT64_FORMAT " tuples\n",
+			   ntuples);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecIncrementalSort
+ *
+ *		Returns tuples of the outer subtree in the requested order,
+ *		sorting one batch of presorted groups at a time.
+ *
+ *		Conditions:
+ *		  -- the outer child is sorted on the first presortedCols
+ *			 sort keys.
+ *
+ *		Initial States:
+ *		  -- the outer child is prepared to return the first tuple.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecIncrementalSort(IncrementalSortState *node)
+{
+	EState	   *estate = node->ss.ps.state;
+	ScanDirection dir = estate->es_direction;
+	TupleTableSlot *slot = node->ss.ps.ps_ResultTupleSlot;
+
+	/* We only support forward scans */
+	Assert(ScanDirectionIsForward(dir));
+
+	for (;;)
+	{
+		if (node->batch_Done)
+		{
+			if (tuplesort_gettupleslot((Tuplesortstate *) node->tuplesortstate,
+									   true, slot))
+			{
+				node->tuples_returned++;
+				return slot;
+			}
+
+			/* Current batch is exhausted; is there another one? */
+			if (node->outer_Done)
+				return slot;
+			node->batch_Done = false;
+		}
+
+		/*
+		 * Want to scan subplan in the forward direction while reading the
+		 * next batch.
+		 */
+		estate->es_direction = ForwardScanDirection;
+		incsort_fill_batch(node);
+		estate->es_direction = dir;
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitIncrementalSort
+ *
+ *		Creates the run-time state information for the incremental
+ *		sort node produced by the planner and initializes its outer
+ *		subtree.
+ * ----------------------------------------------------------------
+ */
+IncrementalSortState *
+ExecInitIncrementalSort(IncrementalSort *node, EState *estate, int eflags)
+{
+	IncrementalSortState *incrsortstate;
+	Oid		   *eqOperators;
+	int			i;
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "initializing incremental sort node");
+
+	/*
+	 * Incremental sort can't be used with backward scan or mark/restore,
+	 * because it doesn't keep earlier batches around.  The planner knows
+	 * this (ExecSupportsBackwardScan and ExecSupportsMarkRestore say no).
+	 */
+	Assert((eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)) == 0);
+
+	/*
+	 * create state structure
+	 */
+	incrsortstate = makeNode(IncrementalSortState);
+	incrsortstate->ss.ps.plan = (Plan *) node;
+	incrsortstate->ss.ps.state = estate;
+
+	incrsortstate->bounded = false;
+	incrsortstate->batch_Done = false;
+	incrsortstate->outer_Done = false;
+	incrsortstate->tuples_returned = 0;
+	incrsortstate->batch_count = 0;
+	incrsortstate->tuplesortstate = NULL;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * We need an ExprContext only for its per-tuple memory, in which the
+	 * presorted key columns are compared.
+	 */
+	ExecAssignExprContext(estate, &incrsortstate->ss.ps);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &incrsortstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &incrsortstate->ss);
+	incrsortstate->group_pivot = ExecInitExtraTupleSlot(estate);
+
+	/*
+	 * initialize child nodes
+	 *
+	 * We shield the child node from the need to support REWIND, BACKWARD, or
+	 * MARK/RESTORE.
+	 */
+	eflags &= ~(EXEC_FLAG_REWIND | EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK);
+
+	outerPlanState(incrsortstate) = ExecInitNode(outerPlan(node), estate, eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&incrsortstate->ss.ps);
+	ExecAssignScanTypeFromOuterPlan(&incrsortstate->ss);
+	incrsortstate->ss.ps.ps_ProjInfo = NULL;
+
+	ExecSetSlotDescriptor(incrsortstate->group_pivot,
+						  ExecGetResultType(outerPlanState(incrsortstate)));
+
+	/*
+	 * Precompute fmgr lookup data for comparing the presorted columns, using
+	 * the equality operators matching their ordering operators.
+	 */
+	eqOperators = (Oid *) palloc(node->presortedCols * sizeof(Oid));
+	for (i = 0; i < node->presortedCols; i++)
+	{
+		eqOperators[i] = get_equality_op_for_ordering_op(node->sort.sortOperators[i],
+														 NULL);
+		if (!OidIsValid(eqOperators[i]))
+			elog(ERROR, "could not find equality operator for ordering operator %u",
+				 node->sort.sortOperators[i]);
+	}
+	incrsortstate->eqfunctions = execTuplesMatchPrepare(node->presortedCols,
+														eqOperators);
+	pfree(eqOperators);
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "incremental sort node initialized");
+
+	return incrsortstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndIncrementalSort(node)
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndIncrementalSort(IncrementalSortState *node)
+{
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "shutting down incremental sort node");
+
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	/* must drop pointer to sort result tuple */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+
+	/*
+	 * Release tuplesort resources
+	 */
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "incremental sort node shutdown");
+}
+
+void
+ExecReScanIncrementalSort(IncrementalSortState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	/*
+	 * If we haven't read anything yet, just return. If outerplan's chgParam
+	 * is not NULL then it will be re-scanned by ExecProcNode, else no reason
+	 * to re-scan it at all.
+	 */
+	if (node->batch_count == 0)
+		return;
+
+	/*
+	 * We don't keep earlier batches, so we always have to re-read the
+	 * subplan from the beginning.
+	 */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+
+	tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	node->batch_Done = false;
+	node->outer_Done = false;
+	node->tuples_returned = 0;
+	node->batch_count = 0;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+}
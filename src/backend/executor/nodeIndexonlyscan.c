@@ -546,6 +546,7 @@ ExecInitIndexOnlyScan(IndexOnlyScan *node, EState *estate, int eflags)
 
 	/* Set it up for index-only scan */
 	indexstate->ioss_ScanDesc->xs_want_itup = true;
+	indexstate->ioss_ScanDesc->xs_want_skip = node->indexskip;
 	indexstate->ioss_VMBuffer = InvalidBuffer;
 
 	/*
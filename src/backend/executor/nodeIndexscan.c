@@ -27,6 +27,7 @@
 
 #include "access/nbtree.h"
 #include "access/relscan.h"
+#include "catalog/pg_am.h"
 #include "executor/execdebug.h"
 #include "executor/nodeIndexscan.h"
 #include "lib/pairingheap.h"
@@ -1014,6 +1015,9 @@ ExecInitIndexScan(IndexScan *node, EState *estate, int eflags)
 											   indexstate->iss_NumScanKeys,
 											 indexstate->iss_NumOrderByKeys);
 
+	/* Ask the index AM for a skip scan if the planner chose one */
+	indexstate->iss_ScanDesc->xs_want_skip = node->indexskip;
+
 	/*
 	 * If no run-time keys to calculate, go ahead and pass the scankeys to the
 	 * index AM.
@@ -1053,7 +1057,7 @@ ExecInitIndexScan(IndexScan *node, EState *estate, int eflags)
  * can have either constant or non-constant comparison values.
  *
  * 4. ScalarArrayOpExpr ("indexkey op ANY (array-expression)").  If the index
- * has rd_am->amsearcharray, we handle these the same as simple operators,
+ * has rd_amroutine->amsearcharray, we handle these the same as simple operators,
  * setting the SK_SEARCHARRAY flag to tell the AM to handle them.  Otherwise,
  * we create a ScanKey with everything filled in except the comparison value,
  * and set up an IndexArrayKeyInfo struct to drive processing of the qual.
@@ -1436,7 +1440,7 @@ ExecIndexBuildScanKeys(PlanState *planstate, Relation index,
 
 			Assert(rightop != NULL);
 
-			if (index->rd_am->amsearcharray)
+			if (index->rd_amroutine->amsearcharray)
 			{
 				/* Index AM will handle this like a simple operator */
 				flags |= SK_SEARCHARRAY;
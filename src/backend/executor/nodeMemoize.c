@@ -0,0 +1,690 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeMemoize.c
+ *	  Routines to handle caching of the results of parameterized subplans.
+ *
+ * A Memoize node sits on the inner side of a parameterized nestloop.  Each
+ * time the nestloop rescans it with new parameter values, we look those
+ * values up in a hash table; if the subplan has already been run to
+ * completion for the same values, the cached tuples are returned instead of
+ * running the subplan again.  Otherwise the subplan is run and its output
+ * is stored in the cache as it is returned.
+ *
+ * The cache is limited to work_mem.  Entries are kept in a list in least
+ * recently used order, and the oldest ones are evicted when we run out of
+ * room.  If a single entry would not fit on its own, we give up caching it
+ * and just pass the subplan's output through for the rest of that scan.
+ *
+ * The cached results stay valid only as long as the subplan's output
+ * depends on nothing but the cache keys, so if any other parameter of the
+ * subplan changes, the whole cache is thrown away.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeMemoize.c
+ *
+ *-------------------------------------------------------------------------
+ */
+/*
+ * INTERFACE ROUTINES
+ *		ExecMemoize			- return tuples from the cache or the subplan
+ *		ExecInitMemoize		- initialize node and subnodes
+ *		ExecEndMemoize		- shutdown node and subnodes
+ *		ExecReScanMemoize	- prepare for a scan with new parameter values
+ */
+#include "postgres.h"
+
+#include "executor/executor.h"
+#include "executor/nodeMemoize.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "utils/memutils.h"
+
+
+/* States of the ExecMemoize state machine */
+#define MEMO_CACHE_LOOKUP			1	/* look up the current keys */
+#define MEMO_CACHE_FETCH_NEXT_TUPLE	2	/* return cached tuples */
+#define MEMO_FILLING_CACHE			3	/* run subplan, caching its output */
+#define MEMO_CACHE_BYPASS_MODE		4	/* run subplan without caching */
+#define MEMO_END_OF_SCAN			5	/* nothing more to return */
+
+/* A tuple stored in the cache */
+typedef struct MemoizeTuple
+{
+	MinimalTuple mintuple;		/* the cached tuple */
+	struct MemoizeTuple *next;	/* next tuple of the same entry, or NULL */
+} MemoizeTuple;
+
+/* Hash key of a cache entry */
+typedef struct MemoizeKey
+{
+	MinimalTuple params;		/* key values; NULL for a probe */
+} MemoizeKey;
+
+/* A cache entry: all tuples returned for one set of key values */
+typedef struct MemoizeEntry
+{
+	MemoizeKey	key;			/* hash key; must be first */
+	dlist_node	lru_node;		/* position in the LRU list */
+	MemoizeTuple *tuplehead;	/* cached tuples, in subplan output order */
+	Size		mem;			/* memory charged for this entry */
+	bool		complete;		/* did the subplan run to completion? */
+} MemoizeEntry;
+
+/*
+ * dynahash.c provides no way to pass state to the hash and match functions,
+ * so the MemoizeState being searched is kept here, as execGrouping.c does.
+ */
+static MemoizeState *CurMemoizeState = NULL;
+
+static uint32 MemoizeHash(const void *key, Size keysize);
+static int	MemoizeMatch(const void *key1, const void *key2, Size keysize);
+static void cache_create(MemoizeState *node);
+static MemoizeEntry *cache_lookup(MemoizeState *node, bool *found);
+static bool cache_store_tuple(MemoizeState *node, TupleTableSlot *slot);
+static bool cache_reduce_memory(MemoizeState *node, MemoizeEntry *keep);
+static void entry_free_tuples(MemoizeState *node, MemoizeEntry *entry);
+static void cache_remove_entry(MemoizeState *node, MemoizeEntry *entry);
+static void cache_purge_all(MemoizeState *node);
+static bool collect_exec_paramids_walker(Node *node, Bitmapset **paramids);
+
+
+/*
+ * Compute the hash value of a key.  A NULL key tuple stands for the values
+ * in probeslot; otherwise this is an entry already in the cache, which is
+ * hashed only when it is being removed.
+ */
+static uint32
+MemoizeHash(const void *key, Size keysize)
+{
+	MinimalTuple tuple = ((const MemoizeKey *) key)->params;
+	MemoizeState *mstate = CurMemoizeState;
+	TupleTableSlot *slot;
+	uint32		hashkey = 0;
+	int			i;
+
+	if (tuple == NULL)
+		slot = mstate->probeslot;
+	else
+	{
+		slot = mstate->tableslot;
+		ExecStoreMinimalTuple(tuple, slot, false);
+	}
+
+	for (i = 0; i < mstate->nkeys; i++)
+	{
+		Datum		attr;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		attr = slot_getattr(slot, i + 1, &isNull);
+
+		if (!isNull)			/* treat nulls as having hash key 0 */
+		{
+			uint32		hkey;
+
+			hkey = DatumGetUInt32(FunctionCall1(&mstate->hashfunctions[i],
+												attr));
+			hashkey ^= hkey;
+		}
+	}
+
+	return hashkey;
+}
+
+/*
+ * See whether a cache entry matches the given key.
+ *
+ * key1 is always an entry in the table.  key2 is either the probe, or an
+ * entry's own key when that entry is being removed; distinct entries never
+ * have equal keys, so the latter case needs only a pointer comparison.
+ */
+static int
+MemoizeMatch(const void *key1, const void *key2, Size keysize)
+{
+	MinimalTuple tuple1 = ((const MemoizeKey *) key1)->params;
+	MinimalTuple tuple2 = ((const MemoizeKey *) key2)->params;
+	MemoizeState *mstate = CurMemoizeState;
+
+	Assert(tuple1 != NULL);
+	if (tuple2 != NULL)
+		return (tuple1 == tuple2) ? 0 : 1;
+
+	ExecStoreMinimalTuple(tuple1, mstate->tableslot, false);
+	if (execTuplesMatch(mstate->probeslot,
+						mstate->tableslot,
+						mstate->nkeys,
+						mstate->keyColIdx,
+						mstate->eqfunctions,
+						mstate->tempContext))
+		return 0;
+	else
+		return 1;
+}
+
+/*
+ * Create an empty cache.  The hash table lives in tableContext, so
+ * resetting that context gets rid of the whole cache.
+ */
+static void
+cache_create(MemoizeState *node)
+{
+	Memoize    *plan = (Memoize *) node->ss.ps.plan;
+	HASHCTL		hash_ctl;
+	long		nbuckets;
+
+	/* Limit initial table size request to not more than work_mem */
+	nbuckets = Max(plan->est_entries, 16);
+	nbuckets = Min(nbuckets, (long) (node->mem_limit / sizeof(MemoizeEntry)));
+
+	MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+	hash_ctl.keysize = sizeof(MemoizeKey);
+	hash_ctl.entrysize = sizeof(MemoizeEntry);
+	hash_ctl.hash = MemoizeHash;
+	hash_ctl.match = MemoizeMatch;
+	hash_ctl.hcxt = node->tableContext;
+	node->hashtable = hash_create("Memoize", nbuckets, &hash_ctl,
+					HASH_ELEM | HASH_FUNCTION | HASH_COMPARE | HASH_CONTEXT);
+
+	dlist_init(&node->lru_list);
+	node->mem_used = 0;
+}
+
+/*
+ * Evaluate the cache keys and find the cache entry for them, creating a
+ * new, empty entry if there is none.  *found tells which case applies.
+ *
+ * Returns NULL if a new entry could not be made to fit within the memory
+ * limit.
+ */
+static MemoizeEntry *
+cache_lookup(MemoizeState *node, bool *found)
+{
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	TupleTableSlot *probeslot = node->probeslot;
+	MemoizeEntry *entry;
+	MemoizeKey	key;
+	MemoryContext oldcontext;
+	ListCell   *l;
+	int			i;
+
+	/* Compute the key values into the probe slot */
+	ResetExprContext(econtext);
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	ExecClearTuple(probeslot);
+	i = 0;
+	foreach(l, node->param_exprs)
+	{
+		ExprState  *keystate = (ExprState *) lfirst(l);
+
+		probeslot->tts_values[i] = ExecEvalExpr(keystate, econtext,
+												&probeslot->tts_isnull[i],
+												NULL);
+		i++;
+	}
+	ExecStoreVirtualTuple(probeslot);
+
+	/* Search the table; hash and equality functions run in tempContext */
+	CurMemoizeState = node;
+	MemoryContextSwitchTo(node->tempContext);
+	key.params = NULL;
+	entry = (MemoizeEntry *) hash_search(node->hashtable, &key,
+										 HASH_ENTER, found);
+	MemoryContextSwitchTo(oldcontext);
+	MemoryContextReset(node->tempContext);
+
+	if (*found)
+	{
+		/* Move the entry to the most recently used end of the list */
+		dlist_delete(&entry->lru_node);
+		dlist_push_tail(&node->lru_list, &entry->lru_node);
+		return entry;
+	}
+
+	/* Initialize the new entry, keeping a copy of the key values */
+	oldcontext = MemoryContextSwitchTo(node->tableContext);
+	entry->key.params = ExecCopySlotMinimalTuple(probeslot);
+	MemoryContextSwitchTo(oldcontext);
+
+	entry->tuplehead = NULL;
+	entry->complete = false;
+	entry->mem = sizeof(MemoizeEntry) +
+		GetMemoryChunkSpace(entry->key.params);
+	dlist_push_tail(&node->lru_list, &entry->lru_node);
+
+	node->mem_used += entry->mem;
+	if (node->mem_used > node->mem_limit &&
+		!cache_reduce_memory(node, entry))
+	{
+		cache_remove_entry(node, entry);
+		return NULL;
+	}
+	node->mem_peak = Max(node->mem_peak, node->mem_used);
+
+	return entry;
+}
+
+/*
+ * Add a copy of the tuple in slot to the end of the current entry.
+ *
+ * Returns false if the entry no longer fits within the memory limit, even
+ * after evicting everything else; the entry has then been removed.
+ */
+static bool
+cache_store_tuple(MemoizeState *node, TupleTableSlot *slot)
+{
+	MemoizeEntry *entry = node->entry;
+	MemoizeTuple *tuple;
+	MemoryContext oldcontext;
+	Size		size;
+
+	oldcontext = MemoryContextSwitchTo(node->tableContext);
+	tuple = (MemoizeTuple *) palloc(sizeof(MemoizeTuple));
+	tuple->mintuple = ExecCopySlotMinimalTuple(slot);
+	tuple->next = NULL;
+	MemoryContextSwitchTo(oldcontext);
+
+	if (node->last_tuple != NULL)
+		node->last_tuple->next = tuple;
+	else
+		entry->tuplehead = tuple;
+	node->last_tuple = tuple;
+
+	size = GetMemoryChunkSpace(tuple) + GetMemoryChunkSpace(tuple->mintuple);
+	entry->mem += size;
+	node->mem_used += size;
+
+	if (node->mem_used > node->mem_limit &&
+		!cache_reduce_memory(node, entry))
+	{
+		cache_remove_entry(node, entry);
+		node->entry = NULL;
+		node->last_tuple = NULL;
+		return false;
+	}
+	node->mem_peak = Max(node->mem_peak, node->mem_used);
+
+	return true;
+}
+
+/*
+ * Evict least recently used entries, other than keep, until the cache fits
+ * within the memory limit.  Returns false if that can't be done.
+ */
+static bool
+cache_reduce_memory(MemoizeState *node, MemoizeEntry *keep)
+{
+	while (node->mem_used > node->mem_limit)
+	{
+		MemoizeEntry *victim;
+
+		victim = dlist_head_element(MemoizeEntry, lru_node, &node->lru_list);
+		if (victim == keep)
+			return false;
+		cache_remove_entry(node, victim);
+		node->cache_evictions++;
+	}
+
+	return true;
+}
+
+/*
+ * Release the tuples of an entry, leaving it empty.
+ */
+static void
+entry_free_tuples(MemoizeState *node, MemoizeEntry *entry)
+{
+	MemoizeTuple *tuple = entry->tuplehead;
+
+	while (tuple != NULL)
+	{
+		MemoizeTuple *next = tuple->next;
+		Size		size;
+
+		size = GetMemoryChunkSpace(tuple) +
+			GetMemoryChunkSpace(tuple->mintuple);
+		entry->mem -= size;
+		node->mem_used -= size;
+
+		pfree(tuple->mintuple);
+		pfree(tuple);
+		tuple = next;
+	}
+
+	entry->tuplehead = NULL;
+	entry->complete = false;
+}
+
+/*
+ * Remove an entry from the cache altogether.
+ */
+static void
+cache_remove_entry(MemoizeState *node, MemoizeEntry *entry)
+{
+	MinimalTuple params = entry->key.params;
+	MemoryContext oldcontext;
+
+	entry_free_tuples(node, entry);
+	dlist_delete(&entry->lru_node);
+	node->mem_used -= entry->mem;
+
+	CurMemoizeState = node;
+	oldcontext = MemoryContextSwitchTo(node->tempContext);
+	if (hash_search(node->hashtable, &entry->key, HASH_REMOVE, NULL) == NULL)
+		elog(ERROR, "memoize cache entry not found");
+	MemoryContextSwitchTo(oldcontext);
+	MemoryContextReset(node->tempContext);
+
+	/* The key tuple is needed to find the entry, so free it last */
+	pfree(params);
+}
+
+/*
+ * Throw away the whole cache.
+ */
+static void
+cache_purge_all(MemoizeState *node)
+{
+	node->entry = NULL;
+	node->last_tuple = NULL;
+	MemoryContextReset(node->tableContext);
+	cache_create(node);
+}
+
+/*
+ * Collect the IDs of the PARAM_EXEC Params used in an expression.
+ */
+static bool
+collect_exec_paramids_walker(Node *node, Bitmapset **paramids)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *) node;
+
+		if (param->paramkind == PARAM_EXEC)
+			*paramids = bms_add_member(*paramids, param->paramid);
+		return false;
+	}
+	return expression_tree_walker(node, collect_exec_paramids_walker,
+								  (void *) paramids);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecMemoize
+ *
+ *		On the first call of each scan, look up the current parameter
+ *		values in the cache.  On a hit, return the cached tuples; on a
+ *		miss, run the subplan, storing its output in a new cache entry
+ *		as it is returned.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecMemoize(MemoizeState *node)
+{
+	PlanState  *outerNode = outerPlanState(node);
+	TupleTableSlot *slot = node->ss.ps.ps_ResultTupleSlot;
+	TupleTableSlot *outerslot;
+
+	switch (node->mstatus)
+	{
+		case MEMO_CACHE_LOOKUP:
+			{
+				MemoizeEntry *entry;
+				bool		found;
+
+				entry = cache_lookup(node, &found);
+
+				if (found && entry->complete)
+				{
+					node->cache_hits++;
+					node->entry = entry;
+					node->last_tuple = entry->tuplehead;
+					if (entry->tuplehead == NULL)
+					{
+						node->mstatus = MEMO_END_OF_SCAN;
+						return NULL;
+					}
+					node->mstatus = MEMO_CACHE_FETCH_NEXT_TUPLE;
+					return ExecStoreMinimalTuple(entry->tuplehead->mintuple,
+												 slot, false);
+				}
+
+				/*
+				 * Cache miss.  An existing entry can only be left over from
+				 * a scan that was not run to completion; refill it.
+				 */
+				node->cache_misses++;
+				if (found)
+					entry_free_tuples(node, entry);
+				node->entry = entry;
+				node->last_tuple = NULL;
+
+				if (entry == NULL)
+				{
+					node->cache_overflows++;
+					node->mstatus = MEMO_CACHE_BYPASS_MODE;
+				}
+				else
+					node->mstatus = MEMO_FILLING_CACHE;
+
+				outerslot = ExecProcNode(outerNode);
+				if (TupIsNull(outerslot))
+				{
+					if (entry != NULL)
+						entry->complete = true;
+					node->mstatus = MEMO_END_OF_SCAN;
+					return NULL;
+				}
+				if (entry != NULL && !cache_store_tuple(node, outerslot))
+				{
+					node->cache_overflows++;
+					node->mstatus = MEMO_CACHE_BYPASS_MODE;
+				}
+				return outerslot;
+			}
+
+		case MEMO_CACHE_FETCH_NEXT_TUPLE:
+			node->last_tuple = node->last_tuple->next;
+			if (node->last_tuple == NULL)
+			{
+				node->mstatus = MEMO_END_OF_SCAN;
+				return NULL;
+			}
+			return ExecStoreMinimalTuple(node->last_tuple->mintuple,
+										 slot, false);
+
+		case MEMO_FILLING_CACHE:
+			outerslot = ExecProcNode(outerNode);
+			if (TupIsNull(outerslot))
+			{
+				node->entry->complete = true;
+				node->mstatus = MEMO_END_OF_SCAN;
+				return NULL;
+			}
+			if (!cache_store_tuple(node, outerslot))
+			{
+				node->cache_overflows++;
+				node->mstatus = MEMO_CACHE_BYPASS_MODE;
+			}
+			return outerslot;
+
+		case MEMO_CACHE_BYPASS_MODE:
+			outerslot = ExecProcNode(outerNode);
+			if (TupIsNull(outerslot))
+			{
+				node->mstatus = MEMO_END_OF_SCAN;
+				return NULL;
+			}
+			return outerslot;
+
+		case MEMO_END_OF_SCAN:
+			return NULL;
+
+		default:
+			elog(ERROR, "unrecognized memoize state: %d", node->mstatus);
+			return NULL;		/* keep compiler quiet */
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitMemoize
+ * ----------------------------------------------------------------
+ */
+MemoizeState *
+ExecInitMemoize(Memoize *node, EState *estate, int eflags)
+{
+	MemoizeState *mstate;
+	Plan	   *outerPlan;
+	TupleDesc	keydesc;
+	int			i;
+
+	/* check for unsupported flags */
+	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
+
+	/*
+	 * create state structure
+	 */
+	mstate = makeNode(MemoizeState);
+	mstate->ss.ps.plan = (Plan *) node;
+	mstate->ss.ps.state = estate;
+	mstate->mstatus = MEMO_CACHE_LOOKUP;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * create expression context for evaluating the cache keys
+	 */
+	ExecAssignExprContext(estate, &mstate->ss.ps);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &mstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &mstate->ss);
+
+	/*
+	 * initialize child nodes
+	 */
+	outerPlan = outerPlan(node);
+	outerPlanState(mstate) = ExecInitNode(outerPlan, estate, eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&mstate->ss.ps);
+	ExecAssignScanTypeFromOuterPlan(&mstate->ss);
+	mstate->ss.ps.ps_ProjInfo = NULL;
+
+	/*
+	 * initialize the cache keys
+	 */
+	mstate->nkeys = node->numKeys;
+	mstate->param_exprs = (List *)
+		ExecInitExpr((Expr *) node->param_exprs, (PlanState *) mstate);
+
+	keydesc = ExecTypeFromExprList(node->param_exprs);
+	mstate->probeslot = ExecInitExtraTupleSlot(estate);
+	ExecSetSlotDescriptor(mstate->probeslot, keydesc);
+	mstate->tableslot = ExecInitExtraTupleSlot(estate);
+	ExecSetSlotDescriptor(mstate->tableslot, keydesc);
+
+	mstate->keyColIdx = (AttrNumber *) palloc(mstate->nkeys *
+											  sizeof(AttrNumber));
+	for (i = 0; i < mstate->nkeys; i++)
+		mstate->keyColIdx[i] = i + 1;
+
+	execTuplesHashPrepare(mstate->nkeys,
+						  node->hashOperators,
+						  &mstate->eqfunctions,
+						  &mstate->hashfunctions);
+
+	mstate->keyparamids = NULL;
+	(void) collect_exec_paramids_walker((Node *) node->param_exprs,
+										&mstate->keyparamids);
+
+	/*
+	 * create the cache
+	 */
+	mstate->mem_limit = work_mem * 1024L;
+	mstate->tableContext = AllocSetContextCreate(CurrentMemoryContext,
+												 "Memoize cache",
+												 ALLOCSET_DEFAULT_MINSIZE,
+												 ALLOCSET_DEFAULT_INITSIZE,
+												 ALLOCSET_DEFAULT_MAXSIZE);
+	mstate->tempContext = AllocSetContextCreate(CurrentMemoryContext,
+												"Memoize temporary",
+												ALLOCSET_SMALL_MINSIZE,
+												ALLOCSET_SMALL_INITSIZE,
+												ALLOCSET_SMALL_MAXSIZE);
+	cache_create(mstate);
+
+	return mstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndMemoize
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndMemoize(MemoizeState *node)
+{
+	/*
+	 * clean out the tuple table; the result slot may point into the cache
+	 */
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+
+	/*
+	 * release the cache
+	 */
+	MemoryContextDelete(node->tableContext);
+	MemoryContextDelete(node->tempContext);
+
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+}
+
+/* ----------------------------------------------------------------
+ *		ExecReScanMemoize
+ * ----------------------------------------------------------------
+ */
+void
+ExecReScanMemoize(MemoizeState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	/* The result slot may point into an entry we are about to evict */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+
+	node->mstatus = MEMO_CACHE_LOOKUP;
+	node->entry = NULL;
+	node->last_tuple = NULL;
+
+	/*
+	 * If parameters other than the cache keys have changed, the subplan may
+	 * now return different tuples for the same keys, so the cached results
+	 * are no longer valid.
+	 */
+	if (bms_nonempty_difference(outerPlan->chgParam, node->keyparamids))
+		cache_purge_all(node);
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+}
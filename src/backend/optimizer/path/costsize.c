@@ -75,6 +75,7 @@
 #endif
 #include <math.h>
 
+#include "access/amapi.h"
 #include "access/htup_details.h"
 #include "access/tsmapi.h"
 #include "executor/executor.h"
@@ -116,12 +117,15 @@ int			max_parallel_degree = 0;
 bool		enable_seqscan = true;
 bool		enable_indexscan = true;
 bool		enable_indexonlyscan = true;
+bool		enable_indexskipscan = true;
 bool		enable_bitmapscan = true;
 bool		enable_tidscan = true;
 bool		enable_sort = true;
+bool		enable_incrementalsort = true;
 bool		enable_hashagg = true;
 bool		enable_nestloop = true;
 bool		enable_material = true;
+bool		enable_memoize = true;
 bool		enable_mergejoin = true;
 bool		enable_hashjoin = true;
 
@@ -135,8 +139,14 @@ static List *extract_nonindex_conditions(List *qual_clauses, List *indexquals);
 static MergeScanSelCache *cached_scansel(PlannerInfo *root,
 			   RestrictInfo *rinfo,
 			   PathKey *pathkey);
+static void cost_tuplesort(Cost *startup_cost, Cost *run_cost,
+			   double tuples, int width,
+			   Cost comparison_cost, int sort_mem,
+			   double limit_tuples);
 static void cost_rescan(PlannerInfo *root, Path *path,
 			Cost *rescan_startup_cost, Cost *rescan_total_cost);
+static void cost_memoize_rescan(PlannerInfo *root, MemoizePath *mpath,
+					Cost *rescan_startup_cost, Cost *rescan_total_cost);
 static bool cost_qual_eval_walker(Node *node, cost_qual_eval_context *context);
 static void get_restriction_qual_cost(PlannerInfo *root, RelOptInfo *baserel,
 						  ParamPathInfo *param_info,
@@ -364,6 +374,7 @@ cost_index(IndexPath *path, PlannerInfo *root, double loop_count)
 	IndexOptInfo *index = path->indexinfo;
 	RelOptInfo *baserel = index->rel;
 	bool		indexonly = (path->path.pathtype == T_IndexOnlyScan);
+	amcostestimate_function amcostestimate;
 	List	   *qpquals;
 	Cost		startup_cost = 0;
 	Cost		run_cost = 0;
@@ -419,14 +430,10 @@ cost_index(IndexPath *path, PlannerInfo *root, double loop_count)
 	 * the fraction of main-table tuples we will have to retrieve) and its
 	 * correlation to the main-table tuple order.
 	 */
-	OidFunctionCall7(index->amcostestimate,
-					 PointerGetDatum(root),
-					 PointerGetDatum(path),
-					 Float8GetDatum(loop_count),
-					 PointerGetDatum(&indexStartupCost),
-					 PointerGetDatum(&indexTotalCost),
-					 PointerGetDatum(&indexSelectivity),
-					 PointerGetDatum(&indexCorrelation));
+	amcostestimate = (amcostestimate_function) index->amcostestimate;
+	amcostestimate(root, path, loop_count,
+				   &indexStartupCost, &indexTotalCost,
+				   &indexSelectivity, &indexCorrelation);
 
 	/*
 	 * Save amcostestimate's results for possible use in bitmap scan planning.
@@ -1361,8 +1368,8 @@ cost_recursive_union(Plan *runion, Plan *nrterm, Plan *rterm)
  * total, but we will also need to write and read each tuple once per
  * merge pass.  We expect about ceil(logM(r)) merge passes where r is the
  * number of initial runs formed and M is the merge order used by tuplesort.c.
- * Since the average initial run should be about twice sort_mem, we have
- *		disk traffic = 2 * relsize * ceil(logM(p / (2*sort_mem)))
+ * Since the average initial run should be about sort_mem, we have
+ *		disk traffic = 2 * relsize * ceil(logM(p / sort_mem))
  *		cpu = comparison_cost * t * log2(t)
  *
  * If the sort is bounded (i.e., only the first k result tuples are needed)
@@ -1398,17 +1405,42 @@ cost_sort(Path *path, PlannerInfo *root,
 		  Cost comparison_cost, int sort_mem,
 		  double limit_tuples)
 {
-	Cost		startup_cost = input_cost;
-	Cost		run_cost = 0;
-	double		input_bytes = relation_byte_size(tuples, width);
-	double		output_bytes;
-	double		output_tuples;
-	long		sort_mem_bytes = sort_mem * 1024L;
+	Cost		startup_cost;
+	Cost		run_cost;
+
+	cost_tuplesort(&startup_cost, &run_cost,
+				   tuples, width, comparison_cost, sort_mem,
+				   limit_tuples);
 
 	if (!enable_sort)
 		startup_cost += disable_cost;
 
+	startup_cost += input_cost;
+
 	path->rows = tuples;
+	path->startup_cost = startup_cost;
+	path->total_cost = startup_cost + run_cost;
+}
+
+/*
+ * cost_tuplesort
+ *	  Determines the cost of sorting 'tuples' tuples with tuplesort.c, not
+ *	  including the cost of reading the input.  This is the guts of
+ *	  cost_sort(), which see for the meaning of the parameters.
+ */
+static void
+cost_tuplesort(Cost *startup_cost, Cost *run_cost,
+			   double tuples, int width,
+			   Cost comparison_cost, int sort_mem,
+			   double limit_tuples)
+{
+	double		input_bytes = relation_byte_size(tuples, width);
+	double		output_bytes;
+	double		output_tuples;
+	long		sort_mem_bytes = sort_mem * 1024L;
+
+	*startup_cost = 0;
+	*run_cost = 0;
 
 	/*
 	 * We want to be sure the cost of a sort is never estimated as zero, even
@@ -1438,7 +1470,7 @@ cost_sort(Path *path, PlannerInfo *root,
 		 * We'll have to use a disk-based sort of all the tuples
 		 */
 		double		npages = ceil(input_bytes / BLCKSZ);
-		double		nruns = (input_bytes / sort_mem_bytes) * 0.5;
+		double		nruns = input_bytes / sort_mem_bytes;
 		double		mergeorder = tuplesort_merge_order(sort_mem_bytes);
 		double		log_runs;
 		double		npageaccesses;
@@ -1448,7 +1480,7 @@ cost_sort(Path *path, PlannerInfo *root,
 		 *
 		 * Assume about N log2 N comparisons
 		 */
-		startup_cost += comparison_cost * tuples * LOG2(tuples);
+		*startup_cost += comparison_cost * tuples * LOG2(tuples);
 
 		/* Disk costs */
 
@@ -1459,7 +1491,7 @@ cost_sort(Path *path, PlannerInfo *root,
 			log_runs = 1.0;
 		npageaccesses = 2.0 * npages * log_runs;
 		/* Assume 3/4ths of accesses are sequential, 1/4th are not */
-		startup_cost += npageaccesses *
+		*startup_cost += npageaccesses *
 			(seq_page_cost * 0.75 + random_page_cost * 0.25);
 	}
 	else if (tuples > 2 * output_tuples || input_bytes > sort_mem_bytes)
@@ -1470,12 +1502,12 @@ cost_sort(Path *path, PlannerInfo *root,
 		 * factor is a bit higher than for quicksort.  Tweak it so that the
 		 * cost curve is continuous at the crossover point.
 		 */
-		startup_cost += comparison_cost * tuples * LOG2(2.0 * output_tuples);
+		*startup_cost += comparison_cost * tuples * LOG2(2.0 * output_tuples);
 	}
 	else
 	{
 		/* We'll use plain quicksort on all the input tuples */
-		startup_cost += comparison_cost * tuples * LOG2(tuples);
+		*startup_cost += comparison_cost * tuples * LOG2(tuples);
 	}
 
 	/*
@@ -1486,7 +1518,94 @@ cost_sort(Path *path, PlannerInfo *root,
 	 * here --- the upper LIMIT will pro-rate the run cost so we'd be double
 	 * counting the LIMIT otherwise.
 	 */
-	run_cost += cpu_operator_cost * tuples;
+	*run_cost += cpu_operator_cost * tuples;
+}
+
+/*
+ * cost_incremental_sort
+ *	  Determines and returns the cost of an incremental sort, that is of
+ *	  sorting input that is already sorted on the first 'presorted_keys'
+ *	  of the 'pathkeys', including the cost of reading the input data.
+ *
+ * The input falls into groups of tuples that are equal on the presorted
+ * keys, and each group is sorted separately.  We estimate the number of
+ * groups with estimate_num_groups() on the presorted key expressions, and
+ * charge each group as a separate sort of the average group size.  Unlike
+ * a full sort, the first output tuple is available as soon as the first
+ * group has been read and sorted, which is what makes this attractive under
+ * a LIMIT; hence the input's startup and total cost are passed separately.
+ *
+ * The other parameters are as for cost_sort().
+ */
+void
+cost_incremental_sort(Path *path, PlannerInfo *root,
+					  List *pathkeys, int presorted_keys,
+					  Cost input_startup_cost, Cost input_total_cost,
+					  double input_tuples, int width, Cost comparison_cost,
+					  int sort_mem, double limit_tuples)
+{
+	Cost		startup_cost;
+	Cost		run_cost;
+	Cost		input_run_cost = input_total_cost - input_startup_cost;
+	double		input_groups;
+	double		group_tuples;
+	Cost		group_startup_cost;
+	Cost		group_run_cost;
+	Cost		group_input_run_cost;
+	List	   *presortedExprs = NIL;
+	ListCell   *l;
+
+	Assert(presorted_keys > 0 && presorted_keys < list_length(pathkeys));
+
+	path->rows = input_tuples;
+
+	/* Mustn't do log(0), and avoid dividing by zero below */
+	if (input_tuples < 2.0)
+		input_tuples = 2.0;
+
+	/* Estimate the number of groups of equal presorted keys */
+	foreach(l, pathkeys)
+	{
+		PathKey    *key = (PathKey *) lfirst(l);
+		EquivalenceMember *member = (EquivalenceMember *)
+		linitial(key->pk_eclass->ec_members);
+
+		presortedExprs = lappend(presortedExprs, member->em_expr);
+		if (list_length(presortedExprs) >= presorted_keys)
+			break;
+	}
+
+	input_groups = estimate_num_groups(root, presortedExprs, input_tuples,
+									   NULL);
+	group_tuples = input_tuples / input_groups;
+	group_input_run_cost = input_run_cost / input_groups;
+
+	/* Cost of sorting a single group */
+	cost_tuplesort(&group_startup_cost, &group_run_cost,
+				   group_tuples, width, comparison_cost, sort_mem,
+				   limit_tuples);
+
+	/*
+	 * The first group has to be read and sorted before we can return
+	 * anything; all the other groups are read, sorted and returned as the
+	 * output is consumed.
+	 */
+	startup_cost = input_startup_cost + group_input_run_cost +
+		group_startup_cost;
+	run_cost = group_run_cost +
+		(group_input_run_cost + group_startup_cost + group_run_cost) *
+		(input_groups - 1);
+
+	/*
+	 * Charge for comparing the presorted keys of each input tuple with those
+	 * of the current group, and for setting up a tuplesort per group.
+	 */
+	run_cost += (cpu_tuple_cost + presorted_keys * cpu_operator_cost) *
+		input_tuples;
+	run_cost += 2.0 * cpu_tuple_cost * input_groups;
+
+	if (!enable_sort || !enable_incrementalsort)
+		startup_cost += disable_cost;
 
 	path->startup_cost = startup_cost;
 	path->total_cost = startup_cost + run_cost;
@@ -3074,6 +3193,10 @@ cost_rescan(PlannerInfo *root, Path *path,
 				*rescan_total_cost = run_cost;
 			}
 			break;
+		case T_Memoize:
+			cost_memoize_rescan(root, (MemoizePath *) path,
+								rescan_startup_cost, rescan_total_cost);
+			break;
 		default:
 			*rescan_startup_cost = path->startup_cost;
 			*rescan_total_cost = path->total_cost;
@@ -3081,6 +3204,75 @@ cost_rescan(PlannerInfo *root, Path *path,
 	}
 }
 
+/*
+ * cost_memoize_rescan
+ *		Estimate the average cost of rescanning a Memoize path.
+ *
+ * The number of distinct cache keys among the expected calls tells us how
+ * many rescans will find their results already cached, given that only as
+ * many entries as fit in work_mem can be kept.  A hit costs just the
+ * replaying of the cached tuples; a miss costs a rescan of the subpath plus
+ * storing its output, and possibly evicting an older entry.
+ *
+ * As a side effect, we set mpath->est_entries, which the executor uses to
+ * size its hash table.
+ */
+static void
+cost_memoize_rescan(PlannerInfo *root, MemoizePath *mpath,
+					Cost *rescan_startup_cost, Cost *rescan_total_cost)
+{
+	Path	   *subpath = mpath->subpath;
+	double		tuples = subpath->rows;
+	double		calls = Max(mpath->calls, 1.0);
+	int			nkeys = list_length(mpath->param_exprs);
+	Cost		input_startup_cost;
+	Cost		input_total_cost;
+	double		est_entry_bytes;
+	double		est_cache_entries;
+	double		ndistinct;
+	double		cached_ratio;
+	double		hit_ratio;
+	Cost		key_cost;
+	Cost		hit_cost;
+	Cost		miss_startup_cost;
+	Cost		miss_cost;
+
+	cost_rescan(root, subpath, &input_startup_cost, &input_total_cost);
+
+	/* Estimate how many cache entries will fit in work_mem */
+	est_entry_bytes = relation_byte_size(tuples, subpath->parent->width) +
+		relation_byte_size(1.0, nkeys * sizeof(Datum));
+	est_cache_entries = floor((work_mem * 1024.0) / est_entry_bytes);
+
+	/* Estimate the number of distinct sets of key values we'll be called with */
+	ndistinct = estimate_num_groups(root, mpath->param_exprs, calls, NULL);
+	ndistinct = clamp_row_est(Min(ndistinct, calls));
+
+	mpath->est_entries = (uint32) Min(Min(ndistinct, est_cache_entries),
+									  PG_UINT32_MAX);
+
+	/*
+	 * Each set of key values misses the first time it is seen.  After that
+	 * it hits, unless its entry has been evicted in the meantime, which we
+	 * assume happens in proportion to the keys that don't fit in the cache.
+	 */
+	cached_ratio = Min(est_cache_entries, ndistinct) / ndistinct;
+	hit_ratio = ((calls - ndistinct) / calls) * cached_ratio;
+	hit_ratio = Max(hit_ratio, 0.0);
+
+	/* Every call evaluates and hashes the keys */
+	key_cost = cpu_operator_cost * nkeys;
+	hit_cost = key_cost + cpu_tuple_cost * tuples;
+	miss_startup_cost = key_cost + input_startup_cost;
+	miss_cost = key_cost + input_total_cost + cpu_operator_cost * tuples +
+		(1.0 - cached_ratio) * cpu_tuple_cost * tuples;
+
+	*rescan_startup_cost = hit_ratio * key_cost +
+		(1.0 - hit_ratio) * miss_startup_cost;
+	*rescan_total_cost = hit_ratio * hit_cost +
+		(1.0 - hit_ratio) * miss_cost;
+}
+
 
 /*
  * cost_qual_eval
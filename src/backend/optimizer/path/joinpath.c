@@ -18,9 +18,13 @@
 
 #include "executor/executor.h"
 #include "foreign/fdwapi.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
+#include "utils/lsyscache.h"
+#include "utils/typcache.h"
 
 /* Hook for plugins to get control in add_paths_to_joinrel() */
 set_join_pathlist_hook_type set_join_pathlist_hook = NULL;
@@ -34,6 +38,9 @@ static void sort_inner_and_outer(PlannerInfo *root, RelOptInfo *joinrel,
 static void match_unsorted_outer(PlannerInfo *root, RelOptInfo *joinrel,
 					 RelOptInfo *outerrel, RelOptInfo *innerrel,
 					 JoinType jointype, JoinPathExtraData *extra);
+static Path *get_memoize_path(PlannerInfo *root, RelOptInfo *innerrel,
+				 RelOptInfo *outerrel, Path *inner_path,
+				 Path *outer_path, JoinType jointype);
 static void hash_inner_and_outer(PlannerInfo *root, RelOptInfo *joinrel,
 					 RelOptInfo *outerrel, RelOptInfo *innerrel,
 					 JoinType jointype, JoinPathExtraData *extra);
@@ -948,6 +955,7 @@ match_unsorted_outer(PlannerInfo *root,
 			foreach(lc2, innerrel->cheapest_parameterized_paths)
 			{
 				Path	   *innerpath = (Path *) lfirst(lc2);
+				Path	   *mpath;
 
 				try_nestloop_path(root,
 								  joinrel,
@@ -956,6 +964,21 @@ match_unsorted_outer(PlannerInfo *root,
 								  merge_pathkeys,
 								  jointype,
 								  extra);
+
+				/*
+				 * Also consider caching the results of a parameterized inner
+				 * path, for outer rows with repeated parameter values.
+				 */
+				mpath = get_memoize_path(root, innerrel, outerrel,
+										 innerpath, outerpath, jointype);
+				if (mpath != NULL)
+					try_nestloop_path(root,
+									  joinrel,
+									  outerpath,
+									  mpath,
+									  merge_pathkeys,
+									  jointype,
+									  extra);
 			}
 
 			/* Also consider materialized form of the cheapest inner path */
@@ -1175,6 +1198,99 @@ match_unsorted_outer(PlannerInfo *root,
 	}
 }
 
+/*
+ * get_memoize_path
+ *	  If possible, make a Memoize path to cache the results of 'inner_path',
+ *	  a path parameterized by the outer rel, across the rescans made by a
+ *	  nestloop with 'outer_path'.  Returns NULL if that isn't possible.
+ *
+ * The cache keys are the outer-side expressions of the inner path's
+ * parameterized join clauses.  Each must be hashable, and nothing but those
+ * clauses may make the inner path's output depend on the outer rel, else
+ * cached results could be reused when they should not be.
+ */
+static Path *
+get_memoize_path(PlannerInfo *root, RelOptInfo *innerrel,
+				 RelOptInfo *outerrel, Path *inner_path,
+				 Path *outer_path, JoinType jointype)
+{
+	List	   *param_exprs = NIL;
+	List	   *hash_operators = NIL;
+	ListCell   *lc;
+
+	if (!enable_memoize)
+		return NULL;
+
+	/* Only a path parameterized by the outer rel alone is of interest */
+	if (inner_path->param_info == NULL ||
+		!bms_is_subset(PATH_REQ_OUTER(inner_path), outerrel->relids))
+		return NULL;
+
+	/*
+	 * Semi and anti joins usually stop reading the inner side after the
+	 * first match, leaving no complete results to cache.
+	 */
+	if (jointype != JOIN_INNER && jointype != JOIN_LEFT)
+		return NULL;
+
+	/* With a single outer row, there is nothing to reuse */
+	if (outer_path->rows < 2)
+		return NULL;
+
+	/*
+	 * Stick to plain base relations, whose only references to the outer rel
+	 * are the parameterized join clauses.  Also, volatile functions in the
+	 * relation's quals or output would make reusing its results wrong.
+	 */
+	if (innerrel->reloptkind != RELOPT_BASEREL ||
+		!bms_is_empty(innerrel->lateral_relids))
+		return NULL;
+	if (contain_volatile_functions((Node *) innerrel->baserestrictinfo) ||
+		contain_volatile_functions((Node *) innerrel->reltargetlist))
+		return NULL;
+
+	foreach(lc, inner_path->param_info->ppi_clauses)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		Expr	   *expr;
+		Oid			exprtype;
+		TypeCacheEntry *typentry;
+
+		if (!is_opclause(rinfo->clause) ||
+			list_length(((OpExpr *) rinfo->clause)->args) != 2 ||
+			contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+
+		if (bms_is_subset(rinfo->left_relids, outerrel->relids) &&
+			bms_is_subset(rinfo->right_relids, innerrel->relids))
+			expr = (Expr *) get_leftop(rinfo->clause);
+		else if (bms_is_subset(rinfo->right_relids, outerrel->relids) &&
+				 bms_is_subset(rinfo->left_relids, innerrel->relids))
+			expr = (Expr *) get_rightop(rinfo->clause);
+		else
+			return NULL;
+
+		/* We need a hashable equality operator for the key's type */
+		exprtype = exprType((Node *) expr);
+		typentry = lookup_type_cache(exprtype, TYPECACHE_EQ_OPR);
+		if (!OidIsValid(typentry->eq_opr) ||
+			!op_hashjoinable(typentry->eq_opr, exprtype))
+			return NULL;
+
+		if (list_member(param_exprs, expr))
+			continue;
+		param_exprs = lappend(param_exprs, expr);
+		hash_operators = lappend_oid(hash_operators, typentry->eq_opr);
+	}
+
+	if (param_exprs == NIL)
+		return NULL;
+
+	return (Path *) create_memoize_path(root, innerrel, inner_path,
+										param_exprs, hash_operators,
+										outer_path->rows);
+}
+
 /*
  * hash_inner_and_outer
  *	  Create hashjoin join paths by explicitly hashing both the outer and
@@ -103,6 +103,13 @@ static bool choose_hashed_distinct(PlannerInfo *root,
 					   Cost sorted_startup_cost, Cost sorted_total_cost,
 					   List *sorted_pathkeys,
 					   double dNumDistinctRows);
+static Path *choose_incremental_sort_path(PlannerInfo *root, List *pathlist,
+							 Path *cheapest_path,
+							 double path_rows, int path_width,
+							 double tuple_fraction);
+static bool incremental_sort_is_cheaper(PlannerInfo *root, Plan *lefttree,
+							List *pathkeys, int presorted_keys,
+							double tuple_fraction, double limit_tuples);
 static List *make_subplanTargetList(PlannerInfo *root, List *tlist,
 					   AttrNumber **groupColIdx, bool *need_tlist_eval);
 static int	get_grouping_column_index(Query *parse, TargetEntry *tle);
@@ -1805,6 +1812,23 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 			}
 		}
 
+		/*
+		 * For a plain ORDER BY query with no fully presorted path worth
+		 * having, a path sorted on a leading subset of the wanted ordering
+		 * may still be a good bet: an incremental sort on top of it need only
+		 * sort each group of equal prefix keys, and can return its first
+		 * tuples without reading all of its input.
+		 */
+		if (!sorted_path && enable_incrementalsort &&
+			root->query_pathkeys != NIL &&
+			!parse->groupClause && !parse->groupingSets &&
+			!parse->distinctClause && !parse->hasAggs &&
+			!root->hasHavingQual && !activeWindows)
+			sorted_path = choose_incremental_sort_path(root, final_rel->pathlist,
+													   cheapest_path,
+													   path_rows, path_width,
+													   tuple_fraction);
+
 		/*
 		 * Consider whether we want to use hashing instead of sorting.
 		 */
@@ -2366,10 +2390,23 @@ grouping_planner(PlannerInfo *root, double tuple_fraction)
 	{
 		if (!pathkeys_contained_in(root->sort_pathkeys, current_pathkeys))
 		{
-			result_plan = (Plan *) make_sort_from_pathkeys(root,
-														   result_plan,
+			int			n_common;
+
+			n_common = pathkeys_common(root->sort_pathkeys, current_pathkeys);
+			if (enable_incrementalsort && n_common > 0 &&
+				incremental_sort_is_cheaper(root, result_plan,
+											root->sort_pathkeys, n_common,
+											tuple_fraction, limit_tuples))
+				result_plan = make_incrementalsort_from_pathkeys(root,
+																 result_plan,
 														 root->sort_pathkeys,
-														   limit_tuples);
+																 n_common,
+																 limit_tuples);
+			else
+				result_plan = (Plan *) make_sort_from_pathkeys(root,
+															   result_plan,
+														 root->sort_pathkeys,
+															   limit_tuples);
 			current_pathkeys = root->sort_pathkeys;
 		}
 	}
@@ -3918,6 +3955,98 @@ choose_hashed_distinct(PlannerInfo *root,
 	return false;
 }
 
+/*
+ * choose_incremental_sort_path
+ *		Look for a path that is sorted on a leading subset of
+ *		root->query_pathkeys and that, completed by an incremental sort,
+ *		beats an explicit sort of the cheapest-total path.
+ *
+ * The comparison is made at the tuple_fraction point, as for the fully
+ * presorted path.  Returns the winning path, or NULL if there is none.
+ */
+static Path *
+choose_incremental_sort_path(PlannerInfo *root, List *pathlist,
+							 Path *cheapest_path,
+							 double path_rows, int path_width,
+							 double tuple_fraction)
+{
+	int			n_query_keys = list_length(root->query_pathkeys);
+	Path	   *best_path = NULL;
+	Path		best_p;
+	Path		sort_p;
+	ListCell   *l;
+
+	/* Nothing to gain if the cheapest path needs no sort at all */
+	if (pathkeys_contained_in(root->query_pathkeys, cheapest_path->pathkeys))
+		return NULL;
+
+	cost_sort(&sort_p, root, root->query_pathkeys,
+			  cheapest_path->total_cost,
+			  path_rows, path_width,
+			  0.0, work_mem, root->limit_tuples);
+
+	foreach(l, pathlist)
+	{
+		Path	   *path = (Path *) lfirst(l);
+		Path		incsort_p;
+		int			n_common;
+
+		/* Parameterized paths are of no use at the top level */
+		if (path->param_info)
+			continue;
+
+		n_common = pathkeys_common(root->query_pathkeys, path->pathkeys);
+		if (n_common == 0 || n_common >= n_query_keys)
+			continue;
+
+		cost_incremental_sort(&incsort_p, root, root->query_pathkeys,
+							  n_common,
+							  path->startup_cost, path->total_cost,
+							  path_rows, path_width,
+							  0.0, work_mem, root->limit_tuples);
+
+		if (compare_fractional_path_costs(&incsort_p, &sort_p,
+										  tuple_fraction) >= 0)
+			continue;
+		if (best_path == NULL ||
+			compare_fractional_path_costs(&incsort_p, &best_p,
+										  tuple_fraction) < 0)
+		{
+			best_path = path;
+			best_p.startup_cost = incsort_p.startup_cost;
+			best_p.total_cost = incsort_p.total_cost;
+		}
+	}
+
+	return best_path;
+}
+
+/*
+ * incremental_sort_is_cheaper
+ *		Decide whether to finish lefttree, already sorted on the first
+ *		presorted_keys of pathkeys, with an incremental sort rather than a
+ *		full sort.
+ */
+static bool
+incremental_sort_is_cheaper(PlannerInfo *root, Plan *lefttree,
+							List *pathkeys, int presorted_keys,
+							double tuple_fraction, double limit_tuples)
+{
+	Path		sort_p;
+	Path		incsort_p;
+
+	cost_sort(&sort_p, root, pathkeys, lefttree->total_cost,
+			  lefttree->plan_rows, lefttree->plan_width,
+			  0.0, work_mem, limit_tuples);
+	cost_incremental_sort(&incsort_p, root, pathkeys, presorted_keys,
+						  lefttree->startup_cost, lefttree->total_cost,
+						  lefttree->plan_rows, lefttree->plan_width,
+						  0.0, work_mem, limit_tuples);
+
+	return compare_fractional_path_costs(&incsort_p, &sort_p,
+										 tuple_fraction) < 0;
+}
+
 /*
  * make_subplanTargetList
  *	  Generate appropriate target list when grouping is required.
@@ -4699,7 +4828,7 @@ plan_cluster_use_sort(Oid tableOid, Oid indexOid)
 	/* Estimate the cost of index scan */
 	indexScanPath = create_index_path(root, indexInfo,
 									  NIL, NIL, NIL, NIL, NIL,
-									  ForwardScanDirection, false,
+									  ForwardScanDirection, false, false,
 									  NULL, 1.0);
 
 	return (seqScanAndSortPath.total_cost < indexScanPath->path.total_cost);
@@ -609,6 +609,7 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 		case T_Hash:
 		case T_Material:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 
@@ -627,6 +628,22 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 			 */
 			Assert(plan->qual == NIL);
 			break;
+		case T_Memoize:
+			{
+				Memoize    *mplan = (Memoize *) plan;
+
+				/*
+				 * Like the plan types above, Memoize doesn't evaluate its
+				 * tlist or quals.  Its cache keys contain only nestloop
+				 * params and expressions over them, so fix_scan_expr works.
+				 */
+				set_dummy_tlist_references(plan, rtoffset);
+				Assert(mplan->plan.qual == NIL);
+
+				mplan->param_exprs =
+					fix_scan_list(root, mplan->param_exprs, rtoffset);
+			}
+			break;
 		case T_LockRows:
 			{
 				LockRows   *splan = (LockRows *) plan;
@@ -752,6 +752,8 @@ create_samplescan_path(PlannerInfo *root, RelOptInfo *rel, Relids required_outer
  *			for an ordered index, or NoMovementScanDirection for
  *			an unordered index.
  * 'indexonly' is true if an index-only scan is wanted.
+ * 'indexskip' is true if the scan should skip over distinct values of the
+ *			first index column (see IndexPath).
  * 'required_outer' is the set of outer relids for a parameterized path.
  * 'loop_count' is the number of repetitions of the indexscan to factor into
  *		estimates of caching behavior.
@@ -768,6 +770,7 @@ create_index_path(PlannerInfo *root,
 				  List *pathkeys,
 				  ScanDirection indexscandir,
 				  bool indexonly,
+				  bool indexskip,
 				  Relids required_outer,
 				  double loop_count)
 {
@@ -795,6 +798,7 @@ create_index_path(PlannerInfo *root,
 	pathnode->indexorderbys = indexorderbys;
 	pathnode->indexorderbycols = indexorderbycols;
 	pathnode->indexscandir = indexscandir;
+	pathnode->indexskip = indexskip;
 
 	cost_index(pathnode, root, loop_count);
 
@@ -1107,6 +1111,52 @@ create_material_path(RelOptInfo *rel, Path *subpath)
 	return pathnode;
 }
 
+/*
+ * create_memoize_path
+ *	  Creates a path corresponding to a Memoize plan, returning the
+ *	  pathnode.
+ *
+ * 'param_exprs' are the expressions supplying the subpath's parameters,
+ * 'hash_operators' the equality operators to compare them with, and
+ * 'calls' the number of times the path is expected to be rescanned.
+ */
+MemoizePath *
+create_memoize_path(PlannerInfo *root, RelOptInfo *rel, Path *subpath,
+					List *param_exprs, List *hash_operators, double calls)
+{
+	MemoizePath *pathnode = makeNode(MemoizePath);
+
+	Assert(subpath->parent == rel);
+
+	pathnode->path.pathtype = T_Memoize;
+	pathnode->path.parent = rel;
+	pathnode->path.param_info = subpath->param_info;
+	pathnode->path.parallel_aware = false;
+	pathnode->path.pathkeys = subpath->pathkeys;
+
+	pathnode->subpath = subpath;
+	pathnode->hash_operators = hash_operators;
+	pathnode->param_exprs = param_exprs;
+	pathnode->calls = calls;
+
+	/* filled in by cost_rescan, when the path is costed as a join inner */
+	pathnode->est_entries = 0;
+
+	/*
+	 * The first scan is always a cache miss, so charge the subpath's costs
+	 * plus a little for evaluating the keys and storing the tuples.  The
+	 * savings come on rescans; see cost_rescan.
+	 */
+	pathnode->path.rows = subpath->rows;
+	pathnode->path.startup_cost = subpath->startup_cost +
+		cpu_operator_cost * list_length(param_exprs);
+	pathnode->path.total_cost = subpath->total_cost +
+		cpu_operator_cost * list_length(param_exprs) +
+		cpu_operator_cost * subpath->rows;
+
+	return pathnode;
+}
+
 /*
  * create_unique_path
  *	  Creates a path representing elimination of distinct rows from the
@@ -31,10 +31,14 @@
  *	  smallest current LSN from the heap.
  *
  *	  In order to cope with large transactions - which can be several times as
- *	  big as the available memory - this module supports spooling the contents
- *	  of a large transactions to disk. When the transaction is replayed the
- *	  contents of individual (sub-)transactions will be read from disk in
- *	  chunks.
+ *	  big as the available memory - this module keeps track of the memory used
+ *	  by the changes of all transactions, and once that exceeds
+ *	  logical_decoding_work_mem evicts the largest transaction from memory.
+ *	  If the output plugin supports it, and the transaction's contents can
+ *	  already be decoded, it is streamed to the plugin before it committed (c.f.
+ *	  ReorderBufferStreamTXN()); otherwise its contents are spooled to disk.
+ *	  When a spooled transaction is replayed the contents of individual
+ *	  (sub-)transactions will be read from disk in chunks.
  *
  *	  This module also has to deal with reassembling toast records from the
  *	  individual chunks stored in WAL. When a new (or initial) version of a
@@ -61,7 +65,7 @@
 #include "replication/logical.h"
 #include "replication/reorderbuffer.h"
 #include "replication/slot.h"
-#include "replication/snapbuild.h"		/* just for SnapBuildSnapDecRefcount */
+#include "replication/snapbuild.h"
 #include "storage/bufmgr.h"
 #include "storage/fd.h"
 #include "storage/sinval.h"
@@ -136,29 +140,17 @@ typedef struct ReorderBufferDiskChange
 } ReorderBufferDiskChange;
 
 /*
- * Maximum number of changes kept in memory, per transaction. After that,
- * changes are spooled to disk.
- *
- * The current value should be sufficient to decode the entire transaction
- * without hitting disk in OLTP workloads, while starting to spool to disk in
- * other workloads reasonably fast.
- *
- * At some point in the future it probably makes sense to have a more elaborate
- * resource management here, but it's not entirely clear what that would look
- * like.
+ * Memory that may be used by the changes of all transactions in a reorder
+ * buffer, in kilobytes.  Once that is exceeded the largest transaction is
+ * streamed or spooled to disk.
  */
-static const Size max_changes_in_memory = 4096;
+int			logical_decoding_work_mem = 65536;
 
 /*
- * We use a very simple form of a slab allocator for frequently allocated
- * objects, simply keeping a fixed number in a linked list when unused,
- * instead pfree()ing them. Without that in many workloads aset.c becomes a
- * major bottleneck, especially when spilling to disk while decoding batch
- * workloads.
+ * Maximum number of changes of a spooled transaction that are read back into
+ * memory at once, when replaying it.
  */
-static const Size max_cached_changes = 4096 * 2;
-static const Size max_cached_tuplebufs = 4096 * 2;		/* ~8MB */
-static const Size max_cached_transactions = 512;
+static const Size max_changes_in_memory = 4096;
 
 
 /* ---------------------------------------
@@ -172,6 +164,8 @@ static ReorderBufferTXN *ReorderBufferTXNByXid(ReorderBuffer *rb,
 					  XLogRecPtr lsn, bool create_as_top);
 
 static void AssertTXNLsnOrder(ReorderBuffer *rb);
+static void ReorderBufferTransferSnapToParent(ReorderBufferTXN *txn,
+								  ReorderBufferTXN *subtxn);
 
 /* ---------------------------------------
  * support functions for lsn-order iterating over the ->changes of a
@@ -187,14 +181,34 @@ static ReorderBufferChange *
 static void ReorderBufferIterTXNFinish(ReorderBuffer *rb,
 						   ReorderBufferIterTXNState *state);
 static void ReorderBufferExecuteInvalidations(ReorderBuffer *rb, ReorderBufferTXN *txn);
+static void ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
+						XLogRecPtr commit_lsn, volatile Snapshot snapshot_now,
+						volatile CommandId command_id, bool streaming);
+
+/* ---------------------------------------
+ * memory accounting and streaming of in-progress transactions
+ * ---------------------------------------
+ */
+static Size ReorderBufferChangeSize(ReorderBufferChange *change);
+static void ReorderBufferChangeMemoryUpdate(ReorderBuffer *rb,
+								ReorderBufferChange *change,
+								ReorderBufferTXN *txn, bool addition);
+static void ReorderBufferCheckMemoryLimit(ReorderBuffer *rb);
+static ReorderBufferTXN *ReorderBufferLargestTXN(ReorderBuffer *rb);
+static ReorderBufferTXN *ReorderBufferLargestTopTXN(ReorderBuffer *rb);
+static bool ReorderBufferCanStream(ReorderBuffer *rb);
+static bool ReorderBufferCanStreamTXN(ReorderBufferTXN *txn);
+static void ReorderBufferStreamTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
+static void ReorderBufferTruncateTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
 
 /*
  * ---------------------------------------
  * Disk serialization support functions
  * ---------------------------------------
  */
-static void ReorderBufferCheckSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
 static void ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn);
+static void ReorderBufferSerializeRemaining(ReorderBuffer *rb,
+								ReorderBufferTXN *txn);
 static void ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 							 int fd, ReorderBufferChange *change);
 static Size ReorderBufferRestoreChanges(ReorderBuffer *rb, ReorderBufferTXN *txn,
@@ -243,6 +257,20 @@ ReorderBufferAllocate(void)
 
 	buffer->context = new_ctx;
 
+	buffer->change_context = SlabContextCreate(new_ctx,
+											   "Change",
+											   SLAB_DEFAULT_BLOCK_SIZE,
+											   sizeof(ReorderBufferChange));
+
+	buffer->txn_context = SlabContextCreate(new_ctx,
+											"TXN",
+											SLAB_DEFAULT_BLOCK_SIZE,
+											sizeof(ReorderBufferTXN));
+
+	buffer->tup_context = GenerationContextCreate(new_ctx,
+												  "Tuples",
+												  SLAB_LARGE_BLOCK_SIZE);
+
 	hash_ctl.keysize = sizeof(TransactionId);
 	hash_ctl.entrysize = sizeof(ReorderBufferTXNByIdEnt);
 	hash_ctl.hcxt = buffer->context;
@@ -253,19 +281,14 @@ ReorderBufferAllocate(void)
 	buffer->by_txn_last_xid = InvalidTransactionId;
 	buffer->by_txn_last_txn = NULL;
 
-	buffer->nr_cached_transactions = 0;
-	buffer->nr_cached_changes = 0;
-	buffer->nr_cached_tuplebufs = 0;
-
 	buffer->outbuf = NULL;
 	buffer->outbufsize = 0;
 
 	buffer->current_restart_decoding_lsn = InvalidXLogRecPtr;
 
+	buffer->size = 0;
+
 	dlist_init(&buffer->toplevel_by_lsn);
-	dlist_init(&buffer->cached_transactions);
-	dlist_init(&buffer->cached_changes);
-	slist_init(&buffer->cached_tuplebufs);
 
 	return buffer;
 }
@@ -286,26 +309,15 @@ ReorderBufferFree(ReorderBuffer *rb)
 }
 
 /*
- * Get an unused, possibly preallocated, ReorderBufferTXN.
+ * Get an unused ReorderBufferTXN.
  */
 static ReorderBufferTXN *
 ReorderBufferGetTXN(ReorderBuffer *rb)
 {
 	ReorderBufferTXN *txn;
 
-	/* check the slab cache */
-	if (rb->nr_cached_transactions > 0)
-	{
-		rb->nr_cached_transactions--;
-		txn = (ReorderBufferTXN *)
-			dlist_container(ReorderBufferTXN, node,
-							dlist_pop_head_node(&rb->cached_transactions));
-	}
-	else
-	{
-		txn = (ReorderBufferTXN *)
-			MemoryContextAlloc(rb->context, sizeof(ReorderBufferTXN));
-	}
+	txn = (ReorderBufferTXN *)
+		MemoryContextAlloc(rb->txn_context, sizeof(ReorderBufferTXN));
 
 	memset(txn, 0, sizeof(ReorderBufferTXN));
 
@@ -318,9 +330,6 @@ ReorderBufferGetTXN(ReorderBuffer *rb)
 
 /*
  * Free a ReorderBufferTXN.
- *
- * Deallocation might be delayed for efficiency purposes, for details check
- * the comments above max_cached_changes's definition.
  */
 static void
 ReorderBufferReturnTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
@@ -346,41 +355,19 @@ ReorderBufferReturnTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 		txn->invalidations = NULL;
 	}
 
-	/* check whether to put into the slab cache */
-	if (rb->nr_cached_transactions < max_cached_transactions)
-	{
-		rb->nr_cached_transactions++;
-		dlist_push_head(&rb->cached_transactions, &txn->node);
-		VALGRIND_MAKE_MEM_UNDEFINED(txn, sizeof(ReorderBufferTXN));
-		VALGRIND_MAKE_MEM_DEFINED(&txn->node, sizeof(txn->node));
-	}
-	else
-	{
-		pfree(txn);
-	}
+	pfree(txn);
 }
 
 /*
- * Get an unused, possibly preallocated, ReorderBufferChange.
+ * Get an unused ReorderBufferChange.
  */
 ReorderBufferChange *
 ReorderBufferGetChange(ReorderBuffer *rb)
 {
 	ReorderBufferChange *change;
 
-	/* check the slab cache */
-	if (rb->nr_cached_changes)
-	{
-		rb->nr_cached_changes--;
-		change = (ReorderBufferChange *)
-			dlist_container(ReorderBufferChange, node,
-							dlist_pop_head_node(&rb->cached_changes));
-	}
-	else
-	{
-		change = (ReorderBufferChange *)
-			MemoryContextAlloc(rb->context, sizeof(ReorderBufferChange));
-	}
+	change = (ReorderBufferChange *)
+		MemoryContextAlloc(rb->change_context, sizeof(ReorderBufferChange));
 
 	memset(change, 0, sizeof(ReorderBufferChange));
 	return change;
@@ -388,13 +375,14 @@ ReorderBufferGetChange(ReorderBuffer *rb)
 
 /*
  * Free an ReorderBufferChange.
- *
- * Deallocation might be delayed for efficiency purposes, for details check
- * the comments above max_cached_changes's definition.
  */
 void
 ReorderBufferReturnChange(ReorderBuffer *rb, ReorderBufferChange *change)
 {
+	/* stop accounting its memory, if we were */
+	if (change->txn != NULL)
+		ReorderBufferChangeMemoryUpdate(rb, change, NULL, false);
+
 	/* free contained data */
 	switch (change->action)
 	{
@@ -428,69 +416,39 @@ ReorderBufferReturnChange(ReorderBuffer *rb, ReorderBufferChange *change)
 			break;
 	}
 
-	/* check whether to put into the slab cache */
-	if (rb->nr_cached_changes < max_cached_changes)
-	{
-		rb->nr_cached_changes++;
-		dlist_push_head(&rb->cached_changes, &change->node);
-		VALGRIND_MAKE_MEM_UNDEFINED(change, sizeof(ReorderBufferChange));
-		VALGRIND_MAKE_MEM_DEFINED(&change->node, sizeof(change->node));
-	}
-	else
-	{
-		pfree(change);
-	}
+	pfree(change);
 }
 
 
 /*
- * Get an unused, possibly preallocated, ReorderBufferTupleBuf
+ * Get a fresh ReorderBufferTupleBuf fitting at least a tuple of size
+ * tuple_len (excluding header overhead).
  */
 ReorderBufferTupleBuf *
-ReorderBufferGetTupleBuf(ReorderBuffer *rb)
+ReorderBufferGetTupleBuf(ReorderBuffer *rb, Size tuple_len)
 {
 	ReorderBufferTupleBuf *tuple;
+	Size		alloc_len;
 
-	/* check the slab cache */
-	if (rb->nr_cached_tuplebufs)
-	{
-		rb->nr_cached_tuplebufs--;
-		tuple = slist_container(ReorderBufferTupleBuf, node,
-								slist_pop_head_node(&rb->cached_tuplebufs));
-#ifdef USE_ASSERT_CHECKING
-		memset(tuple, 0xa9, sizeof(ReorderBufferTupleBuf));
-#endif
-	}
-	else
-	{
-		tuple = (ReorderBufferTupleBuf *)
-			MemoryContextAlloc(rb->context, sizeof(ReorderBufferTupleBuf));
-	}
+	alloc_len = tuple_len + SizeofHeapTupleHeader;
+
+	tuple = (ReorderBufferTupleBuf *)
+		MemoryContextAlloc(rb->tup_context,
+						   sizeof(ReorderBufferTupleBuf) +
+						   MAXIMUM_ALIGNOF + alloc_len);
+	tuple->alloc_tuple_size = alloc_len;
+	tuple->tuple.t_data = ReorderBufferTupleBufData(tuple);
 
 	return tuple;
 }
 
 /*
  * Free an ReorderBufferTupleBuf.
- *
- * Deallocation might be delayed for efficiency purposes, for details check
- * the comments above max_cached_changes's definition.
  */
 void
 ReorderBufferReturnTupleBuf(ReorderBuffer *rb, ReorderBufferTupleBuf *tuple)
 {
-	/* check whether to put into the slab cache */
-	if (rb->nr_cached_tuplebufs < max_cached_tuplebufs)
-	{
-		rb->nr_cached_tuplebufs++;
-		slist_push_head(&rb->cached_tuplebufs, &tuple->node);
-		VALGRIND_MAKE_MEM_UNDEFINED(tuple, sizeof(ReorderBufferTupleBuf));
-		VALGRIND_MAKE_MEM_DEFINED(&tuple->node, sizeof(tuple->node));
-	}
-	else
-	{
-		pfree(tuple);
-	}
+	pfree(tuple);
 }
 
 /*
@@ -596,7 +554,8 @@ ReorderBufferQueueChange(ReorderBuffer *rb, TransactionId xid, XLogRecPtr lsn,
 	txn->nentries++;
 	txn->nentries_mem++;
 
-	ReorderBufferCheckSerializeTXN(rb, txn);
+	ReorderBufferChangeMemoryUpdate(rb, change, txn, true);
+	ReorderBufferCheckMemoryLimit(rb);
 }
 
 static void
@@ -668,12 +627,15 @@ ReorderBufferAssignChild(ReorderBuffer *rb, TransactionId xid,
 		 * that have not yet produced any records. Knowing those aren't top
 		 * level xids allows us to make processing cheaper in some places.
 		 */
+		subtxn->is_known_as_subxact = true;
+		subtxn->toptxn = txn;
 		dlist_push_tail(&txn->subtxns, &subtxn->node);
 		txn->nsubtxns++;
 	}
 	else if (!subtxn->is_known_as_subxact)
 	{
 		subtxn->is_known_as_subxact = true;
+		subtxn->toptxn = txn;
 		Assert(subtxn->nsubtxns == 0);
 
 		/* remove from lsn order list of top-level transactions */
@@ -682,6 +644,9 @@ ReorderBufferAssignChild(ReorderBuffer *rb, TransactionId xid,
 		/* add to toplevel transaction */
 		dlist_push_tail(&txn->subtxns, &subtxn->node);
 		txn->nsubtxns++;
+
+		/* snapshots are only tracked in toplevel transactions from now on */
+		ReorderBufferTransferSnapToParent(txn, subtxn);
 	}
 	else if (new_top)
 	{
@@ -689,6 +654,34 @@ ReorderBufferAssignChild(ReorderBuffer *rb, TransactionId xid,
 	}
 }
 
+/*
+ * Hand a subtransaction's base snapshot over to its toplevel transaction, if
+ * that one has none or a newer one.  That can happen if there are no changes
+ * in the toplevel transaction but in one of the child transactions.  This
+ * allows the parent to simply use its base snapshot initially.
+ */
+static void
+ReorderBufferTransferSnapToParent(ReorderBufferTXN *txn,
+								  ReorderBufferTXN *subtxn)
+{
+	if (subtxn->base_snapshot == NULL)
+		return;
+
+	if (txn->base_snapshot == NULL ||
+		txn->base_snapshot_lsn > subtxn->base_snapshot_lsn)
+	{
+		if (txn->base_snapshot != NULL)
+			SnapBuildSnapDecRefcount(txn->base_snapshot);
+		txn->base_snapshot = subtxn->base_snapshot;
+		txn->base_snapshot_lsn = subtxn->base_snapshot_lsn;
+	}
+	else
+		SnapBuildSnapDecRefcount(subtxn->base_snapshot);
+
+	subtxn->base_snapshot = NULL;
+	subtxn->base_snapshot_lsn = InvalidXLogRecPtr;
+}
+
 /*
  * Associate a subtransaction with its toplevel transaction at commit
  * time. There may be no further changes added after this.
@@ -715,20 +708,8 @@ ReorderBufferCommitChild(ReorderBuffer *rb, TransactionId xid,
 	if (txn == NULL)
 		elog(ERROR, "subxact logged without previous toplevel record");
 
-	/*
-	 * Pass the our base snapshot to the parent transaction if it doesn't have
-	 * one, or ours is older. That can happen if there are no changes in the
-	 * toplevel transaction but in one of the child transactions. This allows
-	 * the parent to simply use it's base snapshot initially.
-	 */
-	if (txn->base_snapshot == NULL ||
-		txn->base_snapshot_lsn > subtxn->base_snapshot_lsn)
-	{
-		txn->base_snapshot = subtxn->base_snapshot;
-		txn->base_snapshot_lsn = subtxn->base_snapshot_lsn;
-		subtxn->base_snapshot = NULL;
-		subtxn->base_snapshot_lsn = InvalidXLogRecPtr;
-	}
+	/* pass our base snapshot to the parent transaction, if useful */
+	ReorderBufferTransferSnapToParent(txn, subtxn);
 
 	subtxn->final_lsn = commit_lsn;
 	subtxn->end_lsn = end_lsn;
@@ -736,6 +717,7 @@ ReorderBufferCommitChild(ReorderBuffer *rb, TransactionId xid,
 	if (!subtxn->is_known_as_subxact)
 	{
 		subtxn->is_known_as_subxact = true;
+		subtxn->toptxn = txn;
 		Assert(subtxn->nsubtxns == 0);
 
 		/* remove from lsn order list of top-level transactions */
@@ -869,7 +851,7 @@ ReorderBufferIterTXNInit(ReorderBuffer *rb, ReorderBufferTXN *txn)
 		{
 			ReorderBufferChange *cur_change;
 
-			if (txn->nentries != txn->nentries_mem)
+			if (cur_txn->nentries != cur_txn->nentries_mem)
 				ReorderBufferRestoreChanges(rb, cur_txn,
 											&state->entries[off].fd,
 											&state->entries[off].segno);
@@ -1068,6 +1050,12 @@ ReorderBufferCleanupTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 		txn->base_snapshot_lsn = InvalidXLogRecPtr;
 	}
 
+	if (txn->stream_snapshot != NULL)
+	{
+		ReorderBufferFreeSnap(rb, txn->stream_snapshot);
+		txn->stream_snapshot = NULL;
+	}
+
 	/* delete from list of known subxacts */
 	if (txn->is_known_as_subxact)
 	{
@@ -1091,6 +1079,9 @@ ReorderBufferCleanupTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 	if (txn->nentries != txn->nentries_mem)
 		ReorderBufferRestoreCleanup(rb, txn);
 
+	/* streamed transactions can have toast chunks left over */
+	ReorderBufferToastReset(rb, txn);
+
 	/* deallocate */
 	ReorderBufferReturnTXN(rb, txn);
 }
@@ -1253,6 +1244,10 @@ ReorderBufferFreeSnap(ReorderBuffer *rb, Snapshot snap)
  * cache invalidations. Thus, once a toplevel commit is read, we iterate over
  * the top and subtransactions (using a k-way merge) and replay the changes in
  * lsn order.
+ *
+ * The exception are transactions that have been streamed to the output plugin
+ * while still in progress; for those the remaining changes are streamed, too,
+ * followed by the stream_commit callback.
  */
 void
 ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
@@ -1261,10 +1256,6 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 					RepOriginId origin_id, XLogRecPtr origin_lsn)
 {
 	ReorderBufferTXN *txn;
-	volatile Snapshot snapshot_now;
-	volatile CommandId command_id = FirstCommandId;
-	bool		using_subtxn;
-	ReorderBufferIterTXNState *volatile iterstate = NULL;
 
 	txn = ReorderBufferTXNByXid(rb, xid, false, NULL, InvalidXLogRecPtr,
 								false);
@@ -1279,9 +1270,16 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 	txn->origin_id = origin_id;
 	txn->origin_lsn = origin_lsn;
 
+	if (txn->streamed)
+	{
+		ReorderBufferStreamTXN(rb, txn);
+		rb->stream_commit(rb, txn, commit_lsn);
+		ReorderBufferCleanupTXN(rb, txn);
+		return;
+	}
+
 	/* serialize the last bunch of changes if we need start earlier anyway */
-	if (txn->nentries_mem != txn->nentries)
-		ReorderBufferSerializeTXN(rb, txn);
+	ReorderBufferSerializeRemaining(rb, txn);
 
 	/*
 	 * If this transaction didn't have any real changes in our database, it's
@@ -1296,9 +1294,36 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 		return;
 	}
 
-	snapshot_now = txn->base_snapshot;
+	ReorderBufferProcessTXN(rb, txn, commit_lsn, txn->base_snapshot,
+							FirstCommandId, false);
+}
+
+/*
+ * Replay the changes of a transaction and its subtransactions, starting with
+ * the passed snapshot and command id.
+ *
+ * Normally that happens once the transaction committed, with begin/change/
+ * commit callbacks, after which the transaction is cleaned up.  When
+ * streaming, the changes queued so far are passed to the stream callbacks
+ * instead, and afterwards removed from the transaction, remembering the
+ * snapshot and command id to continue with next time.
+ */
+static void
+ReorderBufferProcessTXN(ReorderBuffer *rb, ReorderBufferTXN *txn,
+						XLogRecPtr commit_lsn, volatile Snapshot snapshot_now,
+						volatile CommandId command_id, bool streaming)
+{
+	bool		using_subtxn;
+	ReorderBufferIterTXNState *volatile iterstate = NULL;
+	ReorderBufferChange *volatile specinsert = NULL;
+	volatile XLogRecPtr prev_lsn = InvalidXLogRecPtr;
 
 	/* build data to be able to lookup the CommandIds of catalog tuples */
+	if (txn->tuplecid_hash != NULL)
+	{
+		hash_destroy(txn->tuplecid_hash);
+		txn->tuplecid_hash = NULL;
+	}
 	ReorderBufferBuildTupleCidHash(rb, txn);
 
 	/* setup the initial snapshot */
@@ -1319,14 +1344,14 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 	PG_TRY();
 	{
 		ReorderBufferChange *change;
-		ReorderBufferChange *specinsert = NULL;
 
 		if (using_subtxn)
 			BeginInternalSubTransaction("replay");
 		else
 			StartTransactionCommand();
 
-		rb->begin(rb, txn);
+		if (!streaming)
+			rb->begin(rb, txn);
 
 		iterstate = ReorderBufferIterTXNInit(rb, txn);
 		while ((change = ReorderBufferIterTXNNext(rb, iterstate)) != NULL)
@@ -1334,6 +1359,14 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 			Relation	relation = NULL;
 			Oid			reloid;
 
+			/* only open a streamed block once there's something in it */
+			if (streaming && prev_lsn == InvalidXLogRecPtr)
+			{
+				rb->stream_start(rb, txn, change->lsn);
+				txn->streamed = true;
+			}
+			prev_lsn = change->lsn;
+
 			switch (change->action)
 			{
 				case REORDER_BUFFER_CHANGE_INTERNAL_SPEC_CONFIRM:
@@ -1393,7 +1426,10 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 					if (!IsToastRelation(relation))
 					{
 						ReorderBufferToastReplace(rb, txn, relation, change);
-						rb->apply_change(rb, txn, relation, change);
+						if (streaming)
+							rb->stream_change(rb, txn, relation, change);
+						else
+							rb->apply_change(rb, txn, relation, change);
 
 						/*
 						 * Only clear reassembled toast chunks if we're sure
@@ -1534,11 +1570,12 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 		}
 
 		/*
-		 * There's a speculative insertion remaining, just clean in up, it
-		 * can't have been successful, otherwise we'd gotten a confirmation
-		 * record.
+		 * There's a speculative insertion remaining. Unless we're streaming
+		 * an in-progress transaction, whose confirmation record may still
+		 * follow, just clean it up, it can't have been successful, otherwise
+		 * we'd gotten a confirmation record.
 		 */
-		if (specinsert)
+		if (specinsert && !streaming)
 		{
 			ReorderBufferReturnChange(rb, specinsert);
 			specinsert = NULL;
@@ -1548,8 +1585,21 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 		ReorderBufferIterTXNFinish(rb, iterstate);
 		iterstate = NULL;
 
-		/* call commit callback */
-		rb->commit(rb, txn, commit_lsn);
+		/*
+		 * Call commit callback, or close the streamed block and remember
+		 * where to continue from the next time.
+		 */
+		if (!streaming)
+			rb->commit(rb, txn, commit_lsn);
+		else
+		{
+			if (prev_lsn != InvalidXLogRecPtr)
+				rb->stream_stop(rb, txn, prev_lsn);
+
+			txn->stream_snapshot = ReorderBufferCopySnap(rb, snapshot_now,
+														 txn, command_id);
+			txn->stream_command_id = command_id;
+		}
 
 		/* this is just a sanity check against bad output plugin behaviour */
 		if (GetCurrentTransactionIdIfAny() != InvalidTransactionId)
@@ -1576,8 +1626,30 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 		if (snapshot_now->copied)
 			ReorderBufferFreeSnap(rb, snapshot_now);
 
-		/* remove potential on-disk data, and deallocate */
-		ReorderBufferCleanupTXN(rb, txn);
+		if (!streaming)
+		{
+			/* remove potential on-disk data, and deallocate */
+			ReorderBufferCleanupTXN(rb, txn);
+		}
+		else
+		{
+			/*
+			 * Throw away what has been streamed, keeping a pending
+			 * speculative insertion around until its confirmation arrives.
+			 */
+			ReorderBufferTruncateTXN(rb, txn);
+
+			if (specinsert != NULL)
+			{
+				ReorderBufferTXN *spectxn = specinsert->txn;
+
+				Assert(spectxn != NULL);
+				dlist_push_head(&spectxn->changes, &specinsert->node);
+				spectxn->nentries++;
+				spectxn->nentries_mem++;
+				specinsert = NULL;
+			}
+		}
 	}
 	PG_CATCH();
 	{
@@ -1585,6 +1657,9 @@ ReorderBufferCommit(ReorderBuffer *rb, TransactionId xid,
 		if (iterstate)
 			ReorderBufferIterTXNFinish(rb, iterstate);
 
+		if (specinsert != NULL)
+			ReorderBufferReturnChange(rb, specinsert);
+
 		TeardownHistoricSnapshot(true);
 
 		/*
@@ -1637,6 +1712,13 @@ ReorderBufferAbort(ReorderBuffer *rb, TransactionId xid, XLogRecPtr lsn)
 	/* cosmetic... */
 	txn->final_lsn = lsn;
 
+	/*
+	 * Tell the output plugin to throw away what it has been sent of the
+	 * (sub)transaction.
+	 */
+	if (txn->streamed || (txn->toptxn != NULL && txn->toptxn->streamed))
+		rb->stream_abort(rb, txn, lsn);
+
 	/* remove potential on-disk data, and deallocate */
 	ReorderBufferCleanupTXN(rb, txn);
 }
@@ -1670,6 +1752,9 @@ ReorderBufferAbortOld(ReorderBuffer *rb, TransactionId oldestRunningXid)
 		{
 			elog(DEBUG1, "aborting old transaction %u", txn->xid);
 
+			if (txn->streamed)
+				rb->stream_abort(rb, txn, InvalidXLogRecPtr);
+
 			/* remove potential on-disk data, and deallocate this tx */
 			ReorderBufferCleanupTXN(rb, txn);
 		}
@@ -1735,6 +1820,10 @@ ReorderBufferForget(ReorderBuffer *rb, TransactionId xid, XLogRecPtr lsn)
 	else
 		Assert(txn->ninvalidations == 0);
 
+	/* the output plugin may have seen some of it already */
+	if (txn->streamed)
+		rb->stream_abort(rb, txn, lsn);
+
 	/* remove potential on-disk data, and deallocate */
 	ReorderBufferCleanupTXN(rb, txn);
 }
@@ -1786,6 +1875,11 @@ ReorderBufferSetBaseSnapshot(ReorderBuffer *rb, TransactionId xid,
 	bool		is_new;
 
 	txn = ReorderBufferTXNByXid(rb, xid, true, &is_new, lsn, true);
+
+	/* snapshots of known subtransactions are kept by the toplevel one */
+	if (txn->is_known_as_subxact)
+		txn = txn->toptxn;
+
 	Assert(txn->base_snapshot == NULL);
 	Assert(snap != NULL);
 
@@ -1923,63 +2017,352 @@ ReorderBufferXidHasBaseSnapshot(ReorderBuffer *rb, TransactionId xid)
 	if (txn == NULL)
 		return false;
 
-	/*
-	 * TODO: It would be a nice improvement if we would check the toplevel
-	 * transaction in subtransactions, but we'd need to keep track of a bit
-	 * more state.
-	 */
+	/* a known subtransaction uses its toplevel transaction's snapshot */
+	if (txn->is_known_as_subxact)
+		txn = txn->toptxn;
+
 	return txn->base_snapshot != NULL;
 }
 
 
 /*
  * ---------------------------------------
- * Disk serialization support
+ * Memory accounting and streaming of in-progress transactions
  * ---------------------------------------
  */
 
 /*
- * Ensure the IO buffer is >= sz.
+ * Approximate amount of memory used by a change.
+ */
+static Size
+ReorderBufferChangeSize(ReorderBufferChange *change)
+{
+	Size		sz = sizeof(ReorderBufferChange);
+
+	switch (change->action)
+	{
+		case REORDER_BUFFER_CHANGE_INSERT:
+		case REORDER_BUFFER_CHANGE_UPDATE:
+		case REORDER_BUFFER_CHANGE_DELETE:
+		case REORDER_BUFFER_CHANGE_INTERNAL_SPEC_INSERT:
+			if (change->data.tp.newtuple)
+				sz += sizeof(ReorderBufferTupleBuf) +
+					change->data.tp.newtuple->alloc_tuple_size;
+			if (change->data.tp.oldtuple)
+				sz += sizeof(ReorderBufferTupleBuf) +
+					change->data.tp.oldtuple->alloc_tuple_size;
+			break;
+		case REORDER_BUFFER_CHANGE_INTERNAL_SNAPSHOT:
+			{
+				Snapshot	snap = change->data.snapshot;
+
+				sz += sizeof(SnapshotData) +
+					sizeof(TransactionId) * (snap->xcnt + snap->subxcnt);
+				break;
+			}
+		case REORDER_BUFFER_CHANGE_INTERNAL_SPEC_CONFIRM:
+		case REORDER_BUFFER_CHANGE_INTERNAL_COMMAND_ID:
+		case REORDER_BUFFER_CHANGE_INTERNAL_TUPLECID:
+			break;
+	}
+
+	return sz;
+}
+
+/*
+ * Start accounting the memory used by a change in the transaction it has been
+ * queued to, and the reorder buffer as a whole, or stop doing so.
  */
 static void
-ReorderBufferSerializeReserve(ReorderBuffer *rb, Size sz)
+ReorderBufferChangeMemoryUpdate(ReorderBuffer *rb, ReorderBufferChange *change,
+								ReorderBufferTXN *txn, bool addition)
 {
-	if (!rb->outbufsize)
+	Size		sz = ReorderBufferChangeSize(change);
+
+	if (addition)
 	{
-		rb->outbuf = MemoryContextAlloc(rb->context, sz);
-		rb->outbufsize = sz;
+		Assert(change->txn == NULL);
+		change->txn = txn;
+
+		txn->size += sz;
+		rb->size += sz;
 	}
-	else if (rb->outbufsize < sz)
+	else
 	{
-		rb->outbuf = repalloc(rb->outbuf, sz);
-		rb->outbufsize = sz;
+		txn = change->txn;
+		Assert(txn != NULL);
+		Assert(txn->size >= sz && rb->size >= sz);
+
+		txn->size -= sz;
+		rb->size -= sz;
+		change->txn = NULL;
 	}
 }
 
 /*
- * Check whether the transaction tx should spill its data to disk.
+ * Check whether the changes of all transactions exceed
+ * logical_decoding_work_mem, and if so evict transactions from memory until
+ * they don't anymore.
+ *
+ * The largest toplevel transaction is streamed to the output plugin if that's
+ * possible, which gets rid of its subtransactions' changes as well.
+ * Otherwise the largest (sub)transaction is spilled to disk.
  */
 static void
-ReorderBufferCheckSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
+ReorderBufferCheckMemoryLimit(ReorderBuffer *rb)
 {
-	/*
-	 * TODO: improve accounting so we cheaply can take subtransactions into
-	 * account here.
-	 */
-	if (txn->nentries_mem >= max_changes_in_memory)
+	ReorderBufferTXN *txn;
+
+	while (rb->size >= (Size) logical_decoding_work_mem * 1024)
 	{
+		if (ReorderBufferCanStream(rb))
+		{
+			Size		before = rb->size;
+
+			txn = ReorderBufferLargestTopTXN(rb);
+
+			if (txn != NULL && ReorderBufferCanStreamTXN(txn))
+			{
+				ReorderBufferStreamTXN(rb, txn);
+
+				/*
+				 * Only a pending speculative insertion could have been left
+				 * over; if that's all there was, spill instead.
+				 */
+				if (rb->size < before)
+					continue;
+			}
+		}
+
+		txn = ReorderBufferLargestTXN(rb);
+		Assert(txn != NULL && txn->size > 0);
+
 		ReorderBufferSerializeTXN(rb, txn);
-		Assert(txn->nentries_mem == 0);
+		Assert(txn->size == 0 && txn->nentries_mem == 0);
 	}
 }
 
 /*
- * Spill data of a large transaction (and its subtransactions) to disk.
+ * Find the (sub)transaction using the most memory.
+ */
+static ReorderBufferTXN *
+ReorderBufferLargestTXN(ReorderBuffer *rb)
+{
+	HASH_SEQ_STATUS hash_seq;
+	ReorderBufferTXNByIdEnt *ent;
+	ReorderBufferTXN *largest = NULL;
+
+	hash_seq_init(&hash_seq, rb->by_txn);
+	while ((ent = hash_seq_search(&hash_seq)) != NULL)
+	{
+		ReorderBufferTXN *txn = ent->txn;
+
+		if (largest == NULL || txn->size > largest->size)
+			largest = txn;
+	}
+
+	return largest;
+}
+
+/*
+ * Find the toplevel transaction using the most memory, counting its
+ * subtransactions.
+ */
+static ReorderBufferTXN *
+ReorderBufferLargestTopTXN(ReorderBuffer *rb)
+{
+	dlist_iter	iter;
+	ReorderBufferTXN *largest = NULL;
+	Size		largest_size = 0;
+
+	dlist_foreach(iter, &rb->toplevel_by_lsn)
+	{
+		ReorderBufferTXN *txn;
+		dlist_iter	subtxn_i;
+		Size		size;
+
+		txn = dlist_container(ReorderBufferTXN, node, iter.cur);
+
+		size = txn->size;
+		dlist_foreach(subtxn_i, &txn->subtxns)
+		{
+			ReorderBufferTXN *subtxn;
+
+			subtxn = dlist_container(ReorderBufferTXN, node, subtxn_i.cur);
+			size += subtxn->size;
+		}
+
+		if (size > largest_size)
+		{
+			largest = txn;
+			largest_size = size;
+		}
+	}
+
+	return largest;
+}
+
+/*
+ * Can transactions be streamed to the output plugin at this point?
+ *
+ * Besides the output plugin having to support it, the snapshot builder has to
+ * be consistent, and the client must not have confirmed the position we're
+ * decoding at already - transactions committing there are skipped, so they
+ * must not be streamed either.
+ */
+static bool
+ReorderBufferCanStream(ReorderBuffer *rb)
+{
+	LogicalDecodingContext *ctx = rb->private_data;
+
+	if (!ctx->streaming)
+		return false;
+
+	if (SnapBuildCurrentState(ctx->snapshot_builder) != SNAPBUILD_CONSISTENT)
+		return false;
+
+	return !SnapBuildXactNeedsSkip(ctx->snapshot_builder,
+								   ctx->reader->EndRecPtr);
+}
+
+/*
+ * Can the changes of this in-progress toplevel transaction be decoded?
+ *
+ * Transactions that modified the catalog can't be: we don't know their cache
+ * invalidations and all their (cmin, cmax) mappings before they committed.
+ */
+static bool
+ReorderBufferCanStreamTXN(ReorderBufferTXN *txn)
+{
+	dlist_iter	iter;
+
+	Assert(!txn->is_known_as_subxact);
+
+	if (txn->base_snapshot == NULL || txn->has_catalog_changes)
+		return false;
+
+	dlist_foreach(iter, &txn->subtxns)
+	{
+		ReorderBufferTXN *subtxn;
+
+		subtxn = dlist_container(ReorderBufferTXN, node, iter.cur);
+
+		if (subtxn->has_catalog_changes)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Stream the changes of a toplevel transaction and its subtransactions queued
+ * so far to the output plugin, and throw them away afterwards.
+ *
+ * Also used to send the remaining changes of a streamed transaction when it
+ * commits.
+ */
+static void
+ReorderBufferStreamTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
+{
+	Snapshot	snapshot_now;
+	CommandId	command_id;
+
+	Assert(!txn->is_known_as_subxact);
+	Assert(txn->base_snapshot != NULL);
+
+	/* changes spilled to disk before have to be read back in order */
+	ReorderBufferSerializeRemaining(rb, txn);
+
+	if (txn->stream_snapshot == NULL)
+	{
+		/* first time through, start with the base snapshot */
+		snapshot_now = txn->base_snapshot;
+		command_id = FirstCommandId;
+	}
+	else
+	{
+		/*
+		 * Continue where the last run stopped.  Copy the snapshot again, as
+		 * more subtransactions may have been added in the meantime.
+		 */
+		command_id = txn->stream_command_id;
+		snapshot_now = ReorderBufferCopySnap(rb, txn->stream_snapshot,
+											 txn, command_id);
+		ReorderBufferFreeSnap(rb, txn->stream_snapshot);
+		txn->stream_snapshot = NULL;
+	}
+
+	ReorderBufferProcessTXN(rb, txn, InvalidXLogRecPtr, snapshot_now,
+							command_id, true);
+}
+
+/*
+ * Discard the changes of a transaction and its subtransactions, after they
+ * have been streamed.  The transactions themselves stay around.
+ */
+static void
+ReorderBufferTruncateTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
+{
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &txn->subtxns)
+	{
+		ReorderBufferTXN *subtxn;
+
+		subtxn = dlist_container(ReorderBufferTXN, node, iter.cur);
+
+		Assert(subtxn->nsubtxns == 0);
+		ReorderBufferTruncateTXN(rb, subtxn);
+	}
+
+	dlist_foreach_modify(iter, &txn->changes)
+	{
+		ReorderBufferChange *change;
+
+		change = dlist_container(ReorderBufferChange, node, iter.cur);
+
+		dlist_delete(&change->node);
+		ReorderBufferReturnChange(rb, change);
+	}
+
+	/* remove entries spilled to disk */
+	if (txn->nentries != txn->nentries_mem)
+		ReorderBufferRestoreCleanup(rb, txn);
+
+	txn->nentries = 0;
+	txn->nentries_mem = 0;
+}
+
+/*
+ * ---------------------------------------
+ * Disk serialization support
+ * ---------------------------------------
+ */
+
+/*
+ * Ensure the IO buffer is >= sz.
+ */
+static void
+ReorderBufferSerializeReserve(ReorderBuffer *rb, Size sz)
+{
+	if (!rb->outbufsize)
+	{
+		rb->outbuf = MemoryContextAlloc(rb->context, sz);
+		rb->outbufsize = sz;
+	}
+	else if (rb->outbufsize < sz)
+	{
+		rb->outbuf = repalloc(rb->outbuf, sz);
+		rb->outbufsize = sz;
+	}
+}
+
+/*
+ * Spill the in-memory changes of a (sub)transaction to disk.
  */
 static void
 ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 {
-	dlist_iter	subtxn_i;
 	dlist_mutable_iter change_i;
 	int			fd = -1;
 	XLogSegNo	curOpenSegNo = 0;
@@ -1989,15 +2372,6 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 	elog(DEBUG2, "spill %u changes in XID %u to disk",
 		 (uint32) txn->nentries_mem, txn->xid);
 
-	/* do the same to all child TXs */
-	dlist_foreach(subtxn_i, &txn->subtxns)
-	{
-		ReorderBufferTXN *subtxn;
-
-		subtxn = dlist_container(ReorderBufferTXN, node, subtxn_i.cur);
-		ReorderBufferSerializeTXN(rb, subtxn);
-	}
-
 	/* serialize changestream */
 	dlist_foreach_modify(change_i, &txn->changes)
 	{
@@ -2040,6 +2414,14 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 		}
 
 		ReorderBufferSerializeChange(rb, txn, fd, change);
+
+		/*
+		 * Remember the last spilled change, so the files can be found again
+		 * even if the transaction never gets a commit or abort record.
+		 */
+		if (change->lsn > txn->final_lsn)
+			txn->final_lsn = change->lsn;
+
 		dlist_delete(&change->node);
 		ReorderBufferReturnChange(rb, change);
 
@@ -2054,6 +2436,30 @@ ReorderBufferSerializeTXN(ReorderBuffer *rb, ReorderBufferTXN *txn)
 		CloseTransientFile(fd);
 }
 
+/*
+ * Before replaying a transaction, spill the changes still in memory of every
+ * (sub)transaction that has been spilled to disk before, so they are read back
+ * in the right order.
+ */
+static void
+ReorderBufferSerializeRemaining(ReorderBuffer *rb, ReorderBufferTXN *txn)
+{
+	dlist_iter	subtxn_i;
+
+	if (txn->nentries_mem != txn->nentries)
+		ReorderBufferSerializeTXN(rb, txn);
+
+	dlist_foreach(subtxn_i, &txn->subtxns)
+	{
+		ReorderBufferTXN *subtxn;
+
+		subtxn = dlist_container(ReorderBufferTXN, node, subtxn_i.cur);
+
+		if (subtxn->nentries_mem != subtxn->nentries)
+			ReorderBufferSerializeTXN(rb, subtxn);
+	}
+}
+
 /*
  * Serialize individual change to disk.
  */
@@ -2087,15 +2493,18 @@ ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 				newtup = change->data.tp.newtuple;
 
 				if (oldtup)
-					oldlen = offsetof(ReorderBufferTupleBuf, t_data) +
-						oldtup->tuple.t_len;
+				{
+					sz += sizeof(HeapTupleData);
+					oldlen = oldtup->tuple.t_len;
+					sz += oldlen;
+				}
 
 				if (newtup)
-					newlen = offsetof(ReorderBufferTupleBuf, t_data) +
-						newtup->tuple.t_len;
-
-				sz += oldlen;
-				sz += newlen;
+				{
+					sz += sizeof(HeapTupleData);
+					newlen = newtup->tuple.t_len;
+					sz += newlen;
+				}
 
 				/* make sure we have enough space */
 				ReorderBufferSerializeReserve(rb, sz);
@@ -2106,13 +2515,19 @@ ReorderBufferSerializeChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 				if (oldlen)
 				{
-					memcpy(data, oldtup, oldlen);
+					memcpy(data, &oldtup->tuple, sizeof(HeapTupleData));
+					data += sizeof(HeapTupleData);
+
+					memcpy(data, oldtup->tuple.t_data, oldlen);
 					data += oldlen;
 				}
 
 				if (newlen)
 				{
-					memcpy(data, newtup, newlen);
+					memcpy(data, &newtup->tuple, sizeof(HeapTupleData));
+					data += sizeof(HeapTupleData);
+
+					memcpy(data, newtup->tuple.t_data, newlen);
 					data += newlen;
 				}
 				break;
@@ -2332,26 +2747,54 @@ ReorderBufferRestoreChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 		case REORDER_BUFFER_CHANGE_INTERNAL_SPEC_INSERT:
 			if (change->data.tp.newtuple)
 			{
-				Size		len = offsetof(ReorderBufferTupleBuf, t_data) +
-				((ReorderBufferTupleBuf *) data)->tuple.t_len;
+				/* here, data might not be suitably aligned! */
+				uint32		tuplelen;
+
+				memcpy(&tuplelen, data + offsetof(HeapTupleData, t_len),
+					   sizeof(uint32));
 
-				change->data.tp.newtuple = ReorderBufferGetTupleBuf(rb);
-				memcpy(change->data.tp.newtuple, data, len);
+				change->data.tp.newtuple =
+					ReorderBufferGetTupleBuf(rb,
+											 tuplelen - SizeofHeapTupleHeader);
+
+				/* restore ->tuple */
+				memcpy(&change->data.tp.newtuple->tuple, data,
+					   sizeof(HeapTupleData));
+				data += sizeof(HeapTupleData);
+
+				/* reset t_data pointer into the new tuplebuf */
 				change->data.tp.newtuple->tuple.t_data =
-					&change->data.tp.newtuple->t_data.header;
-				data += len;
+					ReorderBufferTupleBufData(change->data.tp.newtuple);
+
+				/* restore tuple data itself */
+				memcpy(change->data.tp.newtuple->tuple.t_data, data, tuplelen);
+				data += tuplelen;
 			}
 
 			if (change->data.tp.oldtuple)
 			{
-				Size		len = offsetof(ReorderBufferTupleBuf, t_data) +
-				((ReorderBufferTupleBuf *) data)->tuple.t_len;
+				/* here, data might not be suitably aligned! */
+				uint32		tuplelen;
 
-				change->data.tp.oldtuple = ReorderBufferGetTupleBuf(rb);
-				memcpy(change->data.tp.oldtuple, data, len);
+				memcpy(&tuplelen, data + offsetof(HeapTupleData, t_len),
+					   sizeof(uint32));
+
+				change->data.tp.oldtuple =
+					ReorderBufferGetTupleBuf(rb,
+											 tuplelen - SizeofHeapTupleHeader);
+
+				/* restore ->tuple */
+				memcpy(&change->data.tp.oldtuple->tuple, data,
+					   sizeof(HeapTupleData));
+				data += sizeof(HeapTupleData);
+
+				/* reset t_data pointer into the new tuplebuf */
 				change->data.tp.oldtuple->tuple.t_data =
-					&change->data.tp.oldtuple->t_data.header;
-				data += len;
+					ReorderBufferTupleBufData(change->data.tp.oldtuple);
+
+				/* restore tuple data itself */
+				memcpy(change->data.tp.oldtuple->tuple.t_data, data, tuplelen);
+				data += tuplelen;
 			}
 			break;
 		case REORDER_BUFFER_CHANGE_INTERNAL_SNAPSHOT:
@@ -2386,6 +2829,10 @@ ReorderBufferRestoreChange(ReorderBuffer *rb, ReorderBufferTXN *txn,
 
 	dlist_push_tail(&txn->changes, &change->node);
 	txn->nentries_mem++;
+
+	/* the copied pointer is stale, account the change afresh */
+	change->txn = NULL;
+	ReorderBufferChangeMemoryUpdate(rb, change, txn, true);
 }
 
 /*
@@ -2576,6 +3023,10 @@ ReorderBufferToastAppendChunk(ReorderBuffer *rb, ReorderBufferTXN *txn,
 	ent->size += chunksize;
 	ent->last_chunk_seq = chunk_seq;
 	ent->num_chunks++;
+
+	/* the chunk can't be evicted from memory anymore, stop accounting it */
+	if (change->txn != NULL)
+		ReorderBufferChangeMemoryUpdate(rb, change, NULL, false);
 	dlist_push_tail(&ent->chunks, &change->node);
 }
 
@@ -2728,8 +3179,25 @@ ReorderBufferToastReplace(ReorderBuffer *rb, ReorderBufferTXN *txn,
 	 * the tuplebuf because attrs[] will point back into the current content.
 	 */
 	tmphtup = heap_form_tuple(desc, attrs, isnull);
-	Assert(newtup->tuple.t_len <= MaxHeapTupleSize);
-	Assert(&newtup->t_data.header == newtup->tuple.t_data);
+	Assert(ReorderBufferTupleBufData(newtup) == newtup->tuple.t_data);
+
+	/*
+	 * The tuplebuf was sized for the tuple as logged.  Replacing on-disk
+	 * toast pointers by indirect ones usually shrinks it, but the new tuple
+	 * can still be larger: if the logged tuple has fewer attributes than the
+	 * descriptor, say after ALTER TABLE ... ADD COLUMN, the rebuilt one gets
+	 * a null bitmap and a bigger header.  Get a bigger tuplebuf in that case.
+	 */
+	if (tmphtup->t_len > newtup->alloc_tuple_size)
+	{
+		ReorderBufferTupleBuf *oldtup = newtup;
+
+		newtup = ReorderBufferGetTupleBuf(rb, tmphtup->t_len);
+		newtup->tuple.t_self = oldtup->tuple.t_self;
+		newtup->tuple.t_tableOid = oldtup->tuple.t_tableOid;
+		ReorderBufferReturnTupleBuf(rb, oldtup);
+		change->data.tp.newtuple = newtup;
+	}
 
 	memcpy(newtup->tuple.t_data, tmphtup->t_data, tmphtup->t_len);
 	newtup->tuple.t_len = tmphtup->t_len;
@@ -89,6 +89,7 @@ static void RemoveProcFromArray(int code, Datum arg);
 static void ProcKill(int code, Datum arg);
 static void AuxiliaryProcKill(int code, Datum arg);
 static void CheckDeadLock(void);
+static Size FastPathLockShmemSize(void);
 
 
 /*
@@ -114,6 +115,27 @@ ProcGlobalShmemSize(void)
 	size = add_size(size, mul_size(NUM_AUXILIARY_PROCS, sizeof(PGXACT)));
 	size = add_size(size, mul_size(max_prepared_xacts, sizeof(PGXACT)));
 
+	/* fast-path lock arrays */
+	size = add_size(size, mul_size(MaxBackends + NUM_AUXILIARY_PROCS +
+								   max_prepared_xacts,
+								   FastPathLockShmemSize()));
+
+	return size;
+}
+
+/*
+ * Report the per-PGPROC space needed for the fast-path lock arrays.
+ */
+static Size
+FastPathLockShmemSize(void)
+{
+	Size		size = 0;
+
+	size = add_size(size, MAXALIGN(mul_size(FastPathLockGroupsPerBackend,
+											sizeof(uint64))));
+	size = add_size(size, MAXALIGN(mul_size(FastPathLockSlotsPerBackend(),
+											sizeof(Oid))));
+
 	return size;
 }
 
@@ -159,6 +181,9 @@ InitProcGlobal(void)
 {
 	PGPROC	   *procs;
 	PGXACT	   *pgxacts;
+	char	   *fpPtr;
+	Size		fpLockBitsSize,
+				fpRelIdSize;
 	int			i,
 				j;
 	bool		found;
@@ -213,6 +238,21 @@ InitProcGlobal(void)
 	MemSet(pgxacts, 0, TotalProcs * sizeof(PGXACT));
 	ProcGlobal->allPgXact = pgxacts;
 
+	/*
+	 * Allocate the fast-path lock arrays for all PGPROCs in one chunk.  Their
+	 * size depends on max_locks_per_transaction, so they can't be embedded
+	 * in the PGPROC structure itself.
+	 */
+	Assert(FastPathLockGroupsPerBackend > 0);
+	fpLockBitsSize = MAXALIGN(FastPathLockGroupsPerBackend * sizeof(uint64));
+	fpRelIdSize = MAXALIGN(FastPathLockSlotsPerBackend() * sizeof(Oid));
+	fpPtr = ShmemAlloc(TotalProcs * (fpLockBitsSize + fpRelIdSize));
+	if (!fpPtr)
+		ereport(FATAL,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of shared memory")));
+	MemSet(fpPtr, 0, TotalProcs * (fpLockBitsSize + fpRelIdSize));
+
 	for (i = 0; i < TotalProcs; i++)
 	{
 		/* Common initialization for all PGPROCs, regardless of type. */
@@ -230,6 +270,12 @@ InitProcGlobal(void)
 		}
 		procs[i].pgprocno = i;
 
+		/* Set up this PGPROC's slice of the fast-path lock arrays. */
+		procs[i].fpLockBits = (uint64 *) fpPtr;
+		fpPtr += fpLockBitsSize;
+		procs[i].fpRelId = (Oid *) fpPtr;
+		fpPtr += fpRelIdSize;
+
 		/*
 		 * Newly created PGPROCs for normal backends, autovacuum and bgworkers
 		 * must be queued up on the appropriate free list.  Because there can
@@ -32,6 +32,7 @@
 #include "postmaster/bgwriter.h"
 #include "storage/fd.h"
 #include "storage/bufmgr.h"
+#include "storage/lwlock.h"
 #include "storage/relfilenode.h"
 #include "storage/smgr.h"
 #include "utils/hsearch.h"
@@ -167,7 +168,9 @@ typedef enum					/* behavior for mdopen & _mdfd_getseg */
 {
 	EXTENSION_FAIL,				/* ereport if segment not present */
 	EXTENSION_RETURN_NULL,		/* return NULL if not present */
-	EXTENSION_CREATE			/* create new segments as needed */
+	EXTENSION_CREATE,			/* create new segments as needed */
+	EXTENSION_NO_CREATE			/* like EXTENSION_RETURN_NULL, but never
+								 * create segments, even during recovery */
 } ExtensionBehavior;
 
 /* local routines */
@@ -591,7 +594,8 @@ mdopen(SMgrRelation reln, ForkNumber forknum, ExtensionBehavior behavior)
 			fd = PathNameOpenFile(path, O_RDWR | O_CREAT | O_EXCL | PG_BINARY, 0600);
 		if (fd < 0)
 		{
-			if (behavior == EXTENSION_RETURN_NULL &&
+			if ((behavior == EXTENSION_RETURN_NULL ||
+				 behavior == EXTENSION_NO_CREATE) &&
 				FILE_POSSIBLY_DELETED(errno))
 			{
 				pfree(path);
@@ -645,14 +649,16 @@ mdclose(SMgrRelation reln, ForkNumber forknum)
 /*
  *	mdprefetch() -- Initiate asynchronous read of the specified block of a relation
  */
-void
+bool
 mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
 {
 #ifdef USE_PREFETCH
 	off_t		seekpos;
 	MdfdVec    *v;
 
-	v = _mdfd_getseg(reln, forknum, blocknum, false, EXTENSION_FAIL);
+	v = _mdfd_getseg(reln, forknum, blocknum, false, EXTENSION_NO_CREATE);
+	if (v == NULL)
+		return false;
 
 	seekpos = (off_t) BLCKSZ *(blocknum % ((BlockNumber) RELSEG_SIZE));
 
@@ -660,6 +666,8 @@ mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
 
 	(void) FilePrefetch(v->mdfd_vfd, seekpos, BLCKSZ);
 #endif   /* USE_PREFETCH */
+
+	return true;
 }
 
 
@@ -1725,7 +1733,8 @@ _mdfd_getseg(SMgrRelation reln, ForkNumber forknum, BlockNumber blkno,
 	BlockNumber nextsegno;
 
 	if (!v)
-		return NULL;			/* only possible if EXTENSION_RETURN_NULL */
+		return NULL;			/* only possible if EXTENSION_RETURN_NULL or
+								 * EXTENSION_NO_CREATE */
 
 	targetseg = blkno / ((BlockNumber) RELSEG_SIZE);
 	for (nextsegno = 1; nextsegno <= targetseg; nextsegno++)
@@ -1746,10 +1755,26 @@ _mdfd_getseg(SMgrRelation reln, ForkNumber forknum, BlockNumber blkno,
 			 * active segment are of size RELSEG_SIZE; therefore, pad them out
 			 * with zeroes if needed.  (This only matters if caller is
 			 * extending the relation discontiguously, but that can happen in
-			 * hash indexes.)
+			 * hash indexes.)  EXTENSION_NO_CREATE callers only want to
+			 * look, so we don't do that for them.
+			 *
+			 * Redo workers may be extending the same relation concurrently,
+			 * so during recovery this is done under RedoExtensionLock, like
+			 * the extension in XLogReadBufferExtended.  The caller may hold
+			 * it already, and so does mdextend when we call it to pad.
 			 */
-			if (behavior == EXTENSION_CREATE || InRecovery)
+			if (behavior == EXTENSION_CREATE ||
+				(InRecovery && behavior != EXTENSION_NO_CREATE))
 			{
+				bool		extlock = false;
+
+				if (InRecovery && !LWLockHeldByMe(RedoExtensionLock))
+				{
+					LWLockAcquire(RedoExtensionLock, LW_EXCLUSIVE);
+					extlock = true;
+				}
+
+				/* the segment may have been filled while we waited */
 				if (_mdnblocks(reln, forknum, v) < RELSEG_SIZE)
 				{
 					char	   *zerobuf = palloc0(BLCKSZ);
@@ -1760,6 +1785,9 @@ _mdfd_getseg(SMgrRelation reln, ForkNumber forknum, BlockNumber blkno,
 					pfree(zerobuf);
 				}
 				v->mdfd_chain = _mdfd_openseg(reln, forknum, +nextsegno, O_CREAT);
+
+				if (extlock)
+					LWLockRelease(RedoExtensionLock);
 			}
 			else
 			{
@@ -1768,7 +1796,8 @@ _mdfd_getseg(SMgrRelation reln, ForkNumber forknum, BlockNumber blkno,
 			}
 			if (v->mdfd_chain == NULL)
 			{
-				if (behavior == EXTENSION_RETURN_NULL &&
+				if ((behavior == EXTENSION_RETURN_NULL ||
+					 behavior == EXTENSION_NO_CREATE) &&
 					FILE_POSSIBLY_DELETED(errno))
 					return NULL;
 				ereport(ERROR,
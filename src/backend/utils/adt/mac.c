@@ -10,6 +10,7 @@
 #include "libpq/pqformat.h"
 #include "utils/builtins.h"
 #include "utils/inet.h"
+#include "utils/sortsupport.h"
 
 
 /*
@@ -22,6 +23,12 @@
 #define lobits(addr) \
   ((unsigned long)(((addr)->d<<16)|((addr)->e<<8)|((addr)->f)))
 
+static int	macaddr_fast_cmp(Datum x, Datum y, SortSupport ssup);
+#if SIZEOF_DATUM >= 8
+static Datum macaddr_abbrev_convert(Datum original, SortSupport ssup);
+static bool macaddr_abbrev_abort(int memtupcount, SortSupport ssup);
+#endif
+
 /*
  *	MAC address reader.  Accepts several common notations.
  */
@@ -175,6 +182,75 @@ macaddr_cmp(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(macaddr_cmp_internal(a1, a2));
 }
 
+/*
+ * Sort support strategy routine
+ */
+Datum
+macaddr_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+
+	ssup->comparator = macaddr_fast_cmp;
+	ssup->ssup_extra = NULL;
+
+#if SIZEOF_DATUM >= 8
+	if (ssup->abbreviate)
+	{
+		/*
+		 * A MAC address is only six bytes wide, so it fits into a Datum in
+		 * its entirety and the abbreviated key is lossless.  Ties on the
+		 * abbreviated key are therefore real ties, and there is never any
+		 * reason to abandon abbreviation.
+		 */
+		ssup->comparator = ssup_datum_unsigned_cmp;
+		ssup->abbrev_converter = macaddr_abbrev_convert;
+		ssup->abbrev_abort = macaddr_abbrev_abort;
+		ssup->abbrev_full_comparator = macaddr_fast_cmp;
+	}
+#endif
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * SortSupport comparison func
+ */
+static int
+macaddr_fast_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	macaddr    *arg1 = DatumGetMacaddrP(x);
+	macaddr    *arg2 = DatumGetMacaddrP(y);
+
+	return macaddr_cmp_internal(arg1, arg2);
+}
+
+#if SIZEOF_DATUM >= 8
+/*
+ * Conversion routine for sortsupport.  The six address bytes are packed,
+ * most significant first, into the low-order bytes of the Datum, so that
+ * comparing abbreviated keys as unsigned integers gives the same answer as
+ * macaddr_cmp_internal().
+ */
+static Datum
+macaddr_abbrev_convert(Datum original, SortSupport ssup)
+{
+	macaddr    *authoritative = DatumGetMacaddrP(original);
+
+	return (Datum) (((uint64) hibits(authoritative) << 24) |
+					(uint64) lobits(authoritative));
+}
+
+/*
+ * Callback for estimating effectiveness of abbreviated key optimization.
+ * Abbreviation is lossless, so it's always worthwhile.
+ */
+static bool
+macaddr_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+	return false;
+}
+#endif
+
 /*
  *	Boolean comparisons.
  */
@@ -14,15 +14,31 @@
 
 #include "access/hash.h"
 #include "catalog/pg_type.h"
+#include "lib/hyperloglog.h"
 #include "libpq/ip.h"
 #include "libpq/libpq-be.h"
 #include "libpq/pqformat.h"
 #include "miscadmin.h"
+#include "port/pg_bswap.h"
 #include "utils/builtins.h"
+#include "utils/guc.h"
 #include "utils/inet.h"
+#include "utils/sortsupport.h"
 
 
+/* sortsupport for inet/cidr */
+typedef struct
+{
+	int64		input_count;	/* number of non-null values seen */
+	bool		estimating;		/* true if estimating cardinality */
+
+	hyperLogLogState abbr_card; /* cardinality estimator */
+} network_sortsupport_state;
+
 static int32 network_cmp_internal(inet *a1, inet *a2);
+static int	network_fast_cmp(Datum x, Datum y, SortSupport ssup);
+static Datum network_abbrev_convert(Datum original, SortSupport ssup);
+static bool network_abbrev_abort(int memtupcount, SortSupport ssup);
 static bool addressOK(unsigned char *a, int bits, int family);
 static inet *internal_inetpl(inet *ip, int64 addend);
 
@@ -414,6 +430,215 @@ network_cmp(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(network_cmp_internal(a1, a2));
 }
 
+/*
+ * Sort support strategy routine
+ */
+Datum
+network_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+
+	ssup->comparator = network_fast_cmp;
+	ssup->ssup_extra = NULL;
+
+	if (ssup->abbreviate)
+	{
+		network_sortsupport_state *nss;
+		MemoryContext oldcontext;
+
+		oldcontext = MemoryContextSwitchTo(ssup->ssup_cxt);
+
+		nss = palloc(sizeof(network_sortsupport_state));
+		nss->input_count = 0;
+		nss->estimating = true;
+		initHyperLogLog(&nss->abbr_card, 10);
+
+		ssup->ssup_extra = nss;
+
+		ssup->comparator = ssup_datum_unsigned_cmp;
+		ssup->abbrev_converter = network_abbrev_convert;
+		ssup->abbrev_abort = network_abbrev_abort;
+		ssup->abbrev_full_comparator = network_fast_cmp;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * SortSupport comparison func
+ */
+static int
+network_fast_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	inet	   *arg1 = DatumGetInetPP(x);
+	inet	   *arg2 = DatumGetInetPP(y);
+	int			result;
+
+	result = network_cmp_internal(arg1, arg2);
+
+	/* We can't afford to leak memory here. */
+	if (PointerGetDatum(arg1) != x)
+		pfree(arg1);
+	if (PointerGetDatum(arg2) != y)
+		pfree(arg2);
+
+	return result;
+}
+
+/*
+ * Callback for estimating effectiveness of abbreviated key optimization.
+ *
+ * This uses the same heuristics as uuid_abbrev_abort(): we pay no attention
+ * to the cardinality of the non-abbreviated data, and stop estimating once
+ * the abbreviated keys are clearly distinct enough to be worthwhile.
+ */
+static bool
+network_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+	network_sortsupport_state *nss = ssup->ssup_extra;
+	double		abbr_card;
+
+	if (memtupcount < 10000 || nss->input_count < 10000 || !nss->estimating)
+		return false;
+
+	abbr_card = estimateHyperLogLog(&nss->abbr_card);
+
+	if (abbr_card > 100000.0)
+	{
+#ifdef TRACE_SORT
+		if (trace_sort)
+			elog(LOG,
+				 "network_abbrev: estimation ends at cardinality %f"
+				 " after " INT64_FORMAT " values (%d rows)",
+				 abbr_card, nss->input_count, memtupcount);
+#endif
+		nss->estimating = false;
+		return false;
+	}
+
+	if (abbr_card < nss->input_count / 2000.0 + 0.5)
+	{
+#ifdef TRACE_SORT
+		if (trace_sort)
+			elog(LOG,
+				 "network_abbrev: aborting abbreviation at cardinality %f"
+				 " below threshold %f after " INT64_FORMAT " values (%d rows)",
+				 abbr_card, nss->input_count / 2000.0 + 0.5, nss->input_count,
+				 memtupcount);
+#endif
+		return true;
+	}
+
+#ifdef TRACE_SORT
+	if (trace_sort)
+		elog(LOG,
+			 "network_abbrev: cardinality %f after " INT64_FORMAT
+			 " values (%d rows)", abbr_card, nss->input_count, memtupcount);
+#endif
+
+	return false;
+}
+
+/*
+ * Conversion routine for sortsupport.  Converts an inet/cidr value to an
+ * abbreviated key that compares, as an unsigned integer, consistently with
+ * network_cmp_internal().
+ *
+ * The most significant bit is the address family (0 for IPv4, 1 for IPv6).
+ * Next come the leading bits of the network part of the address, that is
+ * the address with all bits beyond the netmask cleared.  Comparing masked
+ * networks agrees with network_cmp_internal(): where the common prefix
+ * differs we order the same way it does, and where it doesn't, the value
+ * with the shorter netmask has zeroes where the other has arbitrary bits,
+ * which is again the order network_cmp_internal() establishes by comparing
+ * netmask lengths.
+ *
+ * With 8-byte Datums an IPv4 network only needs 32 of the 63 remaining
+ * bits, so we can also pack in the netmask length (6 bits) and the leading
+ * 25 bits of the host part of the address, which resolves most ties
+ * without consulting the authoritative comparator:
+ *
+ *	[1 bit family][32 bits network][6 bits netmask length][25 bits host]
+ *
+ * IPv6 addresses, and everything on platforms with 4-byte Datums, just get
+ * as much of the network part as fits.
+ */
+static Datum
+network_abbrev_convert(Datum original, SortSupport ssup)
+{
+	network_sortsupport_state *nss = ssup->ssup_extra;
+	inet	   *authoritative = DatumGetInetPP(original);
+	Datum		res,
+				ipaddr_datum,
+				netmask_datum,
+				network;
+	int			datum_bits = SIZEOF_DATUM * BITS_PER_BYTE;
+	int			bits;
+
+	/*
+	 * Get the leading bytes of the address in big-endian order, so that the
+	 * first address bit is the most significant bit of the Datum.
+	 */
+	ipaddr_datum = 0;
+	memcpy(&ipaddr_datum, ip_addr(authoritative),
+		   Min(ip_addrsize(authoritative), sizeof(Datum)));
+	ipaddr_datum = DatumBigEndianToNative(ipaddr_datum);
+
+	bits = Min(ip_bits(authoritative), datum_bits);
+	if (bits == 0)
+		netmask_datum = 0;
+	else
+		netmask_datum = ~((Datum) 0) << (datum_bits - bits);
+
+	network = ipaddr_datum & netmask_datum;
+
+	/* Make room for the family bit */
+	res = network >> 1;
+	if (ip_family(authoritative) == PGSQL_AF_INET6)
+		res |= ((Datum) 1) << (datum_bits - 1);
+
+#if SIZEOF_DATUM == 8
+	if (ip_family(authoritative) == PGSQL_AF_INET)
+	{
+		Datum		host = ipaddr_datum & ~netmask_datum;
+
+		/* Netmask length occupies bits 25..30 */
+		res |= ((Datum) ip_bits(authoritative)) << 25;
+		/*
+		 * The remaining bits 0..24 take the first 25 bits of the address,
+		 * of which only the host bits survived the mask above.  So only the
+		 * part of the host within those 25 bits is kept; with a netmask of
+		 * /25 or longer nothing of it is, and ties are left to the
+		 * authoritative comparator.
+		 */
+		res |= host >> 39;
+	}
+#endif
+
+	nss->input_count += 1;
+
+	if (nss->estimating)
+	{
+		uint32		tmp;
+
+#if SIZEOF_DATUM == 8
+		tmp = (uint32) res ^ (uint32) ((uint64) res >> 32);
+#else							/* SIZEOF_DATUM != 8 */
+		tmp = (uint32) res;
+#endif
+
+		addHyperLogLog(&nss->abbr_card, DatumGetUInt32(hash_uint32(tmp)));
+	}
+
+	/* We can't afford to leak memory here. */
+	if (PointerGetDatum(authoritative) != original)
+		pfree(authoritative);
+
+	return res;
+}
+
 /*
  *	Boolean ordering tests.
  */
@@ -19,6 +19,7 @@
 #include "utils/builtins.h"
 #include "utils/datum.h"
 #include "utils/rangetypes.h"
+#include "utils/sortsupport.h"
 
 
 /*
@@ -163,6 +164,7 @@ static int	single_bound_cmp(const void *a, const void *b, void *arg);
 static int	interval_cmp_lower(const void *a, const void *b, void *arg);
 static int	interval_cmp_upper(const void *a, const void *b, void *arg);
 static int	common_entry_cmp(const void *i1, const void *i2);
+static int	range_gist_sort_cmp(Datum a, Datum b, SortSupport ssup);
 static float8 call_subtype_diff(TypeCacheEntry *typcache,
 				  Datum val1, Datum val2);
 
@@ -694,6 +696,23 @@ range_gist_same(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+/*
+ * Sort support routine for sorted GiST index build.  Ranges are ordered the
+ * same way as by the btree opclass: empty ranges first, then by lower bound
+ * and upper bound.  Packing leaf pages in that order gives them narrow union
+ * ranges.
+ */
+Datum
+range_gist_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+
+	ssup->comparator = range_gist_sort_cmp;
+	ssup->ssup_extra = NULL;
+
+	PG_RETURN_VOID();
+}
+
 /*
  *----------------------------------------------------------
  * STATIC FUNCTIONS
@@ -1548,3 +1567,58 @@ call_subtype_diff(TypeCacheEntry *typcache, Datum val1, Datum val2)
 		return value;
 	return 0.0;
 }
+
+/*
+ * SortSupport comparator for range_gist_sortsupport
+ *
+ * The range type's typcache entry is looked up on first use and remembered
+ * in ssup_extra.
+ */
+static int
+range_gist_sort_cmp(Datum a, Datum b, SortSupport ssup)
+{
+	RangeType  *r1 = DatumGetRangeType(a);
+	RangeType  *r2 = DatumGetRangeType(b);
+	TypeCacheEntry *typcache = (TypeCacheEntry *) ssup->ssup_extra;
+	RangeBound	lower1,
+				lower2;
+	RangeBound	upper1,
+				upper2;
+	bool		empty1,
+				empty2;
+	int			cmp;
+
+	if (typcache == NULL || typcache->type_id != RangeTypeGetOid(r1))
+	{
+		typcache = lookup_type_cache(RangeTypeGetOid(r1),
+									 TYPECACHE_RANGE_INFO);
+		if (typcache->rngelemtype == NULL)
+			elog(ERROR, "type %u is not a range type",
+				 RangeTypeGetOid(r1));
+		ssup->ssup_extra = typcache;
+	}
+
+	range_deserialize(typcache, r1, &lower1, &upper1, &empty1);
+	range_deserialize(typcache, r2, &lower2, &upper2, &empty2);
+
+	if (empty1 && empty2)
+		cmp = 0;
+	else if (empty1)
+		cmp = -1;
+	else if (empty2)
+		cmp = 1;
+	else
+	{
+		cmp = range_cmp_bounds(typcache, &lower1, &lower2);
+		if (cmp == 0)
+			cmp = range_cmp_bounds(typcache, &upper1, &upper2);
+	}
+
+	/* Avoid leaking detoasted copies over the course of the sort */
+	if ((Pointer) r1 != DatumGetPointer(a))
+		pfree(r1);
+	if ((Pointer) r2 != DatumGetPointer(b))
+		pfree(r2);
+
+	return cmp;
+}
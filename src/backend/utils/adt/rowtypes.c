@@ -23,7 +23,9 @@
 #include "libpq/pqformat.h"
 #include "miscadmin.h"
 #include "utils/builtins.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
+#include "utils/sortsupport.h"
 #include "utils/typcache.h"
 
 
@@ -65,6 +67,34 @@ typedef struct RecordCompareData
 	ColumnCompareData columns[FLEXIBLE_ARRAY_MEMBER];
 } RecordCompareData;
 
+/*
+ * structure to hold sortsupport state for record comparison
+ *
+ * The authoritative comparator just calls record_cmp(), keeping its
+ * comparison metadata cached in flinfo across calls.  Abbreviated keys are
+ * built from the first column of the record, using that column's own
+ * sortsupport.  Since the record type isn't known until we see the first
+ * value, the abbreviation strategy is chosen lazily by the first call of
+ * record_abbrev_convert().
+ */
+typedef enum
+{
+	RECORD_ABBREV_UNKNOWN,		/* haven't seen a value yet */
+	RECORD_ABBREV_NONE,			/* first column can't be abbreviated */
+	RECORD_ABBREV_CONVERT,		/* use first column's abbrev_converter */
+	RECORD_ABBREV_DATUM			/* first column's Datum is its own key */
+} RecordAbbrevStrategy;
+
+typedef struct RecordSortSupport
+{
+	FmgrInfo	flinfo;			/* lookup data for record_cmp() */
+	RecordAbbrevStrategy strategy;
+	Oid			first_type;		/* type of first column */
+	Oid			first_collation;	/* collation of first column */
+	Datum		null_key;		/* abbreviated key for a NULL first column */
+	SortSupportData first_ssup; /* sortsupport for first column */
+} RecordSortSupport;
+
 
 /*
  * record_in		- input routine for any composite type.
@@ -1263,6 +1293,222 @@ btrecordcmp(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(record_cmp(fcinfo));
 }
 
+/*
+ * SortSupport comparison func
+ */
+static int
+record_fastcmp(Datum x, Datum y, SortSupport ssup)
+{
+	RecordSortSupport *rss = (RecordSortSupport *) ssup->ssup_extra;
+	FunctionCallInfoData locfcinfo;
+
+	InitFunctionCallInfoData(locfcinfo, &rss->flinfo, 2,
+							 ssup->ssup_collation, NULL, NULL);
+	locfcinfo.arg[0] = x;
+	locfcinfo.arg[1] = y;
+	locfcinfo.argnull[0] = false;
+	locfcinfo.argnull[1] = false;
+	locfcinfo.isnull = false;
+
+	return record_cmp(&locfcinfo);
+}
+
+/*
+ * Choose an abbreviation strategy for records whose first column has the
+ * given type and collation.
+ *
+ * We can only abbreviate if the first column's abbreviated keys are compared
+ * by one of the generic integer comparators, because we need a key that
+ * sorts after every other one to stand in for a NULL first column (record_cmp
+ * sorts NULL after non-NULL).  Pass-by-value types whose plain comparator is
+ * one of those comparators can use the column Datum itself as the key.
+ */
+static void
+record_abbrev_setup(SortSupport ssup, Oid typid, Oid collation)
+{
+	RecordSortSupport *rss = (RecordSortSupport *) ssup->ssup_extra;
+	SortSupport first_ssup = &rss->first_ssup;
+	TypeCacheEntry *typentry;
+	MemoryContext oldcontext;
+
+	rss->strategy = RECORD_ABBREV_NONE;
+	rss->first_type = typid;
+	rss->first_collation = collation;
+
+	typentry = lookup_type_cache(typid, TYPECACHE_LT_OPR);
+	if (!OidIsValid(typentry->lt_opr))
+		return;
+
+	oldcontext = MemoryContextSwitchTo(ssup->ssup_cxt);
+
+	memset(first_ssup, 0, sizeof(SortSupportData));
+	first_ssup->ssup_cxt = ssup->ssup_cxt;
+	first_ssup->ssup_collation = collation;
+	first_ssup->ssup_nulls_first = false;
+	first_ssup->abbreviate = true;
+	PrepareSortSupportFromOrderingOp(typentry->lt_opr, first_ssup);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	if (first_ssup->comparator == ssup_datum_unsigned_cmp)
+		rss->null_key = ~((Datum) 0);
+#if SIZEOF_DATUM >= 8
+	else if (first_ssup->comparator == ssup_datum_signed_cmp)
+		rss->null_key = Int64GetDatum(PG_INT64_MAX);
+#endif
+	else if (first_ssup->comparator == ssup_datum_int32_cmp)
+		rss->null_key = Int32GetDatum(PG_INT32_MAX);
+	else
+		return;
+
+	if (first_ssup->abbrev_converter != NULL)
+		rss->strategy = RECORD_ABBREV_CONVERT;
+	else if (typentry->typbyval)
+		rss->strategy = RECORD_ABBREV_DATUM;
+	else
+		return;
+
+	/* Abbreviated keys compare the same way the first column's do */
+	ssup->comparator = first_ssup->comparator;
+}
+
+/*
+ * Conversion routine for sortsupport.  Converts a record to the abbreviated
+ * key of its first column.
+ */
+static Datum
+record_abbrev_convert(Datum original, SortSupport ssup)
+{
+	RecordSortSupport *rss = (RecordSortSupport *) ssup->ssup_extra;
+	HeapTupleHeader record = DatumGetHeapTupleHeader(original);
+	TupleDesc	tupdesc;
+	HeapTupleData tuple;
+	Datum		value;
+	bool		isnull;
+	Datum		res;
+	int			i;
+
+	tupdesc = lookup_rowtype_tupdesc(HeapTupleHeaderGetTypeId(record),
+									 HeapTupleHeaderGetTypMod(record));
+
+	/* Find the first non-dropped column */
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		if (!tupdesc->attrs[i]->attisdropped)
+			break;
+	}
+
+	if (i >= tupdesc->natts)
+	{
+		/* No columns at all; all such records compare equal */
+		if (rss->strategy == RECORD_ABBREV_UNKNOWN)
+			rss->strategy = RECORD_ABBREV_NONE;
+		ReleaseTupleDesc(tupdesc);
+		return (Datum) 0;
+	}
+
+	if (rss->strategy == RECORD_ABBREV_UNKNOWN)
+		record_abbrev_setup(ssup, tupdesc->attrs[i]->atttypid,
+							tupdesc->attrs[i]->attcollation);
+	else if (rss->first_type != tupdesc->attrs[i]->atttypid)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATATYPE_MISMATCH),
+				 errmsg("cannot compare dissimilar column types %s and %s at record column %d",
+						format_type_be(rss->first_type),
+						format_type_be(tupdesc->attrs[i]->atttypid),
+						1)));
+	else if (rss->first_collation != tupdesc->attrs[i]->attcollation)
+		ereport(ERROR,
+				(errcode(ERRCODE_INDETERMINATE_COLLATION),
+				 errmsg("could not determine which collation to use for record column %d",
+						1)));
+
+	if (rss->strategy == RECORD_ABBREV_NONE)
+	{
+		/* Every key is equal, so the authoritative comparator decides */
+		ReleaseTupleDesc(tupdesc);
+		return (Datum) 0;
+	}
+
+	tuple.t_len = HeapTupleHeaderGetDatumLength(record);
+	ItemPointerSetInvalid(&(tuple.t_self));
+	tuple.t_tableOid = InvalidOid;
+	tuple.t_data = record;
+
+	value = heap_getattr(&tuple, i + 1, tupdesc, &isnull);
+
+	if (isnull)
+		res = rss->null_key;
+	else if (rss->strategy == RECORD_ABBREV_CONVERT)
+		res = rss->first_ssup.abbrev_converter(value, &rss->first_ssup);
+	else
+		res = value;
+
+	ReleaseTupleDesc(tupdesc);
+
+	/* We can't afford to leak memory here. */
+	if (PointerGetDatum(record) != original)
+		pfree(record);
+
+	return res;
+}
+
+/*
+ * Callback for estimating effectiveness of abbreviated key optimization.
+ * Defer to the first column's own heuristics, if it has any.
+ */
+static bool
+record_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+	RecordSortSupport *rss = (RecordSortSupport *) ssup->ssup_extra;
+
+	switch (rss->strategy)
+	{
+		case RECORD_ABBREV_UNKNOWN:
+			return false;
+		case RECORD_ABBREV_NONE:
+			return true;
+		case RECORD_ABBREV_CONVERT:
+			return rss->first_ssup.abbrev_abort(memtupcount,
+												&rss->first_ssup);
+		case RECORD_ABBREV_DATUM:
+			return false;
+	}
+	return false;				/* keep compiler quiet */
+}
+
+/*
+ * Sort support strategy routine
+ */
+Datum
+btrecordsortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+	RecordSortSupport *rss;
+
+	rss = MemoryContextAllocZero(ssup->ssup_cxt, sizeof(RecordSortSupport));
+	fmgr_info_cxt(F_BTRECORDCMP, &rss->flinfo, ssup->ssup_cxt);
+	rss->strategy = RECORD_ABBREV_UNKNOWN;
+
+	ssup->ssup_extra = rss;
+	ssup->comparator = record_fastcmp;
+
+	if (ssup->abbreviate)
+	{
+		/*
+		 * We don't know yet how the first column's keys will be compared;
+		 * record_abbrev_convert() overwrites this once it has seen a value.
+		 * No comparisons can happen before then.
+		 */
+		ssup->comparator = ssup_datum_unsigned_cmp;
+		ssup->abbrev_converter = record_abbrev_convert;
+		ssup->abbrev_abort = record_abbrev_abort;
+		ssup->abbrev_full_comparator = record_fastcmp;
+	}
+
+	PG_RETURN_VOID();
+}
+
 
 /*
  * record_image_cmp :
@@ -2219,6 +2219,7 @@ timestamp_cmp(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(timestamp_cmp_internal(dt1, dt2));
 }
 
+#if !defined(HAVE_INT64_TIMESTAMP) || !defined(USE_FLOAT8_BYVAL)
 /* note: this is used for timestamptz also */
 static int
 timestamp_fastcmp(Datum x, Datum y, SortSupport ssup)
@@ -2228,13 +2229,19 @@ timestamp_fastcmp(Datum x, Datum y, SortSupport ssup)
 
 	return timestamp_cmp_internal(a, b);
 }
+#endif
 
 Datum
 timestamp_sortsupport(PG_FUNCTION_ARGS)
 {
 	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
 
+#if defined(HAVE_INT64_TIMESTAMP) && defined(USE_FLOAT8_BYVAL)
+	/* integer timestamps stored directly in Datums compare as int64 */
+	ssup->comparator = ssup_datum_signed_cmp;
+#else
 	ssup->comparator = timestamp_fastcmp;
+#endif
 	PG_RETURN_VOID();
 }
 
@@ -2518,6 +2525,55 @@ interval_cmp(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(interval_cmp_internal(interval1, interval2));
 }
 
+static int
+interval_fastcmp(Datum x, Datum y, SortSupport ssup)
+{
+	Interval   *a = DatumGetIntervalP(x);
+	Interval   *b = DatumGetIntervalP(y);
+
+	return interval_cmp_internal(a, b);
+}
+
+#if defined(HAVE_INT64_TIMESTAMP) && SIZEOF_DATUM >= 8
+/*
+ * Intervals are compared by their net span, which with integer datetimes is
+ * a single int64.  That makes a lossless abbreviated key, compared as a
+ * signed integer, so there is never any reason to abort abbreviation.
+ */
+static Datum
+interval_abbrev_convert(Datum original, SortSupport ssup)
+{
+	Interval   *authoritative = DatumGetIntervalP(original);
+
+	return (Datum) interval_cmp_value(authoritative);
+}
+
+static bool
+interval_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+	return false;
+}
+#endif
+
+Datum
+interval_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+
+	ssup->comparator = interval_fastcmp;
+
+#if defined(HAVE_INT64_TIMESTAMP) && SIZEOF_DATUM >= 8
+	if (ssup->abbreviate)
+	{
+		ssup->comparator = ssup_datum_signed_cmp;
+		ssup->abbrev_converter = interval_abbrev_convert;
+		ssup->abbrev_abort = interval_abbrev_abort;
+		ssup->abbrev_full_comparator = interval_fastcmp;
+	}
+#endif
+	PG_RETURN_VOID();
+}
+
 /*
  * Hashing for intervals
  *
@@ -505,6 +505,31 @@ InitializeMaxBackends(void)
 		elog(ERROR, "too many backends configured");
 }
 
+/*
+ * Initialize the number of fast-path lock groups from max_locks_per_xact.
+ *
+ * Each group holds FP_LOCK_SLOTS_PER_GROUP relation locks.  We size the
+ * per-backend fast-path area so that a transaction using up to
+ * max_locks_per_transaction relation locks can normally keep all of them
+ * there, rounding up to a power of two so that a relation's group can be
+ * found by masking its hash.
+ *
+ * Like InitializeMaxBackends, this must be called before shared memory size
+ * is determined, and in EXEC_BACKEND builds the value is passed down to
+ * subprocesses via BackendParameters.
+ */
+void
+InitializeFastPathLocks(void)
+{
+	Assert(FastPathLockGroupsPerBackend == 0);
+
+	FastPathLockGroupsPerBackend = 1;
+	while (FastPathLockGroupsPerBackend < FP_LOCK_GROUPS_PER_BACKEND_MAX &&
+		   FastPathLockGroupsPerBackend * FP_LOCK_SLOTS_PER_GROUP <
+		   max_locks_per_xact)
+		FastPathLockGroupsPerBackend *= 2;
+}
+
 /*
  * Early initialization of a backend (either standalone or under postmaster).
  * This happens even before InitPostgres.
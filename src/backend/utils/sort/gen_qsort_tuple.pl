@@ -53,6 +53,25 @@ print <<'EOM';
 EOM
 emit_qsort_implementation();
 
+# Variants for sorts whose leading key is compared by one of the specialized
+# Datum comparators in sortsupport.c.  The comparison functions
+# cmp_tuple_unsigned() and so on are defined in tuplesort.c.
+$SUFFIX      = 'tuple_unsigned';
+$EXTRAARGS   = ', Tuplesortstate *state';
+$EXTRAPARAMS = ', state';
+$CMPPARAMS   = ', state';
+print "\n";
+emit_qsort_implementation();
+
+$SUFFIX = 'tuple_signed';
+print "\n#if SIZEOF_DATUM >= 8\n\n";
+emit_qsort_implementation();
+print "\n#endif\n";
+
+$SUFFIX = 'tuple_int32';
+print "\n";
+emit_qsort_implementation();
+
 sub emit_qsort_boilerplate
 {
 	print <<'EOM';
@@ -59,6 +59,14 @@
  * of releasing many blocks followed by re-using many blocks, due to
  * tuplesort.c's "preread" behavior.
  *
+ * A tape being read destructively (that is, one that is not frozen) can be
+ * given a read buffer larger than one block with
+ * LogicalTapeAssignReadBufferSize().  We then fill the whole buffer each
+ * time it runs dry, which turns many small reads scattered over all the
+ * input tapes of a merge into fewer, longer runs of reads from each tape.
+ * tuplesort.c sizes these buffers from the sort memory that is no longer
+ * needed to hold tuples once the initial runs have been written.
+ *
  * Since all the bookkeeping and buffer memory is allocated with palloc(),
  * and the underlying file(s) are made with OpenTemporaryFile, all resources
  * for a logical tape set are certain to be cleaned up even if processing
@@ -79,6 +87,7 @@
 
 #include "storage/buffile.h"
 #include "utils/logtape.h"
+#include "utils/memutils.h"
 
 /*
  * Block indexes are "long"s, so we can fit this many per indirect block.
@@ -124,13 +133,18 @@ typedef struct LogicalTape
 	int			lastBlockBytes; /* valid bytes in last (incomplete) block */
 
 	/*
-	 * Buffer for current data block.  Note we don't bother to store the
+	 * Buffer for current data block(s).  Note we don't bother to store the
 	 * actual file block number of the data block (during the write phase it
 	 * hasn't been assigned yet, and during read we don't care anymore). But
 	 * we do need the relative block number so we can detect end-of-tape while
-	 * reading.
+	 * reading.  While writing, and while reading a frozen tape, the buffer
+	 * holds exactly one block.  While reading an unfrozen tape it may hold
+	 * several consecutive blocks of the tape, in which case curBlockNumber is
+	 * that of the last one.
 	 */
 	char	   *buffer;			/* physical buffer (separately palloc'd) */
+	int			buffer_size;	/* allocated size of the buffer */
+	int			read_buffer_size;	/* buffer size to use for next read pass */
 	long		curBlockNumber; /* this block's logical blk# within tape */
 	int			pos;			/* next read/write position in buffer */
 	int			nbytes;			/* total # of valid bytes in buffer */
@@ -188,6 +202,8 @@ static long ltsRecallNextBlockNum(LogicalTapeSet *lts,
 static long ltsRecallPrevBlockNum(LogicalTapeSet *lts,
 					  IndirectBlock *indirect);
 static void ltsDumpBuffer(LogicalTapeSet *lts, LogicalTape *lt);
+static void ltsReadFillBuffer(LogicalTapeSet *lts, LogicalTape *lt,
+				  long datablocknum);
 
 
 /*
@@ -546,6 +562,8 @@ LogicalTapeSetCreate(int ntapes)
 		lt->numFullBlocks = 0L;
 		lt->lastBlockBytes = 0;
 		lt->buffer = NULL;
+		lt->buffer_size = 0;
+		lt->read_buffer_size = BLCKSZ;
 		lt->curBlockNumber = 0L;
 		lt->pos = 0;
 		lt->nbytes = 0;
@@ -610,6 +628,39 @@ ltsDumpBuffer(LogicalTapeSet *lts, LogicalTape *lt)
 	/* Caller must do other state update as needed */
 }
 
+/*
+ * Load data into the buffer of a tape in read state, starting with the given
+ * data block, which must be block curBlockNumber of the tape.  As many
+ * further blocks are read as fit into the buffer; curBlockNumber is advanced
+ * to the last block loaded.
+ */
+static void
+ltsReadFillBuffer(LogicalTapeSet *lts, LogicalTape *lt, long datablocknum)
+{
+	lt->pos = 0;
+	lt->nbytes = 0;
+
+	for (;;)
+	{
+		int			thisbytes;
+
+		ltsReadBlock(lts, datablocknum, (void *) (lt->buffer + lt->nbytes));
+		if (!lt->frozen)
+			ltsReleaseBlock(lts, datablocknum);
+		thisbytes = (lt->curBlockNumber < lt->numFullBlocks) ?
+			BLCKSZ : lt->lastBlockBytes;
+		lt->nbytes += thisbytes;
+
+		/* Stop at the last block of the tape, or when the buffer is full */
+		if (thisbytes < BLCKSZ || lt->nbytes + BLCKSZ > lt->buffer_size)
+			break;
+		datablocknum = ltsRecallNextBlockNum(lts, lt->indirect, lt->frozen);
+		if (datablocknum == -1L)
+			break;
+		lt->curBlockNumber++;
+	}
+}
+
 /*
  * Write to a logical tape.
  *
@@ -628,7 +679,10 @@ LogicalTapeWrite(LogicalTapeSet *lts, int tapenum,
 
 	/* Allocate data buffer and first indirect block on first write */
 	if (lt->buffer == NULL)
+	{
 		lt->buffer = (char *) palloc(BLCKSZ);
+		lt->buffer_size = BLCKSZ;
+	}
 	if (lt->indirect == NULL)
 	{
 		lt->indirect = (IndirectBlock *) palloc(sizeof(IndirectBlock));
@@ -699,6 +753,14 @@ LogicalTapeRewind(LogicalTapeSet *lts, int tapenum, bool forWrite)
 			lt->lastBlockBytes = lt->nbytes;
 			lt->writing = false;
 			datablocknum = ltsRewindIndirectBlock(lts, lt->indirect, false);
+
+			/* Switch to the requested read buffer size, if it differs */
+			if (lt->buffer != NULL && lt->buffer_size != lt->read_buffer_size)
+			{
+				pfree(lt->buffer);
+				lt->buffer = (char *) palloc(lt->read_buffer_size);
+				lt->buffer_size = lt->read_buffer_size;
+			}
 		}
 		else
 		{
@@ -709,18 +771,12 @@ LogicalTapeRewind(LogicalTapeSet *lts, int tapenum, bool forWrite)
 			Assert(lt->frozen);
 			datablocknum = ltsRewindFrozenIndirectBlock(lts, lt->indirect);
 		}
-		/* Read the first block, or reset if tape is empty */
+		/* Fill the buffer, or reset if tape is empty */
 		lt->curBlockNumber = 0L;
 		lt->pos = 0;
 		lt->nbytes = 0;
 		if (datablocknum != -1L)
-		{
-			ltsReadBlock(lts, datablocknum, (void *) lt->buffer);
-			if (!lt->frozen)
-				ltsReleaseBlock(lts, datablocknum);
-			lt->nbytes = (lt->curBlockNumber < lt->numFullBlocks) ?
-				BLCKSZ : lt->lastBlockBytes;
-		}
+			ltsReadFillBuffer(lts, lt, datablocknum);
 	}
 	else
 	{
@@ -747,6 +803,14 @@ LogicalTapeRewind(LogicalTapeSet *lts, int tapenum, bool forWrite)
 			lt->indirect->nextSlot = 0;
 			lt->indirect->nextup = NULL;
 		}
+		/* Go back to a single-block buffer for writing */
+		if (lt->buffer != NULL && lt->buffer_size != BLCKSZ)
+		{
+			pfree(lt->buffer);
+			lt->buffer = NULL;
+			lt->buffer_size = 0;
+		}
+		lt->read_buffer_size = BLCKSZ;
 		lt->writing = true;
 		lt->dirty = false;
 		lt->numFullBlocks = 0L;
@@ -757,6 +821,31 @@ LogicalTapeRewind(LogicalTapeSet *lts, int tapenum, bool forWrite)
 	}
 }
 
+/*
+ * Set the size of the buffer to use when the given tape is next rewound for
+ * reading.  The size is rounded down to a multiple of BLCKSZ, but is at
+ * least BLCKSZ.
+ *
+ * This must be called while the tape is still in write state, and only
+ * affects destructive reads: a frozen tape always uses a single-block
+ * buffer, since LogicalTapeBackspace and LogicalTapeSeek depend on that.
+ * The caller is responsible for accounting for the memory used.
+ */
+void
+LogicalTapeAssignReadBufferSize(LogicalTapeSet *lts, int tapenum,
+								size_t bufsize)
+{
+	LogicalTape *lt;
+
+	Assert(tapenum >= 0 && tapenum < lts->nTapes);
+	lt = &lts->tapes[tapenum];
+	Assert(lt->writing);
+
+	bufsize = Min(bufsize, MaxAllocSize);
+	bufsize = (bufsize / BLCKSZ) * BLCKSZ;
+	lt->read_buffer_size = (int) Max(bufsize, BLCKSZ);
+}
+
 /*
  * Read from a logical tape.
  *
@@ -785,12 +874,7 @@ LogicalTapeRead(LogicalTapeSet *lts, int tapenum,
 			if (datablocknum == -1L)
 				break;			/* EOF */
 			lt->curBlockNumber++;
-			lt->pos = 0;
-			ltsReadBlock(lts, datablocknum, (void *) lt->buffer);
-			if (!lt->frozen)
-				ltsReleaseBlock(lts, datablocknum);
-			lt->nbytes = (lt->curBlockNumber < lt->numFullBlocks) ?
-				BLCKSZ : lt->lastBlockBytes;
+			ltsReadFillBuffer(lts, lt, datablocknum);
 			if (lt->nbytes <= 0)
 				break;			/* EOF (possible here?) */
 		}
@@ -836,6 +920,7 @@ LogicalTapeFreeze(LogicalTapeSet *lts, int tapenum)
 	 * Completion of a write phase.  Flush last partial data block, flush any
 	 * partial indirect blocks, rewind for nondestructive read.
 	 */
+	Assert(lt->buffer == NULL || lt->buffer_size == BLCKSZ);
 	if (lt->dirty)
 		ltsDumpBuffer(lts, lt);
 	lt->lastBlockBytes = lt->nbytes;
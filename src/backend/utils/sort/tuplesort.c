@@ -11,24 +11,18 @@
  * algorithm.
  *
  * See Knuth, volume 3, for more than you want to know about the external
- * sorting algorithm.  We divide the input into sorted runs using replacement
- * selection, in the form of a priority tree implemented as a heap
- * (essentially his Algorithm 5.2.3H), then merge the runs using polyphase
- * merge, Knuth's Algorithm 5.4.2D.  The logical "tapes" used by Algorithm D
- * are implemented by logtape.c, which avoids space wastage by recycling
- * disk space as soon as each block is read from its "tape".
- *
- * We do not form the initial runs using Knuth's recommended replacement
- * selection data structure (Algorithm 5.4.1R), because it uses a fixed
- * number of records in memory at all times.  Since we are dealing with
- * tuples that may vary considerably in size, we want to be able to vary
- * the number of records kept in memory to ensure full utilization of the
- * allowed sort memory space.  So, we keep the tuples in a variable-size
- * heap, with the next record to go out at the top of the heap.  Like
- * Algorithm 5.4.1R, each record is stored with the run number that it
- * must go into, and we use (run number, key) as the ordering key for the
- * heap.  When the run number at the top of the heap changes, we know that
- * no more records of the prior run are left in the heap.
+ * sorting algorithm.  Historically, we divided the input into sorted runs
+ * using replacement selection, in the form of a priority tree implemented
+ * as a heap (essentially his Algorithm 5.2.3H), and merged the runs using
+ * polyphase merge, Knuth's Algorithm 5.4.2D.  Both choices assume tape
+ * drives are scarce and memory is tiny.  Neither holds for us: a heap is
+ * cache-unfriendly compared to quicksort once it no longer fits in CPU
+ * cache, and a "tape drive" costs us only a few Kb of buffers.  So we now
+ * form runs by quicksorting workMem-sized batches of tuples, and merge them
+ * with a balanced k-way merge that uses as many input tapes as memory
+ * allows.  The logical "tapes" are implemented by logtape.c, which avoids
+ * space wastage by recycling disk space as soon as each block is read from
+ * its "tape".
  *
  * The approximate amount of memory allowed for any one sort operation
  * is specified in kilobytes by the caller (most pass work_mem).  Initially,
@@ -36,32 +30,43 @@
  * we haven't exceeded workMem.  If we reach the end of the input without
  * exceeding workMem, we sort the array using qsort() and subsequently return
  * tuples just by scanning the tuple array sequentially.  If we do exceed
- * workMem, we construct a heap using Algorithm H and begin to emit tuples
- * into sorted runs in temporary tapes, emitting just enough tuples at each
- * step to get back within the workMem limit.  Whenever the run number at
- * the top of the heap changes, we begin a new run with a new output tape
- * (selected per Algorithm D).  After the end of the input is reached,
- * we dump out remaining tuples in memory into a final run (or two),
- * then merge the runs using Algorithm D.
+ * workMem, we sort the array using qsort() and write it out to a temporary
+ * tape as a sorted run.  Then we go back to absorbing tuples into the
+ * now-empty array, and each time memory fills up again we quicksort and
+ * dump another run.  Runs are distributed round-robin over up to maxTapes
+ * output tapes.  After the end of the input is reached, we dump out the
+ * remaining tuples in memory into a final run, then merge the runs.
+ *
+ * Merging proceeds in passes.  In each pass, the tapes written by the
+ * previous pass (or by run generation) become the input tapes.  We merge
+ * one run from each input tape into a single output run, repeating until
+ * all input runs are consumed; the output runs are again distributed
+ * round-robin over a fresh set of output tapes.  Since each input tape
+ * holds nearly the same number of runs, a pass reduces the number of runs
+ * by a factor of about maxTapes.  With the merge order we can afford for
+ * any reasonable workMem, a single pass nearly always suffices.
  *
  * When merging runs, we use a heap containing just the frontmost tuple from
  * each source run; we repeatedly output the smallest tuple and insert the
  * next tuple from its source tape (if any).  When the heap empties, the merge
  * is complete.  The basic merge algorithm thus needs very little memory ---
- * only M tuples for an M-way merge, and M is constrained to a small number.
- * However, we can still make good use of our full workMem allocation by
- * pre-reading additional tuples from each source tape.  Without prereading,
- * our access pattern to the temporary file would be very erratic; on average
- * we'd read one block from each of M source tapes during the same time that
- * we're writing M blocks to the output tape, so there is no sequentiality of
- * access at all, defeating the read-ahead methods used by most Unix kernels.
- * Worse, the output tape gets written into a very random sequence of blocks
- * of the temp file, ensuring that things will be even worse when it comes
- * time to read that tape.  A straightforward merge pass thus ends up doing a
- * lot of waiting for disk seeks.  We can improve matters by prereading from
- * each source tape sequentially, loading about workMem/M bytes from each tape
- * in turn.  Then we run the merge algorithm, writing but not reading until
- * one of the preloaded tuple series runs out.  Then we switch back to preread
+ * only M tuples for an M-way merge.  However, we can still make good use of
+ * our full workMem allocation, which is no longer needed to hold tuples once
+ * the last run has been written.  Part of it is given to logtape.c as
+ * multi-block read buffers for the input tapes, so that each tape is read
+ * in large sequential chunks.  The rest is used for pre-reading additional
+ * tuples from each source tape.  Without prereading, our access pattern to
+ * the temporary file would be very erratic; on average we'd read one block
+ * from each of M source tapes during the same time that we're writing M
+ * blocks to the output tape, so there is no sequentiality of access at all,
+ * defeating the read-ahead methods used by most Unix kernels.  Worse, the
+ * output tape gets written into a very random sequence of blocks of the
+ * temp file, ensuring that things will be even worse when it comes time to
+ * read that tape.  A straightforward merge pass thus ends up doing a lot of
+ * waiting for disk seeks.  We can improve matters by prereading from each
+ * source tape sequentially, loading about workMem/M bytes from each tape in
+ * turn.  Then we run the merge algorithm, writing but not reading until one
+ * of the preloaded tuple series runs out.  Then we switch back to preread
  * mode, fill memory again, and repeat.  This approach helps to localize both
  * read and write accesses.
  *
@@ -69,22 +74,16 @@
  * the final sorted run on a logical tape which is then "frozen", so
  * that we can access it randomly.  When the caller does not need random
  * access, we return from tuplesort_performsort() as soon as we are down
- * to one run per logical tape.  The final merge is then performed
+ * to one run per input tape.  The final merge is then performed
  * on-the-fly as the caller repeatedly calls tuplesort_getXXX; this
  * saves one cycle of writing all the data out to disk and reading it in.
  *
- * Before Postgres 8.2, we always used a seven-tape polyphase merge, on the
- * grounds that 7 is the "sweet spot" on the tapes-to-passes curve according
- * to Knuth's figure 70 (section 5.4.2).  However, Knuth is assuming that
- * tape drives are expensive beasts, and in particular that there will always
- * be many more runs than tape drives.  In our implementation a "tape drive"
- * doesn't cost much more than a few Kb of memory buffers, so we can afford
- * to have lots of them.  In particular, if we can have as many tape drives
- * as sorted runs, we can eliminate any repeated I/O at all.  In the current
- * code we determine the number of tapes M on the basis of workMem: we want
+ * We determine the number of tapes M on the basis of workMem: we want
  * workMem/M to be large enough that we read a fair amount of data each time
- * we preread from a tape, so as to maintain the locality of access described
- * above.  Nonetheless, with large workMem we can have many tapes.
+ * we read from a tape, so as to maintain the locality of access described
+ * above.  Nonetheless, with large workMem we can have many tapes.  We cap M
+ * at MAXORDER, since merging a very large number of runs at once makes the
+ * merge heap itself too expensive to maintain.
  *
  *
  * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
@@ -103,6 +102,7 @@
 #include "access/htup_details.h"
 #include "access/nbtree.h"
 #include "catalog/index.h"
+#include "catalog/pg_am.h"
 #include "commands/tablespace.h"
 #include "executor/executor.h"
 #include "miscadmin.h"
@@ -160,10 +160,10 @@ bool		optimize_bounded_sort = true;
  * described above.  Accordingly, "tuple" is always used in preference to
  * datum1 as the authoritative value for pass-by-reference cases.
  *
- * While building initial runs, tupindex holds the tuple's run number.  During
- * merge passes, we re-use it to hold the input tape number that each tuple in
- * the heap was read from, or to hold the index of the next tuple pre-read
- * from the same tape in the case of pre-read entries.  tupindex goes unused
+ * During merge passes, tupindex holds the input tape index (that is, the
+ * index into inputTapes[]) that each tuple in the heap was read from, or
+ * the index of the next tuple pre-read from the same tape in the case of
+ * pre-read entries.  tupindex goes unused while building initial runs and
  * if the sort occurs entirely in memory.
  */
 typedef struct
@@ -198,9 +198,11 @@ typedef enum
  * volumes, but it's probably close enough --- see logtape.c).
  *
  * MERGE_BUFFER_SIZE is how much data we'd like to read from each input
- * tape during a preread cycle (see discussion at top of file).
+ * tape during a merge, split between its logtape.c read buffer and the
+ * tuples we preread from it (see discussion at top of file).
  */
 #define MINORDER		6		/* minimum merge order */
+#define MAXORDER		500		/* maximum merge order */
 #define TAPE_BUFFER_OVERHEAD		(BLCKSZ * 3)
 #define MERGE_BUFFER_SIZE			(BLCKSZ * 32)
 
@@ -221,8 +223,8 @@ struct Tuplesortstate
 	int			bound;			/* if bounded, the maximum number of tuples */
 	int64		availMem;		/* remaining memory available, in bytes */
 	int64		allowedMem;		/* total memory allowed, in bytes */
-	int			maxTapes;		/* number of tapes (Knuth's T) */
-	int			tapeRange;		/* maxTapes-1 (Knuth's P) */
+	int			maxTapes;		/* max number of input tapes to merge in each
+								 * pass */
 	MemoryContext sortcontext;	/* memory context holding all sort data */
 	LogicalTapeSet *tapeset;	/* logtape.c object for tapes in a temp file */
 
@@ -267,11 +269,12 @@ struct Tuplesortstate
 	/*
 	 * This array holds the tuples now in sort memory.  If we are in state
 	 * INITIAL, the tuples are in no particular order; if we are in state
-	 * SORTEDINMEM, the tuples are in final sorted order; in states BUILDRUNS
-	 * and FINALMERGE, the tuples are organized in "heap" order per Algorithm
-	 * H.  (Note that memtupcount only counts the tuples that are part of the
-	 * heap --- during merge passes, memtuples[] entries beyond tapeRange are
-	 * never in the heap and are used to hold pre-read tuples.)  In state
+	 * SORTEDINMEM, the tuples are in final sorted order; in state BUILDRUNS,
+	 * they are the not-yet-sorted tuples of the next run; in state
+	 * FINALMERGE, the tuples are organized in "heap" order per Algorithm H.
+	 * (Note that memtupcount only counts the tuples that are part of the
+	 * heap --- during merge passes, memtuples[] entries beyond nInputTapes
+	 * are never in the heap and are used to hold pre-read tuples.)  In state
 	 * SORTEDONTAPE, the array is not used.
 	 */
 	SortTuple  *memtuples;		/* array of SortTuple structs */
@@ -280,8 +283,9 @@ struct Tuplesortstate
 	bool		growmemtuples;	/* memtuples' growth still underway? */
 
 	/*
-	 * While building initial runs, this is the current output run number
-	 * (starting at 0).  Afterwards, it is the number of initial runs we made.
+	 * While building initial runs, this is the number of runs written so far
+	 * (the current output run is currentRun - 1).  Afterwards, it is the
+	 * number of initial runs we made.
 	 */
 	int			currentRun;
 
@@ -292,10 +296,11 @@ struct Tuplesortstate
 
 	/*
 	 * These variables are only used during merge passes.  mergeactive[i] is
-	 * true if we are reading an input run from (actual) tape number i and
-	 * have not yet exhausted that run.  mergenext[i] is the memtuples index
-	 * of the next pre-read tuple (next to be loaded into the heap) for tape
-	 * i, or 0 if we are out of pre-read tuples.  mergelast[i] similarly
+	 * true if we are reading an input run from input tape i (that is, actual
+	 * tape number inputTapes[i]) and have not yet exhausted that run.
+	 * mergenext[i] is the memtuples index of the next pre-read tuple (next
+	 * to be loaded into the heap) for input tape i, or 0 if we are out of
+	 * pre-read tuples.  mergelast[i] similarly
 	 * points to the last pre-read tuple from each tape.  mergeavailslots[i]
 	 * is the number of unused memtuples[] slots reserved for tape i, and
 	 * mergeavailmem[i] is the amount of unused space allocated for tape i.
@@ -314,17 +319,20 @@ struct Tuplesortstate
 	int			mergefirstfree; /* first slot never used in this merge */
 
 	/*
-	 * Variables for Algorithm D.  Note that destTape is a "logical" tape
-	 * number, ie, an index into the tp_xxx[] arrays.  Be careful to keep
-	 * "logical" and "actual" tape numbers straight!
+	 * Variables for the balanced merge.  The tape set holds 2 * maxTapes
+	 * tapes; inputTapes[] and outputTapes[] hold the actual tape numbers of
+	 * the tapes being read and written in the current pass, and trade places
+	 * at the start of each pass.  destTape is an index into outputTapes[].
+	 * Be careful to keep tape indexes and actual tape numbers straight!
 	 */
-	int			Level;			/* Knuth's l */
-	int			destTape;		/* current output tape (Knuth's j, less 1) */
-	int		   *tp_fib;			/* Target Fibonacci run counts (A[]) */
-	int		   *tp_runs;		/* # of real runs on each tape */
-	int		   *tp_dummy;		/* # of dummy runs for each tape (D[]) */
-	int		   *tp_tapenum;		/* Actual tape numbers (TAPE[]) */
-	int			activeTapes;	/* # of active input tapes in merge pass */
+	int		   *inputTapes;		/* actual tape numbers of input tapes */
+	int			nInputTapes;	/* # of input tapes in current pass */
+	int			nInputRuns;		/* # of runs left on the input tapes */
+	int		   *outputTapes;	/* actual tape numbers of output tapes */
+	int			nOutputTapes;	/* # of output tapes written so far */
+	int			nOutputRuns;	/* # of runs written to the output tapes */
+	int			destTape;		/* current output tape (outputTapes[] index) */
+	int			activeTapes;	/* # of active input tapes in merge step */
 
 	/*
 	 * These variables are used after completion of sorting to keep track of
@@ -354,6 +362,14 @@ struct Tuplesortstate
 	 */
 	SortSupport onlyKey;
 
+	/*
+	 * Does SortTuple.datum1 hold the value (or abbreviation) of the leading
+	 * key in sortKeys[0]?  That's not the case for hash index sorts, nor for
+	 * CLUSTER sorts whose leading index column is an expression.  It decides
+	 * whether the specialized qsort routines can be used.
+	 */
+	bool		haveDatum1;
+
 	/*
 	 * Additional state for managing "abbreviated key" sortsupport routines
 	 * (which currently may be used by all cases except the hash index case).
@@ -470,9 +486,10 @@ static void mergeprereadone(Tuplesortstate *state, int srcTape);
 static void dumptuples(Tuplesortstate *state, bool alltuples);
 static void make_bounded_heap(Tuplesortstate *state);
 static void sort_bounded_heap(Tuplesortstate *state);
+static void tuplesort_sort_memtuples(Tuplesortstate *state);
 static void tuplesort_heap_insert(Tuplesortstate *state, SortTuple *tuple,
-					  int tupleindex, bool checkIndex);
-static void tuplesort_heap_siftup(Tuplesortstate *state, bool checkIndex);
+					  int tupleindex);
+static void tuplesort_heap_siftup(Tuplesortstate *state);
 static void reversedirection(Tuplesortstate *state);
 static unsigned int getlen(Tuplesortstate *state, int tapenum, bool eofOK);
 static void markrunend(Tuplesortstate *state, int tapenum);
@@ -508,12 +525,67 @@ static void readtup_datum(Tuplesortstate *state, SortTuple *stup,
 			  int tapenum, unsigned int len);
 static void free_sort_tuple(Tuplesortstate *state, SortTuple *stup);
 
+/*
+ * Comparison functions for the specialized qsort variants below.  These are
+ * used when the leading key's comparator is one of the ssup_datum_xxx_cmp
+ * functions, so that it can be inlined.  Ties on the leading key are broken
+ * with the regular comparetup function, unless there is only one key.
+ */
+static inline int
+cmp_tuple_unsigned(const SortTuple *a, const SortTuple *b,
+				   Tuplesortstate *state)
+{
+	int			compare;
+
+	compare = ApplyUnsignedSortComparator(a->datum1, a->isnull1,
+										  b->datum1, b->isnull1,
+										  state->sortKeys);
+	if (compare != 0 || state->onlyKey != NULL)
+		return compare;
+
+	return state->comparetup(a, b, state);
+}
+
+#if SIZEOF_DATUM >= 8
+static inline int
+cmp_tuple_signed(const SortTuple *a, const SortTuple *b,
+				 Tuplesortstate *state)
+{
+	int			compare;
+
+	compare = ApplySignedSortComparator(a->datum1, a->isnull1,
+										b->datum1, b->isnull1,
+										state->sortKeys);
+	if (compare != 0 || state->onlyKey != NULL)
+		return compare;
+
+	return state->comparetup(a, b, state);
+}
+#endif
+
+static inline int
+cmp_tuple_int32(const SortTuple *a, const SortTuple *b,
+				Tuplesortstate *state)
+{
+	int			compare;
+
+	compare = ApplyInt32SortComparator(a->datum1, a->isnull1,
+									   b->datum1, b->isnull1,
+									   state->sortKeys);
+	if (compare != 0 || state->onlyKey != NULL)
+		return compare;
+
+	return state->comparetup(a, b, state);
+}
+
 /*
  * Special versions of qsort just for SortTuple objects.  qsort_tuple() sorts
  * any variant of SortTuples, using the appropriate comparetup function.
  * qsort_ssup() is specialized for the case where the comparetup function
  * reduces to ApplySortComparator(), that is single-key MinimalTuple sorts
- * and Datum sorts.
+ * and Datum sorts.  qsort_tuple_unsigned(), qsort_tuple_signed() and
+ * qsort_tuple_int32() inline the comparison of the leading key when its
+ * comparator is one of the specialized Datum comparators.
  */
 #include "qsort_tuple.c"
 
@@ -597,7 +669,7 @@ tuplesort_begin_common(int workMem, bool randomAccess)
 	state->currentRun = 0;
 
 	/*
-	 * maxTapes, tapeRange, and Algorithm D variables will be initialized by
+	 * maxTapes and the merge pass variables will be initialized by
 	 * inittapes(), if needed
 	 */
 
@@ -642,6 +714,7 @@ tuplesort_begin_heap(TupleDesc tupDesc,
 	state->copytup = copytup_heap;
 	state->writetup = writetup_heap;
 	state->readtup = readtup_heap;
+	state->haveDatum1 = true;
 
 	state->tupDesc = tupDesc;	/* assume we need not copy tupDesc */
 	state->abbrevNext = 10;
@@ -698,11 +771,11 @@ tuplesort_begin_cluster(TupleDesc tupDesc,
 	if (trace_sort)
 		elog(LOG,
 			 "begin tuple sort: nkeys = %d, workMem = %d, randomAccess = %c",
-			 RelationGetNumberOfAttributes(indexRel),
+			 IndexRelationGetNumberOfKeyAttributes(indexRel),
 			 workMem, randomAccess ? 't' : 'f');
 #endif
 
-	state->nKeys = RelationGetNumberOfAttributes(indexRel);
+	state->nKeys = IndexRelationGetNumberOfKeyAttributes(indexRel);
 
 	TRACE_POSTGRESQL_SORT_START(CLUSTER_SORT,
 								false,	/* no unique check */
@@ -717,6 +790,7 @@ tuplesort_begin_cluster(TupleDesc tupDesc,
 	state->abbrevNext = 10;
 
 	state->indexInfo = BuildIndexInfo(indexRel);
+	state->haveDatum1 = (state->indexInfo->ii_KeyAttrNumbers[0] != 0);
 
 	state->tupDesc = tupDesc;	/* assume we need not copy tupDesc */
 
@@ -793,7 +867,7 @@ tuplesort_begin_index_btree(Relation heapRel,
 			 workMem, randomAccess ? 't' : 'f');
 #endif
 
-	state->nKeys = RelationGetNumberOfAttributes(indexRel);
+	state->nKeys = IndexRelationGetNumberOfKeyAttributes(indexRel);
 
 	TRACE_POSTGRESQL_SORT_START(INDEX_SORT,
 								enforceUnique,
@@ -805,6 +879,7 @@ tuplesort_begin_index_btree(Relation heapRel,
 	state->copytup = copytup_index;
 	state->writetup = writetup_index;
 	state->readtup = readtup_index;
+	state->haveDatum1 = true;
 	state->abbrevNext = 10;
 
 	state->heapRel = heapRel;
@@ -812,7 +887,7 @@ tuplesort_begin_index_btree(Relation heapRel,
 	state->enforceUnique = enforceUnique;
 
 	indexScanKey = _bt_mkscankey_nodata(indexRel);
-	state->nKeys = RelationGetNumberOfAttributes(indexRel);
+	state->nKeys = IndexRelationGetNumberOfKeyAttributes(indexRel);
 
 	/* Prepare SortSupport data for each column */
 	state->sortKeys = (SortSupport) palloc0(state->nKeys *
@@ -883,6 +958,67 @@ tuplesort_begin_index_hash(Relation heapRel,
 	return state;
 }
 
+Tuplesortstate *
+tuplesort_begin_index_gist(Relation heapRel,
+						   Relation indexRel,
+						   int workMem, bool randomAccess)
+{
+	Tuplesortstate *state = tuplesort_begin_common(workMem, randomAccess);
+	MemoryContext oldcontext;
+	int			i;
+
+	oldcontext = MemoryContextSwitchTo(state->sortcontext);
+
+#ifdef TRACE_SORT
+	if (trace_sort)
+		elog(LOG,
+			 "begin index sort: workMem = %d, randomAccess = %c",
+			 workMem, randomAccess ? 't' : 'f');
+#endif
+
+	state->nKeys = IndexRelationGetNumberOfKeyAttributes(indexRel);
+
+	/*
+	 * GiST keys have no notion of uniqueness, so this reuses the btree
+	 * comparator with enforceUnique left false; equal keys are ordered by
+	 * heap TID.
+	 */
+	state->comparetup = comparetup_index_btree;
+	state->copytup = copytup_index;
+	state->writetup = writetup_index;
+	state->readtup = readtup_index;
+	state->haveDatum1 = true;
+	state->abbrevNext = 10;
+
+	state->heapRel = heapRel;
+	state->indexRel = indexRel;
+
+	/* Prepare SortSupport data for each column */
+	state->sortKeys = (SortSupport) palloc0(state->nKeys *
+											sizeof(SortSupportData));
+
+	for (i = 0; i < state->nKeys; i++)
+	{
+		SortSupport sortKey = state->sortKeys + i;
+
+		sortKey->ssup_cxt = CurrentMemoryContext;
+		sortKey->ssup_collation = indexRel->rd_indcollation[i];
+		sortKey->ssup_nulls_first = false;
+		sortKey->ssup_attno = i + 1;
+		/* Convey if abbreviation optimization is applicable in principle */
+		sortKey->abbreviate = (i == 0);
+
+		AssertState(sortKey->ssup_attno != 0);
+
+		/* Look for a sort support function */
+		PrepareSortSupportFromGistIndexRel(indexRel, sortKey);
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return state;
+}
+
 Tuplesortstate *
 tuplesort_begin_datum(Oid datumType, Oid sortOperator, Oid sortCollation,
 					  bool nullsFirstFlag,
@@ -914,6 +1050,7 @@ tuplesort_begin_datum(Oid datumType, Oid sortOperator, Oid sortCollation,
 	state->copytup = copytup_datum;
 	state->writetup = writetup_datum;
 	state->readtup = readtup_datum;
+	state->haveDatum1 = true;
 	state->abbrevNext = 10;
 
 	state->datumType = datumType;
@@ -1456,7 +1593,7 @@ puttuple_common(Tuplesortstate *state, SortTuple *tuple)
 			inittapes(state);
 
 			/*
-			 * Dump tuples until we are back under the limit.
+			 * Sort and dump the tuples in memory as the first run.
 			 */
 			dumptuples(state, false);
 			break;
@@ -1481,34 +1618,23 @@ puttuple_common(Tuplesortstate *state, SortTuple *tuple)
 			{
 				/* discard top of heap, sift up, insert new tuple */
 				free_sort_tuple(state, &state->memtuples[0]);
-				tuplesort_heap_siftup(state, false);
-				tuplesort_heap_insert(state, tuple, 0, false);
+				tuplesort_heap_siftup(state);
+				tuplesort_heap_insert(state, tuple, 0);
 			}
 			break;
 
 		case TSS_BUILDRUNS:
 
 			/*
-			 * Insert the tuple into the heap, with run number currentRun if
-			 * it can go into the current run, else run number currentRun+1.
-			 * The tuple can go into the current run if it is >= the first
-			 * not-yet-output tuple.  (Actually, it could go into the current
-			 * run if it is >= the most recently output tuple ... but that
-			 * would require keeping around the tuple we last output, and it's
-			 * simplest to let writetup free each tuple as soon as it's
-			 * written.)
-			 *
-			 * Note there will always be at least one tuple in the heap at
-			 * this point; see dumptuples.
+			 * Save the tuple into the unsorted array of the next run.  We
+			 * don't grow the array any further once tapes are in use, but
+			 * dumptuples always leaves at least one free slot.
 			 */
-			Assert(state->memtupcount > 0);
-			if (COMPARETUP(state, tuple, &state->memtuples[0]) >= 0)
-				tuplesort_heap_insert(state, tuple, state->currentRun, true);
-			else
-				tuplesort_heap_insert(state, tuple, state->currentRun + 1, true);
+			Assert(state->memtupcount < state->memtupsize);
+			state->memtuples[state->memtupcount++] = *tuple;
 
 			/*
-			 * If we are over the memory limit, dump tuples till we're under.
+			 * If we are over the memory limit, sort and dump the run.
 			 */
 			dumptuples(state, false);
 			break;
@@ -1582,18 +1708,7 @@ tuplesort_performsort(Tuplesortstate *state)
 			 * We were able to accumulate all the tuples within the allowed
 			 * amount of memory.  Just qsort 'em and we're done.
 			 */
-			if (state->memtupcount > 1)
-			{
-				/* Can we use the single-key sort function? */
-				if (state->onlyKey != NULL)
-					qsort_ssup(state->memtuples, state->memtupcount,
-							   state->onlyKey);
-				else
-					qsort_tuple(state->memtuples,
-								state->memtupcount,
-								state->comparetup,
-								state);
-			}
+			tuplesort_sort_memtuples(state);
 			state->current = 0;
 			state->eof_reached = false;
 			state->markpos_offset = 0;
@@ -1817,7 +1932,7 @@ tuplesort_gettuple_common(Tuplesortstate *state, bool forward,
 					state->availMem += tuplen;
 					state->mergeavailmem[srcTape] += tuplen;
 				}
-				tuplesort_heap_siftup(state, false);
+				tuplesort_heap_siftup(state);
 				if ((tupIndex = state->mergenext[srcTape]) == 0)
 				{
 					/*
@@ -1839,7 +1954,7 @@ tuplesort_gettuple_common(Tuplesortstate *state, bool forward,
 				state->mergenext[srcTape] = newtup->tupindex;
 				if (state->mergenext[srcTape] == 0)
 					state->mergelast[srcTape] = 0;
-				tuplesort_heap_insert(state, newtup, srcTape, false);
+				tuplesort_heap_insert(state, newtup, srcTape);
 				/* put the now-unused memtuples entry on the freelist */
 				newtup->tupindex = state->mergefreelist;
 				state->mergefreelist = tupIndex;
@@ -2047,20 +2162,27 @@ tuplesort_merge_order(int64 allowedMem)
 	int			mOrder;
 
 	/*
-	 * We need one tape for each merge input, plus another one for the output,
-	 * and each of these tapes needs buffer space.  In addition we want
-	 * MERGE_BUFFER_SIZE workspace per input tape (but the output tape doesn't
-	 * count).
+	 * We need one tape for each merge input, and in a non-final merge pass
+	 * up to as many output tapes; each of these tapes needs buffer space.  In
+	 * addition we want MERGE_BUFFER_SIZE workspace per input tape (but the
+	 * output tapes don't count).
 	 *
 	 * Note: you might be thinking we need to account for the memtuples[]
 	 * array in this calculation, but we effectively treat that as part of the
 	 * MERGE_BUFFER_SIZE workspace.
 	 */
-	mOrder = (allowedMem - TAPE_BUFFER_OVERHEAD) /
-		(MERGE_BUFFER_SIZE + TAPE_BUFFER_OVERHEAD);
+	mOrder = allowedMem /
+		(2 * TAPE_BUFFER_OVERHEAD + MERGE_BUFFER_SIZE);
 
-	/* Even in minimum memory, use at least a MINORDER merge */
+	/*
+	 * Even in minimum memory, use at least a MINORDER merge.  On the other
+	 * hand, even when we have lots of memory, do not use more than a
+	 * MAXORDER merge.  Tapes are pretty cheap, but the cost of maintaining
+	 * the merge heap grows with the number of inputs, and beyond MAXORDER a
+	 * single merge pass covers any input we can reasonably expect.
+	 */
 	mOrder = Max(mOrder, MINORDER);
+	mOrder = Min(mOrder, MAXORDER);
 
 	return mOrder;
 }
@@ -2074,12 +2196,11 @@ static void
 inittapes(Tuplesortstate *state)
 {
 	int			maxTapes,
-				ntuples,
 				j;
 	int64		tapeSpace;
 
-	/* Compute number of tapes to use: merge order plus 1 */
-	maxTapes = tuplesort_merge_order(state->allowedMem) + 1;
+	/* Compute number of tapes to use: the merge order */
+	maxTapes = tuplesort_merge_order(state->allowedMem);
 
 	/*
 	 * We must have at least 2*maxTapes slots in the memtuples[] array, else
@@ -2089,7 +2210,6 @@ inittapes(Tuplesortstate *state)
 	maxTapes = Min(maxTapes, state->memtupsize / 2);
 
 	state->maxTapes = maxTapes;
-	state->tapeRange = maxTapes - 1;
 
 #ifdef TRACE_SORT
 	if (trace_sort)
@@ -2118,108 +2238,76 @@ inittapes(Tuplesortstate *state)
 	PrepareTempTablespaces();
 
 	/*
-	 * Create the tape set and allocate the per-tape data arrays.
+	 * Create the tape set and allocate the per-tape data arrays.  We need
+	 * maxTapes tapes for the inputs of a merge pass and as many again for its
+	 * outputs.  logtape.c doesn't allocate any buffers for a tape until it is
+	 * first written to, so unused tapes are cheap.
 	 */
-	state->tapeset = LogicalTapeSetCreate(maxTapes);
+	state->tapeset = LogicalTapeSetCreate(2 * maxTapes);
 
 	state->mergeactive = (bool *) palloc0(maxTapes * sizeof(bool));
 	state->mergenext = (int *) palloc0(maxTapes * sizeof(int));
 	state->mergelast = (int *) palloc0(maxTapes * sizeof(int));
 	state->mergeavailslots = (int *) palloc0(maxTapes * sizeof(int));
 	state->mergeavailmem = (int64 *) palloc0(maxTapes * sizeof(int64));
-	state->tp_fib = (int *) palloc0(maxTapes * sizeof(int));
-	state->tp_runs = (int *) palloc0(maxTapes * sizeof(int));
-	state->tp_dummy = (int *) palloc0(maxTapes * sizeof(int));
-	state->tp_tapenum = (int *) palloc0(maxTapes * sizeof(int));
-
-	/*
-	 * Convert the unsorted contents of memtuples[] into a heap. Each tuple is
-	 * marked as belonging to run number zero.
-	 *
-	 * NOTE: we pass false for checkIndex since there's no point in comparing
-	 * indexes in this step, even though we do intend the indexes to be part
-	 * of the sort key...
-	 */
-	ntuples = state->memtupcount;
-	state->memtupcount = 0;		/* make the heap empty */
-	for (j = 0; j < ntuples; j++)
-	{
-		/* Must copy source tuple to avoid possible overwrite */
-		SortTuple	stup = state->memtuples[j];
-
-		tuplesort_heap_insert(state, &stup, 0, false);
-	}
-	Assert(state->memtupcount == ntuples);
-
-	state->currentRun = 0;
+	state->inputTapes = (int *) palloc0(maxTapes * sizeof(int));
+	state->outputTapes = (int *) palloc0(maxTapes * sizeof(int));
 
 	/*
-	 * Initialize variables of Algorithm D (step D1).
+	 * Initial runs are written to the first half of the tape set; the first
+	 * merge pass will write to the second half.
 	 */
 	for (j = 0; j < maxTapes; j++)
 	{
-		state->tp_fib[j] = 1;
-		state->tp_runs[j] = 0;
-		state->tp_dummy[j] = 1;
-		state->tp_tapenum[j] = j;
+		state->outputTapes[j] = j;
+		state->inputTapes[j] = maxTapes + j;
 	}
-	state->tp_fib[state->tapeRange] = 0;
-	state->tp_dummy[state->tapeRange] = 0;
-
-	state->Level = 1;
+	state->nInputTapes = 0;
+	state->nInputRuns = 0;
+	state->nOutputTapes = 0;
+	state->nOutputRuns = 0;
 	state->destTape = 0;
 
+	state->currentRun = 0;
+
 	state->status = TSS_BUILDRUNS;
 }
 
 /*
- * selectnewtape -- select new tape for new initial run.
+ * selectnewtape -- select output tape for the next run.
  *
- * This is called after finishing a run when we know another run
- * must be started.  This implements steps D3, D4 of Algorithm D.
+ * This is called before writing each run, both while building initial runs
+ * and during merge passes.  Until we have maxTapes output tapes, each run
+ * goes onto a tape of its own; after that, runs are appended to the existing
+ * tapes in round-robin order, so that the run counts of any two tapes
+ * differ by at most one.  beginmerge() relies on that.
  */
 static void
 selectnewtape(Tuplesortstate *state)
 {
-	int			j;
-	int			a;
-
-	/* Step D3: advance j (destTape) */
-	if (state->tp_dummy[state->destTape] < state->tp_dummy[state->destTape + 1])
-	{
-		state->destTape++;
-		return;
-	}
-	if (state->tp_dummy[state->destTape] != 0)
-	{
-		state->destTape = 0;
-		return;
-	}
-
-	/* Step D4: increase level */
-	state->Level++;
-	a = state->tp_fib[0];
-	for (j = 0; j < state->tapeRange; j++)
-	{
-		state->tp_dummy[j] = a + state->tp_fib[j + 1] - state->tp_fib[j];
-		state->tp_fib[j] = a + state->tp_fib[j + 1];
-	}
-	state->destTape = 0;
+	if (state->nOutputTapes < state->maxTapes)
+		state->destTape = state->nOutputTapes++;
+	else
+		state->destTape = state->nOutputRuns % state->nOutputTapes;
+	state->nOutputRuns++;
 }
 
 /*
  * mergeruns -- merge all the completed initial runs.
  *
- * This implements steps D5, D6 of Algorithm D.  All input data has
- * already been written to initial runs on tape (see dumptuples).
+ * This performs a balanced multiway merge.  All input data has already been
+ * written to initial runs on tape (see dumptuples).  Each pass merges the
+ * runs on the tapes written by the previous pass, maxTapes at a time, onto
+ * a new set of output tapes, until a single run remains (or, if
+ * !randomAccess, until a single merge step remains, which is then done
+ * on-the-fly).
  */
 static void
 mergeruns(Tuplesortstate *state)
 {
-	int			tapenum,
-				svTape,
-				svRuns,
-				svDummy;
+	int			tapenum;
+	int		   *swapTapes;
+	int64		readBufferSize;
 
 	Assert(state->status == TSS_BUILDRUNS);
 	Assert(state->memtupcount == 0);
@@ -2227,12 +2315,11 @@ mergeruns(Tuplesortstate *state)
 	/*
 	 * If we produced only one initial run (quite likely if the total data
 	 * volume is between 1X and 2X workMem), we can just use that tape as the
-	 * finished output, rather than doing a useless merge.  (This obvious
-	 * optimization is not in Knuth's algorithm.)
+	 * finished output, rather than doing a useless merge.
 	 */
 	if (state->currentRun == 1)
 	{
-		state->result_tape = state->tp_tapenum[state->destTape];
+		state->result_tape = state->outputTapes[0];
 		/* must freeze and rewind the finished output tape */
 		LogicalTapeFreeze(state->tapeset, state->result_tape);
 		state->status = TSS_SORTEDONTAPE;
@@ -2255,118 +2342,102 @@ mergeruns(Tuplesortstate *state)
 		state->sortKeys->abbrev_full_comparator = NULL;
 	}
 
-	/* End of step D2: rewind all output tapes to prepare for merging */
-	for (tapenum = 0; tapenum < state->tapeRange; tapenum++)
-		LogicalTapeRewind(state->tapeset, tapenum, false);
+	/*
+	 * All the memory that held tuples during run building is free now.  Give
+	 * half of it to logtape.c as read buffers for the input tapes, so that
+	 * each tape is read in large sequential chunks, and leave the other half
+	 * for beginmerge() to divide up as preread space.  The first merge pass
+	 * has the most input tapes, so sizing the buffers for it is enough for
+	 * all later passes too.  One block of each buffer is already covered by
+	 * the TAPE_BUFFER_OVERHEAD charged in inittapes().
+	 */
+	readBufferSize = state->availMem / 2 / state->nOutputTapes;
+	readBufferSize = Min(readBufferSize, MaxAllocSize);
+	readBufferSize = Max(readBufferSize / BLCKSZ, 1) * BLCKSZ;
+	USEMEM(state, (readBufferSize - BLCKSZ) * state->nOutputTapes);
 
 	for (;;)
 	{
 		/*
-		 * At this point we know that tape[T] is empty.  If there's just one
-		 * (real or dummy) run left on each input tape, then only one merge
-		 * pass remains.  If we don't have to produce a materialized sorted
-		 * tape, we can stop at this point and do the final merge on-the-fly.
+		 * The output tapes of the previous pass (or of run building) become
+		 * the input tapes of this one.  The previous pass's input tapes have
+		 * been read to the end, so rewind them for reuse as output tapes.
 		 */
-		if (!state->randomAccess)
-		{
-			bool		allOneRun = true;
-
-			Assert(state->tp_runs[state->tapeRange] == 0);
-			for (tapenum = 0; tapenum < state->tapeRange; tapenum++)
-			{
-				if (state->tp_runs[tapenum] + state->tp_dummy[tapenum] != 1)
-				{
-					allOneRun = false;
-					break;
-				}
-			}
-			if (allOneRun)
-			{
-				/* Tell logtape.c we won't be writing anymore */
-				LogicalTapeSetForgetFreeSpace(state->tapeset);
-				/* Initialize for the final merge pass */
-				beginmerge(state);
-				state->status = TSS_FINALMERGE;
-				return;
-			}
-		}
-
-		/* Step D5: merge runs onto tape[T] until tape[P] is empty */
-		while (state->tp_runs[state->tapeRange - 1] ||
-			   state->tp_dummy[state->tapeRange - 1])
+		for (tapenum = 0; tapenum < state->nInputTapes; tapenum++)
+			LogicalTapeRewind(state->tapeset, state->inputTapes[tapenum],
+							  true);
+
+		swapTapes = state->inputTapes;
+		state->inputTapes = state->outputTapes;
+		state->outputTapes = swapTapes;
+		state->nInputTapes = state->nOutputTapes;
+		state->nInputRuns = state->nOutputRuns;
+		state->nOutputTapes = 0;
+		state->nOutputRuns = 0;
+
+		for (tapenum = 0; tapenum < state->nInputTapes; tapenum++)
 		{
-			bool		allDummy = true;
-
-			for (tapenum = 0; tapenum < state->tapeRange; tapenum++)
-			{
-				if (state->tp_dummy[tapenum] == 0)
-				{
-					allDummy = false;
-					break;
-				}
-			}
-
-			if (allDummy)
-			{
-				state->tp_dummy[state->tapeRange]++;
-				for (tapenum = 0; tapenum < state->tapeRange; tapenum++)
-					state->tp_dummy[tapenum]--;
-			}
-			else
-				mergeonerun(state);
+			LogicalTapeAssignReadBufferSize(state->tapeset,
+											state->inputTapes[tapenum],
+											(size_t) readBufferSize);
+			LogicalTapeRewind(state->tapeset, state->inputTapes[tapenum],
+							  false);
 		}
 
-		/* Step D6: decrease level */
-		if (--state->Level == 0)
-			break;
-		/* rewind output tape T to use as new input */
-		LogicalTapeRewind(state->tapeset, state->tp_tapenum[state->tapeRange],
-						  false);
-		/* rewind used-up input tape P, and prepare it for write pass */
-		LogicalTapeRewind(state->tapeset, state->tp_tapenum[state->tapeRange - 1],
-						  true);
-		state->tp_runs[state->tapeRange - 1] = 0;
+#ifdef TRACE_SORT
+		if (trace_sort)
+			elog(LOG, "starting merge pass of %d input runs on %d tapes, "
+				 INT64_FORMAT " KB of read buffer per tape: %s",
+				 state->nInputRuns, state->nInputTapes,
+				 readBufferSize / 1024,
+				 pg_rusage_show(&state->ru_start));
+#endif
 
 		/*
-		 * reassign tape units per step D6; note we no longer care about A[]
+		 * If there's just one run left on each input tape, then only one
+		 * merge step remains.  If we don't have to produce a materialized
+		 * sorted tape, we can stop at this point and do the final merge
+		 * on-the-fly.
 		 */
-		svTape = state->tp_tapenum[state->tapeRange];
-		svDummy = state->tp_dummy[state->tapeRange];
-		svRuns = state->tp_runs[state->tapeRange];
-		for (tapenum = state->tapeRange; tapenum > 0; tapenum--)
+		if (!state->randomAccess && state->nInputRuns <= state->nInputTapes)
 		{
-			state->tp_tapenum[tapenum] = state->tp_tapenum[tapenum - 1];
-			state->tp_dummy[tapenum] = state->tp_dummy[tapenum - 1];
-			state->tp_runs[tapenum] = state->tp_runs[tapenum - 1];
+			/* Tell logtape.c we won't be writing anymore */
+			LogicalTapeSetForgetFreeSpace(state->tapeset);
+			/* Initialize for the final merge pass */
+			beginmerge(state);
+			state->status = TSS_FINALMERGE;
+			return;
 		}
-		state->tp_tapenum[0] = svTape;
-		state->tp_dummy[0] = svDummy;
-		state->tp_runs[0] = svRuns;
+
+		/* Merge one run from each input tape until all are consumed */
+		while (state->nInputRuns > 0)
+		{
+			selectnewtape(state);
+			mergeonerun(state);
+		}
+
+		/* Done if this pass produced a single run */
+		if (state->nOutputRuns == 1)
+			break;
 	}
 
 	/*
-	 * Done.  Knuth says that the result is on TAPE[1], but since we exited
-	 * the loop without performing the last iteration of step D6, we have not
-	 * rearranged the tape unit assignment, and therefore the result is on
-	 * TAPE[T].  We need to do it this way so that we can freeze the final
-	 * output tape while rewinding it.  The last iteration of step D6 would be
-	 * a waste of cycles anyway...
+	 * Done.  The result is the only run on the first output tape of the last
+	 * pass.  We need to freeze it while it is still in write state, which is
+	 * why we did not go around the loop again to make it an input tape.
 	 */
-	state->result_tape = state->tp_tapenum[state->tapeRange];
+	state->result_tape = state->outputTapes[0];
 	LogicalTapeFreeze(state->tapeset, state->result_tape);
 	state->status = TSS_SORTEDONTAPE;
 }
 
 /*
- * Merge one run from each input tape, except ones with dummy runs.
- *
- * This is the inner loop of Algorithm D step D5.  We know that the
- * output tape is TAPE[T].
+ * Merge one run from each active input tape onto the current output tape.
  */
 static void
 mergeonerun(Tuplesortstate *state)
 {
-	int			destTape = state->tp_tapenum[state->tapeRange];
+	int			destTape = state->outputTapes[state->destTape];
 	int			srcTape;
 	int			tupIndex;
 	SortTuple  *tup;
@@ -2375,7 +2446,7 @@ mergeonerun(Tuplesortstate *state)
 
 	/*
 	 * Start the merge by loading one tuple from each active source tape into
-	 * the heap.  We can also decrease the input run/dummy run counts.
+	 * the heap.  We can also decrease the input run count.
 	 */
 	beginmerge(state);
 
@@ -2394,7 +2465,7 @@ mergeonerun(Tuplesortstate *state)
 		spaceFreed = state->availMem - priorAvail;
 		state->mergeavailmem[srcTape] += spaceFreed;
 		/* compact the heap */
-		tuplesort_heap_siftup(state, false);
+		tuplesort_heap_siftup(state);
 		if ((tupIndex = state->mergenext[srcTape]) == 0)
 		{
 			/* out of preloaded data on this tape, try to read more */
@@ -2408,7 +2479,7 @@ mergeonerun(Tuplesortstate *state)
 		state->mergenext[srcTape] = tup->tupindex;
 		if (state->mergenext[srcTape] == 0)
 			state->mergelast[srcTape] = 0;
-		tuplesort_heap_insert(state, tup, srcTape, false);
+		tuplesort_heap_insert(state, tup, srcTape);
 		/* put the now-unused memtuples entry on the freelist */
 		tup->tupindex = state->mergefreelist;
 		state->mergefreelist = tupIndex;
@@ -2417,31 +2488,30 @@ mergeonerun(Tuplesortstate *state)
 
 	/*
 	 * When the heap empties, we're done.  Write an end-of-run marker on the
-	 * output tape, and increment its count of real runs.
+	 * output tape.
 	 */
 	markrunend(state, destTape);
-	state->tp_runs[state->tapeRange]++;
 
 #ifdef TRACE_SORT
 	if (trace_sort)
-		elog(LOG, "finished %d-way merge step: %s", state->activeTapes,
+		elog(LOG, "finished %d-way merge step to tape %d: %s",
+			 state->activeTapes, state->destTape,
 			 pg_rusage_show(&state->ru_start));
 #endif
 }
 
 /*
- * beginmerge - initialize for a merge pass
+ * beginmerge - initialize for a merge step
  *
- * We decrease the counts of real and dummy runs for each tape, and mark
- * which tapes contain active input runs in mergeactive[].  Then, load
- * as many tuples as we can from each active input tape, and finally
- * fill the merge heap with the first tuple from each active tape.
+ * We take one run from each input tape that still has any, and mark those
+ * tapes as active in mergeactive[].  Then, load as many tuples as we can
+ * from each active input tape, and finally fill the merge heap with the
+ * first tuple from each active tape.
  */
 static void
 beginmerge(Tuplesortstate *state)
 {
 	int			activeTapes;
-	int			tapenum;
 	int			srcTape;
 	int			slotsPerTape;
 	int64		spacePerTape;
@@ -2449,23 +2519,18 @@ beginmerge(Tuplesortstate *state)
 	/* Heap should be empty here */
 	Assert(state->memtupcount == 0);
 
-	/* Adjust run counts and mark the active tapes */
+	/*
+	 * Adjust the run count and mark the active tapes.  Since selectnewtape()
+	 * distributed the runs round-robin, the tapes that still have runs left
+	 * are always the first Min(nInputTapes, nInputRuns) ones.
+	 */
+	activeTapes = Min(state->nInputTapes, state->nInputRuns);
+	Assert(activeTapes > 0);
 	memset(state->mergeactive, 0,
 		   state->maxTapes * sizeof(*state->mergeactive));
-	activeTapes = 0;
-	for (tapenum = 0; tapenum < state->tapeRange; tapenum++)
-	{
-		if (state->tp_dummy[tapenum] > 0)
-			state->tp_dummy[tapenum]--;
-		else
-		{
-			Assert(state->tp_runs[tapenum] > 0);
-			state->tp_runs[tapenum]--;
-			srcTape = state->tp_tapenum[tapenum];
-			state->mergeactive[srcTape] = true;
-			activeTapes++;
-		}
-	}
+	for (srcTape = 0; srcTape < activeTapes; srcTape++)
+		state->mergeactive[srcTape] = true;
+	state->nInputRuns -= activeTapes;
 	state->activeTapes = activeTapes;
 
 	/* Clear merge-pass state variables */
@@ -2480,17 +2545,13 @@ beginmerge(Tuplesortstate *state)
 	 * Initialize space allocation to let each active input tape have an equal
 	 * share of preread space.
 	 */
-	Assert(activeTapes > 0);
 	slotsPerTape = (state->memtupsize - state->mergefirstfree) / activeTapes;
 	Assert(slotsPerTape > 0);
 	spacePerTape = state->availMem / activeTapes;
-	for (srcTape = 0; srcTape < state->maxTapes; srcTape++)
+	for (srcTape = 0; srcTape < activeTapes; srcTape++)
 	{
-		if (state->mergeactive[srcTape])
-		{
-			state->mergeavailslots[srcTape] = slotsPerTape;
-			state->mergeavailmem[srcTape] = spacePerTape;
-		}
+		state->mergeavailslots[srcTape] = slotsPerTape;
+		state->mergeavailmem[srcTape] = spacePerTape;
 	}
 
 	/*
@@ -2500,7 +2561,7 @@ beginmerge(Tuplesortstate *state)
 	mergepreread(state);
 
 	/* Load the merge heap with the first tuple from each input tape */
-	for (srcTape = 0; srcTape < state->maxTapes; srcTape++)
+	for (srcTape = 0; srcTape < activeTapes; srcTape++)
 	{
 		int			tupIndex = state->mergenext[srcTape];
 		SortTuple  *tup;
@@ -2511,7 +2572,7 @@ beginmerge(Tuplesortstate *state)
 			state->mergenext[srcTape] = tup->tupindex;
 			if (state->mergenext[srcTape] == 0)
 				state->mergelast[srcTape] = 0;
-			tuplesort_heap_insert(state, tup, srcTape, false);
+			tuplesort_heap_insert(state, tup, srcTape);
 			/* put the now-unused memtuples entry on the freelist */
 			tup->tupindex = state->mergefreelist;
 			state->mergefreelist = tupIndex;
@@ -2539,25 +2600,24 @@ beginmerge(Tuplesortstate *state)
  * In FINALMERGE state, we *don't* use this routine, but instead just preread
  * from the single tape that ran dry.  There's no read/write alternation in
  * that state and so no point in scanning through all the tapes to fix one.
- * (Moreover, there may be quite a lot of inactive tapes in that state, since
- * we might have had many fewer runs than tapes.  In a regular tape-to-tape
- * merge we can expect most of the tapes to be active.)
+ * (Moreover, there may be quite a lot of input tapes in that state, so
+ * scanning them all whenever one runs dry would be expensive.)
  */
 static void
 mergepreread(Tuplesortstate *state)
 {
 	int			srcTape;
 
-	for (srcTape = 0; srcTape < state->maxTapes; srcTape++)
+	for (srcTape = 0; srcTape < state->nInputTapes; srcTape++)
 		mergeprereadone(state, srcTape);
 }
 
 /*
  * mergeprereadone - load tuples from one merge input tape
  *
- * Read tuples from the specified tape until it has used up its free memory
- * or array slots; but ensure that we have at least one tuple, if any are
- * to be had.
+ * Read tuples from the specified input tape (an index into inputTapes[])
+ * until it has used up its free memory or array slots; but ensure that we
+ * have at least one tuple, if any are to be had.
  */
 static void
 mergeprereadone(Tuplesortstate *state, int srcTape)
@@ -2576,12 +2636,12 @@ mergeprereadone(Tuplesortstate *state, int srcTape)
 		   state->mergenext[srcTape] == 0)
 	{
 		/* read next tuple, if any */
-		if ((tuplen = getlen(state, srcTape, true)) == 0)
+		if ((tuplen = getlen(state, state->inputTapes[srcTape], true)) == 0)
 		{
 			state->mergeactive[srcTape] = false;
 			break;
 		}
-		READTUP(state, &stup, srcTape, tuplen);
+		READTUP(state, &stup, state->inputTapes[srcTape], tuplen);
 		/* find a free slot in memtuples[] for it */
 		tupIndex = state->mergefreelist;
 		if (tupIndex)
@@ -2608,67 +2668,84 @@ mergeprereadone(Tuplesortstate *state, int srcTape)
 }
 
 /*
- * dumptuples - remove tuples from heap and write to tape
+ * dumptuples - sort the tuples in memory and write them to tape as a run
  *
  * This is used during initial-run building, but not during merging.
  *
- * When alltuples = false, dump only enough tuples to get under the
- * availMem limit (and leave at least one tuple in the heap in any case,
- * since puttuple assumes it always has a tuple to compare to).  We also
- * insist there be at least one free slot in the memtuples[] array.
+ * When alltuples = false, do nothing unless we have exceeded the availMem
+ * limit or filled the memtuples[] array.  Otherwise, quicksort everything
+ * currently in memory and write it out as a new run, leaving the array
+ * empty for the next run.
  *
- * When alltuples = true, dump everything currently in memory.
+ * When alltuples = true, always dump everything currently in memory.
  * (This case is only used at end of input data.)
- *
- * If we empty the heap, close out the current run and return (this should
- * only happen at end of input data).  If we see that the tuple run number
- * at the top of the heap has changed, start a new run.
  */
 static void
 dumptuples(Tuplesortstate *state, bool alltuples)
 {
-	while (alltuples ||
-		   (LACKMEM(state) && state->memtupcount > 1) ||
-		   state->memtupcount >= state->memtupsize)
-	{
-		/*
-		 * Dump the heap's frontmost entry, and sift up to remove it from the
-		 * heap.
-		 */
-		Assert(state->memtupcount > 0);
-		WRITETUP(state, state->tp_tapenum[state->destTape],
-				 &state->memtuples[0]);
-		tuplesort_heap_siftup(state, true);
+	int			destTape;
+	int			memtupwrite;
+	int			i;
 
-		/*
-		 * If the heap is empty *or* top run number has changed, we've
-		 * finished the current run.
-		 */
-		if (state->memtupcount == 0 ||
-			state->currentRun != state->memtuples[0].tupindex)
-		{
-			markrunend(state, state->tp_tapenum[state->destTape]);
-			state->currentRun++;
-			state->tp_runs[state->destTape]++;
-			state->tp_dummy[state->destTape]--; /* per Alg D step D2 */
+	/*
+	 * Nothing to do if we still fit in available memory and have array
+	 * slots, unless this is the final call during initial run generation.
+	 */
+	if (state->memtupcount < state->memtupsize && !LACKMEM(state) &&
+		!alltuples)
+		return;
+
+	/*
+	 * The final call might find nothing to dump, if input happened to end
+	 * just after we wrote out a run.  Don't create an empty run.
+	 */
+	if (state->memtupcount == 0)
+		return;
+
+	/*
+	 * It seems unlikely that this limit will ever be exceeded, but take no
+	 * chances.
+	 */
+	if (state->currentRun == INT_MAX)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("cannot have more than %d runs for an external sort",
+						INT_MAX)));
+
+	selectnewtape(state);
+	state->currentRun++;
 
 #ifdef TRACE_SORT
-			if (trace_sort)
-				elog(LOG, "finished writing%s run %d to tape %d: %s",
-					 (state->memtupcount == 0) ? " final" : "",
-					 state->currentRun, state->destTape,
-					 pg_rusage_show(&state->ru_start));
+	if (trace_sort)
+		elog(LOG, "starting quicksort of run %d: %s",
+			 state->currentRun, pg_rusage_show(&state->ru_start));
 #endif
 
-			/*
-			 * Done if heap is empty, else prepare for new run.
-			 */
-			if (state->memtupcount == 0)
-				break;
-			Assert(state->currentRun == state->memtuples[0].tupindex);
-			selectnewtape(state);
-		}
+	tuplesort_sort_memtuples(state);
+
+#ifdef TRACE_SORT
+	if (trace_sort)
+		elog(LOG, "finished quicksort of run %d: %s",
+			 state->currentRun, pg_rusage_show(&state->ru_start));
+#endif
+
+	destTape = state->outputTapes[state->destTape];
+	memtupwrite = state->memtupcount;
+	for (i = 0; i < memtupwrite; i++)
+	{
+		WRITETUP(state, destTape, &state->memtuples[i]);
+		state->memtupcount--;
 	}
+	Assert(state->memtupcount == 0);
+	markrunend(state, destTape);
+
+#ifdef TRACE_SORT
+	if (trace_sort)
+		elog(LOG, "finished writing%s run %d to tape %d: %s",
+			 alltuples ? " final" : "",
+			 state->currentRun, state->destTape,
+			 pg_rusage_show(&state->ru_start));
+#endif
 }
 
 /*
@@ -2825,16 +2902,61 @@ tuplesort_get_stats(Tuplesortstate *state,
 
 
 /*
- * Heap manipulation routines, per Knuth's Algorithm 5.2.3H.
+ * tuplesort_sort_memtuples - sort the tuples in memtuples[] with quicksort
  *
- * Compare two SortTuples.  If checkIndex is true, use the tuple index
- * as the front of the sort key; otherwise, no.
+ * This is used both for a sort that fits entirely in memory and for each
+ * initial run of an external sort.
  */
+static void
+tuplesort_sort_memtuples(Tuplesortstate *state)
+{
+	if (state->memtupcount > 1)
+	{
+		/*
+		 * Do we have the leading key's value (or abbreviation) in datum1,
+		 * and is there a specialization for its comparator?
+		 */
+		if (state->haveDatum1 && state->sortKeys != NULL)
+		{
+			SortSupport sortKey = state->sortKeys;
+
+			if (sortKey->comparator == ssup_datum_unsigned_cmp)
+			{
+				qsort_tuple_unsigned(state->memtuples, state->memtupcount,
+									 state);
+				return;
+			}
+#if SIZEOF_DATUM >= 8
+			else if (sortKey->comparator == ssup_datum_signed_cmp)
+			{
+				qsort_tuple_signed(state->memtuples, state->memtupcount,
+								   state);
+				return;
+			}
+#endif
+			else if (sortKey->comparator == ssup_datum_int32_cmp)
+			{
+				qsort_tuple_int32(state->memtuples, state->memtupcount,
+								  state);
+				return;
+			}
+		}
+
+		/* Can we use the single-key sort function? */
+		if (state->onlyKey != NULL)
+			qsort_ssup(state->memtuples, state->memtupcount,
+					   state->onlyKey);
+		else
+			qsort_tuple(state->memtuples,
+						state->memtupcount,
+						state->comparetup,
+						state);
+	}
+}
 
-#define HEAPCOMPARE(tup1,tup2) \
-	(checkIndex && ((tup1)->tupindex != (tup2)->tupindex) ? \
-	 ((tup1)->tupindex) - ((tup2)->tupindex) : \
-	 COMPARETUP(state, tup1, tup2))
+/*
+ * Heap manipulation routines, per Knuth's Algorithm 5.2.3H.
+ */
 
 /*
  * Convert the existing unordered array of SortTuples to a bounded heap,
@@ -2844,10 +2966,6 @@ tuplesort_get_stats(Tuplesortstate *state,
  * at the root (array entry zero), instead of the smallest as in the normal
  * sort case.  This allows us to discard the largest entry cheaply.
  * Therefore, we temporarily reverse the sort direction.
- *
- * We assume that all entries in a bounded heap will always have tupindex
- * zero; it therefore doesn't matter that HEAPCOMPARE() doesn't reverse
- * the direction of comparison for tupindexes.
  */
 static void
 make_bounded_heap(Tuplesortstate *state)
@@ -2878,13 +2996,13 @@ make_bounded_heap(Tuplesortstate *state)
 			/* Must copy source tuple to avoid possible overwrite */
 			SortTuple	stup = state->memtuples[i];
 
-			tuplesort_heap_insert(state, &stup, 0, false);
+			tuplesort_heap_insert(state, &stup, 0);
 
 			/* If heap too full, discard largest entry */
 			if (state->memtupcount > state->bound)
 			{
 				free_sort_tuple(state, &state->memtuples[0]);
-				tuplesort_heap_siftup(state, false);
+				tuplesort_heap_siftup(state);
 			}
 		}
 	}
@@ -2915,7 +3033,7 @@ sort_bounded_heap(Tuplesortstate *state)
 		SortTuple	stup = state->memtuples[0];
 
 		/* this sifts-up the next-largest entry and decreases memtupcount */
-		tuplesort_heap_siftup(state, false);
+		tuplesort_heap_siftup(state);
 		state->memtuples[state->memtupcount] = stup;
 	}
 	state->memtupcount = tupcount;
@@ -2942,7 +3060,7 @@ sort_bounded_heap(Tuplesortstate *state)
  */
 static void
 tuplesort_heap_insert(Tuplesortstate *state, SortTuple *tuple,
-					  int tupleindex, bool checkIndex)
+					  int tupleindex)
 {
 	SortTuple  *memtuples;
 	int			j;
@@ -2969,7 +3087,7 @@ tuplesort_heap_insert(Tuplesortstate *state, SortTuple *tuple,
 	{
 		int			i = (j - 1) >> 1;
 
-		if (HEAPCOMPARE(tuple, &memtuples[i]) >= 0)
+		if (COMPARETUP(state, tuple, &memtuples[i]) >= 0)
 			break;
 		memtuples[j] = memtuples[i];
 		j = i;
@@ -2982,7 +3100,7 @@ tuplesort_heap_insert(Tuplesortstate *state, SortTuple *tuple,
  * Decrement memtupcount, and sift up to maintain the heap invariant.
  */
 static void
-tuplesort_heap_siftup(Tuplesortstate *state, bool checkIndex)
+tuplesort_heap_siftup(Tuplesortstate *state)
 {
 	SortTuple  *memtuples = state->memtuples;
 	SortTuple  *tuple;
@@ -3004,9 +3122,9 @@ tuplesort_heap_siftup(Tuplesortstate *state, bool checkIndex)
 		if (j >= n)
 			break;
 		if (j + 1 < n &&
-			HEAPCOMPARE(&memtuples[j], &memtuples[j + 1]) > 0)
+			COMPARETUP(state, &memtuples[j], &memtuples[j + 1]) > 0)
 			j++;
-		if (HEAPCOMPARE(tuple, &memtuples[j]) <= 0)
+		if (COMPARETUP(state, tuple, &memtuples[j]) <= 0)
 			break;
 		memtuples[i] = memtuples[j];
 		i = j;
@@ -0,0 +1,228 @@
+/*-------------------------------------------------------------------------
+ *
+ * bloom.h
+ *	  header file for postgres bloom index access method
+ *
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/bloom.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include "access/amapi.h"
+#include "access/bloom_xlog.h"
+#include "access/itup.h"
+#include "fmgr.h"
+#include "storage/buf.h"
+#include "storage/bufpage.h"
+#include "utils/relcache.h"
+
+/* Support procedure numbers */
+#define BLOOM_HASH_PROC			1
+#define BLOOM_NPROC				1
+
+/* Scan strategies */
+#define BLOOM_EQUAL_STRATEGY	1
+#define BLOOM_NSTRATEGIES		1
+
+/*
+ * Opaque data stored at the end of each bloom index page.  There are no
+ * sibling links: every scan reads the whole index sequentially.
+ */
+typedef struct BloomPageOpaqueData
+{
+	OffsetNumber maxoff;		/* number of index tuples on page */
+	uint16		flags;			/* see bit definitions below */
+	uint16		unused;			/* placeholder to force maxaligning of size
+								 * of BloomPageOpaqueData and to place
+								 * bloom_page_id exactly at the end of page */
+	uint16		bloom_page_id;	/* for identification of BLOOM indexes */
+} BloomPageOpaqueData;
+
+typedef BloomPageOpaqueData *BloomPageOpaque;
+
+/* Bloom page flags */
+#define BLOOM_META		(1<<0)
+#define BLOOM_DELETED	(1<<1)
+
+/*
+ * The page ID is for the convenience of pg_filedump and similar utilities,
+ * which otherwise would have a hard time telling pages of different index
+ * types apart.  It should be the last 2 bytes on the page.  This is more or
+ * less "free" due to alignment considerations.
+ */
+#define BLOOM_PAGE_ID		0xFF83
+
+/* Macros for accessing bloom page structures */
+#define BloomPageGetOpaque(page) ((BloomPageOpaque) PageGetSpecialPointer(page))
+#define BloomPageGetMaxOffset(page) (BloomPageGetOpaque(page)->maxoff)
+#define BloomPageIsMeta(page) \
+	((BloomPageGetOpaque(page)->flags & BLOOM_META) != 0)
+#define BloomPageIsDeleted(page) \
+	((BloomPageGetOpaque(page)->flags & BLOOM_DELETED) != 0)
+#define BloomPageSetDeleted(page) \
+	(BloomPageGetOpaque(page)->flags |= BLOOM_DELETED)
+#define BloomPageSetNonDeleted(page) \
+	(BloomPageGetOpaque(page)->flags &= ~BLOOM_DELETED)
+#define BloomPageGetData(page)		((BloomTuple *)PageGetContents(page))
+#define BloomPageGetTuple(state, page, offset) \
+	((BloomTuple *)(PageGetContents(page) \
+		+ (state)->sizeOfBloomTuple * ((offset) - 1)))
+#define BloomPageGetNextTuple(state, tuple) \
+	((BloomTuple *)((Pointer)(tuple) + (state)->sizeOfBloomTuple))
+
+/* Preserved page numbers */
+#define BLOOM_METAPAGE_BLKNO	(0)
+#define BLOOM_HEAD_BLKNO		(1)		/* first data page */
+
+/*
+ * We store Bloom signatures as arrays of uint16 words.
+ */
+typedef uint16 BloomSignatureWord;
+
+#define SIGNWORDBITS ((int) (BITS_PER_BYTE * sizeof(BloomSignatureWord)))
+
+/*
+ * Default and maximum signature length in bits, and default and maximum
+ * number of bits generated for each index column.  The signature length is
+ * rounded up to a whole number of signature words.
+ */
+#define DEFAULT_BLOOM_LENGTH	(5 * SIGNWORDBITS)
+#define MAX_BLOOM_LENGTH		(256 * SIGNWORDBITS)
+#define DEFAULT_BLOOM_BITS		2
+#define MAX_BLOOM_BITS			(MAX_BLOOM_LENGTH - 1)
+
+/*
+ * Number of leading index columns that get their own "colN" reloption.
+ * Any further columns always use DEFAULT_BLOOM_BITS.
+ */
+#define BLOOM_NCOLUMN_OPTIONS	32
+
+/* Bloom index options */
+typedef struct BloomOptions
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	int			bloomLength;	/* length of signature in words (not bits!) */
+	int			bitSize[INDEX_MAX_KEYS];		/* # of bits generated for
+												 * each index key */
+} BloomOptions;
+
+/*
+ * FreeBlockNumberArray - array of block numbers sized so that the metadata
+ * fills all the space in the metapage.
+ */
+typedef BlockNumber FreeBlockNumberArray[
+										 MAXALIGN_DOWN(
+		BLCKSZ - SizeOfPageHeaderData - MAXALIGN(sizeof(BloomPageOpaqueData))
+	   - MAXALIGN(sizeof(uint16) * 2 + sizeof(uint32) + sizeof(BloomOptions))
+													   ) / sizeof(BlockNumber)
+];
+
+/* Metadata of bloom index */
+typedef struct BloomMetaPageData
+{
+	uint32		magickNumber;
+	uint16		nStart;
+	uint16		nEnd;
+	BloomOptions opts;
+	FreeBlockNumberArray notFullPage;
+} BloomMetaPageData;
+
+/* Magic number identifying a bloom metapage */
+#define BLOOM_MAGICK_NUMBER (0xDBAC0DED)
+
+/* Number of block numbers that fit in BloomMetaPageData */
+#define BloomMetaBlockN		(sizeof(FreeBlockNumberArray) / sizeof(BlockNumber))
+
+#define BloomPageGetMeta(page)	((BloomMetaPageData *) PageGetContents(page))
+
+typedef struct BloomState
+{
+	FmgrInfo	hashFn[INDEX_MAX_KEYS];
+	Oid			collations[INDEX_MAX_KEYS];
+	BloomOptions opts;			/* copy of options on index's metapage */
+	int32		nColumns;
+
+	/*
+	 * sizeOfBloomTuple is index-specific, and it depends on reloptions, so
+	 * precompute it
+	 */
+	Size		sizeOfBloomTuple;
+} BloomState;
+
+#define BloomPageGetFreeSpace(state, page) \
+	(BLCKSZ - MAXALIGN(SizeOfPageHeaderData) \
+		- BloomPageGetMaxOffset(page) * (state)->sizeOfBloomTuple \
+		- MAXALIGN(sizeof(BloomPageOpaqueData)))
+
+/*
+ * Bloom index tuples are fixed-size: a heap TID followed by the signature.
+ * They are not IndexTuples, and pages have no line pointers.
+ */
+typedef struct BloomTuple
+{
+	ItemPointerData heapPtr;
+	BloomSignatureWord sign[FLEXIBLE_ARRAY_MEMBER];
+} BloomTuple;
+
+#define BLOOMTUPLEHDRSZ offsetof(BloomTuple, sign)
+
+/* Opaque data structure for bloom index scan */
+typedef struct BloomScanOpaqueData
+{
+	BloomSignatureWord *sign;	/* Scan signature */
+	BloomState	state;
+} BloomScanOpaqueData;
+
+typedef BloomScanOpaqueData *BloomScanOpaque;
+
+/* blutils.c */
+extern void initBloomState(BloomState *state, Relation index);
+extern void BloomFillMetapage(Relation index, Page metaPage);
+extern void BloomInitMetapage(Relation index);
+extern void BloomInitPage(Page page, uint16 flags);
+extern Buffer BloomNewBuffer(Relation index);
+extern void signValue(BloomState *state, BloomSignatureWord *sign,
+		  Datum value, int attno);
+extern BloomTuple *BloomFormTuple(BloomState *state, ItemPointer iptr,
+			   Datum *values, bool *isnull);
+extern bool BloomPageAddItem(BloomState *state, Page page, BloomTuple *tuple);
+extern void BloomPageAppendTuple(Page page, BloomTuple *tuple, Size tupleSize);
+extern void BloomPageDeleteItems(Page page, Size tupleSize,
+					 OffsetNumber *deleted, int ndeleted);
+extern void BloomRegisterMetaUpdate(uint8 block_id, Buffer metaBuffer,
+						xl_bloom_update_meta *xlmeta, int nPages);
+extern bytea *bloptions(Datum reloptions, bool validate);
+
+/* blinsert.c */
+extern Datum blhandler(PG_FUNCTION_ARGS);
+extern IndexBuildResult *blbuild(Relation heap, Relation index,
+								 struct IndexInfo *indexInfo);
+extern void blbuildempty(Relation index);
+extern bool blinsert(Relation index, Datum *values, bool *isnull,
+					 ItemPointer ht_ctid, Relation heapRel,
+					 IndexUniqueCheck checkUnique);
+
+/* blscan.c */
+extern IndexScanDesc blbeginscan(Relation r, int nkeys, int norderbys);
+extern int64 blgetbitmap(IndexScanDesc scan, TIDBitmap *tbm);
+extern void blrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
+					 ScanKey orderbys, int norderbys);
+extern void blendscan(IndexScanDesc scan);
+extern void blmarkpos(IndexScanDesc scan);
+extern void blrestrpos(IndexScanDesc scan);
+
+/* blvacuum.c */
+extern IndexBulkDeleteResult *blbulkdelete(IndexVacuumInfo *info,
+										   IndexBulkDeleteResult *stats,
+										   IndexBulkDeleteCallback callback,
+										   void *callback_state);
+extern IndexBulkDeleteResult *blvacuumcleanup(IndexVacuumInfo *info,
+											  IndexBulkDeleteResult *stats);
+
+#endif   /* BLOOM_H */
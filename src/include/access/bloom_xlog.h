@@ -0,0 +1,88 @@
+/*-------------------------------------------------------------------------
+ *
+ * bloom_xlog.h
+ *	  POSTGRES bloom index access XLOG definitions.
+ *
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/bloom_xlog.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef BLOOM_XLOG_H
+#define BLOOM_XLOG_H
+
+#include "access/xlogreader.h"
+#include "lib/stringinfo.h"
+#include "storage/block.h"
+#include "storage/off.h"
+
+
+/*
+ * WAL record definitions for bloom's WAL operations.  Index builds write
+ * full-page images, like other index AMs; these records cover inserts and
+ * VACUUM.
+ *
+ * XLOG allows to store some information in high 4 bits of log
+ * record xl_info field.
+ */
+#define XLOG_BLOOM_INSERT			0x00
+#define XLOG_BLOOM_UPDATE_META		0x10
+#define XLOG_BLOOM_VACUUM_PAGE		0x20
+
+#define XLOG_BLOOM_OPMASK			0x70
+/*
+ * When we insert the first item on a new page, we restore the entire page in
+ * redo.
+ */
+#define XLOG_BLOOM_INIT_PAGE		0x80
+
+/*
+ * Change to the metapage's list of pages with free space.  The first
+ * nPages entries of the list are replaced by the block numbers following
+ * the struct; with nPages = 0 only nStart and nEnd change.
+ *
+ * This is the block data of the metapage, which is backup block 0 of an
+ * XLOG_BLOOM_UPDATE_META record and backup block 1 of an XLOG_BLOOM_INSERT
+ * record that started a new page.
+ */
+typedef struct xl_bloom_update_meta
+{
+	uint16		nStart;
+	uint16		nEnd;
+	uint16		nPages;
+	/* BLOCK NUMBERS FOLLOW AT THE END */
+} xl_bloom_update_meta;
+
+#define SizeOfBloomUpdateMeta	(offsetof(xl_bloom_update_meta, nPages) + sizeof(uint16))
+
+/*
+ * XLOG_BLOOM_INSERT has no main data.
+ *
+ * Backup block 0: data page, block data is the new bloom tuple.
+ * Backup block 1: metapage, only when a new page was started.
+ */
+
+/*
+ * Removal of tuples from a data page by VACUUM.  The surviving tuples are
+ * moved down over the removed ones.
+ *
+ * Backup block 0: data page, block data is the array of removed offsets,
+ * in ascending order.
+ */
+typedef struct xl_bloom_vacuum_page
+{
+	uint16		tupleSize;		/* size of each bloom tuple on the page */
+	uint16		ndeleted;
+} xl_bloom_vacuum_page;
+
+#define SizeOfBloomVacuumPage	(offsetof(xl_bloom_vacuum_page, ndeleted) + sizeof(uint16))
+
+
+extern void bloom_redo(XLogReaderState *record);
+extern void bloom_desc(StringInfo buf, XLogReaderState *record);
+extern const char *bloom_identify(uint8 info);
+
+#endif   /* BLOOM_XLOG_H */
@@ -11,7 +11,19 @@
 #ifndef BRIN_PAGEOPS_H
 #define BRIN_PAGEOPS_H
 
+#include "access/brin_page.h"
 #include "access/brin_revmap.h"
+#include "storage/bufpage.h"
+
+/*
+ * Maximum size of an entry in a BRIN_PAGETYPE_REGULAR page.  We can tolerate
+ * a single item per page, unlike other index AMs.
+ */
+#define BrinMaxItemSize \
+	MAXALIGN_DOWN(BLCKSZ - \
+				  (MAXALIGN(SizeOfPageHeaderData + \
+							sizeof(ItemIdData)) + \
+				   MAXALIGN(sizeof(BrinSpecialSpace))))
 
 extern bool brin_doupdate(Relation idxrel, BlockNumber pagesPerRange,
 			  BrinRevmap *revmap, BlockNumber heapBlk,
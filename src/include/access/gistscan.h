@@ -14,12 +14,13 @@
 #ifndef GISTSCAN_H
 #define GISTSCAN_H
 
-#include "fmgr.h"
+#include "access/amapi.h"
 
-extern Datum gistbeginscan(PG_FUNCTION_ARGS);
-extern Datum gistrescan(PG_FUNCTION_ARGS);
-extern Datum gistmarkpos(PG_FUNCTION_ARGS);
-extern Datum gistrestrpos(PG_FUNCTION_ARGS);
-extern Datum gistendscan(PG_FUNCTION_ARGS);
+extern IndexScanDesc gistbeginscan(Relation r, int nkeys, int norderbys);
+extern void gistrescan(IndexScanDesc scan, ScanKey key, int nscankeys,
+					   ScanKey orderbys, int norderbys);
+extern void gistmarkpos(IndexScanDesc scan);
+extern void gistrestrpos(IndexScanDesc scan);
+extern void gistendscan(IndexScanDesc scan);
 
 #endif   /* GISTSCAN_H */
@@ -14,6 +14,7 @@
 #ifndef NBTREE_H
 #define NBTREE_H
 
+#include "access/amapi.h"
 #include "access/genam.h"
 #include "access/itup.h"
 #include "access/sdir.h"
@@ -132,6 +133,21 @@ typedef struct BTMetaPageData
 #define BTREE_DEFAULT_FILLFACTOR	90
 #define BTREE_NONLEAF_FILLFACTOR	70
 
+/*
+ * Storage type for btree's reloptions.  fillfactor must stay first, so that
+ * RelationGetFillFactor() works on btree indexes just as on other relations.
+ */
+typedef struct BTOptions
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	int			fillfactor;		/* leaf page fillfactor in percent */
+	bool		deduplicate_items;	/* merge duplicates into posting lists? */
+} BTOptions;
+
+#define BTGetDeduplicateItems(relation) \
+	((relation)->rd_options ? \
+	 ((BTOptions *) (relation)->rd_options)->deduplicate_items : true)
+
 /*
  *	Test whether two btree entries are "the same".
  *
@@ -154,8 +170,15 @@ typedef struct BTMetaPageData
 	( (i1).ip_blkid.bi_hi == (i2).ip_blkid.bi_hi && \
 	  (i1).ip_blkid.bi_lo == (i2).ip_blkid.bi_lo && \
 	  (i1).ip_posid == (i2).ip_posid )
+
+/*
+ * Downlinks are compared by block number only: the offset number of a
+ * truncated pivot tuple holds its attribute count rather than P_HIKEY (see
+ * BTreeTupleGetNAtts below), and a downlink rewritten by page deletion need
+ * not have the same count as the stack entry we remembered on the way down.
+ */
 #define BTEntrySame(i1, i2) \
-	BTTidSame((i1)->t_tid, (i2)->t_tid)
+	BlockIdEquals(&(i1)->t_tid.ip_blkid, &(i2)->t_tid.ip_blkid)
 
 
 /*
@@ -204,6 +227,117 @@ typedef struct BTMetaPageData
 #define P_FIRSTKEY			((OffsetNumber) 2)
 #define P_FIRSTDATAKEY(opaque)	(P_RIGHTMOST(opaque) ? P_HIKEY : P_FIRSTKEY)
 
+/*
+ *	Posting list tuples.
+ *
+ *	When deduplication is enabled, several leaf tuples with the same key may
+ *	be merged into a single "posting list" tuple, which stores the key once
+ *	followed by a sorted array of the heap TIDs of all the merged tuples (see
+ *	nbtdedup.c).  A posting list tuple is marked by setting INDEX_ALT_TID_MASK
+ *	in t_info and BT_IS_POSTING in the offset number of t_tid.  The remaining
+ *	bits of the offset number hold the number of heap TIDs, and the block
+ *	number holds the byte offset of the TID array from the start of the tuple,
+ *	which is also the MAXALIGN'd size of the key part.  IndexTupleSize()
+ *	covers the whole tuple, TID array included.
+ *
+ *	Posting list tuples only ever appear as data items on leaf pages; high
+ *	keys and downlinks are never posting lists.
+ */
+#define INDEX_ALT_TID_MASK			INDEX_AM_RESERVED_BIT
+
+#define BT_OFFSET_MASK				0x0FFF
+#define BT_IS_POSTING				0x2000
+
+#define BTreeTupleIsPosting(itup) \
+	(((itup)->t_info & INDEX_ALT_TID_MASK) != 0 && \
+	 ((itup)->t_tid.ip_posid & BT_IS_POSTING) != 0)
+#define BTreeTupleGetNPosting(itup) \
+	( \
+		AssertMacro(BTreeTupleIsPosting(itup)), \
+		(int) ((itup)->t_tid.ip_posid & BT_OFFSET_MASK) \
+	)
+#define BTreeTupleGetPostingOffset(itup) \
+	( \
+		AssertMacro(BTreeTupleIsPosting(itup)), \
+		(Size) BlockIdGetBlockNumber(&(itup)->t_tid.ip_blkid) \
+	)
+#define BTreeTupleSetPosting(itup, nhtids, off) \
+	do { \
+		Assert((nhtids) > 1 && ((nhtids) & BT_OFFSET_MASK) == (nhtids)); \
+		(itup)->t_info |= INDEX_ALT_TID_MASK; \
+		BlockIdSet(&(itup)->t_tid.ip_blkid, (off)); \
+		(itup)->t_tid.ip_posid = BT_IS_POSTING | (nhtids); \
+	} while (0)
+#define BTreeTupleGetPosting(itup) \
+	((ItemPointer) ((char *) (itup) + BTreeTupleGetPostingOffset(itup)))
+#define BTreeTupleGetPostingN(itup, n) \
+	(BTreeTupleGetPosting(itup) + (n))
+
+/* Size of the key part of a leaf tuple, excluding any posting list */
+#define BTreeTupleGetKeySize(itup) \
+	(BTreeTupleIsPosting(itup) ? BTreeTupleGetPostingOffset(itup) : \
+	 (Size) IndexTupleSize(itup))
+/* Heap TIDs of a leaf tuple, and how many there are */
+#define BTreeTupleGetHeapTIDs(itup) \
+	(BTreeTupleIsPosting(itup) ? BTreeTupleGetPosting(itup) : &(itup)->t_tid)
+#define BTreeTupleGetNHeapTIDs(itup) \
+	(BTreeTupleIsPosting(itup) ? BTreeTupleGetNPosting(itup) : 1)
+
+/*
+ *	Truncated pivot tuples.
+ *
+ *	A leaf page's high key, and the downlink that is later copied from it
+ *	into the parent, only has to separate the last key on the left page from
+ *	the first key on the right page.  When the two differ in an earlier
+ *	column, _bt_truncate() drops the trailing columns that are not needed to
+ *	tell them apart.  Such a pivot tuple has INDEX_ALT_TID_MASK set and keeps
+ *	its number of key columns in the offset number of t_tid (BT_IS_POSTING
+ *	is never set); the block number is still the downlink.  Truncated
+ *	columns compare as "minus infinity" in _bt_compare().  Pivot tuples that
+ *	need all their columns are stored exactly as before.
+ */
+#define BT_N_KEYS_OFFSET_MASK		BT_OFFSET_MASK
+
+#define BTreeTupleGetNAtts(itup, rel) \
+	( \
+		(((itup)->t_info & INDEX_ALT_TID_MASK) != 0 && \
+		 ((itup)->t_tid.ip_posid & BT_IS_POSTING) == 0) ? \
+		((int) ((itup)->t_tid.ip_posid & BT_N_KEYS_OFFSET_MASK)) : \
+		RelationGetNumberOfAttributes(rel) \
+	)
+#define BTreeTupleSetNAtts(itup, n) \
+	do { \
+		Assert(((n) & BT_N_KEYS_OFFSET_MASK) == (n)); \
+		(itup)->t_info |= INDEX_ALT_TID_MASK; \
+		(itup)->t_tid.ip_posid = (n); \
+	} while (0)
+
+/* Set the downlink of a pivot tuple, keeping any attribute count */
+#define BTreeInnerTupleSetDownLink(itup, blkno) \
+	do { \
+		if (((itup)->t_info & INDEX_ALT_TID_MASK) != 0) \
+			BlockIdSet(&(itup)->t_tid.ip_blkid, (blkno)); \
+		else \
+			ItemPointerSet(&(itup)->t_tid, (blkno), P_HIKEY); \
+	} while (0)
+
+/*
+ * Upper bound on the number of heap TIDs a leaf page can hold, counting
+ * each TID of every posting list.  Scans size their per-page item arrays
+ * with this.
+ */
+#define MaxTIDsPerBTreePage \
+	((int) ((BLCKSZ - SizeOfPageHeaderData - sizeof(BTPageOpaqueData)) / \
+			sizeof(ItemPointerData)))
+
+/*
+ * Maximum size of a posting list tuple.  We stay well below BTMaxItemSize
+ * so that a page holding a few large posting lists can still be split
+ * reasonably evenly.
+ */
+#define BTMaxPostingSize(page) \
+	MAXALIGN_DOWN(BTMaxItemSize(page) / 2)
+
 /*
  * XLOG records for btree operations
  *
@@ -226,6 +360,7 @@ typedef struct BTMetaPageData
 										 * vacuum */
 #define XLOG_BTREE_REUSE_PAGE	0xD0	/* old page is about to be reused from
 										 * FSM */
+#define XLOG_BTREE_DEDUP		0xE0	/* deduplicate tuples on a leaf page */
 
 /*
  * All that we need to regenerate the meta-data page
@@ -275,9 +410,9 @@ typedef struct xl_btree_insert
  *
  * The left page's data portion contains the new item, if it's the _L variant.
  * (In the _R variants, the new item is one of the right page's tuples.)
- * If level > 0, an IndexTuple representing the HIKEY of the left page
- * follows.  We don't need this on leaf pages, because it's the same as the
- * leftmost key in the new right page.
+ * An IndexTuple representing the HIKEY of the left page follows.  On leaf
+ * pages it is a possibly-truncated copy of the leftmost key in the new right
+ * page (see _bt_truncate), so it has to be logged on all levels.
  *
  * Backup Blk 1: new right page
  *
@@ -346,15 +481,24 @@ typedef struct xl_btree_reuse_page
  *
  * Note that the *last* WAL record in any vacuum of an index is allowed to
  * have a zero length array of offsets. Earlier records must have at least one.
+ *
+ * Posting list tuples that lose only some of their heap TIDs are replaced
+ * by a smaller version of themselves rather than deleted.
+ *
+ * Backup Blk 0: index page (data contains the ndeleted offsets of deleted
+ * tuples, then the nupdated offsets of updated tuples, then the nupdated
+ * replacement tuples)
  */
 typedef struct xl_btree_vacuum
 {
 	BlockNumber lastBlockVacuumed;
+	uint16		ndeleted;
+	uint16		nupdated;
 
-	/* TARGET OFFSET NUMBERS FOLLOW */
+	/* TARGET OFFSET NUMBERS AND UPDATED TUPLES FOLLOW */
 } xl_btree_vacuum;
 
-#define SizeOfBtreeVacuum	(offsetof(xl_btree_vacuum, lastBlockVacuumed) + sizeof(BlockNumber))
+#define SizeOfBtreeVacuum	(offsetof(xl_btree_vacuum, nupdated) + sizeof(uint16))
 
 /*
  * This is what we need to know about marking an empty branch for deletion.
@@ -428,6 +572,23 @@ typedef struct xl_btree_newroot
 
 #define SizeOfBtreeNewroot	(offsetof(xl_btree_newroot, level) + sizeof(uint32))
 
+/*
+ * This is what we need to know about a deduplication pass over a leaf page.
+ * Each interval describes a run of consecutive tuples, by the offset of its
+ * first tuple on the original page and the number of tuples in it, that were
+ * merged into one posting list tuple.  Redo repeats the merge using them.
+ *
+ * Backup Blk 0: leaf page (data contains the array of intervals)
+ */
+typedef struct xl_btree_dedup
+{
+	uint16		nintervals;
+
+	/* DEDUPLICATION INTERVALS FOLLOW */
+} xl_btree_dedup;
+
+#define SizeOfBtreeDedup	(offsetof(xl_btree_dedup, nintervals) + sizeof(uint16))
+
 
 /*
  *	Operator strategy numbers for B-tree have been moved to access/stratnum.h,
@@ -452,6 +613,7 @@ typedef struct xl_btree_newroot
 
 #define BTORDER_PROC		1
 #define BTSORTSUPPORT_PROC	2
+#define BTNProcs			2
 
 /*
  *	We need to be able to tell the difference between read and write
@@ -548,7 +710,7 @@ typedef struct BTScanPosData
 	int			lastItem;		/* last valid index in items[] */
 	int			itemIndex;		/* current index in items[] */
 
-	BTScanPosItem items[MaxIndexTuplesPerPage]; /* MUST BE LAST */
+	BTScanPosItem items[MaxTIDsPerBTreePage];	/* MUST BE LAST */
 } BTScanPosData;
 
 typedef BTScanPosData *BTScanPos;
@@ -609,6 +771,20 @@ typedef struct BTScanOpaqueData
 	BTArrayKeyInfo *arrayKeys;	/* info about each equality-type array key */
 	MemoryContext arrayContext; /* scan-lifespan context for array data */
 
+	/*
+	 * workspace for skip scans: so->skipKeyData[0] is an "attr1 = value" (or
+	 * "attr1 IS NULL") key for the current distinct first-column value, and
+	 * _bt_preprocess_keys appends the regular input keys after it
+	 */
+	bool		skipScan;		/* are we skipping over first-column values? */
+	ScanKey		skipKeyData;	/* prefix key followed by copy of input keys */
+	FmgrInfo	skipEqProc;		/* first column's equality function */
+	Datum		skipValue;		/* current first-column value */
+	bool		skipIsNull;
+	Datum		markSkipValue;	/* first-column value at marked position */
+	bool		markSkipIsNull;
+	MemoryContext skipContext;	/* scan-lifespan context for skip data */
+
 	/* info about killed items if any (killedItems is NULL if never used) */
 	int		   *killedItems;	/* currPos.items indexes of killed items */
 	int			numKilled;		/* number of currently stored items */
@@ -637,6 +813,42 @@ typedef struct BTScanOpaqueData
 
 typedef BTScanOpaqueData *BTScanOpaque;
 
+/*
+ * BTDedupStateData is the working state of a deduplication pass, used both
+ * to merge the tuples of an existing leaf page and to merge tuples on the
+ * fly during an index build.  Tuples are fed to it in index order; while
+ * they keep matching the current "base" tuple, their heap TIDs accumulate
+ * in htids, and when a non-matching tuple arrives the pending group is
+ * emitted as a single posting list tuple.
+ */
+typedef struct BTDedupInterval
+{
+	OffsetNumber baseoff;		/* offset of first merged tuple */
+	uint16		nitems;			/* number of tuples merged */
+} BTDedupInterval;
+
+typedef struct BTDedupStateData
+{
+	Size		maxpostingsize; /* limit on size of final posting list tuple */
+
+	/* Metadata about the base tuple of the pending posting list */
+	IndexTuple	base;			/* first tuple of the pending group */
+	OffsetNumber baseoff;		/* its page offset, if deduplicating a page */
+	Size		basetupsize;	/* size of its key part */
+
+	/* Heap TIDs of the pending posting list */
+	ItemPointer htids;			/* sized for MaxTIDsPerBTreePage */
+	int			nhtids;			/* number of valid entries in htids */
+	int			nitems;			/* number of tuples merged so far */
+	Size		phystupsize;	/* their space on page, line pointers included */
+
+	/* Groups of more than one tuple merged so far (page deduplication only) */
+	int			nintervals;
+	BTDedupInterval intervals[MaxIndexTuplesPerPage];
+} BTDedupStateData;
+
+typedef BTDedupStateData *BTDedupState;
+
 /*
  * We use some private sk_flags bits in preprocessed scan keys.  We're allowed
  * to use bits 16-31 (see skey.h).  The uppermost bits are copied from the
@@ -652,20 +864,29 @@ typedef BTScanOpaqueData *BTScanOpaque;
 /*
  * prototypes for functions in nbtree.c (external entry points for btree)
  */
-extern Datum btbuild(PG_FUNCTION_ARGS);
-extern Datum btbuildempty(PG_FUNCTION_ARGS);
-extern Datum btinsert(PG_FUNCTION_ARGS);
-extern Datum btbeginscan(PG_FUNCTION_ARGS);
-extern Datum btgettuple(PG_FUNCTION_ARGS);
-extern Datum btgetbitmap(PG_FUNCTION_ARGS);
-extern Datum btrescan(PG_FUNCTION_ARGS);
-extern Datum btendscan(PG_FUNCTION_ARGS);
-extern Datum btmarkpos(PG_FUNCTION_ARGS);
-extern Datum btrestrpos(PG_FUNCTION_ARGS);
-extern Datum btbulkdelete(PG_FUNCTION_ARGS);
-extern Datum btvacuumcleanup(PG_FUNCTION_ARGS);
-extern Datum btcanreturn(PG_FUNCTION_ARGS);
-extern Datum btoptions(PG_FUNCTION_ARGS);
+extern Datum bthandler(PG_FUNCTION_ARGS);
+extern IndexBuildResult *btbuild(Relation heap, Relation index,
+								 struct IndexInfo *indexInfo);
+extern void btbuildempty(Relation index);
+extern bool btinsert(Relation rel, Datum *values, bool *isnull,
+					 ItemPointer ht_ctid, Relation heapRel,
+					 IndexUniqueCheck checkUnique);
+extern IndexScanDesc btbeginscan(Relation rel, int nkeys, int norderbys);
+extern bool btgettuple(IndexScanDesc scan, ScanDirection dir);
+extern int64 btgetbitmap(IndexScanDesc scan, TIDBitmap *tbm);
+extern void btrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
+					 ScanKey orderbys, int norderbys);
+extern void btendscan(IndexScanDesc scan);
+extern void btmarkpos(IndexScanDesc scan);
+extern void btrestrpos(IndexScanDesc scan);
+extern IndexBulkDeleteResult *btbulkdelete(IndexVacuumInfo *info,
+										   IndexBulkDeleteResult *stats,
+										   IndexBulkDeleteCallback callback,
+										   void *callback_state);
+extern IndexBulkDeleteResult *btvacuumcleanup(IndexVacuumInfo *info,
+											  IndexBulkDeleteResult *stats);
+extern bool btcanreturn(Relation index, int attno);
+extern bytea *btoptions(Datum reloptions, bool validate);
 
 /*
  * prototypes for functions in nbtinsert.c
@@ -675,6 +896,21 @@ extern bool _bt_doinsert(Relation rel, IndexTuple itup,
 extern Buffer _bt_getstackbuf(Relation rel, BTStack stack, int access);
 extern void _bt_finish_split(Relation rel, Buffer bbuf, BTStack stack);
 
+/*
+ * prototypes for functions in nbtdedup.c
+ */
+extern bool _bt_dedup_enabled(Relation rel);
+extern void _bt_dedup_one_page(Relation rel, Buffer buf);
+extern BTDedupState _bt_dedup_begin(Size maxpostingsize);
+extern void _bt_dedup_end(BTDedupState state);
+extern void _bt_dedup_start_pending(BTDedupState state, IndexTuple base,
+						OffsetNumber baseoff);
+extern bool _bt_dedup_save_htid(BTDedupState state, IndexTuple itup);
+extern Size _bt_dedup_finish_pending(Page newpage, BTDedupState state);
+extern IndexTuple _bt_form_posting(IndexTuple base, ItemPointer htids,
+				 int nhtids);
+extern IndexTuple _bt_pivotcopy(IndexTuple itup);
+
 /*
  * prototypes for functions in nbtpage.c
  */
@@ -693,6 +929,8 @@ extern void _bt_delitems_delete(Relation rel, Buffer buf,
 					OffsetNumber *itemnos, int nitems, Relation heapRel);
 extern void _bt_delitems_vacuum(Relation rel, Buffer buf,
 					OffsetNumber *itemnos, int nitems,
+					OffsetNumber *updateitemnos,
+					IndexTuple *updated, int nupdated,
 					BlockNumber lastBlockVacuumed);
 extern int	_bt_pagedel(Relation rel, Buffer buf);
 
@@ -712,12 +950,16 @@ extern int32 _bt_compare(Relation rel, int keysz, ScanKey scankey,
 extern bool _bt_first(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_next(IndexScanDesc scan, ScanDirection dir);
 extern Buffer _bt_get_endpoint(Relation rel, uint32 level, bool rightmost);
+extern bool _bt_skip_advance(IndexScanDesc scan, ScanDirection dir,
+				 bool first);
 
 /*
  * prototypes for functions in nbtutils.c
  */
 extern ScanKey _bt_mkscankey(Relation rel, IndexTuple itup);
 extern ScanKey _bt_mkscankey_nodata(Relation rel);
+extern IndexTuple _bt_truncate(Relation rel, IndexTuple lastleft,
+			 IndexTuple firstright);
 extern void _bt_freeskey(ScanKey skey);
 extern void _bt_freestack(BTStack stack);
 extern void _bt_preprocess_array_keys(IndexScanDesc scan);
@@ -725,6 +967,10 @@ extern void _bt_start_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_advance_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern void _bt_mark_array_keys(IndexScanDesc scan);
 extern void _bt_restore_array_keys(IndexScanDesc scan);
+extern void _bt_preprocess_skip_keys(IndexScanDesc scan);
+extern void _bt_set_skip_key(IndexScanDesc scan, Datum value, bool isnull);
+extern void _bt_mark_skip_key(IndexScanDesc scan);
+extern void _bt_restore_skip_key(IndexScanDesc scan);
 extern void _bt_preprocess_keys(IndexScanDesc scan);
 extern IndexTuple _bt_checkkeys(IndexScanDesc scan,
 			  Page page, OffsetNumber offnum,
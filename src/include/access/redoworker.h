@@ -0,0 +1,40 @@
+/*
+ * redoworker.h
+ *
+ * Parallel application of WAL records during recovery.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/redoworker.h
+ */
+#ifndef REDOWORKER_H
+#define REDOWORKER_H
+
+#include "access/xlogreader.h"
+#include "storage/relfilenode.h"
+
+/* upper limit for redo_workers */
+#define MAX_REDO_WORKERS	64
+
+/* GUC variable */
+extern int	redo_workers;
+
+/* true in a redo worker process */
+extern bool AmRedoWorker;
+
+extern Size RedoWorkerShmemSize(void);
+extern void RedoWorkerShmemInit(void);
+
+/* used by the startup process */
+extern void RedoWorkersStart(void);
+extern bool RedoWorkersDispatch(XLogReaderState *record);
+extern void RedoWorkersDrain(void);
+extern void RedoWorkersStop(void);
+
+/* used in redo worker processes */
+extern void RedoWorkerMain(Datum main_arg);
+extern void RedoWorkerForwardInvalidPage(RelFileNode node, ForkNumber forkno,
+							 BlockNumber blkno, bool present);
+
+#endif   /* REDOWORKER_H */
@@ -16,8 +16,10 @@
 
 #include "access/itup.h"
 #include "access/spgist.h"
+#include "lib/pairingheap.h"
 #include "nodes/tidbitmap.h"
 #include "storage/buf.h"
+#include "utils/geo_decls.h"
 #include "utils/relcache.h"
 
 
@@ -129,6 +131,33 @@ typedef struct SpGistState
 	bool		isBuild;		/* true if doing index build */
 } SpGistState;
 
+/*
+ * An entry in the queue of yet-to-be-visited items of an index scan.  It's
+ * either an index tuple pointer to descend to (an inner tuple or a chain of
+ * leaf tuples), or, in an ordered scan, a heap tuple whose leaf tuple already
+ * passed the quals and is waiting for its turn to be returned.
+ */
+typedef struct SpGistSearchItem
+{
+	pairingheap_node phNode;	/* pairing heap node, for ordered scans */
+	Datum		value;			/* value reconstructed from parent, or
+								 * leafValue if this is a heap tuple */
+	void	   *traversalValue; /* opclass-specific traverse value */
+	int			level;			/* level of items on this page */
+	ItemPointerData ptr;		/* index tuple to scan from, or heap tuple */
+	bool		isNull;			/* item belongs to the nulls tree? */
+	bool		isLeaf;			/* item is a heap tuple? */
+	bool		recheck;		/* qual recheck is needed (heap tuples) */
+	bool		recheckDistances;		/* distance recheck is needed (heap
+										 * tuples) */
+
+	/* array with numberOfOrderBys entries */
+	double		distances[FLEXIBLE_ARRAY_MEMBER];
+} SpGistSearchItem;
+
+#define SizeOfSpGistSearchItem(n_distances) \
+	(offsetof(SpGistSearchItem, distances) + sizeof(double) * (n_distances))
+
 /*
  * Private state of an index scan
  */
@@ -136,6 +165,7 @@ typedef struct SpGistScanOpaqueData
 {
 	SpGistState state;			/* see above */
 	MemoryContext tempCxt;		/* short-lived memory context */
+	MemoryContext traversalCxt; /* memory context for traversalValues */
 
 	/* Control flags showing whether to search nulls and/or non-nulls */
 	bool		searchNulls;	/* scan matches (all) null entries */
@@ -145,8 +175,18 @@ typedef struct SpGistScanOpaqueData
 	int			numberOfKeys;	/* number of index qualifier conditions */
 	ScanKey		keyData;		/* array of index qualifier descriptors */
 
-	/* Stack of yet-to-be-visited pages */
-	List	   *scanStack;		/* List of ScanStackEntrys */
+	/* Ordering operators, passed to opclass as they are */
+	int			numberOfOrderBys;		/* number of ordering operators */
+	ScanKey		orderByData;	/* array of ordering op descriptors */
+	Oid		   *orderByTypes;	/* result types of ordering operators */
+
+	/*
+	 * Yet-to-be-visited items.  A plain scan keeps them in a LIFO list, to
+	 * walk the tree depth-first.  An ordered scan keeps them in a pairing
+	 * heap sorted by distance, so that items come out nearest first.
+	 */
+	List	   *scanStack;		/* List of SpGistSearchItems */
+	pairingheap *scanQueue;		/* pairing heap of SpGistSearchItems */
 
 	/* These fields are only used in amgetbitmap scans: */
 	TIDBitmap  *tbm;			/* bitmap being filled */
@@ -159,7 +199,11 @@ typedef struct SpGistScanOpaqueData
 	int			iPtr;			/* index for scanning through same */
 	ItemPointerData heapPtrs[MaxIndexTuplesPerPage];	/* TIDs from cur page */
 	bool		recheck[MaxIndexTuplesPerPage]; /* their recheck flags */
+	bool		recheckDistances[MaxIndexTuplesPerPage];	/* distance recheck
+															 * flags */
 	IndexTuple	indexTups[MaxIndexTuplesPerPage];		/* reconstructed tuples */
+	double	   *distances[MaxIndexTuplesPerPage];		/* their distances, or
+														 * NULL */
 
 	/*
 	 * Note: using MaxIndexTuplesPerPage above is a bit hokey since
@@ -648,4 +692,8 @@ extern void spgPageIndexMultiDelete(SpGistState *state, Page page,
 extern bool spgdoinsert(Relation index, SpGistState *state,
 			ItemPointer heapPtr, Datum datum, bool isnull);
 
+/* spgproc.c */
+extern double *spg_key_orderbys_distances(Datum key, bool isLeaf,
+						   ScanKey orderbys, int norderbys);
+
 #endif   /* SPGIST_PRIVATE_H */
@@ -96,6 +96,7 @@ extern int	min_wal_size;
 extern int	max_wal_size;
 extern int	wal_keep_segments;
 extern int	XLOGbuffers;
+extern int	NumXLogInsertLocks;
 extern int	XLogArchiveTimeout;
 extern int	wal_retrieve_retry_interval;
 extern char *XLogArchiveCommand;
@@ -104,6 +105,7 @@ extern bool fullPageWrites;
 extern bool wal_log_hints;
 extern bool wal_compression;
 extern bool log_checkpoints;
+extern bool track_wal_flush_timing;
 
 extern int	CheckPointSegments;
 
@@ -207,12 +209,22 @@ typedef struct CheckpointStatsData
 
 extern CheckpointStatsData CheckpointStats;
 
+/*
+ * WAL flush latency histograms have power-of-two buckets of microseconds;
+ * bucket i counts durations below XLogFlushHistBucketBound(i), except the
+ * last one, which has no upper bound.
+ */
+#define XLOG_FLUSH_HIST_BUCKETS		20
+#define XLogFlushHistBucketBound(i)	(UINT64CONST(16) << (i))
+
 struct XLogRecData;
 
 extern XLogRecPtr XLogInsertRecord(struct XLogRecData *rdata, XLogRecPtr fpw_lsn);
 extern void XLogFlush(XLogRecPtr RecPtr);
+extern void XLogFlushCommit(XLogRecPtr RecPtr);
 extern bool XLogBackgroundFlush(void);
 extern bool XLogNeedsFlush(XLogRecPtr RecPtr);
+extern void XLogGetFlushStats(uint64 *waitHist, uint64 *writeHist);
 extern int	XLogFileInit(XLogSegNo segno, bool *use_existent, bool use_lock);
 extern int	XLogFileOpen(XLogSegNo segno);
 
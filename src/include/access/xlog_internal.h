@@ -31,7 +31,7 @@
 /*
  * Each page of XLOG file has a header like this:
  */
-#define XLOG_PAGE_MAGIC 0xD088	/* can be used as WAL version indicator */
+#define XLOG_PAGE_MAGIC 0xD08D	/* can be used as WAL version indicator */
 
 typedef struct XLogPageHeaderData
 {
@@ -288,6 +288,11 @@ extern XLogRecPtr RequestXLogSwitch(void);
 
 extern void GetOldestRestartPoint(XLogRecPtr *oldrecptr, TimeLineID *oldtli);
 
+/*
+ * Exported for redo workers, which apply records outside the startup process.
+ */
+extern void rm_redo_error_callback(void *arg);
+
 /*
  * Exported for the functions in timeline.c and xlogarchive.c.  Only valid
  * in the startup process.
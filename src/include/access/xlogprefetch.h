@@ -0,0 +1,46 @@
+/*
+ * xlogprefetch.h
+ *
+ * Prefetching of data blocks referenced by WAL, during recovery.
+ *
+ * Portions Copyright (c) 1996-2015, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/xlogprefetch.h
+ */
+#ifndef XLOG_PREFETCH_H
+#define XLOG_PREFETCH_H
+
+#include "access/xlogdefs.h"
+
+/* GUC variable */
+extern int	recovery_prefetch_distance;
+
+/*
+ * Counters describing what the prefetcher did with the block references it
+ * found, since server start.
+ */
+typedef struct XLogPrefetchStats
+{
+	uint64		prefetch;		/* prefetch requests issued */
+	uint64		hit;			/* block was already in shared buffers */
+	uint64		skip_init;		/* redo restores or zeroes the page */
+	uint64		skip_new;		/* block's file doesn't exist (yet) */
+	uint64		skip_repeat;	/* block was recently looked at already */
+	uint32		distance;		/* bytes decoded ahead of replay, at last
+								 * update */
+} XLogPrefetchStats;
+
+typedef struct XLogPrefetcher XLogPrefetcher;
+
+extern Size XLogPrefetchShmemSize(void);
+extern void XLogPrefetchShmemInit(void);
+
+extern XLogPrefetcher *XLogPrefetcherAllocate(uint64 system_identifier);
+extern void XLogPrefetcherFree(XLogPrefetcher *prefetcher);
+extern void XLogPrefetcherReadAhead(XLogPrefetcher *prefetcher,
+						XLogRecPtr replayPtr, TimeLineID replayTLI);
+
+extern void XLogPrefetchGetStats(XLogPrefetchStats *stats);
+
+#endif   /* XLOG_PREFETCH_H */
@@ -53,6 +53,6 @@
  */
 
 /*							yyyymmddN */
-#define CATALOG_VERSION_NO	201511071
+#define CATALOG_VERSION_NO	201511247
 
 #endif
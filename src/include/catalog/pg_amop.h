@@ -767,6 +767,7 @@ DATA(insert (	4015   600 600 5 s	508 4000 0 ));
 DATA(insert (	4015   600 600 10 s 509 4000 0 ));
 DATA(insert (	4015   600 600 6 s	510 4000 0 ));
 DATA(insert (	4015   600 603 8 s	511 4000 0 ));
+DATA(insert (	4015   600 600 15 o 517 4000 1970 ));
 
 /*
  * SP-GiST kd_point_ops
@@ -777,6 +778,7 @@ DATA(insert (	4016   600 600 5 s	508 4000 0 ));
 DATA(insert (	4016   600 600 10 s 509 4000 0 ));
 DATA(insert (	4016   600 600 6 s	510 4000 0 ));
 DATA(insert (	4016   600 603 8 s	511 4000 0 ));
+DATA(insert (	4016   600 600 15 o 517 4000 1970 ));
 
 /*
  * SP-GiST text_ops
@@ -1116,4 +1118,116 @@ DATA(insert (	4104	603  603 12 s	  2572	  3580 0 ));
 /* we could, but choose not to, supply entries for strategies 13 and 14 */
 DATA(insert (	4104	603  600  7 s	   433	  3580 0 ));
 
+/* bloom integer */
+DATA(insert (	3323	  21   21 1 s	    94	  3580 0 ));
+DATA(insert (	3323	  23   23 1 s	    96	  3580 0 ));
+DATA(insert (	3323	  20   20 1 s	   410	  3580 0 ));
+/* bloom float */
+DATA(insert (	3324	 700  700 1 s	   620	  3580 0 ));
+DATA(insert (	3324	 701  701 1 s	   670	  3580 0 ));
+/* bloom numeric */
+DATA(insert (	3325	1700 1700 1 s	  1752	  3580 0 ));
+/* bloom text */
+DATA(insert (	3326	  25   25 1 s	    98	  3580 0 ));
+/* bloom bpchar */
+DATA(insert (	3327	1042 1042 1 s	  1054	  3580 0 ));
+/* bloom bytea */
+DATA(insert (	3328	  17   17 1 s	  1955	  3580 0 ));
+/* bloom oid */
+DATA(insert (	3330	  26   26 1 s	   607	  3580 0 ));
+/* bloom uuid */
+DATA(insert (	3331	2950 2950 1 s	  2972	  3580 0 ));
+/* bloom macaddr */
+DATA(insert (	3332	 829  829 1 s	  1220	  3580 0 ));
+/* bloom network */
+DATA(insert (	3333	 869  869 1 s	  3552	  3580 0 ));
+/* bloom datetime */
+DATA(insert (	3334	1082 1082 1 s	  1093	  3580 0 ));
+DATA(insert (	3334	1114 1114 1 s	  2060	  3580 0 ));
+DATA(insert (	3334	1184 1184 1 s	  1320	  3580 0 ));
+/* bloom time */
+DATA(insert (	3335	1083 1083 1 s	  1108	  3580 0 ));
+/* bloom interval */
+DATA(insert (	3336	1186 1186 1 s	  1330	  3580 0 ));
+/* multi minmax integer */
+DATA(insert (	3337	  21   21 1 s	    95	  3580 0 ));
+DATA(insert (	3337	  21   21 2 s	   522	  3580 0 ));
+DATA(insert (	3337	  21   21 3 s	    94	  3580 0 ));
+DATA(insert (	3337	  21   21 4 s	   524	  3580 0 ));
+DATA(insert (	3337	  21   21 5 s	   520	  3580 0 ));
+DATA(insert (	3337	  23   23 1 s	    97	  3580 0 ));
+DATA(insert (	3337	  23   23 2 s	   523	  3580 0 ));
+DATA(insert (	3337	  23   23 3 s	    96	  3580 0 ));
+DATA(insert (	3337	  23   23 4 s	   525	  3580 0 ));
+DATA(insert (	3337	  23   23 5 s	   521	  3580 0 ));
+DATA(insert (	3337	  20   20 1 s	   412	  3580 0 ));
+DATA(insert (	3337	  20   20 2 s	   414	  3580 0 ));
+DATA(insert (	3337	  20   20 3 s	   410	  3580 0 ));
+DATA(insert (	3337	  20   20 4 s	   415	  3580 0 ));
+DATA(insert (	3337	  20   20 5 s	   413	  3580 0 ));
+/* multi minmax float */
+DATA(insert (	3338	 700  700 1 s	   622	  3580 0 ));
+DATA(insert (	3338	 700  700 2 s	   624	  3580 0 ));
+DATA(insert (	3338	 700  700 3 s	   620	  3580 0 ));
+DATA(insert (	3338	 700  700 4 s	   625	  3580 0 ));
+DATA(insert (	3338	 700  700 5 s	   623	  3580 0 ));
+DATA(insert (	3338	 701  701 1 s	   672	  3580 0 ));
+DATA(insert (	3338	 701  701 2 s	   673	  3580 0 ));
+DATA(insert (	3338	 701  701 3 s	   670	  3580 0 ));
+DATA(insert (	3338	 701  701 4 s	   675	  3580 0 ));
+DATA(insert (	3338	 701  701 5 s	   674	  3580 0 ));
+/* multi minmax numeric */
+DATA(insert (	3339	1700 1700 1 s	  1754	  3580 0 ));
+DATA(insert (	3339	1700 1700 2 s	  1755	  3580 0 ));
+DATA(insert (	3339	1700 1700 3 s	  1752	  3580 0 ));
+DATA(insert (	3339	1700 1700 4 s	  1757	  3580 0 ));
+DATA(insert (	3339	1700 1700 5 s	  1756	  3580 0 ));
+/* multi minmax oid */
+DATA(insert (	3340	  26   26 1 s	   609	  3580 0 ));
+DATA(insert (	3340	  26   26 2 s	   611	  3580 0 ));
+DATA(insert (	3340	  26   26 3 s	   607	  3580 0 ));
+DATA(insert (	3340	  26   26 4 s	   612	  3580 0 ));
+DATA(insert (	3340	  26   26 5 s	   610	  3580 0 ));
+/* multi minmax datetime */
+DATA(insert (	3341	1082 1082 1 s	  1095	  3580 0 ));
+DATA(insert (	3341	1082 1082 2 s	  1096	  3580 0 ));
+DATA(insert (	3341	1082 1082 3 s	  1093	  3580 0 ));
+DATA(insert (	3341	1082 1082 4 s	  1098	  3580 0 ));
+DATA(insert (	3341	1082 1082 5 s	  1097	  3580 0 ));
+DATA(insert (	3341	1114 1114 1 s	  2062	  3580 0 ));
+DATA(insert (	3341	1114 1114 2 s	  2063	  3580 0 ));
+DATA(insert (	3341	1114 1114 3 s	  2060	  3580 0 ));
+DATA(insert (	3341	1114 1114 4 s	  2065	  3580 0 ));
+DATA(insert (	3341	1114 1114 5 s	  2064	  3580 0 ));
+DATA(insert (	3341	1184 1184 1 s	  1322	  3580 0 ));
+DATA(insert (	3341	1184 1184 2 s	  1323	  3580 0 ));
+DATA(insert (	3341	1184 1184 3 s	  1320	  3580 0 ));
+DATA(insert (	3341	1184 1184 4 s	  1325	  3580 0 ));
+DATA(insert (	3341	1184 1184 5 s	  1324	  3580 0 ));
+/* multi minmax time */
+DATA(insert (	3342	1083 1083 1 s	  1110	  3580 0 ));
+DATA(insert (	3342	1083 1083 2 s	  1111	  3580 0 ));
+DATA(insert (	3342	1083 1083 3 s	  1108	  3580 0 ));
+DATA(insert (	3342	1083 1083 4 s	  1113	  3580 0 ));
+DATA(insert (	3342	1083 1083 5 s	  1112	  3580 0 ));
+/* multi minmax interval */
+DATA(insert (	3343	1186 1186 1 s	  1332	  3580 0 ));
+DATA(insert (	3343	1186 1186 2 s	  1333	  3580 0 ));
+DATA(insert (	3343	1186 1186 3 s	  1330	  3580 0 ));
+DATA(insert (	3343	1186 1186 4 s	  1335	  3580 0 ));
+DATA(insert (	3343	1186 1186 5 s	  1334	  3580 0 ));
+/* multi minmax pg_lsn */
+DATA(insert (	3344	3220 3220 1 s	  3224	  3580 0 ));
+DATA(insert (	3344	3220 3220 2 s	  3226	  3580 0 ));
+DATA(insert (	3344	3220 3220 3 s	  3222	  3580 0 ));
+DATA(insert (	3344	3220 3220 4 s	  3227	  3580 0 ));
+DATA(insert (	3344	3220 3220 5 s	  3225	  3580 0 ));
+
+/*
+ * bloom
+ */
+DATA(insert (	3366   23 23 1 s	96 3365 0 ));
+DATA(insert (	3367   20 20 1 s	410 3365 0 ));
+DATA(insert (	3368   25 25 1 s	98 3365 0 ));
+
 #endif   /* PG_AMOP_H */
@@ -81,6 +81,7 @@ DATA(insert (	423   1560 1560 1 1596 ));
 DATA(insert (	424   16 16 1 1693 ));
 DATA(insert (	426   1042 1042 1 1078 ));
 DATA(insert (	428   17 17 1 1954 ));
+DATA(insert (	428   17 17 2 3394 ));
 DATA(insert (	429   18 18 1 358 ));
 DATA(insert (	434   1082 1082 1 1092 ));
 DATA(insert (	434   1082 1082 2 3136 ));
@@ -101,6 +102,7 @@ DATA(insert (	1970   701 701 1 355 ));
 DATA(insert (	1970   701 701 2 3133 ));
 DATA(insert (	1970   701 700 1 2195 ));
 DATA(insert (	1974   869 869 1 926 ));
+DATA(insert (	1974   869 869 2 3396 ));
 DATA(insert (	1976   21 21 1 350 ));
 DATA(insert (	1976   21 21 2 3129 ));
 DATA(insert (	1976   21 23 1 2190 ));
@@ -114,7 +116,9 @@ DATA(insert (	1976   20 20 2 3131 ));
 DATA(insert (	1976   20 23 1 2189 ));
 DATA(insert (	1976   20 21 1 2193 ));
 DATA(insert (	1982   1186 1186 1 1315 ));
+DATA(insert (	1982   1186 1186 2 3397 ));
 DATA(insert (	1984   829 829 1 836 ));
+DATA(insert (	1984   829 829 2 3395 ));
 DATA(insert (	1986   19 19 1 359 ));
 DATA(insert (	1986   19 19 2 3135 ));
 DATA(insert (	1988   1700 1700 1 1769 ));
@@ -136,6 +140,7 @@ DATA(insert (	2789   27 27 1 2794 ));
 DATA(insert (	2968   2950 2950 1 2960 ));
 DATA(insert (	2968   2950 2950 2 3300 ));
 DATA(insert (	2994   2249 2249 1 2987 ));
+DATA(insert (	2994   2249 2249 2 3398 ));
 DATA(insert (	3194   2249 2249 1 3187 ));
 DATA(insert (	3253   3220 3220 1 3251 ));
 DATA(insert (	3522   3500 3500 1 3514 ));
@@ -194,6 +199,7 @@ DATA(insert (	1029   600 600 6 2582 ));
 DATA(insert (	1029   600 600 7 2584 ));
 DATA(insert (	1029   600 600 8 3064 ));
 DATA(insert (	1029   600 600 9 3282 ));
+DATA(insert (	1029   600 600 10 3320 ));
 DATA(insert (	2593   603 603 1 2578 ));
 DATA(insert (	2593   603 603 2 2583 ));
 DATA(insert (	2593   603 603 3 2579 ));
@@ -202,6 +208,7 @@ DATA(insert (	2593   603 603 5 2581 ));
 DATA(insert (	2593   603 603 6 2582 ));
 DATA(insert (	2593   603 603 7 2584 ));
 DATA(insert (	2593   603 603 9 3281 ));
+DATA(insert (	2593   603 603 10 3320 ));
 DATA(insert (	2594   604 604 1 2585 ));
 DATA(insert (	2594   604 604 2 2583 ));
 DATA(insert (	2594   604 604 3 2586 ));
@@ -240,6 +247,7 @@ DATA(insert (	3919   3831 3831 5 3879 ));
 DATA(insert (	3919   3831 3831 6 3880 ));
 DATA(insert (	3919   3831 3831 7 3881 ));
 DATA(insert (	3919   3831 3831 9 3996 ));
+DATA(insert (	3919   3831 3831 10 3321 ));
 DATA(insert (	3550   869 869 1 3553 ));
 DATA(insert (	3550   869 869 2 3554 ));
 DATA(insert (	3550   869 869 3 3555 ));
@@ -661,4 +669,188 @@ DATA(insert (	4104   603	 603  4  4108 ));
 DATA(insert (	4104   603	 603  11 4067 ));
 DATA(insert (	4104   603	 603  13  187 ));
 
+/* bloom integer */
+DATA(insert (	3323    21	  21  1  3345 ));
+DATA(insert (	3323    21	  21  2  3346 ));
+DATA(insert (	3323    21	  21  3  3347 ));
+DATA(insert (	3323    21	  21  4  3348 ));
+DATA(insert (	3323    23	  23  1  3345 ));
+DATA(insert (	3323    23	  23  2  3346 ));
+DATA(insert (	3323    23	  23  3  3347 ));
+DATA(insert (	3323    23	  23  4  3348 ));
+DATA(insert (	3323    20	  20  1  3345 ));
+DATA(insert (	3323    20	  20  2  3346 ));
+DATA(insert (	3323    20	  20  3  3347 ));
+DATA(insert (	3323    20	  20  4  3348 ));
+
+/* bloom float */
+DATA(insert (	3324   700	 700  1  3345 ));
+DATA(insert (	3324   700	 700  2  3346 ));
+DATA(insert (	3324   700	 700  3  3347 ));
+DATA(insert (	3324   700	 700  4  3348 ));
+DATA(insert (	3324   701	 701  1  3345 ));
+DATA(insert (	3324   701	 701  2  3346 ));
+DATA(insert (	3324   701	 701  3  3347 ));
+DATA(insert (	3324   701	 701  4  3348 ));
+
+/* bloom numeric */
+DATA(insert (	3325  1700	1700  1  3345 ));
+DATA(insert (	3325  1700	1700  2  3346 ));
+DATA(insert (	3325  1700	1700  3  3347 ));
+DATA(insert (	3325  1700	1700  4  3348 ));
+
+/* bloom text */
+DATA(insert (	3326    25	  25  1  3345 ));
+DATA(insert (	3326    25	  25  2  3346 ));
+DATA(insert (	3326    25	  25  3  3347 ));
+DATA(insert (	3326    25	  25  4  3348 ));
+
+/* bloom bpchar */
+DATA(insert (	3327  1042	1042  1  3345 ));
+DATA(insert (	3327  1042	1042  2  3346 ));
+DATA(insert (	3327  1042	1042  3  3347 ));
+DATA(insert (	3327  1042	1042  4  3348 ));
+
+/* bloom bytea */
+DATA(insert (	3328    17	  17  1  3345 ));
+DATA(insert (	3328    17	  17  2  3346 ));
+DATA(insert (	3328    17	  17  3  3347 ));
+DATA(insert (	3328    17	  17  4  3348 ));
+
+/* bloom oid */
+DATA(insert (	3330    26	  26  1  3345 ));
+DATA(insert (	3330    26	  26  2  3346 ));
+DATA(insert (	3330    26	  26  3  3347 ));
+DATA(insert (	3330    26	  26  4  3348 ));
+
+/* bloom uuid */
+DATA(insert (	3331  2950	2950  1  3345 ));
+DATA(insert (	3331  2950	2950  2  3346 ));
+DATA(insert (	3331  2950	2950  3  3347 ));
+DATA(insert (	3331  2950	2950  4  3348 ));
+
+/* bloom macaddr */
+DATA(insert (	3332   829	 829  1  3345 ));
+DATA(insert (	3332   829	 829  2  3346 ));
+DATA(insert (	3332   829	 829  3  3347 ));
+DATA(insert (	3332   829	 829  4  3348 ));
+
+/* bloom network */
+DATA(insert (	3333   869	 869  1  3345 ));
+DATA(insert (	3333   869	 869  2  3346 ));
+DATA(insert (	3333   869	 869  3  3347 ));
+DATA(insert (	3333   869	 869  4  3348 ));
+
+/* bloom datetime */
+DATA(insert (	3334  1082	1082  1  3345 ));
+DATA(insert (	3334  1082	1082  2  3346 ));
+DATA(insert (	3334  1082	1082  3  3347 ));
+DATA(insert (	3334  1082	1082  4  3348 ));
+DATA(insert (	3334  1114	1114  1  3345 ));
+DATA(insert (	3334  1114	1114  2  3346 ));
+DATA(insert (	3334  1114	1114  3  3347 ));
+DATA(insert (	3334  1114	1114  4  3348 ));
+DATA(insert (	3334  1184	1184  1  3345 ));
+DATA(insert (	3334  1184	1184  2  3346 ));
+DATA(insert (	3334  1184	1184  3  3347 ));
+DATA(insert (	3334  1184	1184  4  3348 ));
+
+/* bloom time */
+DATA(insert (	3335  1083	1083  1  3345 ));
+DATA(insert (	3335  1083	1083  2  3346 ));
+DATA(insert (	3335  1083	1083  3  3347 ));
+DATA(insert (	3335  1083	1083  4  3348 ));
+
+/* bloom interval */
+DATA(insert (	3336  1186	1186  1  3345 ));
+DATA(insert (	3336  1186	1186  2  3346 ));
+DATA(insert (	3336  1186	1186  3  3347 ));
+DATA(insert (	3336  1186	1186  4  3348 ));
+
+/* multi minmax integer */
+DATA(insert (	3337    21	  21  1  3349 ));
+DATA(insert (	3337    21	  21  2  3350 ));
+DATA(insert (	3337    21	  21  3  3351 ));
+DATA(insert (	3337    21	  21  4  3352 ));
+DATA(insert (	3337    21	  21  11 3353 ));
+DATA(insert (	3337    23	  23  1  3349 ));
+DATA(insert (	3337    23	  23  2  3350 ));
+DATA(insert (	3337    23	  23  3  3351 ));
+DATA(insert (	3337    23	  23  4  3352 ));
+DATA(insert (	3337    23	  23  11 3354 ));
+DATA(insert (	3337    20	  20  1  3349 ));
+DATA(insert (	3337    20	  20  2  3350 ));
+DATA(insert (	3337    20	  20  3  3351 ));
+DATA(insert (	3337    20	  20  4  3352 ));
+DATA(insert (	3337    20	  20  11 3355 ));
+
+/* multi minmax float */
+DATA(insert (	3338   700	 700  1  3349 ));
+DATA(insert (	3338   700	 700  2  3350 ));
+DATA(insert (	3338   700	 700  3  3351 ));
+DATA(insert (	3338   700	 700  4  3352 ));
+DATA(insert (	3338   700	 700  11 3356 ));
+DATA(insert (	3338   701	 701  1  3349 ));
+DATA(insert (	3338   701	 701  2  3350 ));
+DATA(insert (	3338   701	 701  3  3351 ));
+DATA(insert (	3338   701	 701  4  3352 ));
+DATA(insert (	3338   701	 701  11 3357 ));
+
+/* multi minmax numeric */
+DATA(insert (	3339  1700	1700  1  3349 ));
+DATA(insert (	3339  1700	1700  2  3350 ));
+DATA(insert (	3339  1700	1700  3  3351 ));
+DATA(insert (	3339  1700	1700  4  3352 ));
+DATA(insert (	3339  1700	1700  11 3358 ));
+
+/* multi minmax oid */
+DATA(insert (	3340    26	  26  1  3349 ));
+DATA(insert (	3340    26	  26  2  3350 ));
+DATA(insert (	3340    26	  26  3  3351 ));
+DATA(insert (	3340    26	  26  4  3352 ));
+DATA(insert (	3340    26	  26  11 3359 ));
+
+/* multi minmax datetime */
+DATA(insert (	3341  1082	1082  1  3349 ));
+DATA(insert (	3341  1082	1082  2  3350 ));
+DATA(insert (	3341  1082	1082  3  3351 ));
+DATA(insert (	3341  1082	1082  4  3352 ));
+DATA(insert (	3341  1082	1082  11 3360 ));
+DATA(insert (	3341  1114	1114  1  3349 ));
+DATA(insert (	3341  1114	1114  2  3350 ));
+DATA(insert (	3341  1114	1114  3  3351 ));
+DATA(insert (	3341  1114	1114  4  3352 ));
+DATA(insert (	3341  1114	1114  11 3362 ));
+DATA(insert (	3341  1184	1184  1  3349 ));
+DATA(insert (	3341  1184	1184  2  3350 ));
+DATA(insert (	3341  1184	1184  3  3351 ));
+DATA(insert (	3341  1184	1184  4  3352 ));
+DATA(insert (	3341  1184	1184  11 3362 ));
+
+/* multi minmax time */
+DATA(insert (	3342  1083	1083  1  3349 ));
+DATA(insert (	3342  1083	1083  2  3350 ));
+DATA(insert (	3342  1083	1083  3  3351 ));
+DATA(insert (	3342  1083	1083  4  3352 ));
+DATA(insert (	3342  1083	1083  11 3361 ));
+
+/* multi minmax interval */
+DATA(insert (	3343  1186	1186  1  3349 ));
+DATA(insert (	3343  1186	1186  2  3350 ));
+DATA(insert (	3343  1186	1186  3  3351 ));
+DATA(insert (	3343  1186	1186  4  3352 ));
+DATA(insert (	3343  1186	1186  11 3363 ));
+
+/* multi minmax pg_lsn */
+DATA(insert (	3344  3220	3220  1  3349 ));
+DATA(insert (	3344  3220	3220  2  3350 ));
+DATA(insert (	3344  3220	3220  3  3351 ));
+DATA(insert (	3344  3220	3220  4  3352 ));
+DATA(insert (	3344  3220	3220  11 3364 ));
+
+/* bloom */
+DATA(insert (	3366   23 23 1 450 ));
+DATA(insert (	3367   20 20 1 949 ));
+DATA(insert (	3368   25 25 1 400 ));
+
 #endif   /* PG_AMPROC_H */
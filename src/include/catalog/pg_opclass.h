@@ -271,5 +271,41 @@ DATA(insert (	3580	pg_lsn_minmax_ops		PGNSP PGUID 4082  3220 t 3220 ));
 /* no brin opclass for enum, tsvector, tsquery, jsonb */
 DATA(insert (	3580	box_inclusion_ops		PGNSP PGUID 4104   603 t 603 ));
 /* no brin opclass for the geometric types except box */
+DATA(insert (	3580	int2_bloom_ops	PGNSP PGUID 3323  21 f 21 ));
+DATA(insert (	3580	int4_bloom_ops	PGNSP PGUID 3323  23 f 23 ));
+DATA(insert (	3580	int8_bloom_ops	PGNSP PGUID 3323  20 f 20 ));
+DATA(insert (	3580	float4_bloom_ops	PGNSP PGUID 3324  700 f 700 ));
+DATA(insert (	3580	float8_bloom_ops	PGNSP PGUID 3324  701 f 701 ));
+DATA(insert (	3580	numeric_bloom_ops	PGNSP PGUID 3325  1700 f 1700 ));
+DATA(insert (	3580	text_bloom_ops	PGNSP PGUID 3326  25 f 25 ));
+DATA(insert (	3580	bpchar_bloom_ops	PGNSP PGUID 3327  1042 f 1042 ));
+DATA(insert (	3580	bytea_bloom_ops	PGNSP PGUID 3328  17 f 17 ));
+DATA(insert (	3580	oid_bloom_ops	PGNSP PGUID 3330  26 f 26 ));
+DATA(insert (	3580	uuid_bloom_ops	PGNSP PGUID 3331  2950 f 2950 ));
+DATA(insert (	3580	macaddr_bloom_ops	PGNSP PGUID 3332  829 f 829 ));
+DATA(insert (	3580	inet_bloom_ops	PGNSP PGUID 3333  869 f 869 ));
+DATA(insert (	3580	date_bloom_ops	PGNSP PGUID 3334  1082 f 1082 ));
+DATA(insert (	3580	timestamp_bloom_ops	PGNSP PGUID 3334  1114 f 1114 ));
+DATA(insert (	3580	timestamptz_bloom_ops	PGNSP PGUID 3334  1184 f 1184 ));
+DATA(insert (	3580	time_bloom_ops	PGNSP PGUID 3335  1083 f 1083 ));
+DATA(insert (	3580	interval_bloom_ops	PGNSP PGUID 3336  1186 f 1186 ));
+DATA(insert (	3580	int2_minmax_multi_ops	PGNSP PGUID 3337  21 f 21 ));
+DATA(insert (	3580	int4_minmax_multi_ops	PGNSP PGUID 3337  23 f 23 ));
+DATA(insert (	3580	int8_minmax_multi_ops	PGNSP PGUID 3337  20 f 20 ));
+DATA(insert (	3580	float4_minmax_multi_ops	PGNSP PGUID 3338  700 f 700 ));
+DATA(insert (	3580	float8_minmax_multi_ops	PGNSP PGUID 3338  701 f 701 ));
+DATA(insert (	3580	numeric_minmax_multi_ops	PGNSP PGUID 3339  1700 f 1700 ));
+DATA(insert (	3580	oid_minmax_multi_ops	PGNSP PGUID 3340  26 f 26 ));
+DATA(insert (	3580	date_minmax_multi_ops	PGNSP PGUID 3341  1082 f 1082 ));
+DATA(insert (	3580	timestamp_minmax_multi_ops	PGNSP PGUID 3341  1114 f 1114 ));
+DATA(insert (	3580	timestamptz_minmax_multi_ops	PGNSP PGUID 3341  1184 f 1184 ));
+DATA(insert (	3580	time_minmax_multi_ops	PGNSP PGUID 3342  1083 f 1083 ));
+DATA(insert (	3580	interval_minmax_multi_ops	PGNSP PGUID 3343  1186 f 1186 ));
+DATA(insert (	3580	pg_lsn_minmax_multi_ops	PGNSP PGUID 3344  3220 f 3220 ));
+
+/* bloom */
+DATA(insert (	3365	int4_ops			PGNSP PGUID 3366   23 t 0 ));
+DATA(insert (	3365	int8_ops			PGNSP PGUID 3367   20 t 0 ));
+DATA(insert (	3365	text_ops			PGNSP PGUID 3368   25 t 0 ));
 
 #endif   /* PG_OPCLASS_H */
@@ -182,5 +182,31 @@ DATA(insert OID = 4081 (	3580	uuid_minmax_ops			PGNSP PGUID ));
 DATA(insert OID = 4103 (	3580	range_inclusion_ops		PGNSP PGUID ));
 DATA(insert OID = 4082 (	3580	pg_lsn_minmax_ops		PGNSP PGUID ));
 DATA(insert OID = 4104 (	3580	box_inclusion_ops		PGNSP PGUID ));
+DATA(insert OID = 3323 (	3580	integer_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3324 (	3580	float_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3325 (	3580	numeric_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3326 (	3580	text_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3327 (	3580	bpchar_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3328 (	3580	bytea_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3330 (	3580	oid_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3331 (	3580	uuid_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3332 (	3580	macaddr_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3333 (	3580	network_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3334 (	3580	datetime_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3335 (	3580	time_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3336 (	3580	interval_bloom_ops	PGNSP PGUID ));
+DATA(insert OID = 3337 (	3580	integer_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 3338 (	3580	float_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 3339 (	3580	numeric_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 3340 (	3580	oid_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 3341 (	3580	datetime_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 3342 (	3580	time_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 3343 (	3580	interval_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 3344 (	3580	pg_lsn_minmax_multi_ops	PGNSP PGUID ));
+
+/* bloom */
+DATA(insert OID = 3366 (	3365	int4_ops		PGNSP PGUID ));
+DATA(insert OID = 3367 (	3365	int8_ops		PGNSP PGUID ));
+DATA(insert OID = 3368 (	3365	text_ops		PGNSP PGUID ));
 
 #endif   /* PG_OPFAMILY_H */
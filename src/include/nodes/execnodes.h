@@ -17,6 +17,7 @@
 #include "access/genam.h"
 #include "access/heapam.h"
 #include "executor/instrument.h"
+#include "lib/ilist.h"
 #include "lib/pairingheap.h"
 #include "nodes/params.h"
 #include "nodes/plannodes.h"
@@ -33,8 +34,10 @@
  *		entries for a particular index.  Used for both index_build and
  *		retail creation of index entries.
  *
- *		NumIndexAttrs		number of columns in this index
- *		KeyAttrNumbers		underlying-rel attribute numbers used as keys
+ *		NumIndexAttrs		total number of columns in this index
+ *		NumIndexKeyAttrs	number of key columns in index; any further
+ *							columns are non-key INCLUDE columns
+ *		KeyAttrNumbers		underlying-rel attribute numbers of all columns
  *							(zeroes indicate expressions)
  *		Expressions			expr trees for expression entries, or NIL if none
  *		ExpressionsState	exec state for expressions, or NIL if none
@@ -59,6 +62,7 @@ typedef struct IndexInfo
 {
 	NodeTag		type;
 	int			ii_NumIndexAttrs;
+	int			ii_NumIndexKeyAttrs;
 	AttrNumber	ii_KeyAttrNumbers[INDEX_MAX_KEYS];
 	List	   *ii_Expressions; /* list of Expr */
 	List	   *ii_ExpressionsState;	/* list of ExprState */
@@ -1788,6 +1792,49 @@ typedef struct MaterialState
 	Tuplestorestate *tuplestorestate;
 } MaterialState;
 
+/* ----------------
+ *	 MemoizeState information
+ *
+ *		memoize nodes cache the output of their parameterized subplan
+ *		in a hash table keyed by the parameter values.  The table is
+ *		limited to work_mem; when it fills up, the least recently used
+ *		entries are evicted.
+ *
+ *		probeslot holds the current key values; tableslot is used to
+ *		examine the key tuples stored in the hash table.
+ * ----------------
+ */
+struct MemoizeEntry;			/* private in nodeMemoize.c */
+struct MemoizeTuple;			/* private in nodeMemoize.c */
+
+typedef struct MemoizeState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	int			mstatus;		/* state of the ExecMemoize state machine */
+	int			nkeys;			/* number of cache keys */
+	List	   *param_exprs;	/* list of ExprStates for the keys */
+	AttrNumber *keyColIdx;		/* key columns in probeslot: 1 .. nkeys */
+	FmgrInfo   *hashfunctions;	/* per-key hash functions */
+	FmgrInfo   *eqfunctions;	/* per-key equality functions */
+	TupleTableSlot *probeslot;	/* virtual slot holding the current keys */
+	TupleTableSlot *tableslot;	/* slot for examining stored keys */
+	HTAB	   *hashtable;		/* the cache, keyed by parameter values */
+	MemoryContext tableContext; /* memory context holding cached tuples */
+	MemoryContext tempContext;	/* short-term context for hashing keys */
+	dlist_head	lru_list;		/* entries, least recently used first */
+	struct MemoizeEntry *entry; /* entry being filled or replayed */
+	struct MemoizeTuple *last_tuple;	/* last tuple returned or stored */
+	Size		mem_used;		/* bytes charged to cache entries */
+	Size		mem_limit;		/* maximum for mem_used */
+	Bitmapset  *keyparamids;	/* PARAM_EXEC ids used in param_exprs */
+	/* statistics for EXPLAIN ANALYZE */
+	uint64		cache_hits;		/* rescans answered from the cache */
+	uint64		cache_misses;	/* rescans that ran the subplan */
+	uint64		cache_evictions;	/* entries evicted to make room */
+	uint64		cache_overflows;	/* entries too big to cache at all */
+	Size		mem_peak;		/* peak of mem_used */
+} MemoizeState;
+
 /* ----------------
  *	 SortState information
  * ----------------
@@ -1804,6 +1851,29 @@ typedef struct SortState
 	void	   *tuplesortstate; /* private state of tuplesort.c */
 } SortState;
 
+/* ----------------
+ *	 IncrementalSortState information
+ *
+ *	 Tuples are read from the outer plan in batches that end at a change of
+ *	 the presorted key columns; each batch is sorted on its own.  The first
+ *	 tuple of the next batch is read before the current one can be finished,
+ *	 so it's kept in group_pivot until then.
+ * ----------------
+ */
+typedef struct IncrementalSortState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	bool		bounded;		/* is the result set bounded? */
+	int64		bound;			/* if bounded, how many tuples are needed */
+	FmgrInfo   *eqfunctions;	/* equality fns for the presorted columns */
+	bool		batch_Done;		/* current batch sorted and being returned? */
+	bool		outer_Done;		/* reached end of outer plan? */
+	int64		tuples_returned;	/* tuples returned so far */
+	int64		batch_count;	/* number of batches sorted so far */
+	TupleTableSlot *group_pivot;	/* first tuple of the next batch */
+	void	   *tuplesortstate; /* private state of tuplesort.c */
+} IncrementalSortState;
+
 /* ---------------------
  *	GroupState information
  * -------------------------
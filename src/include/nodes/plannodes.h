@@ -337,6 +337,9 @@ typedef struct SampleScan
  *
  * indexorderdir specifies the scan ordering, for indexscans on amcanorder
  * indexes (for other indexes it should be "don't care").
+ *
+ * indexskip is true if the index AM should skip from one distinct value of
+ * the first index column to the next (see IndexPath).
  * ----------------
  */
 typedef struct IndexScan
@@ -349,6 +352,7 @@ typedef struct IndexScan
 	List	   *indexorderbyorig;		/* the same in original form */
 	List	   *indexorderbyops;	/* OIDs of sort ops for ORDER BY exprs */
 	ScanDirection indexorderdir;	/* forward or backward or don't care */
+	bool		indexskip;		/* skip distinct first-column values? */
 } IndexScan;
 
 /* ----------------
@@ -376,6 +380,7 @@ typedef struct IndexOnlyScan
 	List	   *indexorderby;	/* list of index ORDER BY exprs */
 	List	   *indextlist;		/* TargetEntry list describing index's cols */
 	ScanDirection indexorderdir;	/* forward or backward or don't care */
+	bool		indexskip;		/* skip distinct first-column values? */
 } IndexOnlyScan;
 
 /* ----------------
@@ -401,6 +406,7 @@ typedef struct BitmapIndexScan
 	Oid			indexid;		/* OID of index to scan */
 	List	   *indexqual;		/* list of index quals (OpExprs) */
 	List	   *indexqualorig;	/* the same in original form */
+	bool		indexskip;		/* skip distinct first-column values? */
 } BitmapIndexScan;
 
 /* ----------------
@@ -671,6 +677,26 @@ typedef struct Material
 	Plan		plan;
 } Material;
 
+/* ----------------
+ *		memoize node
+ *
+ * A Memoize node sits above the parameterized inner side of a nestloop and
+ * caches the inner plan's output for each distinct set of parameter values,
+ * so that a rescan with previously-seen values can be answered without
+ * re-executing the subplan.  param_exprs are the cache key expressions,
+ * which are evaluated afresh on each rescan; hashOperators are equality
+ * operators with associated hash functions for comparing them.
+ * ----------------
+ */
+typedef struct Memoize
+{
+	Plan		plan;
+	int			numKeys;		/* number of cache keys */
+	Oid		   *hashOperators;	/* hash equality operators for each key */
+	List	   *param_exprs;	/* cache key expressions */
+	uint32		est_entries;	/* estimated number of cache entries */
+} Memoize;
+
 /* ----------------
  *		sort node
  * ----------------
@@ -685,6 +711,19 @@ typedef struct Sort
 	bool	   *nullsFirst;		/* NULLS FIRST/LAST directions */
 } Sort;
 
+/* ----------------
+ *		incremental sort node
+ *
+ * The input is already sorted on the first presortedCols sort keys, so only
+ * groups of tuples that are equal on those keys need sorting.
+ * ----------------
+ */
+typedef struct IncrementalSort
+{
+	Sort		sort;
+	int			presortedCols;	/* number of presorted columns */
+} IncrementalSort;
+
 /* ---------------
  *	 group node -
  *		Used for queries with GROUP BY (but no aggregates) specified.
@@ -503,7 +503,10 @@ typedef struct RelOptInfo
  *		Per-index information for planning/optimization
  *
  *		indexkeys[], indexcollations[], opfamily[], and opcintype[]
- *		each have ncolumns entries.
+ *		each have ncolumns entries.  Only the first nkeycolumns columns are
+ *		searchable or ordered; the rest are non-key INCLUDE columns, which
+ *		have zero opfamily[] and opcintype[] entries and can only be
+ *		returned by index-only scans.
  *
  *		sortopfamily[], reverse_sort[], and nulls_first[] likewise have
  *		ncolumns entries, if the index is ordered; but if it is unordered,
@@ -539,6 +542,7 @@ typedef struct IndexOptInfo
 
 	/* index descriptor information */
 	int			ncolumns;		/* number of columns in index */
+	int			nkeycolumns;	/* number of key columns in index */
 	int		   *indexkeys;		/* column numbers of index's keys, or 0 */
 	Oid		   *indexcollations;	/* OIDs of collations of index columns */
 	Oid		   *opfamily;		/* OIDs of operator families for columns */
@@ -550,7 +554,7 @@ typedef struct IndexOptInfo
 								 * index-only scan? */
 	Oid			relam;			/* OID of the access method (in pg_am) */
 
-	RegProcedure amcostestimate;	/* OID of the access method's cost fcn */
+	void		(*amcostestimate) ();	/* AM's cost estimator */
 
 	List	   *indexprs;		/* expressions for non-simple index columns */
 	List	   *indpred;		/* predicate if a partial index, else NIL */
@@ -563,6 +567,7 @@ typedef struct IndexOptInfo
 	bool		hypothetical;	/* true if index doesn't really exist */
 	bool		amcanorderbyop; /* does AM support order by operator result? */
 	bool		amoptionalkey;	/* can query omit key for the first column? */
+	bool		amcanskip;		/* can AM skip distinct first-column values? */
 	bool		amsearcharray;	/* can AM handle ScalarArrayOpExpr quals? */
 	bool		amsearchnulls;	/* can AM search for NULL/NOT NULL entries? */
 	bool		amhasgettuple;	/* does AM have amgettuple interface? */
@@ -815,6 +820,11 @@ typedef struct Path
  * NoMovementScanDirection for an indexscan, but the planner wants to
  * distinguish ordered from unordered indexes for building pathkeys.)
  *
+ * 'indexskip' is TRUE if the scan should skip from one distinct value of the
+ * first index column to the next, applying the indexquals (none of which
+ * reference the first column) within each group.  Only indexes whose AM has
+ * amcanskip are ever marked this way.
+ *
  * 'indextotalcost' and 'indexselectivity' are saved in the IndexPath so that
  * we need not recompute them when considering using the same index in a
  * bitmap index/heap scan (see BitmapHeapPath).  The costs of the IndexPath
@@ -831,6 +841,7 @@ typedef struct IndexPath
 	List	   *indexorderbys;
 	List	   *indexorderbycols;
 	ScanDirection indexscandir;
+	bool		indexskip;
 	Cost		indextotalcost;
 	Selectivity indexselectivity;
 } IndexPath;
@@ -1019,6 +1030,24 @@ typedef struct MaterialPath
 	Path	   *subpath;
 } MaterialPath;
 
+/*
+ * MemoizePath represents use of a Memoize plan node, i.e., caching of the
+ * output of a parameterized subpath keyed by the values of its parameters.
+ * param_exprs are the outer-side expressions supplying the parameters, and
+ * hash_operators the equality operators used to compare them.  calls is the
+ * expected number of rescans, and est_entries the number of cache entries
+ * expected to fit in work_mem (filled in by cost_rescan).
+ */
+typedef struct MemoizePath
+{
+	Path		path;
+	Path	   *subpath;
+	List	   *hash_operators; /* OIDs of hash equality operators */
+	List	   *param_exprs;	/* cache key expressions */
+	double		calls;			/* expected number of rescans */
+	uint32		est_entries;	/* estimated number of cache entries */
+} MemoizePath;
+
 /*
  * UniquePath represents elimination of distinct rows from the output of
  * its subpath.
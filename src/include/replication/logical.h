@@ -66,6 +66,12 @@ typedef struct LogicalDecodingContext
 	 */
 	void	   *output_writer_private;
 
+	/*
+	 * Does the output plugin support streaming of in-progress transactions,
+	 * and does it want it?
+	 */
+	bool		streaming;
+
 	/*
 	 * State for writing output.
 	 */
@@ -87,6 +87,52 @@ typedef void (*LogicalDecodeShutdownCB) (
 											  struct LogicalDecodingContext *
 );
 
+/*
+ * Called when starting to stream a block of changes of an in-progress
+ * transaction.  Streaming is only used if all stream_* callbacks are
+ * provided; the startup callback can still disable it by clearing
+ * ctx->streaming.
+ */
+typedef void (*LogicalDecodeStreamStartCB) (
+											 struct LogicalDecodingContext *,
+														ReorderBufferTXN *txn);
+
+/*
+ * Called after streaming a block of changes of an in-progress transaction.
+ */
+typedef void (*LogicalDecodeStreamStopCB) (
+											 struct LogicalDecodingContext *,
+													   ReorderBufferTXN *txn);
+
+/*
+ * Called when a streamed (sub)transaction aborts; changes streamed for it
+ * have to be discarded.
+ */
+typedef void (*LogicalDecodeStreamAbortCB) (
+											 struct LogicalDecodingContext *,
+														ReorderBufferTXN *txn,
+													  XLogRecPtr abort_lsn);
+
+/*
+ * Called when a streamed transaction commits, after its remaining changes
+ * have been streamed.
+ */
+typedef void (*LogicalDecodeStreamCommitCB) (
+											 struct LogicalDecodingContext *,
+														 ReorderBufferTXN *txn,
+													   XLogRecPtr commit_lsn);
+
+/*
+ * Callback for every individual change streamed in an in-progress
+ * transaction.
+ */
+typedef void (*LogicalDecodeStreamChangeCB) (
+											 struct LogicalDecodingContext *,
+														 ReorderBufferTXN *txn,
+														 Relation relation,
+												 ReorderBufferChange *change
+);
+
 /*
  * Output plugin callbacks
  */
@@ -98,6 +144,12 @@ typedef struct OutputPluginCallbacks
 	LogicalDecodeCommitCB commit_cb;
 	LogicalDecodeFilterByOriginCB filter_by_origin_cb;
 	LogicalDecodeShutdownCB shutdown_cb;
+	/* streaming of in-progress transactions, optional */
+	LogicalDecodeStreamStartCB stream_start_cb;
+	LogicalDecodeStreamStopCB stream_stop_cb;
+	LogicalDecodeStreamAbortCB stream_abort_cb;
+	LogicalDecodeStreamCommitCB stream_commit_cb;
+	LogicalDecodeStreamChangeCB stream_change_cb;
 } OutputPluginCallbacks;
 
 void		OutputPluginPrepareWrite(struct LogicalDecodingContext *ctx, bool last_write);
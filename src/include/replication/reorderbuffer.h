@@ -17,22 +17,25 @@
 #include "utils/snapshot.h"
 #include "utils/timestamp.h"
 
+/* GUC variable */
+extern PGDLLIMPORT int logical_decoding_work_mem;
+
 /* an individual tuple, stored in one chunk of memory */
 typedef struct ReorderBufferTupleBuf
 {
-	/* position in preallocated list */
-	slist_node	node;
-
-	/* tuple, stored sequentially */
+	/* tuple header, the interesting bit for users of logical decoding */
 	HeapTupleData tuple;
-	union
-	{
-		HeapTupleHeaderData header;
-		char		data[MaxHeapTupleSize];
-		double		align_it;	/* ensure t_data is MAXALIGN'd */
-	}			t_data;
+
+	/* allocated size of the tuple data following this struct */
+	Size		alloc_tuple_size;
+
+	/* actual tuple data follows */
 } ReorderBufferTupleBuf;
 
+/* pointer to the data stored in a TupleBuf */
+#define ReorderBufferTupleBufData(p) \
+	((HeapTupleHeader) MAXALIGN(((char *) p) + sizeof(ReorderBufferTupleBuf)))
+
 /*
  * Types of the change passed to a 'change' callback.
  *
@@ -74,6 +77,12 @@ typedef struct ReorderBufferChange
 
 	RepOriginId origin_id;
 
+	/*
+	 * Transaction whose memory usage this change is accounted in, or NULL
+	 * while it isn't accounted at all.
+	 */
+	struct ReorderBufferTXN *txn;
+
 	/*
 	 * Context data for the change, which part of the union is valid depends
 	 * on action/action_internal.
@@ -140,6 +149,16 @@ typedef struct ReorderBufferTXN
 	 */
 	bool		is_known_as_subxact;
 
+	/* toplevel transaction, if we know this is a subxact */
+	struct ReorderBufferTXN *toptxn;
+
+	/*
+	 * Have some of this transaction's changes already been streamed to the
+	 * output plugin, before it committed?  Only used in toplevel
+	 * transactions.
+	 */
+	bool		streamed;
+
 	/*
 	 * LSN of the first data carrying, WAL record with knowledge about this
 	 * xid. This is allowed to *not* be first record adorned with this xid, if
@@ -187,6 +206,13 @@ typedef struct ReorderBufferTXN
 	Snapshot	base_snapshot;
 	XLogRecPtr	base_snapshot_lsn;
 
+	/*
+	 * Snapshot and command id to continue decoding with, after some of the
+	 * transaction has been streamed.
+	 */
+	Snapshot	stream_snapshot;
+	CommandId	stream_command_id;
+
 	/*
 	 * How many ReorderBufferChange's do we have in this txn.
 	 *
@@ -200,6 +226,12 @@ typedef struct ReorderBufferTXN
 	 */
 	uint64		nentries_mem;
 
+	/*
+	 * Memory used by the changes kept in memory, in bytes.  Like the counts
+	 * above this does not include subtransactions.
+	 */
+	Size		size;
+
 	/*
 	 * List of ReorderBufferChange structs, including new Snapshots and new
 	 * CommandIds
@@ -271,6 +303,37 @@ typedef void (*ReorderBufferCommitCB) (
 												   ReorderBufferTXN *txn,
 												   XLogRecPtr commit_lsn);
 
+/* stream start callback signature */
+typedef void (*ReorderBufferStreamStartCB) (
+													ReorderBuffer *rb,
+													ReorderBufferTXN *txn,
+													XLogRecPtr first_lsn);
+
+/* stream stop callback signature */
+typedef void (*ReorderBufferStreamStopCB) (
+													ReorderBuffer *rb,
+													ReorderBufferTXN *txn,
+													XLogRecPtr last_lsn);
+
+/* stream abort callback signature */
+typedef void (*ReorderBufferStreamAbortCB) (
+													ReorderBuffer *rb,
+													ReorderBufferTXN *txn,
+													XLogRecPtr abort_lsn);
+
+/* stream commit callback signature */
+typedef void (*ReorderBufferStreamCommitCB) (
+													ReorderBuffer *rb,
+													ReorderBufferTXN *txn,
+													XLogRecPtr commit_lsn);
+
+/* stream change callback signature */
+typedef void (*ReorderBufferStreamChangeCB) (
+													ReorderBuffer *rb,
+													ReorderBufferTXN *txn,
+													Relation relation,
+													ReorderBufferChange *change);
+
 struct ReorderBuffer
 {
 	/*
@@ -298,6 +361,16 @@ struct ReorderBuffer
 	ReorderBufferApplyChangeCB apply_change;
 	ReorderBufferCommitCB commit;
 
+	/*
+	 * Callbacks to be called when streaming a transaction before it
+	 * committed, or NULL if streaming isn't supported.
+	 */
+	ReorderBufferStreamStartCB stream_start;
+	ReorderBufferStreamStopCB stream_stop;
+	ReorderBufferStreamAbortCB stream_abort;
+	ReorderBufferStreamCommitCB stream_commit;
+	ReorderBufferStreamChangeCB stream_change;
+
 	/*
 	 * Pointer that will be passed untouched to the callbacks.
 	 */
@@ -309,29 +382,20 @@ struct ReorderBuffer
 	MemoryContext context;
 
 	/*
-	 * Data structure slab cache.
-	 *
-	 * We allocate/deallocate some structures very frequently, to avoid bigger
-	 * overhead we cache some unused ones here.
-	 *
-	 * The maximum number of cached entries is controlled by const variables
-	 * ontop of reorderbuffer.c
+	 * Memory contexts for specific types of objects.  Changes and transactions
+	 * are fixed-size and allocated very frequently, so they come from slab
+	 * contexts; tuples vary in size but are freed roughly in the order they
+	 * were decoded, which suits a generation context.
 	 */
-
-	/* cached ReorderBufferTXNs */
-	dlist_head	cached_transactions;
-	Size		nr_cached_transactions;
-
-	/* cached ReorderBufferChanges */
-	dlist_head	cached_changes;
-	Size		nr_cached_changes;
-
-	/* cached ReorderBufferTupleBufs */
-	slist_head	cached_tuplebufs;
-	Size		nr_cached_tuplebufs;
+	MemoryContext change_context;
+	MemoryContext txn_context;
+	MemoryContext tup_context;
 
 	XLogRecPtr	current_restart_decoding_lsn;
 
+	/* memory used by the changes of all transactions, in bytes */
+	Size		size;
+
 	/* buffer for disk<->memory conversions */
 	char	   *outbuf;
 	Size		outbufsize;
@@ -341,7 +405,7 @@ struct ReorderBuffer
 ReorderBuffer *ReorderBufferAllocate(void);
 void		ReorderBufferFree(ReorderBuffer *);
 
-ReorderBufferTupleBuf *ReorderBufferGetTupleBuf(ReorderBuffer *);
+ReorderBufferTupleBuf *ReorderBufferGetTupleBuf(ReorderBuffer *, Size tuple_len);
 void		ReorderBufferReturnTupleBuf(ReorderBuffer *, ReorderBufferTupleBuf *tuple);
 ReorderBufferChange *ReorderBufferGetChange(ReorderBuffer *);
 void		ReorderBufferReturnChange(ReorderBuffer *, ReorderBufferChange *);
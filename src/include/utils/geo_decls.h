@@ -424,6 +424,7 @@ extern Datum gist_point_consistent(PG_FUNCTION_ARGS);
 extern Datum gist_point_distance(PG_FUNCTION_ARGS);
 extern Datum gist_bbox_distance(PG_FUNCTION_ARGS);
 extern Datum gist_point_fetch(PG_FUNCTION_ARGS);
+extern Datum gist_box_sortsupport(PG_FUNCTION_ARGS);
 
 
 /* geo_selfuncs.c */
@@ -28,6 +28,12 @@
  * abbreviation.  Furthermore, a converter and abort/costing function must be
  * provided.
  *
+ * Datatypes whose sort order is simply that of their Datum representation,
+ * taken as an integer, should use one of the ssup_datum_xxx_cmp functions
+ * below as their comparator (or abbreviated comparator) instead of writing
+ * their own.  tuplesort.c recognizes these and sorts with the comparison
+ * inlined, which is considerably faster.
+ *
  * All sort support functions will be passed the address of the
  * SortSupportData struct when called, so they can use it to store
  * additional private data as needed.  In particular, for collation-aware
@@ -267,10 +273,126 @@ ApplySortAbbrevFullComparator(Datum datum1, bool isNull1,
 	return compare;
 }
 
+/*
+ * Apply one of the specialized Datum comparators declared below, with the
+ * comparison inlined.  These must only be used when ssup->comparator is the
+ * corresponding function.  NULLs-ordering and reverse-sort are handled as in
+ * ApplySortComparator().
+ */
+static inline int
+ApplyUnsignedSortComparator(Datum datum1, bool isNull1,
+							Datum datum2, bool isNull2,
+							SortSupport ssup)
+{
+	int			compare;
+
+	if (!isNull1)
+	{
+		if (!isNull2)
+		{
+			if (datum1 < datum2)
+				compare = -1;
+			else if (datum1 > datum2)
+				compare = 1;
+			else
+				compare = 0;
+			if (ssup->ssup_reverse)
+				compare = -compare;
+		}
+		else
+			compare = ssup->ssup_nulls_first ? 1 : -1;
+	}
+	else if (!isNull2)
+		compare = ssup->ssup_nulls_first ? -1 : 1;
+	else
+		compare = 0;			/* NULL "=" NULL */
+
+	return compare;
+}
+
+#if SIZEOF_DATUM >= 8
+static inline int
+ApplySignedSortComparator(Datum datum1, bool isNull1,
+						  Datum datum2, bool isNull2,
+						  SortSupport ssup)
+{
+	int			compare;
+
+	if (!isNull1)
+	{
+		if (!isNull2)
+		{
+			int64		xx = DatumGetInt64(datum1);
+			int64		yy = DatumGetInt64(datum2);
+
+			if (xx < yy)
+				compare = -1;
+			else if (xx > yy)
+				compare = 1;
+			else
+				compare = 0;
+			if (ssup->ssup_reverse)
+				compare = -compare;
+		}
+		else
+			compare = ssup->ssup_nulls_first ? 1 : -1;
+	}
+	else if (!isNull2)
+		compare = ssup->ssup_nulls_first ? -1 : 1;
+	else
+		compare = 0;			/* NULL "=" NULL */
+
+	return compare;
+}
+#endif
+
+static inline int
+ApplyInt32SortComparator(Datum datum1, bool isNull1,
+						 Datum datum2, bool isNull2,
+						 SortSupport ssup)
+{
+	int			compare;
+
+	if (!isNull1)
+	{
+		if (!isNull2)
+		{
+			int32		xx = DatumGetInt32(datum1);
+			int32		yy = DatumGetInt32(datum2);
+
+			if (xx < yy)
+				compare = -1;
+			else if (xx > yy)
+				compare = 1;
+			else
+				compare = 0;
+			if (ssup->ssup_reverse)
+				compare = -compare;
+		}
+		else
+			compare = ssup->ssup_nulls_first ? 1 : -1;
+	}
+	else if (!isNull2)
+		compare = ssup->ssup_nulls_first ? -1 : 1;
+	else
+		compare = 0;			/* NULL "=" NULL */
+
+	return compare;
+}
+
+/* Specialized Datum comparators in utils/sort/sortsupport.c */
+extern int	ssup_datum_unsigned_cmp(Datum x, Datum y, SortSupport ssup);
+#if SIZEOF_DATUM >= 8
+extern int	ssup_datum_signed_cmp(Datum x, Datum y, SortSupport ssup);
+#endif
+extern int	ssup_datum_int32_cmp(Datum x, Datum y, SortSupport ssup);
+
 /* Other functions in utils/sort/sortsupport.c */
 extern void PrepareSortSupportComparisonShim(Oid cmpFunc, SortSupport ssup);
 extern void PrepareSortSupportFromOrderingOp(Oid orderingOp, SortSupport ssup);
 extern void PrepareSortSupportFromIndexRel(Relation indexRel, int16 strategy,
 							   SortSupport ssup);
+extern void PrepareSortSupportFromGistIndexRel(Relation indexRel,
+								   SortSupport ssup);
 
 #endif   /* SORTSUPPORT_H */
@@ -0,0 +1,38 @@
+# Check that autosummarize makes autovacuum summarize the page ranges that
+# inserts have moved past.
+use strict;
+use warnings;
+use TestLib;
+use Test::More tests => 2;
+
+my $tempdir = TestLib::tempdir;
+
+start_test_server($tempdir);
+
+psql 'postgres', "ALTER SYSTEM SET autovacuum_naptime = 1";
+psql 'postgres', "SELECT pg_reload_conf()";
+psql 'postgres', "CREATE EXTENSION pageinspect";
+psql 'postgres', "CREATE TABLE brin_wi (a int) WITH (fillfactor = 10)";
+psql 'postgres', "CREATE INDEX brin_wi_idx ON brin_wi USING brin (a)
+	WITH (pages_per_range = 1, autosummarize = on)";
+
+my $count_query = "SELECT count(*) FROM brin_page_items(
+	get_raw_page('brin_wi_idx', 2), 'brin_wi_idx'::regclass)";
+
+is(psql('postgres', $count_query), '1', 'only the first range is summarized');
+
+# Fill several pages; each insert that starts a new page asks autovacuum to
+# summarize the range before it.
+psql 'postgres', "INSERT INTO brin_wi SELECT generate_series(1, 100)";
+
+my $summarized = 0;
+foreach my $i (1 .. 180)
+{
+	if (psql('postgres', $count_query) > 1)
+	{
+		$summarized = 1;
+		last;
+	}
+	sleep 1;
+}
+ok($summarized, 'autovacuum summarized the new ranges');
@@ -0,0 +1,53 @@
+# Check that crash recovery with redo workers replays changes made around
+# relation drops and truncations, which the workers must not apply through
+# stale file handles.
+use strict;
+use warnings;
+use TestLib;
+use Test::More tests => 4;
+
+my $tempdir = TestLib::tempdir;
+my $pgdata  = "$tempdir/pgdata";
+
+start_test_server($tempdir);
+
+psql 'postgres', "ALTER SYSTEM SET redo_workers = 2";
+psql 'postgres', "CREATE TABLE dropped (a int)";
+psql 'postgres', "CREATE TABLE truncated (a int)";
+psql 'postgres', "CREATE TABLE vacuumed (a int) WITH (autovacuum_enabled = off)";
+psql 'postgres', "CHECKPOINT";
+
+# Everything from here on is replayed after the crash.
+psql 'postgres', "INSERT INTO dropped SELECT generate_series(1, 5000)";
+psql 'postgres', "INSERT INTO truncated SELECT generate_series(1, 5000)";
+psql 'postgres', "INSERT INTO vacuumed SELECT generate_series(1, 5000)";
+psql 'postgres', "DROP TABLE dropped";
+psql 'postgres', "TRUNCATE truncated";
+psql 'postgres', "INSERT INTO truncated SELECT generate_series(1, 100)";
+
+# Truncation that keeps the relfilenode: in the creating transaction, and
+# by VACUUM giving back empty pages at the end.
+psql 'postgres', "BEGIN;
+	CREATE TABLE same_file (a int);
+	INSERT INTO same_file SELECT generate_series(1, 5000);
+	TRUNCATE same_file;
+	INSERT INTO same_file SELECT generate_series(1, 10);
+	COMMIT";
+psql 'postgres', "DELETE FROM vacuumed WHERE a > 1000";
+psql 'postgres', "VACUUM vacuumed";
+psql 'postgres', "INSERT INTO vacuumed SELECT generate_series(1, 1000)";
+psql 'postgres', "CREATE TABLE dropped (a int)";
+psql 'postgres', "INSERT INTO dropped SELECT generate_series(1, 20)";
+
+system_or_bail('pg_ctl', '-D', $pgdata, '-m', 'immediate', 'stop');
+system_or_bail('pg_ctl', '-D', $pgdata, '-w', '-l',
+	"$log_path/postmaster.log", 'start');
+
+is(psql('postgres', "SELECT count(*), sum(a) FROM dropped"),
+	"20|210", 'table recreated after DROP');
+is(psql('postgres', "SELECT count(*), sum(a) FROM truncated"),
+	"100|5050", 'table refilled after TRUNCATE');
+is(psql('postgres', "SELECT count(*), sum(a) FROM same_file"),
+	"10|55", 'table truncated in its creating transaction');
+is(psql('postgres', "SELECT count(*), sum(a) FROM vacuumed"),
+	"2000|1001000", 'table truncated by VACUUM');
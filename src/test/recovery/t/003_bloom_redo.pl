@@ -0,0 +1,36 @@
+# Check that crash recovery replays inserts into and VACUUM of a bloom index.
+use strict;
+use warnings;
+use TestLib;
+use Test::More tests => 2;
+
+my $tempdir = TestLib::tempdir;
+my $pgdata  = "$tempdir/pgdata";
+
+start_test_server($tempdir);
+
+psql 'postgres', "CREATE TABLE bloom_test (a int, b text)";
+psql 'postgres', "CREATE INDEX bloom_test_idx ON bloom_test USING bloom (a, b)";
+psql 'postgres', "CHECKPOINT";
+
+# Everything from here on is replayed after the crash.
+psql 'postgres',
+  "INSERT INTO bloom_test SELECT i, 'v' || i FROM generate_series(1, 20000) i";
+psql 'postgres', "DELETE FROM bloom_test WHERE a % 3 = 0";
+psql 'postgres', "VACUUM bloom_test";
+psql 'postgres',
+  "INSERT INTO bloom_test SELECT i, 'w' || i FROM generate_series(1, 2000) i";
+
+system_or_bail('pg_ctl', '-D', $pgdata, '-m', 'immediate', 'stop');
+system_or_bail('pg_ctl', '-D', $pgdata, '-w', '-l',
+	"$log_path/postmaster.log", 'start');
+
+my $query = "SELECT count(*) FROM bloom_test WHERE a = 42 AND b = 'w42';
+			 SELECT count(*) FROM bloom_test WHERE a = 7 AND b = 'v7';
+			 SELECT count(*) FROM bloom_test WHERE a = 9 AND b = 'v9'";
+
+is( psql(
+		'postgres', "SET enable_seqscan = off; $query"),
+	"1\n1\n0",
+	'bloom index scan after crash recovery');
+is(psql('postgres', $query), "1\n1\n0", 'same result without the index');
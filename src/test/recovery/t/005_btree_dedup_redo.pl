@@ -0,0 +1,76 @@
+# Check that crash recovery replays B-tree deduplication, and the VACUUM
+# of posting list tuples, leaving the index with the same contents as the
+# heap.
+use strict;
+use warnings;
+use TestLib;
+use Test::More tests => 5;
+
+my $tempdir = TestLib::tempdir;
+my $pgdata  = "$tempdir/pgdata";
+
+start_test_server($tempdir);
+
+psql 'postgres', "CREATE TABLE dedup_test (a int)";
+psql 'postgres', "CREATE INDEX dedup_test_idx ON dedup_test (a)";
+psql 'postgres',
+  "CREATE INDEX dedup_test_nodedup ON dedup_test (a)
+	 WITH (deduplicate_items = off)";
+psql 'postgres', "CHECKPOINT";
+
+# Everything from here on is replayed after the crash.  The indexes start
+# out empty, so all posting lists are made by deduplication on insert.
+psql 'postgres',
+  "INSERT INTO dedup_test SELECT i % 100 FROM generate_series(1, 100000) i";
+psql 'postgres', "DELETE FROM dedup_test WHERE a % 10 = 0 OR a = 55";
+psql 'postgres', "VACUUM dedup_test";
+psql 'postgres',
+  "INSERT INTO dedup_test SELECT i % 50 FROM generate_series(1, 20000) i";
+
+system_or_bail('pg_ctl', '-D', $pgdata, '-m', 'immediate', 'stop');
+system_or_bail('pg_ctl', '-D', $pgdata, '-w', '-l',
+	"$log_path/postmaster.log", 'start');
+
+is( psql(
+		'postgres',
+		"SELECT pg_relation_size('dedup_test_idx') * 2 <
+				pg_relation_size('dedup_test_nodedup')"),
+	't',
+	'duplicates were merged into posting lists');
+psql 'postgres', "DROP INDEX dedup_test_nodedup";
+
+# Compare what the index returns with the heap.  The keys come from an
+# index-only scan, the heap TIDs from a plain index scan, so the TIDs
+# stored in the posting lists are checked too.
+my $keys = "SELECT count(*), md5(string_agg(a::text, ',' ORDER BY a))
+			FROM (SELECT a FROM dedup_test ORDER BY a) s";
+my $tids = "SELECT count(*), md5(string_agg(ctid::text, ',' ORDER BY ctid))
+			FROM (SELECT ctid FROM dedup_test WHERE a >= 0) s";
+my $noseq = "SET enable_seqscan = off; SET enable_bitmapscan = off;
+			 SET enable_sort = off;";
+
+my $heap_keys = psql('postgres', "SET enable_indexscan = off;
+	SET enable_indexonlyscan = off; SET enable_bitmapscan = off; $keys");
+my $heap_tids = psql('postgres', "SET enable_indexscan = off;
+	SET enable_indexonlyscan = off; SET enable_bitmapscan = off; $tids");
+
+like(
+	psql('postgres', "$noseq EXPLAIN (COSTS OFF) SELECT a FROM dedup_test ORDER BY a"),
+	qr/Index Only Scan using dedup_test_idx/,
+	'index-only scan used');
+is(psql('postgres', "$noseq $keys"), $heap_keys,
+	'index-only scan returns the heap keys after crash recovery');
+is( psql(
+		'postgres', "$noseq SET enable_indexonlyscan = off; $tids"),
+	$heap_tids,
+	'index scan returns the heap TIDs after crash recovery');
+
+# The index must keep deduplicating and splitting posting lists.
+psql 'postgres',
+  "INSERT INTO dedup_test SELECT i % 100 FROM generate_series(1, 50000) i";
+is( psql(
+		'postgres',
+		"$noseq SET enable_indexonlyscan = off;
+		 SELECT count(*) FROM dedup_test WHERE a = 55"),
+	'500',
+	'index usable after crash recovery');
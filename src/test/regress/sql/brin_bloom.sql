@@ -0,0 +1,215 @@
+--
+-- Tests for the BRIN bloom operator classes
+--
+CREATE TABLE brintest_bloom (byteacol bytea,
+	int2col smallint,
+	int4col integer,
+	int8col bigint,
+	textcol text,
+	oidcol oid,
+	float4col real,
+	float8col double precision,
+	macaddrcol macaddr,
+	inetcol inet,
+	bpcharcol character(4),
+	datecol date,
+	timecol time without time zone,
+	timestampcol timestamp without time zone,
+	timestamptzcol timestamp with time zone,
+	intervalcol interval,
+	numericcol numeric,
+	uuidcol uuid
+) WITH (fillfactor=10);
+
+-- the values are a permutation of 0..999, so minmax would be useless here
+INSERT INTO brintest_bloom SELECT
+	decode(md5(v::text), 'hex'),
+	v::int2,
+	v::int4,
+	v::int8 * 1000000007,
+	md5(v::text),
+	v::oid,
+	(v / 4.0)::real,
+	(v / 8.0)::float8,
+	('08002b' || lpad(to_hex(v), 6, '0'))::macaddr,
+	inet '10.0.0.0' + v,
+	lpad(v::text, 4, '0')::bpchar,
+	date '2000-01-01' + v,
+	time '00:00' + v * interval '1 minute',
+	timestamp '2000-01-01' + v * interval '1 hour',
+	timestamptz '2000-01-01 00:00+00' + v * interval '1 hour',
+	v * interval '1 second',
+	v * 1.5,
+	md5(v::text)::uuid
+FROM (SELECT (i * 7919) % 1000 AS v FROM generate_series(1, 500) i) s;
+
+-- default pages_per_range, so that all eighteen filters, each sized for a
+-- full range, have to share a single index tuple
+CREATE INDEX brinidx_bloom ON brintest_bloom USING brin (
+	byteacol bytea_bloom_ops,
+	int2col int2_bloom_ops,
+	int4col int4_bloom_ops,
+	int8col int8_bloom_ops,
+	textcol text_bloom_ops,
+	oidcol oid_bloom_ops,
+	float4col float4_bloom_ops,
+	float8col float8_bloom_ops,
+	macaddrcol macaddr_bloom_ops,
+	inetcol inet_bloom_ops,
+	bpcharcol bpchar_bloom_ops,
+	datecol date_bloom_ops,
+	timecol time_bloom_ops,
+	timestampcol timestamp_bloom_ops,
+	timestamptzcol timestamptz_bloom_ops,
+	intervalcol interval_bloom_ops,
+	numericcol numeric_bloom_ops,
+	uuidcol uuid_bloom_ops
+);
+
+-- the rest of the values go through brininsert, plus a few NULLs
+INSERT INTO brintest_bloom SELECT
+	decode(md5(v::text), 'hex'),
+	v::int2,
+	v::int4,
+	v::int8 * 1000000007,
+	md5(v::text),
+	v::oid,
+	(v / 4.0)::real,
+	(v / 8.0)::float8,
+	('08002b' || lpad(to_hex(v), 6, '0'))::macaddr,
+	inet '10.0.0.0' + v,
+	lpad(v::text, 4, '0')::bpchar,
+	date '2000-01-01' + v,
+	time '00:00' + v * interval '1 minute',
+	timestamp '2000-01-01' + v * interval '1 hour',
+	timestamptz '2000-01-01 00:00+00' + v * interval '1 hour',
+	v * interval '1 second',
+	v * 1.5,
+	md5(v::text)::uuid
+FROM (SELECT (i * 7919) % 1000 AS v FROM generate_series(501, 1000) i) s;
+
+INSERT INTO brintest_bloom (int4col) SELECT NULL FROM generate_series(1, 5);
+
+VACUUM brintest_bloom;  -- summarize the new ranges
+
+-- each column is an injective function of the value, expressed in expr
+CREATE TABLE brinopers_bloom (colname name, expr text);
+
+INSERT INTO brinopers_bloom VALUES
+	('byteacol', $$decode(md5(%s::text), 'hex')$$),
+	('int2col', $$%s::int2$$),
+	('int4col', $$%s::int4$$),
+	('int8col', $$%s::int8 * 1000000007$$),
+	('textcol', $$md5(%s::text)$$),
+	('oidcol', $$%s::oid$$),
+	('float4col', $$(%s / 4.0)::real$$),
+	('float8col', $$(%s / 8.0)::float8$$),
+	('macaddrcol', $$('08002b' || lpad(to_hex(%s), 6, '0'))::macaddr$$),
+	('inetcol', $$inet '10.0.0.0' + %s$$),
+	('bpcharcol', $$lpad(%s::text, 4, '0')::bpchar$$),
+	('datecol', $$date '2000-01-01' + %s$$),
+	('timecol', $$time '00:00' + %s * interval '1 minute'$$),
+	('timestampcol', $$timestamp '2000-01-01' + %s * interval '1 hour'$$),
+	('timestamptzcol', $$timestamptz '2000-01-01 00:00+00' + %s * interval '1 hour'$$),
+	('intervalcol', $$%s * interval '1 second'$$),
+	('numericcol', $$%s * 1.5$$),
+	('uuidcol', $$md5(%s::text)::uuid$$);
+
+-- Bloom filters may have false positives, but never false negatives: every
+-- value in the table must be found through the index, however many filters
+-- the index tuple has to hold.
+DO $x$
+DECLARE
+	r record;
+	nfound int;
+	nabsent int;
+	plan_ok bool;
+	plan_line text;
+	query text;
+BEGIN
+	SET enable_seqscan = 0;
+	SET enable_bitmapscan = 1;
+
+	FOR r IN SELECT colname, expr FROM brinopers_bloom LOOP
+		query := format($y$SELECT count(*) FROM generate_series(0, 999, 37) v
+			WHERE EXISTS (SELECT 1 FROM brintest_bloom WHERE %I = %s)$y$,
+			r.colname, format(r.expr, 'v'));
+
+		plan_ok := false;
+		FOR plan_line IN EXECUTE 'EXPLAIN ' || query LOOP
+			IF plan_line LIKE '%Bitmap Index Scan on brinidx_bloom%' THEN
+				plan_ok := true;
+			END IF;
+		END LOOP;
+		IF NOT plan_ok THEN
+			RAISE WARNING 'did not get bitmap indexscan plan for %', r;
+		END IF;
+
+		EXECUTE query INTO nfound;
+		IF nfound <> 28 THEN
+			RAISE WARNING 'found only % of 28 values for %', nfound, r;
+		END IF;
+
+		-- and a value that isn't there must not be returned
+		EXECUTE format($y$SELECT count(*) FROM brintest_bloom WHERE %I = %s$y$,
+			r.colname, format(r.expr, 1000)) INTO nabsent;
+		IF nabsent <> 0 THEN
+			RAISE WARNING 'found % rows for a missing value for %', nabsent, r;
+		END IF;
+	END LOOP;
+
+	RESET enable_seqscan;
+	RESET enable_bitmapscan;
+END;
+$x$;
+
+-- NULLs are tracked apart from the filter
+SET enable_seqscan = 0;
+SELECT count(*) FROM brintest_bloom WHERE int4col IS NULL;
+SELECT count(*) FROM brintest_bloom WHERE uuidcol IS NOT NULL;
+RESET enable_seqscan;
+
+-- bloom filters only support equality
+SET enable_seqscan = 0;
+EXPLAIN (COSTS OFF) SELECT * FROM brintest_bloom WHERE int4col = 42;
+EXPLAIN (COSTS OFF) SELECT * FROM brintest_bloom WHERE int4col < 42;
+RESET enable_seqscan;
+
+SELECT brin_summarize_new_values('brinidx_bloom'); -- ok, no change expected
+
+-- Each range holds values from a small set of its own, in no particular
+-- order across ranges; looking one up only needs to read the range holding
+-- it, plus the odd false positive.
+CREATE TABLE brin_bloom_prune (a int) WITH (autovacuum_enabled = false);
+INSERT INTO brin_bloom_prune
+	SELECT ((i / 452) * 7919 % 1000) * 10 + i % 10
+	FROM generate_series(0, 19999) i;
+CREATE INDEX brin_bloom_prune_idx ON brin_bloom_prune
+	USING brin (a int4_bloom_ops) WITH (pages_per_range = 2);
+
+CREATE FUNCTION brin_bloom_heap_blocks(query text) RETURNS int
+LANGUAGE plpgsql AS
+$$
+DECLARE
+	ln text;
+BEGIN
+	FOR ln IN EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF) ' || query LOOP
+		IF ln ~ 'Heap Blocks:' THEN
+			RETURN substring(ln FROM 'lossy=([0-9]+)')::int;
+		END IF;
+	END LOOP;
+	RETURN NULL;
+END;
+$$;
+
+SET enable_seqscan = 0;
+SELECT brin_bloom_heap_blocks('SELECT * FROM brin_bloom_prune WHERE a = 1903') <= 4
+	AS pruned;
+SELECT count(*) FROM brin_bloom_prune WHERE a = 1903;
+RESET enable_seqscan;
+
+DROP FUNCTION brin_bloom_heap_blocks(text);
+DROP TABLE brin_bloom_prune;
+
+DROP TABLE brintest_bloom;
+DROP TABLE brinopers_bloom;
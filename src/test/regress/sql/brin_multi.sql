@@ -0,0 +1,167 @@
+--
+-- Tests for the BRIN minmax-multi operator classes
+--
+CREATE TABLE brintest_multi (int2col smallint,
+	int4col integer,
+	int8col bigint,
+	oidcol oid,
+	float4col real,
+	float8col double precision,
+	numericcol numeric,
+	datecol date,
+	timecol time without time zone,
+	timestampcol timestamp without time zone,
+	timestamptzcol timestamp with time zone,
+	intervalcol interval,
+	lsncol pg_lsn
+) WITH (fillfactor=10);
+
+-- mostly sequential values, with an outlier every 50 rows
+INSERT INTO brintest_multi SELECT
+	v::int2,
+	v::int4,
+	v::int8 * 1000000007,
+	v::oid,
+	(v / 4.0)::real,
+	(v / 8.0)::float8,
+	v * 1.5,
+	date '2000-01-01' + v,
+	time '00:00' + v * interval '1 second',
+	timestamp '2000-01-01' + v * interval '1 hour',
+	timestamptz '2000-01-01 00:00+00' + v * interval '1 hour',
+	v * interval '1 second',
+	('0/' || to_hex(v))::pg_lsn
+FROM (SELECT CASE WHEN i % 50 = 0 THEN 20000 + i ELSE i END AS v
+	  FROM generate_series(1, 500) i) s;
+
+CREATE INDEX brinidx_multi ON brintest_multi USING brin (
+	int2col int2_minmax_multi_ops,
+	int4col int4_minmax_multi_ops,
+	int8col int8_minmax_multi_ops,
+	oidcol oid_minmax_multi_ops,
+	float4col float4_minmax_multi_ops,
+	float8col float8_minmax_multi_ops,
+	numericcol numeric_minmax_multi_ops,
+	datecol date_minmax_multi_ops,
+	timecol time_minmax_multi_ops,
+	timestampcol timestamp_minmax_multi_ops,
+	timestamptzcol timestamptz_minmax_multi_ops,
+	intervalcol interval_minmax_multi_ops,
+	lsncol pg_lsn_minmax_multi_ops
+) WITH (pages_per_range = 1);
+
+-- the rest of the values go through brininsert, plus a few NULLs
+INSERT INTO brintest_multi SELECT
+	v::int2,
+	v::int4,
+	v::int8 * 1000000007,
+	v::oid,
+	(v / 4.0)::real,
+	(v / 8.0)::float8,
+	v * 1.5,
+	date '2000-01-01' + v,
+	time '00:00' + v * interval '1 second',
+	timestamp '2000-01-01' + v * interval '1 hour',
+	timestamptz '2000-01-01 00:00+00' + v * interval '1 hour',
+	v * interval '1 second',
+	('0/' || to_hex(v))::pg_lsn
+FROM (SELECT CASE WHEN i % 50 = 0 THEN 20000 + i ELSE i END AS v
+	  FROM generate_series(501, 1000) i) s;
+
+INSERT INTO brintest_multi (int4col) SELECT NULL FROM generate_series(1, 5);
+
+VACUUM brintest_multi;  -- summarize the new ranges
+
+-- each column is a monotonic function of the value, expressed in expr
+CREATE TABLE brinopers_multi (colname name, expr text);
+
+INSERT INTO brinopers_multi VALUES
+	('int2col', $$%s::int2$$),
+	('int4col', $$%s::int4$$),
+	('int8col', $$%s::int8 * 1000000007$$),
+	('oidcol', $$%s::oid$$),
+	('float4col', $$(%s / 4.0)::real$$),
+	('float8col', $$(%s / 8.0)::float8$$),
+	('numericcol', $$%s * 1.5$$),
+	('datecol', $$date '2000-01-01' + %s$$),
+	('timecol', $$time '00:00' + %s * interval '1 second'$$),
+	('timestampcol', $$timestamp '2000-01-01' + %s * interval '1 hour'$$),
+	('timestamptzcol', $$timestamptz '2000-01-01 00:00+00' + %s * interval '1 hour'$$),
+	('intervalcol', $$%s * interval '1 second'$$),
+	('lsncol', $$('0/' || to_hex(%s))::pg_lsn$$);
+
+DO $x$
+DECLARE
+	r record;
+	cond text;
+	count int;
+	count_ss int;
+	plan_ok bool;
+	plan_line text;
+BEGIN
+	FOR r IN SELECT colname, expr, oper, value, matches FROM brinopers_multi,
+		(VALUES ('<', 100, 98), ('<=', 99, 98), ('=', 99, 1), ('=', 100, 0),
+				('>=', 901, 118), ('>', 900, 118), ('=', 20500, 1),
+				('>=', 20500, 11), ('<', 1, 0), (NULL, NULL, 5))
+			AS v(oper, value, matches) LOOP
+
+		-- prepare the condition
+		IF r.value IS NULL THEN
+			cond := format('%I IS NULL', r.colname);
+		ELSE
+			cond := format('%I %s %s', r.colname, r.oper, format(r.expr, r.value));
+		END IF;
+
+		-- run the query using the brin index
+		SET enable_seqscan = 0;
+		SET enable_bitmapscan = 1;
+
+		plan_ok := false;
+		FOR plan_line IN EXECUTE format($y$EXPLAIN SELECT * FROM brintest_multi WHERE %s $y$, cond) LOOP
+			IF plan_line LIKE '%Bitmap Index Scan on brinidx_multi%' THEN
+				plan_ok := true;
+			END IF;
+		END LOOP;
+		IF NOT plan_ok THEN
+			RAISE WARNING 'did not get bitmap indexscan plan for %', r;
+		END IF;
+
+		EXECUTE format($y$SELECT count(*) FROM brintest_multi WHERE %s $y$, cond) INTO count;
+
+		-- run the query using a seqscan
+		SET enable_seqscan = 1;
+		SET enable_bitmapscan = 0;
+
+		EXECUTE format($y$SELECT count(*) FROM brintest_multi WHERE %s $y$, cond) INTO count_ss;
+
+		-- make sure both return the expected number of matches
+		IF count <> count_ss OR count <> r.matches THEN
+			RAISE WARNING 'unexpected number of results % (seqscan %) for %', count, count_ss, r;
+		END IF;
+	END LOOP;
+	RESET enable_seqscan;
+	RESET enable_bitmapscan;
+END;
+$x$;
+
+SELECT brin_summarize_new_values('brinidx_multi'); -- ok, no change expected
+
+-- many values per range, so that intervals have to be merged
+CREATE TABLE brin_multi_reduce (a int) WITH (autovacuum_enabled = false);
+INSERT INTO brin_multi_reduce
+	SELECT CASE WHEN i % 50 = 0 THEN 100000 + i ELSE i END
+	FROM generate_series(1, 10000) i;
+CREATE INDEX brin_multi_reduce_idx ON brin_multi_reduce
+	USING brin (a int4_minmax_multi_ops) WITH (pages_per_range = 1);
+
+SET enable_seqscan = 0;
+EXPLAIN (COSTS OFF) SELECT count(*) FROM brin_multi_reduce WHERE a > 100000;
+SELECT count(*) FROM brin_multi_reduce WHERE a > 100000;
+SELECT count(*) FROM brin_multi_reduce WHERE a = 100500;
+SELECT count(*) FROM brin_multi_reduce WHERE a < 50;
+SELECT count(*) FROM brin_multi_reduce WHERE a BETWEEN 5000 AND 5100;
+RESET enable_seqscan;
+
+DROP TABLE brintest_multi;
+DROP TABLE brinopers_multi;
+DROP TABLE brin_multi_reduce;
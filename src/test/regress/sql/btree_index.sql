@@ -92,3 +92,130 @@ vacuum btree_tall_tbl;
 -- need to insert some rows to cause the fast root page to split.
 insert into btree_tall_tbl (id, t)
   select g, repeat('x', 100) from generate_series(1, 500) g;
+
+--
+-- Test B-tree deduplication of duplicate keys into posting list tuples
+--
+create table btree_dup_tbl (a int4, b int4);
+insert into btree_dup_tbl select g % 10, g from generate_series(1, 10000) g;
+create index btree_dup_idx on btree_dup_tbl (a);
+create index btree_nodup_idx on btree_dup_tbl (a) with (deduplicate_items = off);
+
+-- The build merged the duplicates, so the index is much smaller
+select pg_relation_size('btree_dup_idx') * 2 <
+       pg_relation_size('btree_nodup_idx') as dedup_smaller;
+drop index btree_nodup_idx;
+
+-- Adding more duplicates fills leaf pages and merges them on insertion
+insert into btree_dup_tbl select g % 10, g from generate_series(10001, 20000) g;
+
+set enable_seqscan to false;
+set enable_bitmapscan to false;
+select count(*), sum(b) from btree_dup_tbl where a = 5;
+select a, count(*) from btree_dup_tbl where a < 3 group by a order by a;
+select count(*) from (select a from btree_dup_tbl where a >= 7 order by a desc) s;
+
+-- VACUUM removes posting list tuples whose heap TIDs are all dead, and
+-- shrinks those with only some dead ones
+delete from btree_dup_tbl where b % 3 = 0 or a = 9;
+vacuum btree_dup_tbl;
+select count(*), sum(b) from btree_dup_tbl where a = 5;
+select count(*) from btree_dup_tbl where a = 9;
+select count(*) from btree_dup_tbl where a >= 0;
+select count(*) from (select a from btree_dup_tbl where a >= 7 order by a desc) s;
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+alter index btree_dup_idx set (deduplicate_items = off);
+alter index btree_dup_idx reset (deduplicate_items);
+drop table btree_dup_tbl;
+
+-- Leaf high keys of a multi-column index only keep the columns needed to
+-- separate the two halves of a split
+create table btree_trunc_tbl (a int4, b text);
+insert into btree_trunc_tbl
+  select g / 100, repeat('x', 200) || g from generate_series(1, 5000) g;
+create index btree_trunc_idx on btree_trunc_tbl (a, b);
+insert into btree_trunc_tbl
+  select g / 100, repeat('x', 200) || g from generate_series(5001, 10000) g;
+
+set enable_seqscan to false;
+set enable_bitmapscan to false;
+select count(*) from btree_trunc_tbl where a = 42;
+select count(*) from btree_trunc_tbl where a = 42 and b = repeat('x', 200) || 4242;
+select count(*) from btree_trunc_tbl where a between 10 and 19;
+select count(*) from btree_trunc_tbl where a >= 99;
+
+-- Deleting pages whose high keys are truncated
+delete from btree_trunc_tbl where a between 20 and 79;
+vacuum btree_trunc_tbl;
+select count(*) from btree_trunc_tbl where a >= 0;
+select count(*) from btree_trunc_tbl where a = 80;
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table btree_trunc_tbl;
+
+-- Skip scans use a multi-column index for quals that don't constrain its
+-- first column, by visiting each distinct first-column value in turn
+create table btree_skip_tbl (a int4, b int4);
+insert into btree_skip_tbl
+  select case when g % 50 = 0 then null else g % 5 end, g % 997
+  from generate_series(1, 10000) g;
+create index btree_skip_idx on btree_skip_tbl (a, b);
+analyze btree_skip_tbl;
+
+set enable_seqscan to false;
+set enable_bitmapscan to false;
+explain (costs off)
+select a, b from btree_skip_tbl where b = 50;
+select a, b from btree_skip_tbl where b = 50;
+explain (costs off)
+select a, b from btree_skip_tbl where b = 50 order by a desc;
+select a, b from btree_skip_tbl where b = 50 order by a desc;
+select count(*) from btree_skip_tbl where b between 10 and 19;
+select count(*) from btree_skip_tbl where b in (42, 50);
+select count(*) from btree_skip_tbl where b = 50 and a is null;
+
+set enable_indexskipscan to false;
+explain (costs off)
+select a, b from btree_skip_tbl where b = 50;
+select count(*) from btree_skip_tbl where b between 10 and 19;
+reset enable_indexskipscan;
+
+set enable_indexscan to false;
+set enable_bitmapscan to true;
+explain (costs off)
+select * from btree_skip_tbl where b = 50;
+select count(*) from btree_skip_tbl where b between 10 and 19;
+reset enable_indexscan;
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table btree_skip_tbl;
+
+-- Non-key INCLUDE columns are stored in leaf tuples only; they don't take
+-- part in uniqueness, but index-only scans can return them
+create table btree_incl_tbl (a int4, b int4, c text, d point);
+insert into btree_incl_tbl
+  select g, g % 7, 'c' || g, point(g, g) from generate_series(1, 10000) g;
+create unique index btree_incl_idx on btree_incl_tbl (a, b) include (c, d);
+select pg_get_indexdef('btree_incl_idx'::regclass);
+select indnatts, indnkeyatts from pg_index
+  where indexrelid = 'btree_incl_idx'::regclass;
+vacuum analyze btree_incl_tbl;
+
+set enable_seqscan to false;
+set enable_bitmapscan to false;
+explain (costs off)
+select a, c, d from btree_incl_tbl where a = 42;
+select a, c, d from btree_incl_tbl where a = 42;
+select count(*) from btree_incl_tbl where a between 100 and 8000;
+insert into btree_incl_tbl values (42, 0, 'dup', point(0, 0));
+insert into btree_incl_tbl values (42, 1, 'c42', point(42, 42));
+select a, b, c from btree_incl_tbl where a = 42 order by b;
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+create index on btree_incl_tbl (a) include (b desc);
+create index on btree_incl_tbl (a) include ((b + 1));
+create index on btree_incl_tbl using hash (a) include (b);
+drop table btree_incl_tbl;
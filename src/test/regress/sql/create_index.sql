@@ -198,6 +198,14 @@ SELECT count(*) FROM quad_point_tbl WHERE p >^ '(5000, 4000)';
 
 SELECT count(*) FROM quad_point_tbl WHERE p ~= '(4585, 365)';
 
+CREATE TEMP TABLE quad_point_tbl_ord_seq1 AS
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM quad_point_tbl;
+
+CREATE TEMP TABLE quad_point_tbl_ord_seq2 AS
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM quad_point_tbl WHERE p <@ box '(200,200,1000,1000)';
+
 SELECT count(*) FROM radix_text_tbl WHERE t = 'P0123456789abcdef';
 
 SELECT count(*) FROM radix_text_tbl WHERE t = 'P0123456789abcde';
@@ -389,6 +397,62 @@ EXPLAIN (COSTS OFF)
 SELECT count(*) FROM kd_point_tbl WHERE p ~= '(4585, 365)';
 SELECT count(*) FROM kd_point_tbl WHERE p ~= '(4585, 365)';
 
+EXPLAIN (COSTS OFF)
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM quad_point_tbl;
+CREATE TEMP TABLE quad_point_tbl_ord_idx1 AS
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM quad_point_tbl;
+(SELECT n, dist, p::text FROM quad_point_tbl_ord_seq1
+ EXCEPT ALL
+ SELECT n, dist, p::text FROM quad_point_tbl_ord_idx1)
+UNION ALL
+(SELECT n, dist, p::text FROM quad_point_tbl_ord_idx1
+ EXCEPT ALL
+ SELECT n, dist, p::text FROM quad_point_tbl_ord_seq1);
+
+EXPLAIN (COSTS OFF)
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM quad_point_tbl WHERE p <@ box '(200,200,1000,1000)';
+CREATE TEMP TABLE quad_point_tbl_ord_idx2 AS
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM quad_point_tbl WHERE p <@ box '(200,200,1000,1000)';
+(SELECT n, dist, p::text FROM quad_point_tbl_ord_seq2
+ EXCEPT ALL
+ SELECT n, dist, p::text FROM quad_point_tbl_ord_idx2)
+UNION ALL
+(SELECT n, dist, p::text FROM quad_point_tbl_ord_idx2
+ EXCEPT ALL
+ SELECT n, dist, p::text FROM quad_point_tbl_ord_seq2);
+
+EXPLAIN (COSTS OFF)
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM kd_point_tbl;
+CREATE TEMP TABLE kd_point_tbl_ord_idx1 AS
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM kd_point_tbl;
+(SELECT n, dist, p::text FROM quad_point_tbl_ord_seq1
+ EXCEPT ALL
+ SELECT n, dist, p::text FROM kd_point_tbl_ord_idx1)
+UNION ALL
+(SELECT n, dist, p::text FROM kd_point_tbl_ord_idx1
+ EXCEPT ALL
+ SELECT n, dist, p::text FROM quad_point_tbl_ord_seq1);
+
+EXPLAIN (COSTS OFF)
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM kd_point_tbl WHERE p <@ box '(200,200,1000,1000)';
+CREATE TEMP TABLE kd_point_tbl_ord_idx2 AS
+SELECT rank() OVER (ORDER BY p <-> '0,0') n, p <-> '0,0' dist, p
+FROM kd_point_tbl WHERE p <@ box '(200,200,1000,1000)';
+(SELECT n, dist, p::text FROM quad_point_tbl_ord_seq2
+ EXCEPT ALL
+ SELECT n, dist, p::text FROM kd_point_tbl_ord_idx2)
+UNION ALL
+(SELECT n, dist, p::text FROM kd_point_tbl_ord_idx2
+ EXCEPT ALL
+ SELECT n, dist, p::text FROM quad_point_tbl_ord_seq2);
+
 EXPLAIN (COSTS OFF)
 SELECT count(*) FROM radix_text_tbl WHERE t = 'P0123456789abcdef';
 SELECT count(*) FROM radix_text_tbl WHERE t = 'P0123456789abcdef';
@@ -10,7 +10,16 @@ create index gin_test_idx on gin_test_tbl using gin (i) with (fastupdate = on);
 insert into gin_test_tbl select array[1, 2, g] from generate_series(1, 20000) g;
 insert into gin_test_tbl select array[1, 3, g] from generate_series(1, 1000) g;
 
-vacuum gin_test_tbl; -- flush the fastupdate buffers
+-- Searches must see the entries still in the pending list
+set enable_seqscan = off;
+select count(*) from gin_test_tbl where i @> array[3];
+select count(*) from gin_test_tbl where i @> array[2, 3];
+reset enable_seqscan;
+
+select gin_clean_pending_list('gin_test_idx') > 10 as many; -- flush the fastupdate buffers
+select gin_clean_pending_list('gin_test_idx'); -- nothing left to flush
+
+vacuum gin_test_tbl;
 
 -- Test vacuuming
 delete from gin_test_tbl where i @> array[2];
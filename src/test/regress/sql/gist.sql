@@ -24,6 +24,25 @@ delete from gist_point_tbl where id < 10000;
 
 vacuum analyze gist_point_tbl;
 
+-- Rebuild the index using the sorted build, which is the default for point
+-- columns, and the buffering build, and check that both give the same
+-- answer as a sequential scan.
+select count(*) from gist_point_tbl where p <@ box(point(0,0), point(50000, 50000));
+
+set enable_seqscan=off;
+set enable_bitmapscan=off;
+
+drop index gist_pointidx;
+create index gist_pointidx_sorted on gist_point_tbl using gist(p);
+select count(*) from gist_point_tbl where p <@ box(point(0,0), point(50000, 50000));
+drop index gist_pointidx_sorted;
+
+create index gist_pointidx_buffered on gist_point_tbl using gist(p) with (buffering = on);
+select count(*) from gist_point_tbl where p <@ box(point(0,0), point(50000, 50000));
+
+reset enable_seqscan;
+reset enable_bitmapscan;
+
 
 --
 -- Test Index-only plans on GiST indexes
@@ -151,3 +151,34 @@ SELECT h.seqno AS f20000
 
 -- SELECT count(*) AS i988 FROM hash_ovfl_heap
 --  WHERE x = 1000;
+
+-- Fill an overflow chain with a single key, then force bucket splits.
+CREATE TABLE hash_split_heap (keycol INT);
+INSERT INTO hash_split_heap SELECT 1 FROM generate_series(1, 500) a;
+CREATE INDEX hash_split_index on hash_split_heap USING HASH (keycol);
+INSERT INTO hash_split_heap SELECT 1 FROM generate_series(1, 5000) a;
+INSERT INTO hash_split_heap SELECT a/2 FROM generate_series(1, 25000) a;
+
+-- Empty the overflow chain; VACUUM squeezes the bucket and frees its
+-- overflow pages, and the next inserts reuse them.
+DELETE FROM hash_split_heap WHERE keycol = 1;
+VACUUM hash_split_heap;
+INSERT INTO hash_split_heap SELECT a/2 FROM generate_series(1, 2000) a;
+
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+EXPLAIN (COSTS OFF)
+SELECT count(*) FROM hash_split_heap WHERE keycol = 1;
+SELECT count(*) FROM hash_split_heap WHERE keycol = 1;
+
+-- every remaining row must be found through the index
+SET enable_hashjoin = off;
+SET enable_mergejoin = off;
+SELECT count(*) FROM generate_series(0, 12500) k
+   JOIN hash_split_heap h ON h.keycol = k;
+RESET enable_hashjoin;
+RESET enable_mergejoin;
+RESET enable_bitmapscan;
+RESET enable_seqscan;
+
+DROP TABLE hash_split_heap;
@@ -0,0 +1,54 @@
+--
+-- Incremental sort
+--
+
+-- input sorted on a prefix of the wanted ordering
+explain (costs off)
+select * from (select four, ten from tenk1 order by four) t
+  order by four, ten limit 3;
+select * from (select four, ten from tenk1 order by four) t
+  order by four, ten limit 3;
+
+-- results must be right across batch and group boundaries
+select * from (select four, ten from tenk1 order by four) t
+  order by four, ten limit 4 offset 2498;
+
+set enable_incrementalsort = off;
+explain (costs off)
+select * from (select four, ten from tenk1 order by four) t
+  order by four, ten limit 3;
+reset enable_incrementalsort;
+
+-- rescans with a different bound each time must start over
+explain (costs off)
+select v.n, x.* from (values (0), (499), (2499), (499)) v(n),
+  lateral (select * from (select four, ten from tenk1 order by four) t
+           order by four, ten offset v.n limit 2) x;
+select v.n, x.* from (values (0), (499), (2499), (499)) v(n),
+  lateral (select * from (select four, ten from tenk1 order by four) t
+           order by four, ten offset v.n limit 2) x;
+
+-- an index on the leading key feeds the incremental sort, so only the
+-- first groups have to be read
+explain (costs off)
+select hundred, thousand from tenk1 order by hundred, thousand limit 12;
+select hundred, thousand from tenk1 order by hundred, thousand limit 12;
+
+-- NULLs in the presorted key form a group of their own
+explain (costs off)
+select * from (select nullif(four, 0) as a, ten from tenk1
+               order by a nulls first) t
+  order by a nulls first, ten limit 4 offset 2498;
+select * from (select nullif(four, 0) as a, ten from tenk1
+               order by a nulls first) t
+  order by a nulls first, ten limit 4 offset 2498;
+select * from (select nullif(four, 0) as a, ten from tenk1
+               order by a desc) t
+  order by a desc, ten limit 4 offset 2498;
+
+-- more than one presorted key
+explain (costs off)
+select * from (select four, ten, hundred from tenk1 order by four, ten) t
+  order by four, ten, hundred limit 4 offset 498;
+select * from (select four, ten, hundred from tenk1 order by four, ten) t
+  order by four, ten, hundred limit 4 offset 498;
@@ -123,3 +123,49 @@ INSERT INTO INET_TBL (c, i) VALUES ('10', '10::/8');
 SELECT inet_merge(c, i) FROM INET_TBL;
 -- fix it by inet_same_family() condition
 SELECT inet_merge(c, i) FROM INET_TBL WHERE inet_same_family(c, i);
+
+-- Sorting and indexing abbreviate inet and cidr values.  Values sharing a
+-- network but differing in netmask or host bits must still sort correctly.
+SELECT i FROM (VALUES ('10.1.2.3/24'::inet), ('10.1.2.3/8'), ('10.1.2.3'),
+    ('::ffff:10.1.2.3/120'), ('10.1.2.4/24'), ('10.1.0.0/16'), ('10.0.0.0/8'),
+    ('10.1.2.3/16'), ('9.255.255.255/8'), ('10.1.2.2/24')) v(i)
+  ORDER BY i;
+SELECT c FROM (VALUES ('10.1.2.0/24'::cidr), ('10.1.2.4/32'), ('10.0.0.0/7'),
+    ('10.1.0.0/16'), ('10.1.2.3/32'), ('10.0.0.0/8')) v(c)
+  ORDER BY c DESC;
+CREATE TEMP TABLE inet_sort AS
+  SELECT i, network(i) AS c FROM
+    (SELECT set_masklen(('10.' || g % 3 || '.' || (g / 3) % 256 || '.' ||
+                         (g * 7) % 256)::inet, 8 + g % 25) AS i
+     FROM generate_series(1, 10000) g
+     UNION ALL
+     SELECT set_masklen(('2001:db8::' || to_hex(g % 4096))::inet, 96 + g % 33)
+     FROM generate_series(1, 10000) g
+     UNION ALL
+     -- equal after abbreviation to some of the above, or to each other
+     SELECT i::inet FROM (VALUES ('10.0.1.21/8'), ('10.0.1.22/8'),
+         ('10.0.1.100/8'), ('10.0.1.200/8'), ('10.2.255.248/30'),
+         ('10.2.255.250/30')) v(i)) s;
+-- the OFFSET 0 keeps the LIMIT from bounding the sort, which would not
+-- abbreviate
+SELECT i FROM (SELECT i FROM inet_sort ORDER BY i OFFSET 0) s LIMIT 6;
+SELECT i FROM (SELECT i FROM inet_sort ORDER BY i OFFSET 0) s
+  OFFSET 9999 LIMIT 10;
+SELECT i FROM (SELECT i FROM inet_sort ORDER BY i DESC OFFSET 0) s LIMIT 4;
+SELECT c FROM (SELECT c FROM inet_sort ORDER BY c OFFSET 0) s
+  OFFSET 400 LIMIT 6;
+SELECT c FROM (SELECT c FROM inet_sort ORDER BY c DESC OFFSET 0) s LIMIT 4;
+CREATE INDEX inet_sort_i ON inet_sort (i);
+CREATE INDEX inet_sort_c ON inet_sort (c);
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SET enable_sort = off;
+SELECT i FROM inet_sort ORDER BY i LIMIT 6;
+SELECT i FROM inet_sort ORDER BY i OFFSET 9999 LIMIT 10;
+SELECT i FROM inet_sort ORDER BY i DESC LIMIT 4;
+SELECT c FROM inet_sort ORDER BY c OFFSET 400 LIMIT 6;
+SELECT c FROM inet_sort ORDER BY c DESC LIMIT 4;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+RESET enable_sort;
+DROP TABLE inet_sort;
@@ -276,3 +276,37 @@ select make_interval(months := 'NaN'::float::int);
 select make_interval(secs := 'inf');
 select make_interval(secs := 'NaN');
 select make_interval(secs := 7e12);
+
+--
+-- Sorting and indexing intervals abbreviates on their span, so intervals
+-- of equal span but different fields are equal after abbreviation.  The
+-- OFFSET 0 keeps the LIMIT from bounding the sort, which would not
+-- abbreviate.
+--
+CREATE TEMP TABLE interval_sort AS
+  SELECT i AS id, ((i * 7919) % 10000) * interval '1 hour' AS iv
+  FROM generate_series(1, 10000) i
+  UNION ALL
+  SELECT 10001, interval '1 month'
+  UNION ALL
+  SELECT 10002, interval '30 days'
+  UNION ALL
+  SELECT 10003, interval '29 days 24 hours'
+  UNION ALL
+  SELECT 10004, interval '-1 hour';
+SELECT * FROM (SELECT * FROM interval_sort ORDER BY iv, id OFFSET 0) s LIMIT 3;
+SELECT * FROM (SELECT * FROM interval_sort ORDER BY iv, id OFFSET 0) s
+  OFFSET 720 LIMIT 6;
+SELECT * FROM (SELECT * FROM interval_sort ORDER BY iv DESC, id DESC OFFSET 0) s
+  LIMIT 2;
+
+CREATE INDEX interval_sort_idx ON interval_sort (iv, id);
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT * FROM interval_sort ORDER BY iv, id LIMIT 3;
+SELECT * FROM interval_sort ORDER BY iv, id OFFSET 720 LIMIT 6;
+SELECT * FROM interval_sort ORDER BY iv DESC, id DESC LIMIT 2;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+
+DROP TABLE interval_sort;
@@ -41,3 +41,35 @@ SELECT  b & '00:00:00:ff:ff:ff' FROM macaddr_data;
 SELECT  b | '01:02:03:04:05:06' FROM macaddr_data;
 
 DROP TABLE macaddr_data;
+
+--
+-- Sorting and indexing macaddr abbreviates; the abbreviated keys are the
+-- whole address, so ties on them are real ties.  The OFFSET 0 keeps the
+-- LIMIT from bounding the sort, which would not abbreviate.
+--
+CREATE TEMP TABLE macaddr_sort AS
+  SELECT i AS id,
+         ('08002b' || lpad(to_hex((i * 7919) % 10000), 6, '0'))::macaddr AS m
+  FROM generate_series(1, 10000) i
+  UNION ALL
+  SELECT 10000 + i, '08:00:2b:00:13:88' FROM generate_series(1, 3) i
+  UNION ALL
+  SELECT 10004, '08:00:2a:ff:ff:ff'
+  UNION ALL
+  SELECT 10005, '08:00:2c:00:00:00';
+SELECT * FROM (SELECT * FROM macaddr_sort ORDER BY m, id OFFSET 0) s LIMIT 3;
+SELECT * FROM (SELECT * FROM macaddr_sort ORDER BY m, id OFFSET 0) s
+  OFFSET 5000 LIMIT 6;
+SELECT * FROM (SELECT * FROM macaddr_sort ORDER BY m DESC, id DESC OFFSET 0) s
+  LIMIT 2;
+
+CREATE INDEX macaddr_sort_idx ON macaddr_sort (m, id);
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT * FROM macaddr_sort ORDER BY m, id LIMIT 3;
+SELECT * FROM macaddr_sort ORDER BY m, id OFFSET 5000 LIMIT 6;
+SELECT * FROM macaddr_sort ORDER BY m DESC, id DESC LIMIT 2;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+
+DROP TABLE macaddr_sort;
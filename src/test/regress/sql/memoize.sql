@@ -0,0 +1,132 @@
+--
+-- Memoize caching of parameterized nestloop inner scans
+--
+
+-- force a nestloop with a parameterized inner index scan
+set enable_hashjoin = off;
+set enable_mergejoin = off;
+set enable_bitmapscan = off;
+
+-- only 20 distinct values of t2.twenty among the 1000 outer rows
+explain (costs off)
+select count(*), avg(t1.unique1) from tenk1 t1
+  inner join tenk1 t2 on t1.unique1 = t2.twenty
+  where t2.unique1 < 1000;
+select count(*), avg(t1.unique1) from tenk1 t1
+  inner join tenk1 t2 on t1.unique1 = t2.twenty
+  where t2.unique1 < 1000;
+
+-- the same, with caching disabled
+set enable_memoize = off;
+explain (costs off)
+select count(*), avg(t1.unique1) from tenk1 t1
+  inner join tenk1 t2 on t1.unique1 = t2.twenty
+  where t2.unique1 < 1000;
+select count(*), avg(t1.unique1) from tenk1 t1
+  inner join tenk1 t2 on t1.unique1 = t2.twenty
+  where t2.unique1 < 1000;
+
+reset enable_memoize;
+
+-- report only the cache statistics, with the memory use masked
+create function explain_memoize(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in execute 'explain (analyze, costs off, timing off) ' || query
+    loop
+        if ln ~ 'Hits:' then
+            ln := regexp_replace(ln, 'Evictions: [1-9][0-9]*', 'Evictions: N');
+            ln := regexp_replace(ln, 'Memory Usage: [0-9]+', 'Memory Usage: N');
+            return next ltrim(ln);
+        end if;
+    end loop;
+end;
+$$;
+
+select explain_memoize('
+select count(*), avg(t1.unique1) from tenk1 t1
+  inner join tenk1 t2 on t1.unique1 = t2.twenty
+  where t2.unique1 < 1000');
+
+-- outer join, where half of the keys find no inner rows; those empty
+-- results are cached too
+explain (costs off)
+select count(*), count(t1.unique1) from tenk1 t2
+  left join tenk1 t1 on t1.unique1 = t2.twenty + 9990
+  where t2.unique1 < 1000;
+select explain_memoize('
+select count(*), count(t1.unique1) from tenk1 t2
+  left join tenk1 t1 on t1.unique1 = t2.twenty + 9990
+  where t2.unique1 < 1000');
+select t2.twenty, t1.unique1, count(*) from tenk1 t2
+  left join tenk1 t1 on t1.unique1 = t2.twenty + 9990
+  where t2.unique1 < 1000
+  group by t2.twenty, t1.unique1 order by t2.twenty;
+
+-- a change of a parameter that is not a cache key must purge the cache
+explain (costs off)
+select v.x, (select count(*) from tenk1 t1
+             inner join tenk1 t2 on t1.unique1 = t2.twenty
+             where t2.unique1 < 1000 and t1.hundred < v.x)
+  from (values (3), (7), (3)) v(x);
+select explain_memoize('
+select v.x, (select count(*) from tenk1 t1
+             inner join tenk1 t2 on t1.unique1 = t2.twenty
+             where t2.unique1 < 1000 and t1.hundred < v.x)
+  from (values (3), (7), (3)) v(x)');
+select v.x, (select count(*) from tenk1 t1
+             inner join tenk1 t2 on t1.unique1 = t2.twenty
+             where t2.unique1 < 1000 and t1.hundred < v.x)
+  from (values (3), (7), (3)) v(x);
+
+-- Entries that don't all fit in work_mem: 100 keys of 10 rows each, every
+-- key looked up twice in a row, in two rounds, so the second round only
+-- hits after evicting older entries.  Key 1000 has 2000 rows, more than
+-- fit in the cache on their own, so its scans bypass the cache.  The plan
+-- is made with the default work_mem, in which everything fits, and then
+-- run with the least work_mem allowed.
+create temp table memo_inner (a int, b text);
+insert into memo_inner
+  select i % 100, md5(i::text) from generate_series(1, 1000) i
+  union all
+  select 1000, md5(i::text) from generate_series(1, 2000) i;
+create index memo_inner_a on memo_inner (a);
+analyze memo_inner;
+create temp table memo_outer as
+  select g / 2 % 100 as k from generate_series(0, 399) g
+  union all
+  select 1000 from generate_series(1, 2);
+analyze memo_outer;
+
+prepare memo_q as
+  select o.k, i.b from memo_outer o inner join memo_inner i on i.a = o.k;
+explain (costs off) execute memo_q;
+set work_mem = '64kB';
+select explain_memoize('execute memo_q');
+
+-- the rows must be the same as without caching
+create temp table memo_result as execute memo_q;
+reset work_mem;
+set enable_memoize = off;
+select count(*) from memo_result;
+select count(*) from
+  ((table memo_result
+    except all
+    select o.k, i.b from memo_outer o inner join memo_inner i on i.a = o.k)
+   union all
+   (select o.k, i.b from memo_outer o inner join memo_inner i on i.a = o.k
+    except all
+    table memo_result)) d;
+
+reset enable_memoize;
+deallocate memo_q;
+drop table memo_result;
+drop table memo_outer;
+drop table memo_inner;
+drop function explain_memoize(text);
+reset enable_hashjoin;
+reset enable_mergejoin;
+reset enable_bitmapscan;
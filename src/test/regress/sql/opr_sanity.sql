@@ -960,6 +960,23 @@ WHERE p1.oid != p2.oid AND
     p1.opcmethod = p2.opcmethod AND p1.opcintype = p2.opcintype AND
     p1.opcdefault AND p2.opcdefault;
 
+-- **************** pg_am ****************
+
+-- Look for illegal values in pg_am fields
+
+SELECT p1.oid, p1.amname
+FROM pg_am AS p1
+WHERE p1.amhandler = 0;
+
+-- Check for amhandler functions with the wrong signature
+
+SELECT p1.oid, p1.amname, p2.oid, p2.proname
+FROM pg_am AS p1, pg_proc AS p2
+WHERE p2.oid = p1.amhandler AND
+    (p2.prorettype != 'index_am_handler'::regtype OR p2.proretset
+     OR p2.pronargs != 1
+     OR p2.proargtypes[0] != 'internal'::regtype);
+
 -- **************** pg_amop ****************
 
 -- Look for illegal values in pg_amop fields
@@ -996,18 +1013,23 @@ WHERE p1.amopsortfamily <> 0 AND NOT EXISTS
      AND op.opfmethod = (SELECT oid FROM pg_am WHERE amname = 'btree'));
 
 -- check for ordering operators not supported by parent AM
+-- (only gist and spgist have amcanorderbyop)
 
 SELECT p1.amopfamily, p1.amopopr, p2.oid, p2.amname
 FROM pg_amop AS p1, pg_am AS p2
 WHERE p1.amopmethod = p2.oid AND
-    p1.amoppurpose = 'o' AND NOT p2.amcanorderbyop;
+    p1.amoppurpose = 'o' AND p2.amname NOT IN ('gist', 'spgist');
 
--- Cross-check amopstrategy index against parent AM
+-- Cross-check amopstrategy index against parent AM.  The AMs' strategy
+-- counts are no longer visible in pg_am, so they are hard-wired here.
 
 SELECT p1.amopfamily, p1.amopopr, p2.oid, p2.amname
 FROM pg_amop AS p1, pg_am AS p2
 WHERE p1.amopmethod = p2.oid AND
-    p1.amopstrategy > p2.amstrategies AND p2.amstrategies <> 0;
+    p1.amopstrategy > CASE p2.amname WHEN 'btree' THEN 5
+                                     WHEN 'hash' THEN 1
+                                     WHEN 'bloom' THEN 1
+                                     ELSE 32767 END;
 
 -- Detect missing pg_amop entries: should have as many strategy operators
 -- as AM expects for each datatype combination supported by the opfamily.
@@ -1016,19 +1038,20 @@ WHERE p1.amopmethod = p2.oid AND
 SELECT p1.amname, p2.amoplefttype, p2.amoprighttype
 FROM pg_am AS p1, pg_amop AS p2
 WHERE p2.amopmethod = p1.oid AND
-    p1.amstrategies <> 0 AND
-    p1.amstrategies != (SELECT count(*) FROM pg_amop AS p3
-                        WHERE p3.amopfamily = p2.amopfamily AND
-                              p3.amoplefttype = p2.amoplefttype AND
-                              p3.amoprighttype = p2.amoprighttype AND
-                              p3.amoppurpose = 's');
+    p1.amname IN ('btree', 'hash', 'bloom') AND
+    CASE p1.amname WHEN 'btree' THEN 5 ELSE 1 END !=
+        (SELECT count(*) FROM pg_amop AS p3
+         WHERE p3.amopfamily = p2.amopfamily AND
+               p3.amoplefttype = p2.amoplefttype AND
+               p3.amoprighttype = p2.amoprighttype AND
+               p3.amoppurpose = 's');
 
 -- Currently, none of the AMs with fixed strategy sets support ordering ops.
 
 SELECT p1.amname, p2.amopfamily, p2.amopstrategy
 FROM pg_am AS p1, pg_amop AS p2
 WHERE p2.amopmethod = p1.oid AND
-    p1.amstrategies <> 0 AND p2.amoppurpose <> 's';
+    p1.amname IN ('btree', 'hash', 'bloom') AND p2.amoppurpose <> 's';
 
 -- Check that amopopr points at a reasonable-looking operator, ie a binary
 -- operator.  If it's a search operator it had better yield boolean,
@@ -1176,12 +1199,20 @@ FROM pg_amproc as p1
 WHERE p1.amprocfamily = 0 OR p1.amproclefttype = 0 OR p1.amprocrighttype = 0
     OR p1.amprocnum < 1 OR p1.amproc = 0;
 
--- Cross-check amprocnum index against parent AM
+-- Cross-check amprocnum index against parent AM.  As above, the AMs'
+-- support function counts are hard-wired here.
 
 SELECT p1.amprocfamily, p1.amprocnum, p2.oid, p2.amname
 FROM pg_amproc AS p1, pg_am AS p2, pg_opfamily AS p3
 WHERE p1.amprocfamily = p3.oid AND p3.opfmethod = p2.oid AND
-    p1.amprocnum > p2.amsupport;
+    p1.amprocnum > CASE p2.amname WHEN 'btree' THEN 2
+                                  WHEN 'hash' THEN 1
+                                  WHEN 'gist' THEN 10
+                                  WHEN 'gin' THEN 6
+                                  WHEN 'spgist' THEN 5
+                                  WHEN 'brin' THEN 15
+                                  WHEN 'bloom' THEN 1
+                                  ELSE 0 END;
 
 -- Detect missing pg_amproc entries: should have as many support functions
 -- as AM expects for each datatype combination supported by the opfamily.
@@ -1196,17 +1227,19 @@ SELECT * FROM (
 WHERE NOT (
   -- btree has one mandatory and one optional support function.
   -- hash has one support function, which is mandatory.
-  -- GiST has eight support functions, one of which is optional.
+  -- GiST has ten support functions; 8 through 10 are optional.
   -- GIN has six support functions. 1-3 are mandatory, 5 is optional, and
   --   at least one of 4 and 6 must be given.
   -- SP-GiST has five support functions, all mandatory
   -- BRIN has four mandatory support functions, and a bunch of optionals
+  -- bloom has one support function, which is mandatory
   amname = 'btree' AND procnums @> '{1}' OR
   amname = 'hash' AND procnums = '{1}' OR
   amname = 'gist' AND procnums @> '{1, 2, 3, 4, 5, 6, 7}' OR
   amname = 'gin' AND (procnums @> '{1, 2, 3}' AND (procnums && '{4, 6}')) OR
   amname = 'spgist' AND procnums = '{1, 2, 3, 4, 5}' OR
-  amname = 'brin' AND procnums @> '{1, 2, 3, 4}'
+  amname = 'brin' AND procnums @> '{1, 2, 3, 4}' OR
+  amname = 'bloom' AND procnums = '{1}'
 );
 
 -- Also, check if there are any pg_opclass entries that don't seem to have
@@ -1226,7 +1259,8 @@ WHERE NOT (
   amname = 'gist' AND procnums @> '{1, 2, 3, 4, 5, 6, 7}' OR
   amname = 'gin' AND (procnums @> '{1, 2, 3}' AND (procnums && '{4, 6}')) OR
   amname = 'spgist' AND procnums = '{1, 2, 3, 4, 5}' OR
-  amname = 'brin' AND procnums @> '{1, 2, 3, 4}'
+  amname = 'brin' AND procnums @> '{1, 2, 3, 4}' OR
+  amname = 'bloom' AND procnums = '{1}'
 );
 
 -- Unfortunately, we can't check the amproc link very well because the
@@ -1329,7 +1363,8 @@ WHERE p1.amproc = p2.oid AND
 SELECT p1.indexrelid, p1.indrelid
 FROM pg_index as p1
 WHERE p1.indexrelid = 0 OR p1.indrelid = 0 OR
-      p1.indnatts <= 0 OR p1.indnatts > 32;
+      p1.indnatts <= 0 OR p1.indnatts > 32 OR
+      p1.indnkeyatts <= 0 OR p1.indnkeyatts > p1.indnatts;
 
 -- oidvector and int2vector fields should be of length indnatts.
 
@@ -271,3 +271,55 @@ create temp table tt1 as select * from int8_tbl limit 2;
 create temp table tt2 () inherits(tt1);
 insert into tt2 values(0,0);
 select row_to_json(r) from (select q2,q1 from tt1 offset 0) r;
+
+--
+-- Sorting and indexing records abbreviates on their first column.  The
+-- sorts below are not bounded by their LIMIT, so that they abbreviate.
+--
+create type abbrev_int as (a int4, b text);
+create type abbrev_text as (a text, b int4);
+create temp table abbrev_test as
+  select row(case when i % 7 = 0 then null else (i * 37) % 1000 - 500 end,
+             i::text)::abbrev_int as ri,
+         row(case when i % 11 = 0 then null else 'k' || (i * 37) % 500 end,
+             i)::abbrev_text as rt,
+         row(null, i)::abbrev_text as rn
+  from generate_series(1, 20000) i;
+
+-- ties on the first column are broken by the full record comparison
+select ri from (select ri from abbrev_test order by ri offset 0) s limit 5;
+select rt from (select rt from abbrev_test order by rt offset 0) s limit 5;
+select rn from (select rn from abbrev_test order by rn offset 0) s limit 3;
+-- a NULL first column sorts after all others
+select ri from (select ri from abbrev_test order by ri offset 0) s
+  offset 17140 limit 4;
+select ri from (select ri from abbrev_test order by ri desc offset 0) s
+  limit 3;
+select rt from (select rt from abbrev_test order by rt offset 0) s
+  offset 18180 limit 4;
+select rn from (select rn from abbrev_test order by rn desc offset 0) s
+  limit 3;
+
+create index abbrev_test_ri on abbrev_test (ri);
+create index abbrev_test_rt on abbrev_test (rt);
+create index abbrev_test_rn on abbrev_test (rn);
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+set enable_sort = off;
+
+select ri from abbrev_test order by ri limit 5;
+select rt from abbrev_test order by rt limit 5;
+select rn from abbrev_test order by rn limit 3;
+select ri from abbrev_test order by ri offset 17140 limit 4;
+select ri from abbrev_test order by ri desc limit 3;
+select rt from abbrev_test order by rt offset 18180 limit 4;
+select rn from abbrev_test order by rn desc limit 3;
+select count(*) from abbrev_test where ri = row(null, '700')::abbrev_int;
+select count(*) from abbrev_test where rt = row('k3', 10000)::abbrev_text;
+
+reset enable_seqscan;
+reset enable_bitmapscan;
+reset enable_sort;
+drop table abbrev_test;
+drop type abbrev_int;
+drop type abbrev_text;
@@ -148,5 +148,23 @@ SELECT st.heap_blks_read + st.heap_blks_hit >= pr.heap_blks + cl.relpages,
 SELECT pr.snap_ts < pg_stat_get_snapshot_timestamp() as snapshot_newer
 FROM prevstats AS pr;
 
+-- with track_wal_flush_timing on, commits that have to flush WAL are
+-- counted in the WAL flush latency histogram
+CREATE TEMP TABLE prevflush AS
+  SELECT sum(flush_waits) AS waits FROM pg_stat_get_wal_flush_latency();
+SET track_wal_flush_timing = on;
+CREATE TABLE flush_stats_test (a int);
+INSERT INTO flush_stats_test VALUES (1);
+INSERT INTO flush_stats_test VALUES (2);
+RESET track_wal_flush_timing;
+
+SELECT count(*), count(bucket_upper_usec) AS bounded,
+       sum(flush_waits) - pr.waits > 0 AS waits_counted,
+       sum(flush_waits) >= sum(flush_writes) AS waits_cover_writes
+  FROM pg_stat_get_wal_flush_latency(), prevflush AS pr
+ GROUP BY pr.waits;
+
+DROP TABLE flush_stats_test;
+
 DROP TABLE trunc_stats_test, trunc_stats_test1, trunc_stats_test2, trunc_stats_test3, trunc_stats_test4;
 -- End of Stats Test
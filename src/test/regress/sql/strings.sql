@@ -559,3 +559,33 @@ SELECT btrim(E'\\000trim\\000'::bytea, ''::bytea);
 SELECT encode(overlay(E'Th\\000omas'::bytea placing E'Th\\001omas'::bytea from 2),'escape');
 SELECT encode(overlay(E'Th\\000omas'::bytea placing E'\\002\\003'::bytea from 8),'escape');
 SELECT encode(overlay(E'Th\\000omas'::bytea placing E'\\002\\003'::bytea from 5 for 3),'escape');
+
+--
+-- Sorting and indexing bytea abbreviates on the leading eight bytes.  The
+-- OFFSET 0 keeps the LIMIT from bounding the sort, which would not abbreviate.
+--
+CREATE TEMP TABLE bytea_sort AS
+  SELECT i AS id, decode(lpad(to_hex((i * 7919) % 10000), 8, '0'), 'hex') AS b
+  FROM generate_series(1, 10000) i
+  UNION ALL
+  -- equal after abbreviation to each other and to 0x00001388
+  SELECT 10000 + i, decode('0000138800000000' || lpad(to_hex(10 - i), 2, '0'), 'hex')
+  FROM generate_series(1, 10) i
+  UNION ALL
+  SELECT 10011, decode('0000138800000000', 'hex');
+SELECT id, encode(b, 'hex')
+  FROM (SELECT id, b FROM bytea_sort ORDER BY b OFFSET 0) s
+  OFFSET 4999 LIMIT 14;
+SELECT id, encode(b, 'hex')
+  FROM (SELECT id, b FROM bytea_sort ORDER BY b DESC OFFSET 0) s LIMIT 3;
+
+CREATE INDEX bytea_sort_idx ON bytea_sort (b);
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT id, encode(b, 'hex') FROM bytea_sort
+  WHERE b > decode('00001386', 'hex') ORDER BY b LIMIT 14;
+SELECT id, encode(b, 'hex') FROM bytea_sort ORDER BY b DESC LIMIT 3;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+
+DROP TABLE bytea_sort;
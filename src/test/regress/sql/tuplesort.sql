@@ -0,0 +1,86 @@
+--
+-- External sorts
+--
+
+-- report only the sort method, the amount of memory or disk varies
+create function explain_sort_method(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in execute 'explain (analyze, costs off, timing off) ' || query
+    loop
+        if ln ~ 'Sort Method' then
+            return next substring(ln from 'Sort Method: [a-z-]+(?: [a-z]+)?');
+        end if;
+    end loop;
+end;
+$$;
+
+-- a permutation of 1..100002, so that sorted position = value
+create temp table sort_test as
+  select (i * 7919) % 100003 as a, md5(i::text) as b
+  from generate_series(1, 100002) i;
+
+-- In 64kB each initial run holds only a few hundred tuples, which makes
+-- far more runs than can be merged at once, so these sorts need more than
+-- one merge pass.
+set work_mem = '64kB';
+
+select explain_sort_method('select a from sort_test order by a');
+
+select count(*), min(a), max(a), bool_and(a = prev + 1) as in_order
+  from (select a, lag(a) over () as prev
+        from (select a from sort_test order by a offset 0) s) t
+  where prev is not null;
+
+select count(*), bool_and(b > prev) as in_order
+  from (select b, lag(b) over () as prev
+        from (select b from sort_test order by b offset 0) s) t
+  where prev is not null;
+
+-- descending, and on two keys
+select count(*), bool_and(a = prev - 1) as in_order
+  from (select a, lag(a) over () as prev
+        from (select a from sort_test order by a desc offset 0) s) t
+  where prev is not null;
+
+select count(*), bool_and((a % 10, b) > (prev_a % 10, prev_b)) as in_order
+  from (select a, b, lag(a) over () as prev_a, lag(b) over () as prev_b
+        from (select a, b from sort_test order by a % 10, b offset 0) s) t
+  where prev_a is not null;
+
+-- the inner sort of a merge join must support mark and restore, so its
+-- result is merged onto a single tape instead of merged on the fly
+set enable_hashjoin = off;
+set enable_nestloop = off;
+select explain_sort_method('select count(*) from sort_test s1 join sort_test s2 using (a)');
+select count(*) from sort_test s1 join sort_test s2 using (a);
+reset enable_hashjoin;
+reset enable_nestloop;
+
+-- random access to the sorted result on tape: scrolling backward and
+-- jumping around in a scrollable cursor
+begin;
+declare c scroll cursor for select a from sort_test order by a;
+fetch 3 from c;
+fetch last from c;
+fetch backward 3 from c;
+fetch absolute 50000 from c;
+fetch backward 2 from c;
+fetch relative 1000 from c;
+fetch first from c;
+fetch prior from c;
+fetch next from c;
+move last in c;
+fetch backward 1 from c;
+close c;
+commit;
+
+-- bounded sort reading its input from a large external sort
+select a from (select a from sort_test order by a desc offset 0) s
+  order by a limit 3;
+
+reset work_mem;
+drop function explain_sort_method(text);